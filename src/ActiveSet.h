@@ -0,0 +1,125 @@
+// ActiveSet.h
+// Incrementally maintained set of active neurons for sparse phase updates
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ============================================================================
+// Activity Parameters
+// ============================================================================
+//
+// A neuron that stays below all three thresholds for `graceFrames`
+// consecutive updates goes dormant. Dormant neurons are revisited in
+// round-robin slices, each once every `dormantPeriod` updates of a phase,
+// and woken at once when something touches them: a photon interaction, a
+// velocity perturbation or a neighbor that has itself just woken up.
+
+struct ActivityParams {
+    bool enabled = false;                // Off: every neuron is updated every time
+    float activationThreshold = 0.02f;
+    float speedThreshold = 2.0f;
+    int connectionThreshold = 32;
+    int graceFrames = 4;
+    int dormantPeriod = 16;
+};
+
+// ============================================================================
+// Active Set
+// ============================================================================
+//
+// Two dense lists, active and dormant, with each neuron's position in its
+// list, so waking or retiring a neuron is an O(1) swap-remove and a phase's
+// work list costs O(active + dormant / period) to build rather than a scan
+// of the population. Not thread-safe: phases that touch it are ordered by
+// the Activity field.
+
+class ActiveSet {
+public:
+    // Every one of `count` neurons starts active
+    void reset(size_t count) {
+        active.resize(count);
+        dormant.clear();
+        slot.resize(count);
+        dormantFlag.assign(count, 0);
+        quiet.assign(count, 0);
+        for (size_t i = 0; i < count; ++i) {
+            active[i] = static_cast<uint32_t>(i);
+            slot[i] = static_cast<uint32_t>(i);
+        }
+    }
+
+    // Rebuilds the set for a renumbered population: neuron i takes over the
+    // state of former neuron from[i], or starts active when that is NONE
+    static constexpr uint32_t NONE = UINT32_MAX;
+    void remap(const std::vector<uint32_t>& from) {
+        const std::vector<uint8_t> wasDormant = dormantFlag, wasQuiet = quiet;
+        reset(from.size());
+        for (size_t i = 0; i < from.size(); ++i) {
+            if (from[i] == NONE || from[i] >= wasDormant.size()) continue;
+            quiet[i] = wasQuiet[from[i]];
+            if (wasDormant[from[i]]) sleep(i);
+        }
+    }
+
+    size_t size() const { return slot.size(); }
+    size_t activeCount() const { return active.size(); }
+    size_t dormantCount() const { return dormant.size(); }
+    bool isActive(size_t i) const { return !dormantFlag[i]; }
+
+    void wake(size_t i) {
+        quiet[i] = 0;
+        if (!dormantFlag[i]) return;
+        move(dormant, active, i);
+        dormantFlag[i] = 0;
+    }
+
+    void sleep(size_t i) {
+        if (dormantFlag[i]) return;
+        move(active, dormant, i);
+        dormantFlag[i] = 1;
+    }
+
+    // Records one update's verdict: neurons quiet for `grace` updates in a
+    // row go dormant, anything else keeps (or regains) its place
+    void settle(size_t i, bool isQuiet, int grace) {
+        if (!isQuiet) {
+            wake(i);
+        } else if (quiet[i] < 255 && ++quiet[i] >= grace) {
+            sleep(i);
+        }
+    }
+
+    // Work list for one phase update: every active neuron, then the next
+    // 1/period slice of the dormant ones starting at `cursor` (owned by the
+    // phase, so phases on different schedules each see every dormant neuron)
+    template <typename Vector>
+    void collectDue(size_t& cursor, int period, Vector& out) const {
+        out.assign(active.begin(), active.end());
+        if (dormant.empty()) return;
+        const size_t slice = (dormant.size() + std::max(1, period) - 1) / std::max(1, period);
+        if (cursor >= dormant.size()) cursor = 0;
+        for (size_t k = 0; k < slice; ++k) {
+            out.push_back(dormant[cursor]);
+            if (++cursor == dormant.size()) cursor = 0;
+        }
+    }
+
+private:
+    std::vector<uint32_t> active, dormant;
+    std::vector<uint32_t> slot;          // Position of each neuron in its list
+    std::vector<uint8_t> dormantFlag;
+    std::vector<uint8_t> quiet;          // Consecutive quiet updates
+
+    void move(std::vector<uint32_t>& from, std::vector<uint32_t>& to, size_t i) {
+        const uint32_t last = from.back();
+        from[slot[i]] = last;
+        slot[last] = slot[i];
+        from.pop_back();
+        slot[i] = static_cast<uint32_t>(to.size());
+        to.push_back(static_cast<uint32_t>(i));
+    }
+};
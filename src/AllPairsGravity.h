@@ -0,0 +1,332 @@
+// AllPairsGravity.h
+// Exact cache-blocked all-pairs gravity with symmetric force accumulation
+
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// Gravity Parameters
+// ============================================================================
+
+struct GravityParams {
+    float gravitationalConstant = 6.67430e-11f;  // m³/kg⋅s²
+    float minDistanceSquared = 0.01f;            // Pairs closer than this are skipped (singularity guard)
+    float softeningSquared = 0.0f;               // Plummer softening ε² added to r²
+};
+
+// ============================================================================
+// Tiled All-Pairs Kernel
+// ============================================================================
+//
+// Every unordered pair (i, j) is visited exactly once and its contribution is
+// applied to both bodies (Newton's third law), halving the work of the naive
+// O(N²) loop. Bodies are split into tiles of TILE_SIZE so that the j-tile's
+// positions, masses and partial accelerations (7 floats per body, ~7 KB) stay
+// in L1 while the i-tile streams over it. The upper triangle of tile pairs is
+// distributed dynamically over the thread pool; each participating thread
+// accumulates into its own acceleration buffer, and a final parallel pass
+// reduces the buffers, so no atomics are needed.
+
+class AllPairsGravity {
+public:
+    static constexpr size_t TILE_SIZE = 256;
+    static constexpr size_t SIMD_LANES = 8;
+
+    // Writes accelerations (not forces) for `count` bodies given in SoA form
+    void computeAccelerations(const float* x, const float* y, const float* z, const float* m,
+                              size_t count, float* ax, float* ay, float* az,
+                              const GravityParams& params, ThreadPool& pool) {
+        if (count == 0) return;
+
+        const size_t tiles = (count + TILE_SIZE - 1) / TILE_SIZE;
+        buildTilePairs(tiles);
+
+        const unsigned slots = pool.concurrency();
+        const size_t stride = count;
+        if (slotBuffers.size() != static_cast<size_t>(slots) * 3 * stride) {
+            slotBuffers.assign(static_cast<size_t>(slots) * 3 * stride, 0.0f);
+        }
+
+        // Accumulate tile-pair interactions into per-slot buffers
+        pool.parallelFor(0, tilePairs.size(), 1, [&](size_t begin, size_t end, unsigned slot) {
+            float* fx = slotBuffers.data() + static_cast<size_t>(slot) * 3 * stride;
+            float* fy = fx + stride;
+            float* fz = fy + stride;
+
+            for (size_t p = begin; p < end; ++p) {
+                const size_t tileI = tilePairs[p].first;
+                const size_t tileJ = tilePairs[p].second;
+                const size_t i0 = tileI * TILE_SIZE, i1 = std::min(count, i0 + TILE_SIZE);
+                const size_t j0 = tileJ * TILE_SIZE, j1 = std::min(count, j0 + TILE_SIZE);
+                interactTiles(x, y, z, m, i0, i1, j0, j1, tileI == tileJ, params, fx, fy, fz);
+            }
+        });
+
+        // Reduce per-slot buffers and leave them zeroed for the next call
+        pool.parallelFor(0, count, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                ax[i] = 0.0f;
+                ay[i] = 0.0f;
+                az[i] = 0.0f;
+            }
+            for (unsigned s = 0; s < slots; ++s) {
+                float* fx = slotBuffers.data() + static_cast<size_t>(s) * 3 * stride;
+                float* fy = fx + stride;
+                float* fz = fy + stride;
+                for (size_t i = begin; i < end; ++i) {
+                    ax[i] += fx[i];
+                    ay[i] += fy[i];
+                    az[i] += fz[i];
+                    fx[i] = 0.0f;
+                    fy[i] = 0.0f;
+                    fz[i] = 0.0f;
+                }
+            }
+        });
+    }
+
+    // Accelerations for up to SIMD_LANES independent small systems at once.
+    // Arrays are interleaved lanes-across-systems: body j of system g lives at
+    // [j * SIMD_LANES + g], so one vector instruction advances the same pair
+    // in every system. Systems shorter than `count` are padded with massless
+    // bodies, which neither feel nor exert a force that matters. Each pair is
+    // visited from both sides (no third-law halving), which for small systems
+    // costs less than the tile bookkeeping it avoids.
+    void computeBatchedAccelerations(const float* x, const float* y, const float* z, const float* m,
+                                     size_t count, float* ax, float* ay, float* az,
+                                     const GravityParams& params, ThreadPool& pool) {
+        const float G = params.gravitationalConstant;
+        const float minD2 = params.minDistanceSquared;
+        const float soft2 = params.softeningSquared;
+        constexpr size_t L = SIMD_LANES;
+
+        pool.parallelFor(0, count, 16, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                float xi[L], yi[L], zi[L];
+                float sumX[L] = {}, sumY[L] = {}, sumZ[L] = {};
+                for (size_t g = 0; g < L; ++g) {
+                    xi[g] = x[i * L + g];
+                    yi[g] = y[i * L + g];
+                    zi[g] = z[i * L + g];
+                }
+
+                for (size_t j = 0; j < count; ++j) {
+                    const float* __restrict xj = x + j * L;
+                    const float* __restrict yj = y + j * L;
+                    const float* __restrict zj = z + j * L;
+                    const float* __restrict mj = m + j * L;
+#pragma GCC unroll 8
+                    for (size_t g = 0; g < L; ++g) {
+                        const float dx = xj[g] - xi[g];
+                        const float dy = yj[g] - yi[g];
+                        const float dz = zj[g] - zi[g];
+                        const float r2 = dx * dx + dy * dy + dz * dz + soft2;
+                        const float invR = 1.0f / std::sqrt(r2);
+                        const float invR3 = (r2 > minD2 && r2 > 0.0f) ? invR * invR * invR : 0.0f;
+                        const float s = G * mj[g] * invR3;
+                        sumX[g] += dx * s;
+                        sumY[g] += dy * s;
+                        sumZ[g] += dz * s;
+                    }
+                }
+
+                for (size_t g = 0; g < L; ++g) {
+                    ax[i * L + g] = sumX[g];
+                    ay[i * L + g] = sumY[g];
+                    az[i * L + g] = sumZ[g];
+                }
+            }
+        });
+    }
+
+    // Adds to (ax, ay, az) the acceleration every target feels from a
+    // separate set of source bodies, e.g. bodies owned by another domain.
+    // Sources never feel the targets back, so no third-law halving here.
+    void accumulateExternalAccelerations(const float* tx, const float* ty, const float* tz, size_t targetCount,
+                                         const float* sx, const float* sy, const float* sz, const float* sm,
+                                         size_t sourceCount, float* ax, float* ay, float* az,
+                                         const GravityParams& params, ThreadPool& pool) {
+        const float G = params.gravitationalConstant;
+        const float minD2 = params.minDistanceSquared;
+        const float soft2 = params.softeningSquared;
+
+        pool.parallelFor(0, targetCount, 64, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                const float xi = tx[i], yi = ty[i], zi = tz[i];
+                float sumX[SIMD_LANES] = {};
+                float sumY[SIMD_LANES] = {};
+                float sumZ[SIMD_LANES] = {};
+
+                size_t j = 0;
+                for (; j + SIMD_LANES <= sourceCount; j += SIMD_LANES) {
+#pragma GCC unroll 8
+                    for (size_t l = 0; l < SIMD_LANES; ++l) {
+                        const float dx = sx[j + l] - xi;
+                        const float dy = sy[j + l] - yi;
+                        const float dz = sz[j + l] - zi;
+                        const float r2 = dx * dx + dy * dy + dz * dz + soft2;
+                        const float invR = 1.0f / std::sqrt(r2);
+                        const float invR3 = (r2 > minD2) ? invR * invR * invR : 0.0f;
+                        const float s = G * sm[j + l] * invR3;
+                        sumX[l] += dx * s;
+                        sumY[l] += dy * s;
+                        sumZ[l] += dz * s;
+                    }
+                }
+
+                float axi = 0.0f, ayi = 0.0f, azi = 0.0f;
+                for (size_t l = 0; l < SIMD_LANES; ++l) {
+                    axi += sumX[l];
+                    ayi += sumY[l];
+                    azi += sumZ[l];
+                }
+                for (; j < sourceCount; ++j) {
+                    const float dx = sx[j] - xi;
+                    const float dy = sy[j] - yi;
+                    const float dz = sz[j] - zi;
+                    const float r2 = dx * dx + dy * dy + dz * dz + soft2;
+                    if (r2 <= minD2) continue;
+                    const float invR = 1.0f / std::sqrt(r2);
+                    const float s = G * sm[j] * invR * invR * invR;
+                    axi += dx * s;
+                    ayi += dy * s;
+                    azi += dz * s;
+                }
+
+                ax[i] += axi;
+                ay[i] += ayi;
+                az[i] += azi;
+            }
+        });
+    }
+
+    // Total pairwise potential energy -Σ G·mi·mj/r, accumulated in double
+    double potentialEnergy(const float* x, const float* y, const float* z, const float* m,
+                           size_t count, const GravityParams& params, ThreadPool& pool) {
+        std::vector<double> partial(pool.concurrency(), 0.0);
+        const double G = params.gravitationalConstant;
+
+        pool.parallelFor(0, count, 64, [&](size_t begin, size_t end, unsigned slot) {
+            double sum = 0.0;
+            for (size_t i = begin; i < end; ++i) {
+                for (size_t j = i + 1; j < count; ++j) {
+                    const double dx = x[j] - x[i];
+                    const double dy = y[j] - y[i];
+                    const double dz = z[j] - z[i];
+                    const double r2 = dx * dx + dy * dy + dz * dz + params.softeningSquared;
+                    if (r2 <= params.minDistanceSquared) continue;
+                    sum -= G * m[i] * m[j] / std::sqrt(r2);
+                }
+            }
+            partial[slot] += sum;
+        });
+
+        double total = 0.0;
+        for (double value : partial) total += value;
+        return total;
+    }
+
+    // Floating-point operations per pair interaction, counted the usual way
+    // (sqrt and divide as one each) for both bodies of the symmetric update
+    static constexpr double FLOPS_PER_PAIR = 27.0;
+
+    static double pairCount(size_t count) {
+        return 0.5 * static_cast<double>(count) * static_cast<double>(count > 0 ? count - 1 : 0);
+    }
+
+private:
+    void buildTilePairs(size_t tiles) {
+        if (tiles == tilePairTiles) return;
+        tilePairs.clear();
+        tilePairs.reserve(tiles * (tiles + 1) / 2);
+        // Row-major upper triangle: consecutive work items reuse the i-tile
+        for (size_t i = 0; i < tiles; ++i) {
+            for (size_t j = i; j < tiles; ++j) {
+                tilePairs.emplace_back(i, j);
+            }
+        }
+        tilePairTiles = tiles;
+    }
+
+    static void interactTiles(const float* __restrict x, const float* __restrict y,
+                              const float* __restrict z, const float* __restrict m,
+                              size_t i0, size_t i1, size_t j0, size_t j1, bool diagonal,
+                              const GravityParams& params,
+                              float* __restrict fx, float* __restrict fy, float* __restrict fz) {
+        const float G = params.gravitationalConstant;
+        const float minD2 = params.minDistanceSquared;
+        const float soft2 = params.softeningSquared;
+
+        for (size_t i = i0; i < i1; ++i) {
+            const float xi = x[i], yi = y[i], zi = z[i];
+            const float gmi = G * m[i];
+
+            float sumX[SIMD_LANES] = {};
+            float sumY[SIMD_LANES] = {};
+            float sumZ[SIMD_LANES] = {};
+
+            size_t j = diagonal ? i + 1 : j0;
+
+            // Fixed-width lane blocks: partial sums per lane let the compiler
+            // vectorize the i-accumulation without reassociating floats
+            for (; j + SIMD_LANES <= j1; j += SIMD_LANES) {
+#pragma GCC unroll 8
+                for (size_t l = 0; l < SIMD_LANES; ++l) {
+                    const float dx = x[j + l] - xi;
+                    const float dy = y[j + l] - yi;
+                    const float dz = z[j + l] - zi;
+                    const float r2 = dx * dx + dy * dy + dz * dz + soft2;
+                    const float invR = 1.0f / std::sqrt(r2);
+                    const float invR3 = (r2 > minD2) ? invR * invR * invR : 0.0f;
+                    const float si = G * m[j + l] * invR3;
+                    const float sj = gmi * invR3;
+                    sumX[l] += dx * si;
+                    sumY[l] += dy * si;
+                    sumZ[l] += dz * si;
+                    fx[j + l] -= dx * sj;
+                    fy[j + l] -= dy * sj;
+                    fz[j + l] -= dz * sj;
+                }
+            }
+
+            float axi = 0.0f, ayi = 0.0f, azi = 0.0f;
+            for (size_t l = 0; l < SIMD_LANES; ++l) {
+                axi += sumX[l];
+                ayi += sumY[l];
+                azi += sumZ[l];
+            }
+
+            for (; j < j1; ++j) {
+                const float dx = x[j] - xi;
+                const float dy = y[j] - yi;
+                const float dz = z[j] - zi;
+                const float r2 = dx * dx + dy * dy + dz * dz + soft2;
+                if (r2 <= minD2) continue;
+                const float invR = 1.0f / std::sqrt(r2);
+                const float invR3 = invR * invR * invR;
+                const float si = G * m[j] * invR3;
+                const float sj = gmi * invR3;
+                axi += dx * si;
+                ayi += dy * si;
+                azi += dz * si;
+                fx[j] -= dx * sj;
+                fy[j] -= dy * sj;
+                fz[j] -= dz * sj;
+            }
+
+            fx[i] += axi;
+            fy[i] += ayi;
+            fz[i] += azi;
+        }
+    }
+
+    std::vector<std::pair<size_t, size_t>> tilePairs;
+    size_t tilePairTiles = 0;
+    std::vector<float> slotBuffers;
+};
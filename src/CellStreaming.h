@@ -0,0 +1,604 @@
+// CellStreaming.h
+// Observer-driven streaming of galaxy cells: active, frozen or evicted to disk
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ============================================================================
+// Streaming Parameters
+// ============================================================================
+//
+// Space is cut into cubic cells. A cell that comes within activeRadius of
+// an observer is simulated normally; out to frozenRadius its neurons are
+// frozen (held in memory, out of every phase); beyond that they are
+// evicted to disk. A cell is demoted only once it is `hysteresis`
+// (relative) past a radius and promoted as soon as it is back inside, so an
+// observer hovering at a boundary does not thrash the disk.
+
+struct StreamingParams {
+    bool enabled = false;
+    float cellSize = 1000.0f;
+    float activeRadius = 2500.0f;
+    float frozenRadius = 5000.0f;
+    float hysteresis = 0.1f;
+    std::string directory = ".";     // Where evicted cells are written
+    int updateEvery = 10;            // Frames between streaming passes
+};
+
+struct StreamingChanges {
+    size_t frozen = 0;       // Neurons taken out of the simulation
+    size_t thawed = 0;       // Neurons put back
+    size_t evicted = 0;      // Neurons written out
+    size_t loaded = 0;       // Neurons read back (now frozen)
+};
+
+// ============================================================================
+// Cell File Format
+// ============================================================================
+//
+// One file per eviction: a header naming the cell, the time its neurons
+// were frozen at and how many follow, then one fixed-size record per
+// neuron. Spectra are recomputed from temperature on load; synapses and
+// other transient fields are not kept.
+
+namespace CellFormat {
+
+constexpr char MAGIC[8] = {'N', 'E', 'B', 'C', 'E', 'L', 'L', '2'};
+
+struct Header {
+    char magic[8];
+    int64_t x, y, z;
+    double frozenAt;
+    uint64_t count;
+};
+
+struct Record {
+    float x, y, z;
+    float vx, vy, vz;
+    float mass;
+    float luminosity;
+    float temperature;
+    float age;
+    float activation;
+    int32_t connections;
+    uint32_t slot;
+};
+
+template <typename Particle>
+Record toRecord(const Particle& p) {
+    return Record{p.position.x, p.position.y, p.position.z, p.velocity.x, p.velocity.y, p.velocity.z,
+                  p.mass, p.luminosity, p.temperature, p.age, p.activation, static_cast<int32_t>(p.connections),
+                  static_cast<uint32_t>(p.slot)};
+}
+
+template <typename Particle>
+Particle fromRecord(const Record& r) {
+    Particle p;
+    p.position.x = r.x;
+    p.position.y = r.y;
+    p.position.z = r.z;
+    p.velocity.x = r.vx;
+    p.velocity.y = r.vy;
+    p.velocity.z = r.vz;
+    p.mass = r.mass;
+    p.luminosity = r.luminosity;
+    p.temperature = r.temperature;
+    p.age = r.age;
+    p.activation = r.activation;
+    p.connections = r.connections;
+    p.slot = r.slot;
+    p.updateSpectrum();
+    return p;
+}
+
+inline bool write(const std::string& path, const Header& header, const std::vector<Record>& records) {
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(Record));
+    file.close();
+    if (!file) {
+        std::cerr << "Error: could not write cell file " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+inline bool read(const std::string& path, Header& header, std::vector<Record>& records) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        std::cerr << "Error: " << path << " is not a NEBULA cell file" << std::endl;
+        return false;
+    }
+    records.resize(header.count);
+    if (!file.read(reinterpret_cast<char*>(records.data()), records.size() * sizeof(Record))) {
+        std::cerr << "Error: " << path << " is truncated" << std::endl;
+        records.clear();
+        return false;
+    }
+    return true;
+}
+
+} // namespace CellFormat
+
+// ============================================================================
+// Cell Streamer
+// ============================================================================
+//
+// Holds the neurons of every cell that is not active. Frozen neurons
+// advance analytically: they coast on their velocity, so catching a cell
+// up on thaw is one multiply-add per neuron however long it was frozen
+// (pair forces between neurons of a few solar masses are far too weak to
+// bend a path noticeably over that time). Evicted cells carry the time
+// they were frozen at, so they catch up the same way once reloaded.
+//
+// All file I/O runs on one background thread in submission order, so a
+// read of a cell always sees the writes queued before it. The thread starts
+// with the first queued job, so a streamer that never evicts costs none. update() starts
+// reads for evicted cells observers are approaching and, on a later pass,
+// merges whatever has arrived; a frame never waits for the disk. A cell's
+// records stay with its write job until the write succeeds; a failed write
+// hands them back and they are frozen again on the next pass, so a full or
+// vanished disk costs memory, never neurons.
+//
+// Superparticles (see LevelOfDetail.h) are never streamed: their members
+// live with the LOD hierarchy, and they are already cheap.
+//
+// Particles need the fields of CellFormat::Record plus `superparticle` and
+// updateSpectrum(). The slots of evicted neurons are kept in memory, so
+// forEachSlot() can report every held neuron without touching the disk.
+
+template <typename Particle>
+class CellStreamer {
+public:
+    CellStreamer() = default;
+
+    ~CellStreamer() {
+        if (io.joinable()) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_all();
+            io.join();
+        }
+        for (auto& entry : cells) {
+            for (const std::string& path : entry.second.files) std::remove(path.c_str());
+        }
+        for (Loaded& loaded : completed) {
+            for (const std::string& path : loaded.paths) std::remove(path.c_str());
+        }
+    }
+
+    CellStreamer(const CellStreamer&) = delete;
+    CellStreamer& operator=(const CellStreamer&) = delete;
+
+    // Streaming stays off, and false is returned, when evicted cells could
+    // not be written to the directory
+    bool setParams(const StreamingParams& p) {
+        streamingParams = p;
+        if (p.enabled && !directoryWritable(p.directory)) {
+            std::cerr << "Error: streaming directory " << p.directory << " is not a writable directory" << std::endl;
+            streamingParams.enabled = false;
+            return false;
+        }
+        return true;
+    }
+
+    static bool directoryWritable(const std::string& directory) {
+        struct stat info;
+        return stat(directory.c_str(), &info) == 0 && S_ISDIR(info.st_mode) &&
+               access(directory.c_str(), W_OK | X_OK) == 0;
+    }
+    const StreamingParams& params() const { return streamingParams; }
+
+    // Neurons held here, in memory and on disk
+    size_t frozenCount() const {
+        size_t total = 0;
+        for (const auto& entry : cells) total += entry.second.resident.size();
+        return total;
+    }
+    size_t evictedCount() const {
+        size_t total = 0;
+        for (const auto& entry : cells) total += entry.second.onDisk;
+        return total;
+    }
+    bool holdsCells() const { return !cells.empty(); }
+    // Whether the I/O thread has been started
+    bool ioStarted() const { return io.joinable(); }
+
+    // Calls visit(slot) for every held neuron, frozen or evicted
+    template <typename Visit>
+    void forEachSlot(Visit&& visit) const {
+        for (const auto& entry : cells) {
+            for (const Particle& p : entry.second.resident) visit(p.slot);
+            for (uint32_t slot : entry.second.diskSlots) visit(slot);
+        }
+    }
+
+    // One streaming pass at simulation time `time`. Active neurons in cells
+    // that should no longer be active are frozen; frozen cells near an
+    // observer are thawed (appended to `particles`), distant ones evicted;
+    // evicted cells observers approach start loading.
+    template <typename Point>
+    StreamingChanges update(std::vector<Particle>& particles, double time, const std::vector<Point>& observers) {
+        StreamingChanges changes;
+        collectLoads(time, changes);
+
+        const float demoteActive = streamingParams.activeRadius * (1.0f + streamingParams.hysteresis);
+        const float demoteFrozen = streamingParams.frozenRadius * (1.0f + streamingParams.hysteresis);
+
+        // Freeze active neurons whose cell moved out of range
+        size_t kept = 0;
+        for (size_t i = 0; i < particles.size(); ++i) {
+            Particle& p = particles[i];
+            if (p.superparticle < 0) {
+                const CellKey key = cellOf(p.position);
+                if (distance(key, observers) >= demoteActive) {
+                    Cell& cell = cells[key];
+                    catchUp(cell, time);
+                    cell.resident.push_back(std::move(p));
+                    ++changes.frozen;
+                    continue;
+                }
+            }
+            if (kept != i) particles[kept] = std::move(p);
+            ++kept;
+        }
+        particles.resize(kept);
+
+        for (auto it = cells.begin(); it != cells.end();) {
+            Cell& cell = it->second;
+            const float d = distance(it->first, observers);
+            if (d < streamingParams.activeRadius) {
+                catchUp(cell, time);
+                changes.thawed += cell.resident.size();
+                for (Particle& p : cell.resident) particles.push_back(std::move(p));
+                cell.resident.clear();
+                if (!cell.files.empty() && !cell.loading) requestLoad(it->first, cell);
+            } else if (d < streamingParams.frozenRadius) {
+                if (!cell.files.empty() && !cell.loading) requestLoad(it->first, cell);
+            } else if (d >= demoteFrozen && !cell.resident.empty() && !cell.writeFailed) {
+                changes.evicted += cell.resident.size();
+                requestWrite(it->first, cell);
+            }
+            cell.writeFailed = false;
+            if (cell.resident.empty() && cell.files.empty() && !cell.loading) {
+                it = cells.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return changes;
+    }
+
+    // Brings every held neuron back into `particles`, waiting for the disk;
+    // used when streaming is switched off
+    void restoreAll(std::vector<Particle>& particles, double time, StreamingChanges& changes) {
+        for (auto& entry : cells) {
+            if (!entry.second.files.empty() && !entry.second.loading) requestLoad(entry.first, entry.second);
+        }
+        waitForIo();
+        collectLoads(time, changes);
+        for (auto& entry : cells) {
+            catchUp(entry.second, time);
+            changes.thawed += entry.second.resident.size();
+            for (Particle& p : entry.second.resident) particles.push_back(std::move(p));
+            if (entry.second.onDisk > 0) {
+                std::cerr << "Error: " << entry.second.onDisk << " streamed-out neurons are in unreadable cell files"
+                          << std::endl;
+            }
+        }
+        cells.clear();
+    }
+
+    // Appends copies of every held neuron as of `time`, reading evicted
+    // cells from disk; the cells stay where they are. Used for snapshots.
+    void snapshot(std::vector<Particle>& out, double time) {
+        waitForIo();
+        StreamingChanges ignored;
+        collectLoads(time, ignored);
+        for (const auto& entry : cells) {
+            for (const Particle& resident : entry.second.resident) {
+                Particle p = resident;
+                coast(p, time - entry.second.frozenAt);
+                out.push_back(std::move(p));
+            }
+            for (const std::string& path : entry.second.files) {
+                CellFormat::Header header;
+                std::vector<CellFormat::Record> records;
+                if (!CellFormat::read(path, header, records)) continue;
+                for (const CellFormat::Record& r : records) {
+                    Particle p = CellFormat::fromRecord<Particle>(r);
+                    coast(p, time - header.frozenAt);
+                    out.push_back(std::move(p));
+                }
+            }
+        }
+    }
+
+    // Forgets every held neuron and deletes their files; used when the
+    // galaxy is reinitialized or loaded from a snapshot
+    void clear() {
+        waitForIo();
+        StreamingChanges ignored;
+        collectLoads(0.0, ignored);
+        for (auto& entry : cells) {
+            for (const std::string& path : entry.second.files) std::remove(path.c_str());
+        }
+        cells.clear();
+    }
+
+    // Copies another streamer's cells (reading its evicted ones into memory)
+    // so a forked galaxy starts with the complete state
+    void inherit(CellStreamer& parent, double time) {
+        streamingParams = parent.streamingParams;
+        parent.waitForIo();
+        StreamingChanges ignored;
+        parent.collectLoads(time, ignored);
+        for (auto& entry : parent.cells) {
+            Cell& cell = cells[entry.first];
+            cell.frozenAt = entry.second.frozenAt;
+            cell.resident = entry.second.resident;
+            for (const std::string& path : entry.second.files) {
+                CellFormat::Header header;
+                std::vector<CellFormat::Record> records;
+                if (!CellFormat::read(path, header, records)) continue;
+                merge(cell, header.frozenAt, records, time);
+            }
+        }
+    }
+
+    // Blocks until every queued write and read has finished
+    void waitForIo() {
+        std::unique_lock<std::mutex> lock(mutex);
+        idle.wait(lock, [&]() { return jobs.empty() && !busy; });
+    }
+
+private:
+    struct CellKey {
+        int64_t x, y, z;
+        bool operator<(const CellKey& o) const { return std::tie(x, y, z) < std::tie(o.x, o.y, o.z); }
+    };
+
+    struct Cell {
+        double frozenAt = 0.0;
+        std::vector<Particle> resident;      // Frozen, in memory
+        std::vector<std::string> files;      // Evicted batches on disk
+        std::vector<uint32_t> diskSlots;     // Slots of the neurons in them
+        size_t onDisk = 0;
+        bool loading = false;
+        bool writeFailed = false;            // Records handed back this pass; retry next pass
+    };
+
+    struct Job {
+        bool write;
+        CellKey key;
+        std::vector<std::string> paths;
+        CellFormat::Header header{};
+        std::vector<CellFormat::Record> records;
+    };
+
+    // A finished read, or a failed write handing its records back
+    struct Loaded {
+        CellKey key;
+        std::vector<std::string> paths;
+        std::vector<std::pair<double, std::vector<CellFormat::Record>>> batches;
+        std::string failedWrite;
+    };
+
+    StreamingParams streamingParams;
+    std::map<CellKey, Cell> cells;
+    uint64_t fileSerial = 0;
+    std::vector<std::string> abandoned;   // Failed writes a queued read still names
+
+    std::mutex mutex;
+    std::condition_variable wake, idle;
+    std::deque<Job> jobs;
+    std::vector<Loaded> completed;
+    bool busy = false;
+    bool stopping = false;
+    std::thread io;
+
+    template <typename Position>
+    CellKey cellOf(const Position& p) const {
+        const float e = streamingParams.cellSize;
+        return CellKey{static_cast<int64_t>(std::floor(p.x / e)), static_cast<int64_t>(std::floor(p.y / e)),
+                       static_cast<int64_t>(std::floor(p.z / e))};
+    }
+
+    // Distance from the nearest observer to the nearest point of the cell,
+    // so the cell an observer is in is always active
+    template <typename Point>
+    float distance(const CellKey& key, const std::vector<Point>& observers) const {
+        const float e = streamingParams.cellSize;
+        auto gap = [e](int64_t k, float o) {
+            const float lo = k * e, hi = lo + e;
+            return o < lo ? lo - o : o > hi ? o - hi : 0.0f;
+        };
+        float nearest = std::numeric_limits<float>::max();
+        for (const Point& o : observers) {
+            const float dx = gap(key.x, o.x), dy = gap(key.y, o.y), dz = gap(key.z, o.z);
+            nearest = std::min(nearest, std::sqrt(dx * dx + dy * dy + dz * dz));
+        }
+        return nearest;
+    }
+
+    static void coast(Particle& p, double dt) {
+        const float t = static_cast<float>(dt);
+        p.position = p.position + p.velocity * t;
+        p.age += t;
+    }
+
+    // Advances the resident neurons to `time` and restamps the cell
+    static void catchUp(Cell& cell, double time) {
+        if (cell.frozenAt != time) {
+            for (Particle& p : cell.resident) coast(p, time - cell.frozenAt);
+        }
+        cell.frozenAt = time;
+    }
+
+    static void merge(Cell& cell, double frozenAt, const std::vector<CellFormat::Record>& records, double time) {
+        catchUp(cell, time);
+        for (const CellFormat::Record& r : records) {
+            Particle p = CellFormat::fromRecord<Particle>(r);
+            coast(p, time - frozenAt);
+            cell.resident.push_back(std::move(p));
+        }
+    }
+
+    void collectLoads(double time, StreamingChanges& changes) {
+        std::vector<Loaded> arrived;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            arrived.swap(completed);
+        }
+        for (Loaded& loaded : arrived) {
+            Cell& cell = cells[loaded.key];
+            if (!loaded.failedWrite.empty()) {
+                // The neurons were never on disk: freeze them again
+                cell.writeFailed = true;
+                auto file = std::find(cell.files.begin(), cell.files.end(), loaded.failedWrite);
+                if (file != cell.files.end()) {
+                    cell.files.erase(file);
+                } else {
+                    abandoned.push_back(loaded.failedWrite);
+                }
+            } else {
+                cell.loading = false;
+                for (const std::string& path : loaded.paths) {   // Unreadable
+                    auto gone = std::find(abandoned.begin(), abandoned.end(), path);
+                    if (gone != abandoned.end()) {
+                        abandoned.erase(gone);
+                    } else {
+                        cell.files.push_back(path);
+                    }
+                }
+            }
+            for (auto& batch : loaded.batches) {
+                if (loaded.failedWrite.empty()) changes.loaded += batch.second.size();
+                cell.onDisk -= std::min(cell.onDisk, batch.second.size());
+                forgetSlots(cell, batch.second);
+                merge(cell, batch.first, batch.second, time);
+            }
+        }
+    }
+
+    static void forgetSlots(Cell& cell, const std::vector<CellFormat::Record>& records) {
+        std::vector<uint32_t> loaded;
+        loaded.reserve(records.size());
+        for (const CellFormat::Record& r : records) loaded.push_back(r.slot);
+        std::sort(loaded.begin(), loaded.end());
+        std::sort(cell.diskSlots.begin(), cell.diskSlots.end());
+        std::vector<uint32_t> remaining;
+        std::set_difference(cell.diskSlots.begin(), cell.diskSlots.end(), loaded.begin(), loaded.end(),
+                            std::back_inserter(remaining));
+        cell.diskSlots.swap(remaining);
+    }
+
+    void requestWrite(const CellKey& key, Cell& cell) {
+        Job job;
+        job.write = true;
+        job.key = key;
+        job.paths.push_back(streamingParams.directory + "/nebula_cell_" + std::to_string(getpid()) + "_" +
+                            std::to_string(reinterpret_cast<uintptr_t>(this)) + "_" +
+                            std::to_string(fileSerial++) + ".nbc");
+        std::memcpy(job.header.magic, CellFormat::MAGIC, sizeof(CellFormat::MAGIC));
+        job.header.x = key.x;
+        job.header.y = key.y;
+        job.header.z = key.z;
+        job.header.frozenAt = cell.frozenAt;
+        job.header.count = cell.resident.size();
+        job.records.reserve(cell.resident.size());
+        for (const Particle& p : cell.resident) {
+            job.records.push_back(CellFormat::toRecord(p));
+            cell.diskSlots.push_back(static_cast<uint32_t>(p.slot));
+        }
+
+        cell.files.push_back(job.paths.front());
+        cell.onDisk += cell.resident.size();
+        cell.resident.clear();
+        cell.resident.shrink_to_fit();
+        enqueue(std::move(job));
+    }
+
+    void requestLoad(const CellKey& key, Cell& cell) {
+        Job job;
+        job.write = false;
+        job.key = key;
+        job.paths.swap(cell.files);
+        cell.loading = true;
+        enqueue(std::move(job));
+    }
+
+    void enqueue(Job&& job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        if (!io.joinable()) io = std::thread([this]() { ioLoop(); });
+        wake.notify_one();
+    }
+
+    void ioLoop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [&]() { return stopping || !jobs.empty(); });
+            if (jobs.empty()) return;   // Stopping with nothing left to do
+            Job job = std::move(jobs.front());
+            jobs.pop_front();
+            busy = true;
+            lock.unlock();
+
+            Loaded loaded;
+            bool report = !job.write;
+            if (job.write) {
+                if (!CellFormat::write(job.paths.front(), job.header, job.records)) {
+                    std::remove(job.paths.front().c_str());
+                    loaded.key = job.key;
+                    loaded.failedWrite = job.paths.front();
+                    loaded.batches.emplace_back(job.header.frozenAt, std::move(job.records));
+                    report = true;
+                }
+            } else {
+                loaded.key = job.key;
+                for (const std::string& path : job.paths) {
+                    CellFormat::Header header;
+                    std::vector<CellFormat::Record> records;
+                    if (CellFormat::read(path, header, records)) {
+                        loaded.batches.emplace_back(header.frozenAt, std::move(records));
+                        std::remove(path.c_str());
+                    } else {
+                        loaded.paths.push_back(path);
+                    }
+                }
+            }
+
+            lock.lock();
+            if (report) completed.push_back(std::move(loaded));
+            busy = false;
+            if (jobs.empty()) idle.notify_all();
+        }
+    }
+};
@@ -0,0 +1,348 @@
+// ClusterTracking.h
+// Persistent cluster identities across clustering passes
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Clustering.h"
+#include "SlotMap.h"
+#include "ThreadPool.h"
+
+// ============================================================================
+// Tracking Parameters and Events
+// ============================================================================
+//
+// A cluster of one pass and a cluster of the next are linked when they
+// share at least linkFraction of the smaller one's members. Statistics are
+// exponential moving averages giving the newest pass weight `smoothing`.
+
+struct TrackingParams {
+    float linkFraction = 0.3f;
+    float smoothing = 0.2f;
+};
+
+enum class ClusterEventType { Birth, Death, Merge, Split };
+
+// Birth and Death name only `cluster`. A Merge names the survivor and, as
+// `other`, the cluster absorbed into it (now dead); a Split names the
+// cluster split from and, as `other`, the new fragment.
+struct ClusterEvent {
+    ClusterEventType type;
+    SlotHandle cluster;
+    SlotHandle other;
+    uint64_t pass = 0;
+};
+
+struct TrackingChanges {
+    size_t born = 0;
+    size_t died = 0;
+    size_t merged = 0;
+    size_t split = 0;
+    size_t memberships = 0;   // Neurons whose persistent cluster changed
+};
+
+// One persistent cluster. `stability` is the moving average of the
+// Jaccard overlap between its members in consecutive passes: 1 for a
+// cluster that keeps every member, 0 on the pass it appears. It is the
+// measure AneurysmSignature::TemporalStability of the medical translator
+// asks for.
+struct TrackedCluster {
+    SlotHandle id;
+    uint64_t born = 0;          // Pass it appeared in
+    uint64_t lastSeen = 0;
+    uint32_t passes = 0;        // Passes it has been seen in
+    uint32_t index = 0;         // Its ClusterID in the latest ClusterResult
+    ClusterSummary latest;
+
+    double meanSize = 0.0;
+    double meanMass = 0.0;
+    double meanLuminosity = 0.0;
+    ClusterVector meanVelocity;
+    ClusterVector meanAngularMomentum;
+    float stability = 0.0f;
+};
+
+// ============================================================================
+// Cluster Tracker
+// ============================================================================
+//
+// Members are named by handle, so the tracker follows clusters through
+// LOD, streaming and fusion passes that renumber the neurons. Every neuron
+// slot remembers the persistent cluster it was last in. A pass then:
+//
+//  1. Counts, for each new cluster in parallel, how many of its members
+//     come from each persistent cluster. The counters are indexed by
+//     persistent slot and reset through a touched list, so the work is one
+//     visit per member and the overlap table holds only pairs that share
+//     members; no cluster is ever compared with another.
+//  2. Links each new cluster to its largest predecessor and each
+//     predecessor to its largest successor (ties to the smaller index).
+//     A mutual pair whose link holds continues the persistent cluster;
+//     other clusters are split fragments if their predecessor link holds,
+//     else births.
+//     Persistent clusters not continued merge into their successor if
+//     that link holds, else die.
+//  3. Rewrites the remembered cluster of neurons whose cluster changed;
+//     neurons that stayed put cost a compare.
+//
+// Handles of dead clusters fail lookups, so holders notice deaths and
+// merges without reading the events.
+
+class ClusterTracker {
+public:
+    void setParams(const TrackingParams& p) { trackingParams = p; }
+    const TrackingParams& params() const { return trackingParams; }
+
+    // Advances by one clustering pass. handleOf(i) is the handle of
+    // particle i of the clustered array, and every handle's slot is below
+    // slotCount.
+    template <typename HandleOf>
+    const std::vector<ClusterEvent>& update(const ClusterResult& result, size_t slotCount,
+                                            HandleOf&& handleOf, ThreadPool& pool) {
+        ++currentPass;
+        passEvents.clear();
+        passChanges = TrackingChanges();
+        if (membership.size() < slotCount) membership.resize(slotCount);
+
+        countOverlaps(result, handleOf, pool);
+        linkClusters(result);
+        assignIdentities(result);
+        updateMemberships(result, handleOf, pool);
+        return passEvents;
+    }
+
+    // Persistent cluster of ClusterID c in the latest pass
+    SlotHandle idOf(size_t c) const { return currentIds[c]; }
+
+    const TrackedCluster* get(SlotHandle id) const { return tracked.get(id); }
+    bool alive(SlotHandle id) const { return tracked.contains(id); }
+    const SlotMap<TrackedCluster>& clusters() const { return tracked; }
+
+    const std::vector<ClusterEvent>& events() const { return passEvents; }
+    const TrackingChanges& changes() const { return passChanges; }
+    uint64_t pass() const { return currentPass; }
+
+    void clear() {
+        tracked.clear();
+        membership.clear();
+        currentIds.clear();
+        passEvents.clear();
+        passChanges = TrackingChanges();
+    }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Membership {
+        uint32_t generation = 0;   // Of the neuron in this slot
+        SlotHandle cluster;
+    };
+
+    // `overlap` members of new cluster `current` came from persistent slot
+    // `previous`
+    struct Link {
+        uint32_t current;
+        uint32_t previous;
+        uint32_t overlap;
+    };
+
+    TrackingParams trackingParams;
+    SlotMap<TrackedCluster> tracked;
+    std::vector<Membership> membership;   // Per neuron slot
+    std::vector<SlotHandle> currentIds;   // Per ClusterID of the latest pass
+    std::vector<ClusterEvent> passEvents;
+    TrackingChanges passChanges;
+    uint64_t currentPass = 0;
+
+    // Scratch
+    std::vector<std::vector<Link>> linksOf;             // Per new cluster
+    std::vector<std::vector<uint32_t>> slotCounts;      // Per thread, per persistent slot
+    std::vector<uint32_t> bestPrevious, bestPreviousOverlap;     // Per new cluster
+    std::vector<uint32_t> bestNext, bestNextOverlap, previousSize;   // Per persistent slot
+    std::vector<SlotHandle> dying;
+
+    template <typename HandleOf>
+    void countOverlaps(const ClusterResult& result, HandleOf& handleOf, ThreadPool& pool) {
+        const uint32_t k = static_cast<uint32_t>(result.clusterCount());
+        const size_t persistentSlots = tracked.slotCount();
+        linksOf.resize(k);
+        slotCounts.resize(pool.concurrency());
+        for (std::vector<uint32_t>& counts : slotCounts) counts.assign(persistentSlots, 0);
+
+        pool.parallelFor(0, k, 1, [&](size_t begin, size_t end, unsigned thread) {
+            std::vector<uint32_t>& counts = slotCounts[thread];
+            for (size_t c = begin; c < end; ++c) {
+                std::vector<Link>& links = linksOf[c];
+                links.clear();
+                for (const uint32_t* i = result.begin(c); i != result.end(c); ++i) {
+                    const SlotHandle from = previousCluster(handleOf(*i));
+                    if (!from.valid()) continue;
+                    if (counts[from.slot]++ == 0) {
+                        links.push_back(Link{static_cast<uint32_t>(c), from.slot, 0});
+                    }
+                }
+                for (Link& link : links) {
+                    link.overlap = counts[link.previous];
+                    counts[link.previous] = 0;
+                }
+            }
+        });
+    }
+
+    // Persistent cluster a neuron was last in, if it still exists
+    SlotHandle previousCluster(SlotHandle neuron) const {
+        const Membership& m = membership[neuron.slot];
+        if (m.generation != neuron.generation || !tracked.contains(m.cluster)) return SlotHandle();
+        return m.cluster;
+    }
+
+    bool holds(const Link& link, const ClusterResult& result) const {
+        const size_t smaller = std::min<size_t>(result.size(link.current), previousSize[link.previous]);
+        return link.overlap > 0 && link.overlap >= trackingParams.linkFraction * smaller;
+    }
+
+    TrackedCluster& at(uint32_t slot) { return *tracked.get(tracked.handleOfSlot(slot)); }
+
+    void linkClusters(const ClusterResult& result) {
+        const uint32_t k = static_cast<uint32_t>(result.clusterCount());
+        const size_t persistentSlots = tracked.slotCount();
+        bestPrevious.assign(k, NONE);
+        bestPreviousOverlap.assign(k, 0);
+        bestNext.assign(persistentSlots, NONE);
+        bestNextOverlap.assign(persistentSlots, 0);
+        previousSize.assign(persistentSlots, 0);
+        for (const TrackedCluster& t : tracked) previousSize[t.id.slot] = t.latest.size;
+
+        // Links are visited by ascending new cluster, so strict comparisons
+        // leave ties with the smaller index
+        for (uint32_t c = 0; c < k; ++c) {
+            for (const Link& link : linksOf[c]) {
+                if (link.overlap > bestPreviousOverlap[c] ||
+                    (link.overlap == bestPreviousOverlap[c] && link.previous < bestPrevious[c])) {
+                    bestPrevious[c] = link.previous;
+                    bestPreviousOverlap[c] = link.overlap;
+                }
+                if (link.overlap > bestNextOverlap[link.previous]) {
+                    bestNext[link.previous] = c;
+                    bestNextOverlap[link.previous] = link.overlap;
+                }
+            }
+        }
+    }
+
+    void assignIdentities(const ClusterResult& result) {
+        const uint32_t k = static_cast<uint32_t>(result.clusterCount());
+        const float s = trackingParams.smoothing;
+        currentIds.assign(k, SlotHandle());
+
+        // Continuations first, so fragments and merges can name them. A
+        // mutual pair whose link does not hold (a cluster replaced by
+        // another that kept a handful of its members) is a death and a birth.
+        for (uint32_t c = 0; c < k; ++c) {
+            const uint32_t p = bestPrevious[c];
+            if (p == NONE || bestNext[p] != c) continue;
+            const Link* link = findLink(c, p);
+            if (!link || !holds(*link, result)) continue;
+            TrackedCluster& t = at(p);
+            const double overlap = bestPreviousOverlap[c];
+            const double jaccard = overlap / (result.size(c) + previousSize[p] - overlap);
+            t.stability = static_cast<float>((1.0 - s) * t.stability + s * jaccard);
+            observe(t, result, c);
+            currentIds[c] = t.id;
+        }
+
+        // Fragments and births
+        for (uint32_t c = 0; c < k; ++c) {
+            if (currentIds[c].valid()) continue;
+            TrackedCluster fresh;
+            fresh.born = currentPass;
+            const SlotHandle id = tracked.insert(fresh);
+            TrackedCluster& t = *tracked.get(id);
+            t.id = id;
+            observe(t, result, c);
+            currentIds[c] = id;
+
+            const uint32_t p = bestPrevious[c];
+            const Link* link = p == NONE ? nullptr : findLink(c, p);
+            if (link && holds(*link, result)) {
+                passEvents.push_back(ClusterEvent{ClusterEventType::Split, tracked.handleOfSlot(p), id, currentPass});
+                ++passChanges.split;
+            } else {
+                passEvents.push_back(ClusterEvent{ClusterEventType::Birth, id, SlotHandle(), currentPass});
+                ++passChanges.born;
+            }
+        }
+
+        // Persistent clusters not seen this pass merged or died
+        dying.clear();
+        for (const TrackedCluster& t : tracked) {
+            if (t.lastSeen != currentPass) dying.push_back(t.id);
+        }
+        for (const SlotHandle& id : dying) {
+            const uint32_t c = bestNext[id.slot];
+            const Link* link = c == NONE ? nullptr : findLink(c, id.slot);
+            if (link && holds(*link, result)) {
+                passEvents.push_back(ClusterEvent{ClusterEventType::Merge, currentIds[c], id, currentPass});
+                ++passChanges.merged;
+            } else {
+                passEvents.push_back(ClusterEvent{ClusterEventType::Death, id, SlotHandle(), currentPass});
+                ++passChanges.died;
+            }
+        }
+        for (const SlotHandle& id : dying) tracked.erase(id);
+    }
+
+    const Link* findLink(uint32_t c, uint32_t previous) const {
+        for (const Link& link : linksOf[c]) {
+            if (link.previous == previous) return &link;
+        }
+        return nullptr;
+    }
+
+    // Takes in cluster c of this pass
+    void observe(TrackedCluster& t, const ClusterResult& result, uint32_t c) {
+        const ClusterSummary& now = result.clusters[c];
+        const double s = t.passes == 0 ? 1.0 : trackingParams.smoothing;
+        auto blend = [s](double mean, double value) { return (1.0 - s) * mean + s * value; };
+        auto blendVector = [&](ClusterVector& mean, const ClusterVector& value) {
+            mean.x = static_cast<float>(blend(mean.x, value.x));
+            mean.y = static_cast<float>(blend(mean.y, value.y));
+            mean.z = static_cast<float>(blend(mean.z, value.z));
+        };
+        t.meanSize = blend(t.meanSize, now.size);
+        t.meanMass = blend(t.meanMass, now.mass);
+        t.meanLuminosity = blend(t.meanLuminosity, now.luminosity);
+        blendVector(t.meanVelocity, now.velocity);
+        blendVector(t.meanAngularMomentum, now.angularMomentum);
+        t.latest = now;
+        t.index = c;
+        t.lastSeen = currentPass;
+        ++t.passes;
+    }
+
+    template <typename HandleOf>
+    void updateMemberships(const ClusterResult& result, HandleOf& handleOf, ThreadPool& pool) {
+        std::vector<size_t> threadChanges(pool.concurrency(), 0);
+        pool.parallelFor(0, result.clusterOf.size(), 4096, [&](size_t begin, size_t end, unsigned thread) {
+            size_t changed = 0;
+            for (size_t i = begin; i < end; ++i) {
+                const SlotHandle neuron = handleOf(i);
+                const int32_t c = result.clusterOf[i];
+                const SlotHandle now = c == ClusterResult::NOISE ? SlotHandle() : currentIds[c];
+                Membership& m = membership[neuron.slot];
+                const SlotHandle before = m.generation == neuron.generation ? m.cluster : SlotHandle();
+                if (before != now) {
+                    m.generation = neuron.generation;
+                    m.cluster = now;
+                    ++changed;
+                }
+            }
+            threadChanges[thread] += changed;
+        });
+        for (size_t changed : threadChanges) passChanges.memberships += changed;
+    }
+};
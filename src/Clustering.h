@@ -0,0 +1,240 @@
+// Clustering.h
+// Parallel grid DBSCAN over neuron positions with per-cluster aggregates
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "ParallelPrimitives.h"
+#include "SpatialGrid.h"
+#include "ThreadPool.h"
+
+// ============================================================================
+// Cluster Parameters
+// ============================================================================
+//
+// DBSCAN: a neuron with at least minPoints neurons (itself included)
+// within epsilon is a core neuron; core neurons within epsilon of each
+// other share a cluster, and a non-core neuron within epsilon of a core
+// neuron joins the cluster of the nearest one. Everything else is noise.
+// Neurons below minActivation take no part at all, which gives the
+// "active clusters" of the UE5 code.
+
+struct ClusterParams {
+    float epsilon = 50.0f;
+    int minPoints = 8;
+    float minActivation = 0.0f;
+};
+
+struct ClusterVector {
+    float x = 0.0f, y = 0.0f, z = 0.0f;
+};
+
+// Aggregates of one cluster. The centroid is mass-weighted, the velocity
+// is that of the center of mass, and the angular momentum is taken about
+// the centroid (the cluster's spin, independent of its bulk motion).
+struct ClusterSummary {
+    uint32_t size = 0;
+    double mass = 0.0;
+    double luminosity = 0.0;
+    ClusterVector centroid;
+    ClusterVector velocity;
+    ClusterVector angularMomentum;
+};
+
+// One clustering of a particle array. ClusterIDs are dense, 0 ..
+// clusters.size() - 1, numbered in order of each cluster's smallest core
+// index, so they are the same whatever the thread count. Members of
+// cluster c are members[memberStart[c] .. memberStart[c + 1]), ascending.
+struct ClusterResult {
+    static constexpr int32_t NOISE = -1;
+
+    std::vector<int32_t> clusterOf;        // ClusterID per particle, or NOISE
+    std::vector<uint32_t> memberStart{0};
+    std::vector<uint32_t> members;
+    std::vector<ClusterSummary> clusters;
+    size_t noise = 0;
+
+    size_t clusterCount() const { return clusters.size(); }
+    size_t size(size_t c) const { return memberStart[c + 1] - memberStart[c]; }
+    const uint32_t* begin(size_t c) const { return members.data() + memberStart[c]; }
+    const uint32_t* end(size_t c) const { return members.data() + memberStart[c + 1]; }
+};
+
+// ============================================================================
+// Cluster Engine
+// ============================================================================
+//
+// Every step is a parallel sweep; nothing compares all pairs:
+//
+//  1. Participating neurons are compacted with a prefix sum and bucketed
+//     in a SpatialGrid with cells of epsilon.
+//  2. Core test: a radius count that stops at minPoints.
+//  3. Core neurons unite with core neighbors in a ConcurrentUnionFind.
+//  4. Border neurons pick their nearest core neighbor. Roots (the smallest
+//     core index of each set) get ClusterIDs by a prefix sum over root
+//     flags.
+//  5. Members are counting-sorted by cluster, and every cluster's
+//     aggregates are summed over its own members, clusters in parallel.
+//
+// Particles need position, velocity, mass, luminosity and activation.
+
+class ClusterEngine {
+public:
+    void setParams(const ClusterParams& p) { clusterParams = p; }
+    const ClusterParams& params() const { return clusterParams; }
+
+    template <typename Source>
+    const ClusterResult& identify(const Source& particles, ThreadPool& pool) {
+        const size_t n = particles.size();
+        const float eps = clusterParams.epsilon;
+        const size_t minPoints = static_cast<size_t>(std::max(1, clusterParams.minPoints));
+
+        // 1. Participants, compacted in index order
+        flags.assign(n, 0);
+        pool.parallelFor(0, n, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                flags[i] = particles[i].activation >= clusterParams.minActivation ? 1 : 0;
+            }
+        });
+        scratch.resize(n + 1);
+        const uint32_t m = parallelExclusiveScan(flags.data(), scratch.data(), n, pool);
+        points.resize(m);
+        pool.parallelFor(0, n, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                if (flags[i]) points[scratch[i]] = static_cast<uint32_t>(i);
+            }
+        });
+        grid.build(m, [&](size_t k) -> const auto& { return particles[points[k]].position; }, eps, pool);
+
+        // 2. Core neurons
+        core.assign(m, 0);
+        pool.parallelFor(0, m, 256, [&](size_t begin, size_t end, unsigned) {
+            for (size_t k = begin; k < end; ++k) {
+                core[k] = grid.countInRadius(particles[points[k]].position, eps, minPoints) >= minPoints;
+            }
+        });
+
+        // 3. Connect core neighbors
+        unionFind.reset(m, pool);
+        pool.parallelFor(0, m, 256, [&](size_t begin, size_t end, unsigned) {
+            for (size_t k = begin; k < end; ++k) {
+                if (!core[k]) continue;
+                const uint32_t self = static_cast<uint32_t>(k);
+                grid.forEachInRadius(particles[points[k]].position, eps, [&](uint32_t j, float) {
+                    if (j > self && core[j]) unionFind.unite(self, j);
+                });
+            }
+        });
+
+        // 4. Anchor of every participant: its own root, or for a border
+        //    neuron the root of its nearest core neighbor
+        anchors.resize(m);
+        pool.parallelFor(0, m, 256, [&](size_t begin, size_t end, unsigned) {
+            for (size_t k = begin; k < end; ++k) {
+                if (core[k]) {
+                    anchors[k] = unionFind.find(static_cast<uint32_t>(k));
+                    continue;
+                }
+                uint32_t nearest = NONE;
+                float nearestD2 = std::numeric_limits<float>::max();
+                grid.forEachInRadius(particles[points[k]].position, eps, [&](uint32_t j, float d2) {
+                    if (core[j] && (d2 < nearestD2 || (d2 == nearestD2 && j < nearest))) {
+                        nearest = j;
+                        nearestD2 = d2;
+                    }
+                });
+                anchors[k] = nearest == NONE ? NONE : unionFind.find(nearest);
+            }
+        });
+        rootFlags.resize(m);
+        pool.parallelFor(0, m, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t k = begin; k < end; ++k) rootFlags[k] = core[k] && anchors[k] == k ? 1 : 0;
+        });
+        clusterIndex.resize(m + 1);
+        const uint32_t clusters = parallelExclusiveScan(rootFlags.data(), clusterIndex.data(), m, pool);
+
+        result.clusterOf.assign(n, ClusterResult::NOISE);
+        pool.parallelFor(0, m, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t k = begin; k < end; ++k) {
+                if (anchors[k] != NONE) result.clusterOf[points[k]] = static_cast<int32_t>(clusterIndex[anchors[k]]);
+            }
+        });
+
+        // 5. Members by cluster, then aggregates
+        result.memberStart.assign(clusters + 1, 0);
+        for (uint32_t k = 0; k < m; ++k) {
+            if (anchors[k] != NONE) ++result.memberStart[clusterIndex[anchors[k]] + 1];
+        }
+        for (uint32_t c = 0; c < clusters; ++c) result.memberStart[c + 1] += result.memberStart[c];
+        result.members.resize(result.memberStart[clusters]);
+        std::vector<uint32_t>& cursor = scratch;   // Free again; reused
+        cursor.assign(result.memberStart.begin(), result.memberStart.end() - 1);
+        for (uint32_t k = 0; k < m; ++k) {
+            if (anchors[k] != NONE) result.members[cursor[clusterIndex[anchors[k]]]++] = points[k];
+        }
+        result.noise = n - result.members.size();
+
+        result.clusters.assign(clusters, ClusterSummary());
+        pool.parallelFor(0, clusters, 16, [&](size_t begin, size_t end, unsigned) {
+            for (size_t c = begin; c < end; ++c) summarize(particles, c);
+        });
+        return result;
+    }
+
+    const ClusterResult& last() const { return result; }
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    ClusterParams clusterParams;
+    SpatialGrid grid;
+    ConcurrentUnionFind unionFind;
+    std::vector<uint32_t> flags, scratch, points, anchors, rootFlags, clusterIndex;
+    std::vector<uint8_t> core;
+    ClusterResult result;
+
+    template <typename Source>
+    void summarize(const Source& particles, size_t c) {
+        double mass = 0.0, luminosity = 0.0;
+        double x = 0.0, y = 0.0, z = 0.0, px = 0.0, py = 0.0, pz = 0.0;
+        for (const uint32_t* i = result.begin(c); i != result.end(c); ++i) {
+            const auto& p = particles[*i];
+            const double w = p.mass;
+            mass += w;
+            luminosity += p.luminosity;
+            x += w * p.position.x;
+            y += w * p.position.y;
+            z += w * p.position.z;
+            px += w * p.velocity.x;
+            py += w * p.velocity.y;
+            pz += w * p.velocity.z;
+        }
+        const double inverse = mass > 0.0 ? 1.0 / mass : 0.0;
+        const double cx = x * inverse, cy = y * inverse, cz = z * inverse;
+
+        // Angular momentum about the centroid
+        double lx = 0.0, ly = 0.0, lz = 0.0;
+        for (const uint32_t* i = result.begin(c); i != result.end(c); ++i) {
+            const auto& p = particles[*i];
+            const double rx = p.position.x - cx, ry = p.position.y - cy, rz = p.position.z - cz;
+            const double w = p.mass;
+            lx += w * (ry * p.velocity.z - rz * p.velocity.y);
+            ly += w * (rz * p.velocity.x - rx * p.velocity.z);
+            lz += w * (rx * p.velocity.y - ry * p.velocity.x);
+        }
+
+        ClusterSummary& s = result.clusters[c];
+        s.size = static_cast<uint32_t>(result.size(c));
+        s.mass = mass;
+        s.luminosity = luminosity;
+        s.centroid = ClusterVector{float(cx), float(cy), float(cz)};
+        s.velocity = ClusterVector{float(px * inverse), float(py * inverse), float(pz * inverse)};
+        s.angularMomentum = ClusterVector{float(lx), float(ly), float(lz)};
+    }
+};
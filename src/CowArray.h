@@ -0,0 +1,268 @@
+// CowArray.h
+// Chunked array whose chunks are shared copy-on-write between forks
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <iterator>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// ============================================================================
+// Copy-on-Write Chunked Array
+// ============================================================================
+//
+// Elements live in fixed-size chunks with an atomic reference count. share()
+// produces a second array that points at the same chunks in O(chunks); the
+// first write to a chunk from either side copies that chunk alone, so a
+// branch pays memory and copy time only for the chunks it actually modifies.
+//
+// Const access never copies. Non-const operator[] (and the mutable iterator)
+// must be assumed to write: in code that only reads, go through a const
+// reference to avoid unsharing chunks needlessly.
+//
+// Threading: writes to an array may come from several threads at once
+// (parallel loops over disjoint elements, or two phases writing different
+// fields of the same elements). A chunk is unshared under a lock and its
+// pointer is published before it is marked owned. Chunks replaced this way
+// are kept alive until reclaim(), because another thread of the same array
+// may still be reading through the old pointer; call it at a point where no
+// access is in flight (e.g. the end of a frame). share(), growth and clear()
+// require exclusive access.
+//
+// resize() builds whole chunks on a thread pool. Each chunk's pages are then
+// first written by the thread that will most likely process them, so under
+// the kernel's first-touch NUMA policy a large array spreads over the nodes
+// the pool runs on instead of landing entirely on the initializing thread's.
+
+template <typename T, size_t CHUNK_SIZE = 1024>
+class CowArray {
+    struct Chunk {
+        std::atomic<long> refs{1};
+        std::pmr::vector<T> items;
+
+        explicit Chunk(std::pmr::memory_resource* memory) : items(memory) { items.reserve(CHUNK_SIZE); }
+        Chunk(const Chunk& other, std::pmr::memory_resource* memory) : items(memory) {
+            items.reserve(CHUNK_SIZE);
+            items.assign(other.items.begin(), other.items.end());
+        }
+    };
+
+    struct Slot {
+        std::atomic<Chunk*> chunk{nullptr};
+        std::atomic<bool> owned{false};   // Writable without copying: this array holds the only reference
+
+        Slot() = default;
+        Slot(Chunk* c, bool isOwned) : chunk(c), owned(isOwned) {}
+        Slot(const Slot& other)
+            : chunk(other.chunk.load(std::memory_order_relaxed)),
+              owned(other.owned.load(std::memory_order_relaxed)) {}
+    };
+
+public:
+    template <bool Const>
+    class Iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+        using Array = std::conditional_t<Const, const CowArray, CowArray>;
+
+        Iterator() = default;
+        Iterator(Array* array, size_t index) : array(array), index(index) {}
+
+        reference operator*() const { return (*array)[index]; }
+        pointer operator->() const { return &(*array)[index]; }
+        reference operator[](difference_type n) const { return (*array)[index + n]; }
+        Iterator& operator++() { ++index; return *this; }
+        Iterator operator++(int) { Iterator it = *this; ++index; return it; }
+        Iterator& operator--() { --index; return *this; }
+        Iterator& operator+=(difference_type n) { index += n; return *this; }
+        Iterator operator+(difference_type n) const { return Iterator(array, index + n); }
+        difference_type operator-(const Iterator& other) const {
+            return static_cast<difference_type>(index) - static_cast<difference_type>(other.index);
+        }
+        bool operator==(const Iterator& other) const { return index == other.index; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
+        bool operator<(const Iterator& other) const { return index < other.index; }
+
+    private:
+        Array* array = nullptr;
+        size_t index = 0;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    explicit CowArray(std::pmr::memory_resource* memory = std::pmr::get_default_resource())
+        : memory(memory) {}
+
+    CowArray(const CowArray&) = delete;
+    CowArray& operator=(const CowArray&) = delete;
+
+    ~CowArray() {
+        clear();
+    }
+
+    // A new array sharing every chunk with this one
+    CowArray share(std::pmr::memory_resource* target = nullptr) {
+        CowArray copy(target ? target : memory);
+        copy.count = count;
+        copy.slots.reserve(slots.size());
+        for (Slot& slot : slots) {
+            Chunk* chunk = slot.chunk.load(std::memory_order_relaxed);
+            chunk->refs.fetch_add(1, std::memory_order_relaxed);
+            slot.owned.store(false, std::memory_order_relaxed);
+            copy.slots.emplace_back(chunk, false);
+        }
+        return copy;
+    }
+
+    CowArray(CowArray&& other) noexcept
+        : memory(other.memory), slots(std::move(other.slots)), count(other.count),
+          retired(std::move(other.retired)) {
+        other.slots.clear();
+        other.count = 0;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    void reserve(size_t n) { slots.reserve((n + CHUNK_SIZE - 1) / CHUNK_SIZE); }
+
+    const T& operator[](size_t i) const {
+        const Chunk* chunk = slots[i / CHUNK_SIZE].chunk.load(std::memory_order_acquire);
+        return chunk->items[i % CHUNK_SIZE];
+    }
+
+    T& operator[](size_t i) {
+        Slot& slot = slots[i / CHUNK_SIZE];
+        Chunk* chunk = slot.owned.load(std::memory_order_acquire)
+                           ? slot.chunk.load(std::memory_order_relaxed)
+                           : unshare(slot);
+        return chunk->items[i % CHUNK_SIZE];
+    }
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (count % CHUNK_SIZE == 0) {
+            slots.emplace_back(newChunk(), true);
+        }
+        Chunk* chunk = slots.back().owned.load(std::memory_order_relaxed)
+                           ? slots.back().chunk.load(std::memory_order_relaxed)
+                           : unshare(slots.back());
+        ++count;
+        return chunk->items.emplace_back(std::forward<Args>(args)...);
+    }
+
+    // Appends default-constructed elements up to `n` using the pool's threads
+    void resize(size_t n, ThreadPool& pool) {
+        while (count < n && count % CHUNK_SIZE != 0) emplace_back();
+        if (count >= n) return;
+
+        const size_t base = count;
+        const size_t firstChunk = slots.size();
+        const size_t newChunks = (n - base + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        slots.resize(firstChunk + newChunks);
+        pool.parallelFor(0, newChunks, 1, [&](size_t chunkBegin, size_t chunkEnd, unsigned) {
+            for (size_t c = chunkBegin; c < chunkEnd; ++c) {
+                Chunk* chunk = newChunk();
+                chunk->items.resize(std::min(CHUNK_SIZE, n - base - c * CHUNK_SIZE));
+                slots[firstChunk + c].chunk.store(chunk, std::memory_order_relaxed);
+                slots[firstChunk + c].owned.store(true, std::memory_order_relaxed);
+            }
+        });
+        count = n;
+    }
+
+    void clear() {
+        for (Slot& slot : slots) {
+            release(slot.chunk.load(std::memory_order_relaxed));
+        }
+        slots.clear();
+        count = 0;
+        reclaim();
+    }
+
+    // Frees chunks that were replaced by private copies
+    void reclaim() {
+        std::lock_guard<std::mutex> lock(unshareMutex);
+        for (Chunk* chunk : retired) release(chunk);
+        retired.clear();
+    }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, count); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, count); }
+
+    size_t chunkCount() const { return slots.size(); }
+
+    // Contiguous read-only view of one chunk, for tight inner loops where
+    // per-element chunk lookup would cost more than the work itself
+    const T* chunkData(size_t c) const {
+        return slots[c].chunk.load(std::memory_order_acquire)->items.data();
+    }
+    size_t chunkLength(size_t c) const {
+        return std::min(CHUNK_SIZE, count - c * CHUNK_SIZE);
+    }
+    static constexpr size_t chunkCapacity() { return CHUNK_SIZE; }
+
+    // Chunks currently referenced by another array as well
+    size_t sharedChunkCount() const {
+        size_t shared = 0;
+        for (const Slot& slot : slots) {
+            if (slot.chunk.load(std::memory_order_relaxed)->refs.load(std::memory_order_relaxed) > 1) ++shared;
+        }
+        return shared;
+    }
+
+    static constexpr size_t chunkBytes() { return CHUNK_SIZE * sizeof(T); }
+
+private:
+    Chunk* newChunk() {
+        std::pmr::polymorphic_allocator<Chunk> allocator(memory);
+        Chunk* chunk = allocator.allocate(1);
+        new (chunk) Chunk(memory);
+        return chunk;
+    }
+
+    void release(Chunk* chunk) {
+        if (chunk->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::pmr::polymorphic_allocator<Chunk> allocator(chunk->items.get_allocator().resource());
+            chunk->~Chunk();
+            allocator.deallocate(chunk, 1);
+        }
+    }
+
+    Chunk* unshare(Slot& slot) {
+        std::lock_guard<std::mutex> lock(unshareMutex);
+        Chunk* chunk = slot.chunk.load(std::memory_order_relaxed);
+        if (slot.owned.load(std::memory_order_relaxed)) return chunk;
+
+        if (chunk->refs.load(std::memory_order_acquire) > 1) {
+            std::pmr::polymorphic_allocator<Chunk> allocator(memory);
+            Chunk* copy = allocator.allocate(1);
+            new (copy) Chunk(*chunk, memory);
+            slot.chunk.store(copy, std::memory_order_release);
+            retired.push_back(chunk);
+            chunk = copy;
+        }
+        slot.owned.store(true, std::memory_order_release);
+        return chunk;
+    }
+
+    std::pmr::memory_resource* memory;
+    std::vector<Slot> slots;
+    size_t count = 0;
+    std::mutex unshareMutex;
+    std::vector<Chunk*> retired;
+};
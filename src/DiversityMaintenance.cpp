@@ -63,9 +63,11 @@ private:
     
     void ApplyLateralInhibition(TArray<FNeuronState>& Neurons)
     {
-        // Bright neurons suppress nearby neurons (like in retina)
-        TArray<float> InhibitionField;
-        InhibitionField.SetNum(Neurons.Num());
+        // Bright neurons suppress nearby neurons (like in retina).
+        // Scratch comes from the thread's frame stack, released on return.
+        FMemMark Mark(FMemStack::Get());
+        TArray<float, TMemStackAllocator<>> InhibitionField;
+        InhibitionField.SetNumZeroed(Neurons.Num());
         
         // Calculate inhibition field
         for (int32 i = 0; i < Neurons.Num(); i++)
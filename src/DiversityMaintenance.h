@@ -0,0 +1,332 @@
+// DiversityMaintenance.h
+// Standalone port of the UE5 FDiversityController: annealing noise, lateral
+// inhibition, pressure on overgrown clusters and periodic perturbation
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Clustering.h"
+#include "ParallelPrimitives.h"
+#include "SpatialGrid.h"
+#include "ThreadPool.h"
+
+// ============================================================================
+// Diversity Parameters
+// ============================================================================
+//
+// Defaults are those of DiversityMaintenance.cpp. The temperature starts at
+// initialTemperature and is multiplied by coolingRate every pass, never
+// dropping below minTemperature.
+
+struct DiversityParams {
+    bool enabled = false;
+    float initialTemperature = 1000.0f;
+    float coolingRate = 0.995f;
+    float minTemperature = 10.0f;
+
+    float brightThreshold = 5.0f;        // Neurons brighter than this inhibit
+    float inhibitionRadius = 500.0f;     // Kernel length and cutoff
+    float inhibitionStrength = 0.5f;
+    float repulsionThreshold = 0.1f;     // Inhibition that also pushes a neuron away
+    float repulsionSpeed = 10.0f;        // Per unit of inhibition
+
+    float pressureFraction = 0.1f;       // Clusters above this share of neurons are penalized
+    float pressureDimming = 0.95f;
+    float pressureEnergyLoss = 0.9f;
+
+    int perturbEvery = 100;              // Passes between perturbations
+    float perturbFraction = 0.01f;
+    float perturbKick = 100.0f;          // Largest kick per velocity component
+    float mutationChance = 0.1f;         // Of a perturbed neuron's luminosity spiking 2-5x
+
+    int updateEvery = 1;                 // Frames between passes
+};
+
+struct DiversityChanges {
+    size_t inhibited = 0;      // Neurons under any inhibition
+    size_t repelled = 0;
+    size_t pressured = 0;      // Neurons in penalized clusters
+    size_t perturbed = 0;
+};
+
+// ============================================================================
+// Inhibition Kernel
+// ============================================================================
+//
+// exp(-d / R) for d <= R, tabulated over u = (d / R)^2 so a lookup needs
+// neither sqrt() nor exp(): the grid already hands out squared distances.
+// Linear interpolation between 4096 entries stays within 0.4% of the
+// exact kernel, the worst case being next to d = 0 where sqrt is steepest.
+
+class InhibitionKernel {
+public:
+    static constexpr size_t SIZE = 4096;
+
+    InhibitionKernel() {
+        table.resize(SIZE + 1);
+        for (size_t k = 0; k <= SIZE; ++k) {
+            table[k] = std::exp(-std::sqrt(static_cast<float>(k) / SIZE));
+        }
+    }
+
+    // Kernel at squared distance d2 for inverse squared radius invR2
+    float operator()(float d2, float invR2) const {
+        const float u = std::min(d2 * invR2, 1.0f) * SIZE;
+        const size_t k = std::min(static_cast<size_t>(u), SIZE - 1);
+        const float t = u - static_cast<float>(k);
+        return table[k] + t * (table[k + 1] - table[k]);
+    }
+
+private:
+    std::vector<float> table;
+};
+
+// ============================================================================
+// Diversity Controller
+// ============================================================================
+//
+// The four mechanisms of the UE5 controller, each one parallel sweep:
+//
+//  1. Thermal noise: every neuron's velocity takes a random force scaled by
+//     sqrt(temperature), and its luminosity a random fluctuation.
+//  2. Lateral inhibition: bright neurons are compacted with a prefix sum
+//     and bucketed in a SpatialGrid with cells of the inhibition radius.
+//     Every neuron then gathers the field of the bright neurons within the
+//     radius, so threads only ever write their own neuron; the UE5 code
+//     visited all pairs with an exp() each. Inhibited neurons dim, and
+//     strongly inhibited ones get a random push.
+//  3. Diversity pressure: members of clusters holding more than
+//     pressureFraction of the neurons dim, and lose energy so they tend to
+//     split. Fusion and fission read a neuron's energy as its luminosity,
+//     so both factors apply to luminosity here.
+//  4. Perturbation, every perturbEvery passes: each neuron is kicked with
+//     probability perturbFraction. The UE5 code drew that many indices
+//     with replacement; a per-neuron draw perturbs the same share on
+//     average and needs no serial pass.
+//
+// Random numbers come from hashing the seed, the pass and the index, so
+// results do not depend on the thread count. Superparticles (see
+// LevelOfDetail.h) inhibit like any bright neuron but are otherwise left
+// alone.
+//
+// The galaxy recomputes luminosity from mass and temperature at every
+// stellar phase, so inhibition, pressure and mutation scale temperature
+// along with luminosity and outlast it; only the thermal flicker is a
+// momentary fluctuation. Particles need position, velocity, luminosity,
+// temperature, updateSpectrum() and an int `superparticle`.
+
+class DiversityController {
+public:
+    void setParams(const DiversityParams& p) {
+        diversityParams = p;
+        systemTemperature = p.initialTemperature;
+    }
+    const DiversityParams& params() const { return diversityParams; }
+    void setSeed(uint64_t s) { seed = s; }
+
+    float temperature() const { return systemTemperature; }
+    const DiversityChanges& changes() const { return passChanges; }
+
+    // Continues another controller's passes (same parameters, temperature
+    // and random numbers); scratch is not copied
+    void inherit(const DiversityController& parent) {
+        diversityParams = parent.diversityParams;
+        systemTemperature = parent.systemTemperature;
+        seed = parent.seed;
+        pass = parent.pass;
+    }
+
+    // One pass over `particles`, `elapsed` time after the previous one.
+    // `clusters` must have been identified on the same particles.
+    template <typename Target>
+    const DiversityChanges& update(Target& particles, const ClusterResult& clusters, float elapsed,
+                                   ThreadPool& pool) {
+        ++pass;
+        passChanges = DiversityChanges();
+        applyThermalNoise(particles, elapsed, pool);
+        applyLateralInhibition(particles, pool);
+        applyDiversityPressure(particles, clusters, pool);
+        if (pass % static_cast<uint64_t>(std::max(1, diversityParams.perturbEvery)) == 0) {
+            applyRandomPerturbation(particles, pool);
+        }
+
+        systemTemperature = std::max(systemTemperature * diversityParams.coolingRate,
+                                     diversityParams.minTemperature);
+        return passChanges;
+    }
+
+private:
+    // Streams of random numbers drawn per neuron and pass
+    enum Stream : uint64_t { THERMAL = 1, REPULSION, PERTURBATION };
+
+    DiversityParams diversityParams;
+    float systemTemperature = DiversityParams().initialTemperature;
+    uint64_t seed = 0;
+    uint64_t pass = 0;
+    DiversityChanges passChanges;
+
+    InhibitionKernel kernel;
+    SpatialGrid grid;
+    std::vector<uint32_t> flags, sourceOf, sources;
+    std::vector<float> sourceLuminosity, field;
+
+    // Scales a neuron's brightness in a way its next stellar phase keeps
+    template <typename Particle>
+    static void scaleBrightness(Particle& p, float factor) {
+        p.luminosity *= factor;
+        p.temperature *= factor;
+        p.updateSpectrum();
+    }
+
+    // Random 64 bits for neuron `index`, draw `draw` of `stream`
+    uint64_t random(Stream stream, size_t index, uint64_t draw = 0) const {
+        const uint64_t passKey = splitMix64(seed ^ (pass * 0x9E3779B97F4A7C15ull) ^ (stream << 56));
+        return splitMix64(splitMix64(passKey ^ index) ^ draw);
+    }
+
+    // Uniform in [lo, hi) from the top 24 bits of a draw
+    static float uniform(uint64_t bits, float lo, float hi) {
+        return lo + (hi - lo) * (static_cast<float>(bits >> 40) / static_cast<float>(1 << 24));
+    }
+
+    // Uniform direction from one draw
+    static void direction(uint64_t bits, float& dx, float& dy, float& dz) {
+        const float cosTheta = uniform(bits, -1.0f, 1.0f);
+        const float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+        const float phi = 6.2831853f * static_cast<float>((bits >> 16) & 0xFFFFFF) / static_cast<float>(1 << 24);
+        dx = sinTheta * std::cos(phi);
+        dy = cosTheta;
+        dz = sinTheta * std::sin(phi);
+    }
+
+    template <typename Target>
+    void applyThermalNoise(Target& particles, float elapsed, ThreadPool& pool) {
+        const float noise = std::sqrt(systemTemperature) * 0.01f * elapsed;
+        const float flicker = 0.1f * systemTemperature / 1000.0f;
+        pool.parallelFor(0, particles.size(), 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                if (std::as_const(particles)[i].superparticle >= 0) continue;
+                const uint64_t a = random(THERMAL, i, 0), b = random(THERMAL, i, 1);
+                auto& p = particles[i];
+                p.velocity.x += uniform(a, -1.0f, 1.0f) * noise;
+                p.velocity.y += uniform(a << 24, -1.0f, 1.0f) * noise;
+                p.velocity.z += uniform(b, -1.0f, 1.0f) * noise;
+                p.luminosity *= 1.0f + uniform(b << 24, -1.0f, 1.0f) * flicker;
+                p.luminosity = std::clamp(p.luminosity, 0.1f, 100.0f);
+            }
+        });
+    }
+
+    template <typename Target>
+    void applyLateralInhibition(Target& particles, ThreadPool& pool) {
+        const auto& view = std::as_const(particles);
+        const size_t n = view.size();
+        const float radius = diversityParams.inhibitionRadius;
+        const float invR2 = radius > 0.0f ? 1.0f / (radius * radius) : 0.0f;
+
+        // Bright neurons, compacted in index order, with their luminosity
+        // before any inhibition
+        flags.assign(n, 0);
+        pool.parallelFor(0, n, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) flags[i] = view[i].luminosity > diversityParams.brightThreshold ? 1 : 0;
+        });
+        sourceOf.resize(n + 1);
+        const uint32_t m = parallelExclusiveScan(flags.data(), sourceOf.data(), n, pool);
+        sources.resize(m);
+        sourceLuminosity.resize(m);
+        pool.parallelFor(0, n, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                if (!flags[i]) continue;
+                sources[sourceOf[i]] = static_cast<uint32_t>(i);
+                sourceLuminosity[sourceOf[i]] = view[i].luminosity;
+            }
+        });
+        if (m == 0 || radius <= 0.0f) return;
+        grid.build(m, [&](size_t k) -> const auto& { return view[sources[k]].position; }, radius, pool);
+
+        // Field at every neuron, gathered from the sources around it
+        field.resize(n);
+        const float strength = diversityParams.inhibitionStrength;
+        pool.parallelFor(0, n, 256, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                float sum = 0.0f;
+                grid.forEachInRadius(view[i].position, radius, [&](uint32_t k, float d2) {
+                    if (sources[k] != i) sum += sourceLuminosity[k] * kernel(d2, invR2);
+                });
+                field[i] = strength * sum;
+            }
+        });
+
+        std::vector<size_t> inhibited(pool.concurrency(), 0), repelled(pool.concurrency(), 0);
+        const float threshold = diversityParams.repulsionThreshold, speed = diversityParams.repulsionSpeed;
+        pool.parallelFor(0, n, 4096, [&](size_t begin, size_t end, unsigned slot) {
+            for (size_t i = begin; i < end; ++i) {
+                const float f = field[i];
+                if (f <= 0.0f || view[i].superparticle >= 0) continue;
+                ++inhibited[slot];
+                auto& p = particles[i];
+                scaleBrightness(p, 1.0f / (1.0f + f));
+                if (f > threshold) {
+                    float dx, dy, dz;
+                    direction(random(REPULSION, i), dx, dy, dz);
+                    p.velocity.x += dx * f * speed;
+                    p.velocity.y += dy * f * speed;
+                    p.velocity.z += dz * f * speed;
+                    ++repelled[slot];
+                }
+            }
+        });
+        for (size_t c : inhibited) passChanges.inhibited += c;
+        for (size_t c : repelled) passChanges.repelled += c;
+    }
+
+    template <typename Target>
+    void applyDiversityPressure(Target& particles, const ClusterResult& clusters, ThreadPool& pool) {
+        const double limit = diversityParams.pressureFraction * static_cast<double>(particles.size());
+        const float factor = diversityParams.pressureDimming * diversityParams.pressureEnergyLoss;
+        std::vector<size_t> pressured(pool.concurrency(), 0);
+
+        // Clusters are disjoint, so members of different clusters are
+        // written from different threads without conflict
+        pool.parallelFor(0, clusters.clusterCount(), 1, [&](size_t begin, size_t end, unsigned slot) {
+            for (size_t c = begin; c < end; ++c) {
+                if (clusters.size(c) <= limit) continue;
+                for (const uint32_t* i = clusters.begin(c); i != clusters.end(c); ++i) {
+                    if (std::as_const(particles)[*i].superparticle >= 0) continue;
+                    scaleBrightness(particles[*i], factor);
+                    ++pressured[slot];
+                }
+            }
+        });
+        for (size_t c : pressured) passChanges.pressured += c;
+    }
+
+    template <typename Target>
+    void applyRandomPerturbation(Target& particles, ThreadPool& pool) {
+        const float kick = diversityParams.perturbKick;
+        std::vector<size_t> perturbed(pool.concurrency(), 0);
+        pool.parallelFor(0, particles.size(), 4096, [&](size_t begin, size_t end, unsigned slot) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint64_t pick = random(PERTURBATION, i, 0);
+                if (uniform(pick, 0.0f, 1.0f) >= diversityParams.perturbFraction) continue;
+                if (std::as_const(particles)[i].superparticle >= 0) continue;
+                const uint64_t a = random(PERTURBATION, i, 1), b = random(PERTURBATION, i, 2);
+                auto& p = particles[i];
+                p.velocity.x += uniform(a, -kick, kick);
+                p.velocity.y += uniform(a << 24, -kick, kick);
+                p.velocity.z += uniform(b, -kick, kick);
+                if (uniform(b << 24, 0.0f, 1.0f) < diversityParams.mutationChance) {
+                    scaleBrightness(p, uniform(pick << 24, 2.0f, 5.0f));
+                }
+                ++perturbed[slot];
+            }
+        });
+        for (size_t c : perturbed) passChanges.perturbed += c;
+    }
+};
@@ -0,0 +1,528 @@
+// DomainDecomposition.h
+// Slab domain decomposition of a galaxy across local worker processes
+
+#pragma once
+
+#include "AllPairsGravity.h"
+#include "SharedMemory.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Neuron Records and Parameters
+// ============================================================================
+//
+// Neurons cross process boundaries as flat records tagged with their global
+// id; everything the distributed phases read or write travels with them.
+
+struct NeuronRecord {
+    uint32_t id;
+    float x, y, z;
+    float vx, vy, vz;
+    float mass;
+    float luminosity;
+    float temperature;
+    float age;
+    float activation;
+    int32_t connections;
+};
+
+constexpr uint32_t END_OF_BATCH = std::numeric_limits<uint32_t>::max();
+
+struct DomainParams {
+    float deltaTime = 0.016f;
+    float connectionRadius = 100.0f;   // Same threshold as updateNeuralConnections
+    float ghostWidth = 100.0f;         // Ghost zone depth; ≥ connectionRadius keeps connections exact
+    int rebalanceEvery = 10;           // Frames between re-cuts by neuron count (0: never)
+    GravityParams gravity;
+    uint64_t seed = 1;                 // Stellar noise stream, keyed by neuron id and frame
+    unsigned threadsPerDomain = 1;
+};
+
+// ============================================================================
+// Slab Decomposition
+// ============================================================================
+//
+// Domain d owns the slab cuts[d] <= x < cuts[d + 1]; the outer cuts are
+// infinite so every position has exactly one owner. Cuts are placed at
+// neuron-count quantiles, so domains hold equal shares of the work.
+
+class SlabDecomposition {
+public:
+    explicit SlabDecomposition(int domains = 1) : cuts(domains + 1, 0.0f) {
+        cuts.front() = -std::numeric_limits<float>::infinity();
+        cuts.back() = std::numeric_limits<float>::infinity();
+    }
+
+    int domainCount() const { return static_cast<int>(cuts.size()) - 1; }
+    float lower(int domain) const { return cuts[domain]; }
+    float upper(int domain) const { return cuts[domain + 1]; }
+
+    int owner(float x) const {
+        auto it = std::upper_bound(cuts.begin() + 1, cuts.end() - 1, x);
+        return static_cast<int>(it - (cuts.begin() + 1));
+    }
+
+    // Distance along x from `x` to the slab of `domain` (0 inside it)
+    float distanceTo(float x, int domain) const {
+        if (x < cuts[domain]) return cuts[domain] - x;
+        if (x >= cuts[domain + 1]) return x - cuts[domain + 1];
+        return 0.0f;
+    }
+
+    // Exact quantile cuts from every position
+    static SlabDecomposition balanced(std::vector<float> xs, int domains) {
+        SlabDecomposition slabs(domains);
+        std::sort(xs.begin(), xs.end());
+        for (int k = 1; k < domains && !xs.empty(); ++k) {
+            slabs.cuts[k] = xs[xs.size() * k / domains];
+        }
+        return slabs;
+    }
+
+    // Approximate quantile cuts from a histogram of x over [lo, hi]
+    static SlabDecomposition fromHistogram(const std::vector<uint64_t>& counts, float lo, float hi, int domains) {
+        SlabDecomposition slabs(domains);
+        uint64_t total = 0;
+        for (uint64_t c : counts) total += c;
+        const float binWidth = (hi - lo) / counts.size();
+
+        uint64_t cumulative = 0;
+        size_t bin = 0;
+        for (int k = 1; k < domains; ++k) {
+            const uint64_t target = total * k / domains;
+            while (bin < counts.size() && cumulative + counts[bin] <= target) {
+                cumulative += counts[bin++];
+            }
+            slabs.cuts[k] = lo + binWidth * bin;
+        }
+        return slabs;
+    }
+
+private:
+    std::vector<float> cuts;
+};
+
+// ============================================================================
+// Shared State
+// ============================================================================
+//
+// One control block (barrier, rebalance histograms, per-domain reports), a
+// double-buffered position/mass snapshot per domain for gravity, one ring per
+// ordered domain pair for ghost and migration traffic, and a result table
+// indexed by neuron id. Create it before forking the workers.
+
+struct DomainReport {
+    uint32_t neurons = 0;
+    uint32_t ghosts = 0;               // Ghosts received in the last frame
+    uint64_t migratedOut = 0;
+    uint64_t ghostsSent = 0;
+    double computeSeconds = 0.0;
+    double exchangeSeconds = 0.0;
+};
+
+class DomainSharedState {
+public:
+    static constexpr int MAX_DOMAINS = 64;
+    static constexpr size_t HISTOGRAM_BINS = 1024;
+
+    struct Control {
+        ShmBarrier barrier;
+        float rangeMin[MAX_DOMAINS];
+        float rangeMax[MAX_DOMAINS];
+        uint32_t histogram[MAX_DOMAINS][HISTOGRAM_BINS];
+        DomainReport reports[MAX_DOMAINS];
+    };
+
+    bool create(const std::string& prefix, int domains, size_t totalNeurons, size_t ringCapacity) {
+        this->domains = domains;
+        this->totalNeurons = totalNeurons;
+        this->ringCapacity = ringCapacity;
+
+        control = SharedSegment(prefix + "_control", sizeof(Control));
+        snapshots = SharedSegment(prefix + "_bodies", snapshotBytes() * domains * 2);
+        rings = SharedSegment(prefix + "_rings", ShmRing<NeuronRecord>::bytesFor(ringCapacity) * domains * domains);
+        results = SharedSegment(prefix + "_results", sizeof(NeuronRecord) * std::max<size_t>(1, totalNeurons));
+        if (!control.isOpen() || !snapshots.isOpen() || !rings.isOpen() || !results.isOpen()) return false;
+
+        new (control.data()) Control();
+        getControl().barrier.initialize(domains);
+        for (int from = 0; from < domains; ++from) {
+            for (int to = 0; to < domains; ++to) {
+                ShmRing<NeuronRecord>(ringMemory(from, to), ringCapacity, true);
+            }
+        }
+        return true;
+    }
+
+    int domainCount() const { return domains; }
+    Control& getControl() { return *static_cast<Control*>(control.data()); }
+    NeuronRecord* resultTable() { return static_cast<NeuronRecord*>(results.data()); }
+
+    ShmRing<NeuronRecord> ring(int from, int to) {
+        return ShmRing<NeuronRecord>(ringMemory(from, to), ringCapacity, false);
+    }
+
+    // Snapshot layout: count, then x, y, z, mass arrays of totalNeurons each
+    uint32_t& snapshotCount(int domain, int parity) {
+        return *reinterpret_cast<uint32_t*>(snapshotBase(domain, parity));
+    }
+    float* snapshotArray(int domain, int parity, int component) {
+        return reinterpret_cast<float*>(snapshotBase(domain, parity) + 64) + component * totalNeurons;
+    }
+
+private:
+    size_t snapshotBytes() const { return 64 + 4 * sizeof(float) * std::max<size_t>(1, totalNeurons); }
+
+    char* snapshotBase(int domain, int parity) {
+        return static_cast<char*>(snapshots.data()) + snapshotBytes() * (2 * domain + parity);
+    }
+
+    void* ringMemory(int from, int to) {
+        return static_cast<char*>(rings.data()) +
+               ShmRing<NeuronRecord>::bytesFor(ringCapacity) * (from * domains + to);
+    }
+
+    int domains = 0;
+    size_t totalNeurons = 0;
+    size_t ringCapacity = 0;
+    SharedSegment control, snapshots, rings, results;
+};
+
+// ============================================================================
+// Domain Worker
+// ============================================================================
+//
+// Runs in one process and advances the neurons of one slab. Per frame:
+//
+//   1. gravity   - publish own bodies, then sum the exact all-pairs kernel
+//                  over own bodies plus every other domain's snapshot, so
+//                  each remote body is seen exactly once
+//   2. rebalance - every rebalanceEvery frames all domains pool x histograms
+//                  and compute identical new cuts by neuron count
+//   3. migrate   - neurons now outside the slab move to their new owner
+//   4. ghosts    - neurons within ghostWidth of another slab are copied there
+//   5. connect   - proximity connections over own neurons plus ghosts
+//   6. stellar   - purely local, noise keyed by (id, frame)
+//
+// Connections use the previous frame's luminosities (Jacobi) rather than the
+// in-place update of the single-process galaxy, because a ghost's update is
+// not visible until the next exchange. The results then depend on the number
+// of domains only through the order of floating-point sums: gravity adds
+// each slab's bodies in turn and connections visit own neurons before
+// ghosts, so the rounding of those sums, not the physics, may differ.
+// Photons are not distributed.
+
+class DomainWorker {
+public:
+    DomainWorker(int domain, DomainSharedState& shared, const SlabDecomposition& slabs,
+                 const DomainParams& params, std::vector<NeuronRecord> owned)
+        : domain(domain), domains(shared.domainCount()), shared(shared), slabs(slabs),
+          params(params), owned(std::move(owned)), pool(params.threadsPerDomain) {}
+
+    void run(long frames) {
+        for (long frame = 0; frame < frames; ++frame) {
+            stepFrame(frame);
+        }
+
+        NeuronRecord* table = shared.resultTable();
+        for (const NeuronRecord& record : owned) {
+            table[record.id] = record;
+        }
+        DomainReport& report = shared.getControl().reports[domain];
+        report.neurons = static_cast<uint32_t>(owned.size());
+        report.ghosts = static_cast<uint32_t>(ghosts.size());
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    static double since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    void stepFrame(long frame) {
+        DomainReport& report = shared.getControl().reports[domain];
+
+        auto start = Clock::now();
+        integrate(frame);
+        report.computeSeconds += since(start);
+
+        start = Clock::now();
+        if (params.rebalanceEvery > 0 && frame % params.rebalanceEvery == params.rebalanceEvery - 1) {
+            rebalance();
+        }
+        migrate(report);
+        exchangeGhosts(report);
+        report.exchangeSeconds += since(start);
+
+        start = Clock::now();
+        updateConnections();
+        updateStellar(frame);
+        report.computeSeconds += since(start);
+    }
+
+    void integrate(long frame) {
+        const int parity = static_cast<int>(frame & 1);
+        const size_t n = owned.size();
+        float* px = shared.snapshotArray(domain, parity, 0);
+        float* py = shared.snapshotArray(domain, parity, 1);
+        float* pz = shared.snapshotArray(domain, parity, 2);
+        float* pm = shared.snapshotArray(domain, parity, 3);
+        for (size_t i = 0; i < n; ++i) {
+            px[i] = owned[i].x;
+            py[i] = owned[i].y;
+            pz[i] = owned[i].z;
+            pm[i] = owned[i].mass;
+        }
+        shared.snapshotCount(domain, parity) = static_cast<uint32_t>(n);
+        shared.getControl().barrier.wait();
+
+        ax.assign(n, 0.0f);
+        ay.assign(n, 0.0f);
+        az.assign(n, 0.0f);
+        gravity.computeAccelerations(px, py, pz, pm, n, ax.data(), ay.data(), az.data(), params.gravity, pool);
+        for (int other = 0; other < domains; ++other) {
+            if (other == domain) continue;
+            gravity.accumulateExternalAccelerations(
+                px, py, pz, n,
+                shared.snapshotArray(other, parity, 0), shared.snapshotArray(other, parity, 1),
+                shared.snapshotArray(other, parity, 2), shared.snapshotArray(other, parity, 3),
+                shared.snapshotCount(other, parity), ax.data(), ay.data(), az.data(), params.gravity, pool);
+        }
+
+        // Semi-implicit Euler, as in the single-process galaxy
+        const float dt = params.deltaTime;
+        for (size_t i = 0; i < n; ++i) {
+            NeuronRecord& r = owned[i];
+            r.vx += ax[i] * dt;
+            r.vy += ay[i] * dt;
+            r.vz += az[i] * dt;
+            r.x += r.vx * dt;
+            r.y += r.vy * dt;
+            r.z += r.vz * dt;
+            r.age += dt;
+        }
+    }
+
+    void rebalance() {
+        DomainSharedState::Control& control = shared.getControl();
+        float lo = std::numeric_limits<float>::infinity();
+        float hi = -std::numeric_limits<float>::infinity();
+        for (const NeuronRecord& r : owned) {
+            lo = std::min(lo, r.x);
+            hi = std::max(hi, r.x);
+        }
+        control.rangeMin[domain] = lo;
+        control.rangeMax[domain] = hi;
+        control.barrier.wait();
+
+        for (int d = 0; d < domains; ++d) {
+            lo = std::min(lo, control.rangeMin[d]);
+            hi = std::max(hi, control.rangeMax[d]);
+        }
+
+        // No domain owns a neuron: every domain sees the same empty range
+        // and keeps its slabs (and skips the barriers below together)
+        if (!(lo <= hi)) return;
+        hi = std::nextafter(hi, std::numeric_limits<float>::infinity());
+
+        const size_t bins = DomainSharedState::HISTOGRAM_BINS;
+        uint32_t* histogram = control.histogram[domain];
+        std::fill(histogram, histogram + bins, 0u);
+        for (const NeuronRecord& r : owned) {
+            size_t bin = static_cast<size_t>((r.x - lo) / (hi - lo) * bins);
+            ++histogram[std::min(bin, bins - 1)];
+        }
+        control.barrier.wait();
+
+        std::vector<uint64_t> total(bins, 0);
+        for (int d = 0; d < domains; ++d) {
+            for (size_t b = 0; b < bins; ++b) total[b] += control.histogram[d][b];
+        }
+        slabs = SlabDecomposition::fromHistogram(total, lo, hi, domains);
+
+        // Nobody may overwrite a histogram until everyone has summed them
+        control.barrier.wait();
+    }
+
+    void migrate(DomainReport& report) {
+        outgoing.assign(domains, {});
+        size_t kept = 0;
+        for (size_t i = 0; i < owned.size(); ++i) {
+            int target = slabs.owner(owned[i].x);
+            if (target == domain) {
+                owned[kept++] = owned[i];
+            } else {
+                outgoing[target].push_back(owned[i]);
+                ++report.migratedOut;
+            }
+        }
+        owned.resize(kept);
+
+        incoming.clear();
+        exchange();
+        owned.insert(owned.end(), incoming.begin(), incoming.end());
+
+        // Arrival order depends on timing; id order keeps results reproducible
+        std::sort(owned.begin(), owned.end(),
+                  [](const NeuronRecord& a, const NeuronRecord& b) { return a.id < b.id; });
+    }
+
+    void exchangeGhosts(DomainReport& report) {
+        outgoing.assign(domains, {});
+        for (const NeuronRecord& r : owned) {
+            for (int d = 0; d < domains; ++d) {
+                if (d != domain && slabs.distanceTo(r.x, d) < params.ghostWidth) {
+                    outgoing[d].push_back(r);
+                    ++report.ghostsSent;
+                }
+            }
+        }
+
+        incoming.clear();
+        exchange();
+        ghosts.swap(incoming);
+        std::sort(ghosts.begin(), ghosts.end(),
+                  [](const NeuronRecord& a, const NeuronRecord& b) { return a.id < b.id; });
+    }
+
+    // Sends outgoing[d] to every peer d and collects what the peers send
+    // here, each batch closed by an END_OF_BATCH record. Pushing and popping
+    // interleave, so batches larger than a ring cannot deadlock.
+    void exchange() {
+        std::vector<size_t> sent(domains, 0);
+        std::vector<char> endSent(domains, 0), endSeen(domains, 0);
+        endSent[domain] = endSeen[domain] = 1;
+        NeuronRecord end{};
+        end.id = END_OF_BATCH;
+
+        int pending = 2 * (domains - 1);
+        while (pending > 0) {
+            bool progress = false;
+            for (int d = 0; d < domains; ++d) {
+                if (endSent[d]) continue;
+                ShmRing<NeuronRecord> ring = shared.ring(domain, d);
+                while (sent[d] < outgoing[d].size() && ring.tryPush(outgoing[d][sent[d]])) {
+                    ++sent[d];
+                    progress = true;
+                }
+                if (sent[d] == outgoing[d].size() && ring.tryPush(end)) {
+                    endSent[d] = 1;
+                    --pending;
+                    progress = true;
+                }
+            }
+            for (int d = 0; d < domains; ++d) {
+                if (endSeen[d]) continue;
+                ShmRing<NeuronRecord> ring = shared.ring(d, domain);
+                NeuronRecord record;
+                while (ring.tryPop(record)) {
+                    progress = true;
+                    if (record.id == END_OF_BATCH) {
+                        endSeen[d] = 1;
+                        --pending;
+                        break;
+                    }
+                    incoming.push_back(record);
+                }
+            }
+            if (!progress) std::this_thread::yield();
+        }
+    }
+
+    void updateConnections() {
+        // Candidates: own neurons first, then ghosts, in SoA for the inner loop
+        const size_t n = owned.size();
+        const size_t total = n + ghosts.size();
+        for (auto* v : {&cx, &cy, &cz, &cl}) v->resize(total);
+        for (size_t i = 0; i < total; ++i) {
+            const NeuronRecord& r = i < n ? owned[i] : ghosts[i - n];
+            cx[i] = r.x;
+            cy[i] = r.y;
+            cz[i] = r.z;
+            cl[i] = r.luminosity;
+        }
+
+        const float radius = params.connectionRadius;
+        activation.resize(n);
+        connections.resize(n);
+        pool.parallelFor(0, n, 64, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                int count = 0;
+                float sum = 0.0f;
+                auto scan = [&](size_t from, size_t to) {
+                    for (size_t j = from; j < to; ++j) {
+                        const float dx = cx[i] - cx[j];
+                        const float dy = cy[i] - cy[j];
+                        const float dz = cz[i] - cz[j];
+                        const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+                        if (distance < radius) {
+                            ++count;
+                            sum += cl[j] / (distance + 1.0f);
+                        }
+                    }
+                };
+                scan(0, i);
+                scan(i + 1, total);
+                connections[i] = count;
+                activation[i] = count > 0 ? sum / count : 0.0f;
+            }
+        });
+
+        for (size_t i = 0; i < n; ++i) {
+            NeuronRecord& r = owned[i];
+            r.connections = connections[i];
+            r.activation = activation[i];
+            r.luminosity = r.luminosity * 0.99f + r.activation * 0.01f;
+        }
+    }
+
+    void updateStellar(long frame) {
+        const float dt = params.deltaTime;
+        for (NeuronRecord& r : owned) {
+            const float evolutionRate = r.mass * dt * 0.001f;
+            r.temperature += evolutionRate * (noise(r.id, frame) - 0.5f) * 100.0f;
+            r.temperature = std::max(1000.0f, std::min(50000.0f, r.temperature));
+            if (r.mass > 2.0f) {
+                r.mass = std::max(0.1f, r.mass - evolutionRate * 0.01f);
+            }
+            r.luminosity = r.mass * r.temperature / 5778.0f;
+        }
+    }
+
+    // Uniform [0, 1) from (seed, id, frame) via splitmix64, independent of
+    // which domain owns the neuron
+    float noise(uint32_t id, long frame) const {
+        uint64_t z = params.seed ^ (static_cast<uint64_t>(id) << 32) ^ static_cast<uint64_t>(frame);
+        z += 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        z ^= z >> 31;
+        return static_cast<float>(z >> 40) / static_cast<float>(1ull << 24);
+    }
+
+    int domain;
+    int domains;
+    DomainSharedState& shared;
+    SlabDecomposition slabs;
+    DomainParams params;
+    std::vector<NeuronRecord> owned;
+    std::vector<NeuronRecord> ghosts;
+    ThreadPool pool;
+    AllPairsGravity gravity;
+
+    std::vector<std::vector<NeuronRecord>> outgoing;
+    std::vector<NeuronRecord> incoming;
+    std::vector<float> ax, ay, az;
+    std::vector<float> cx, cy, cz, cl, activation;
+    std::vector<int> connections;
+};
@@ -0,0 +1,293 @@
+// EnsembleRunner.h
+// Many seeded galaxies advanced together on one thread pool and memory arena
+
+#pragma once
+
+#include "NEBULA_EMERGENT_CORE.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+// ============================================================================
+// Ensemble Specification and Results
+// ============================================================================
+
+struct EnsembleMemberSpec {
+    int neurons = 2000;
+    int photons = 500;
+    unsigned seed = 1;
+    long frames = 10;
+    float deltaTime = 0.01f;
+    GravityMode gravity = GravityMode::ExactTiled;
+};
+
+struct EnsembleOptions {
+    unsigned threads = 0;          // Shared pool size (0: hardware concurrency)
+    bool batchSmall = true;        // Batch small exact-gravity members across SIMD lanes
+    int batchThreshold = 256;      // Largest neuron count that counts as small
+};
+
+struct RunningStat {
+    double sum = 0.0;
+    double min = std::numeric_limits<double>::infinity();
+    double max = -std::numeric_limits<double>::infinity();
+    long count = 0;
+
+    void add(double value) {
+        sum += value;
+        min = std::min(min, value);
+        max = std::max(max, value);
+        ++count;
+    }
+
+    double mean() const { return count > 0 ? sum / count : 0.0; }
+};
+
+// Per-frame statistics of one member, aggregated over its run
+struct EnsembleMemberSummary {
+    EnsembleMemberSpec spec;
+    int batch = -1;                // Index of the lane batch it ran in, -1 if alone
+    long frames = 0;
+    double wallSeconds = 0.0;      // Time spent inside this member's frames
+    RunningStat frameMs;
+    RunningStat maxSpeed;
+    RunningStat maxAcceleration;
+    RunningStat avgLuminosity;
+    RunningStat avgTemperature;
+    RunningStat galaxyTemperature;
+    FrameStats last;
+};
+
+// ============================================================================
+// Ensemble Runner
+// ============================================================================
+//
+// Parameter sweeps and seed ensembles used to run one galaxy per process,
+// each with its own pool of threads competing for the same cores. Here every
+// member borrows one ThreadPool and one synchronized pool resource. Each
+// member (or lane batch) is a task that advances one frame and resubmits
+// itself, so frames of different members interleave round-robin and a member
+// whose phases leave cores idle lets the others use them.
+//
+// Small exact-gravity members are grouped up to SIMD_LANES at a time: their
+// bodies are interleaved lanes-across-systems and one batched kernel computes
+// the opening force evaluation for all of them, which then feeds each
+// member's own integrator step.
+
+class EnsembleRunner {
+public:
+    explicit EnsembleRunner(const EnsembleOptions& options = EnsembleOptions())
+        : options(options), pool(options.threads) {}
+
+    size_t addMember(const EnsembleMemberSpec& spec) {
+        specs.push_back(spec);
+        return specs.size() - 1;
+    }
+
+    size_t memberCount() const { return specs.size(); }
+    size_t batchCount() const { return batchTotal; }
+    ThreadPool& getThreadPool() { return pool; }
+    const NEBULAEmergentGalaxy& getGalaxy(size_t member) const { return *galaxies[member]; }
+    const std::vector<EnsembleMemberSummary>& getSummaries() const { return summaries; }
+
+    // Builds every member, runs all of them to completion and fills the
+    // summaries. Returns the wall time of the whole ensemble in seconds.
+    double run() {
+        auto start = std::chrono::steady_clock::now();
+        buildMembers();
+        buildUnits();
+
+        std::atomic<size_t> finished{0};
+        for (size_t u = 0; u < units.size(); ++u) {
+            schedule(u, finished);
+        }
+        const size_t total = units.size();
+        pool.helpUntil([&]() { return finished.load(std::memory_order_acquire) == total; });
+
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+private:
+    // A member advanced on its own, or a lane batch advanced in lockstep
+    struct WorkUnit {
+        std::vector<size_t> members;
+        bool batched = false;
+        std::pmr::vector<float> x, y, z, m, ax, ay, az;     // Interleaved lanes
+        std::pmr::vector<float> memberX, memberY, memberZ, memberM;
+
+        explicit WorkUnit(std::pmr::memory_resource* memory)
+            : x(memory), y(memory), z(memory), m(memory), ax(memory), ay(memory), az(memory),
+              memberX(memory), memberY(memory), memberZ(memory), memberM(memory) {}
+    };
+
+    void buildMembers() {
+        galaxies.clear();
+        summaries.assign(specs.size(), EnsembleMemberSummary());
+
+        GalaxyOptions galaxyOptions;
+        galaxyOptions.threadPool = &pool;
+        galaxyOptions.memory = &arena;
+        galaxyOptions.verbose = false;
+
+        for (size_t i = 0; i < specs.size(); ++i) {
+            const EnsembleMemberSpec& spec = specs[i];
+            galaxies.push_back(std::make_unique<NEBULAEmergentGalaxy>(spec.neurons, spec.photons,
+                                                                      spec.seed, galaxyOptions));
+            galaxies.back()->setGravityMode(spec.gravity);
+            summaries[i].spec = spec;
+        }
+    }
+
+    bool batchable(const EnsembleMemberSpec& spec) const {
+        return options.batchSmall && NEBULA_INTEGRATOR::EVALUATES_AT_START &&
+               spec.gravity == GravityMode::ExactTiled && spec.neurons <= options.batchThreshold;
+    }
+
+    void buildUnits() {
+        units.clear();
+        batchTotal = 0;
+
+        std::vector<size_t> small;
+        for (size_t i = 0; i < specs.size(); ++i) {
+            if (batchable(specs[i])) {
+                small.push_back(i);
+            } else {
+                units.push_back(std::make_unique<WorkUnit>(&arena));
+                units.back()->members.push_back(i);
+            }
+        }
+
+        // Similar sizes share a batch so little of each lane is padding
+        std::stable_sort(small.begin(), small.end(), [&](size_t a, size_t b) {
+            return specs[a].neurons < specs[b].neurons;
+        });
+        for (size_t begin = 0; begin < small.size(); begin += AllPairsGravity::SIMD_LANES) {
+            const size_t end = std::min(small.size(), begin + AllPairsGravity::SIMD_LANES);
+            auto unit = std::make_unique<WorkUnit>(&arena);
+            unit->members.assign(small.begin() + begin, small.begin() + end);
+            unit->batched = unit->members.size() > 1;
+            if (unit->batched) {
+                for (size_t member : unit->members) summaries[member].batch = static_cast<int>(batchTotal);
+                ++batchTotal;
+            }
+            units.push_back(std::move(unit));
+        }
+    }
+
+    bool remaining(size_t member) const {
+        return summaries[member].frames < specs[member].frames;
+    }
+
+    void schedule(size_t unitIndex, std::atomic<size_t>& finished) {
+        pool.submit([this, unitIndex, &finished]() {
+            WorkUnit& unit = *units[unitIndex];
+            double sharedSeconds = 0.0;
+            if (unit.batched) {
+                // The batched kernel's cost is split evenly over its live lanes
+                auto start = std::chrono::steady_clock::now();
+                size_t lanes = computeBatchForces(unit);
+                sharedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() /
+                                std::max<size_t>(1, lanes);
+            }
+            for (size_t member : unit.members) {
+                if (remaining(member)) advance(member, sharedSeconds);
+            }
+
+            bool more = std::any_of(unit.members.begin(), unit.members.end(),
+                                    [&](size_t member) { return remaining(member); });
+            if (more) {
+                schedule(unitIndex, finished);
+            } else {
+                finished.fetch_add(1, std::memory_order_release);
+            }
+        });
+    }
+
+    // Returns the number of lanes that received accelerations
+    size_t computeBatchForces(WorkUnit& unit) {
+        constexpr size_t L = AllPairsGravity::SIMD_LANES;
+        size_t count = 0;
+        for (size_t member : unit.members) {
+            count = std::max(count, galaxies[member]->getNeuronCount());
+        }
+
+        for (auto* v : {&unit.x, &unit.y, &unit.z, &unit.m, &unit.ax, &unit.ay, &unit.az}) {
+            v->assign(count * L, 0.0f);
+        }
+        for (auto* v : {&unit.memberX, &unit.memberY, &unit.memberZ, &unit.memberM}) {
+            v->resize(count);
+        }
+
+        for (size_t g = 0; g < unit.members.size(); ++g) {
+            const size_t member = unit.members[g];
+            if (!remaining(member)) continue;   // Finished lanes stay massless padding
+            const NEBULAEmergentGalaxy& galaxy = *galaxies[member];
+            galaxy.exportBodies(unit.memberX.data(), unit.memberY.data(), unit.memberZ.data(),
+                                unit.memberM.data());
+            for (size_t j = 0; j < galaxy.getNeuronCount(); ++j) {
+                unit.x[j * L + g] = unit.memberX[j];
+                unit.y[j * L + g] = unit.memberY[j];
+                unit.z[j * L + g] = unit.memberZ[j];
+                unit.m[j * L + g] = unit.memberM[j];
+            }
+        }
+
+        const GravityParams params = galaxies[unit.members.front()]->getGravityParams();
+        batchGravity.computeBatchedAccelerations(unit.x.data(), unit.y.data(), unit.z.data(), unit.m.data(),
+                                                 count, unit.ax.data(), unit.ay.data(), unit.az.data(),
+                                                 params, pool);
+
+        size_t lanes = 0;
+        for (size_t g = 0; g < unit.members.size(); ++g) {
+            const size_t member = unit.members[g];
+            if (!remaining(member)) continue;
+            const size_t n = galaxies[member]->getNeuronCount();
+            for (size_t j = 0; j < n; ++j) {
+                unit.memberX[j] = unit.ax[j * L + g];
+                unit.memberY[j] = unit.ay[j * L + g];
+                unit.memberZ[j] = unit.az[j * L + g];
+            }
+            galaxies[member]->setPendingAccelerations(unit.memberX.data(), unit.memberY.data(),
+                                                      unit.memberZ.data());
+            ++lanes;
+        }
+        return lanes;
+    }
+
+    void advance(size_t member, double sharedSeconds) {
+        NEBULAEmergentGalaxy& galaxy = *galaxies[member];
+        EnsembleMemberSummary& summary = summaries[member];
+
+        auto start = std::chrono::steady_clock::now();
+        galaxy.evolveFrame(specs[member].deltaTime);
+        const double seconds = sharedSeconds +
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        const FrameStats stats = galaxy.getFrameStats();
+        summary.frames += 1;
+        summary.wallSeconds += seconds;
+        summary.frameMs.add(1000.0 * seconds);
+        summary.maxSpeed.add(stats.maxSpeed);
+        summary.maxAcceleration.add(stats.maxAcceleration);
+        summary.avgLuminosity.add(stats.avgLuminosity);
+        summary.avgTemperature.add(stats.avgTemperature);
+        summary.galaxyTemperature.add(stats.galaxyTemperature);
+        summary.last = stats;
+    }
+
+    EnsembleOptions options;
+    ThreadPool pool;
+    std::pmr::synchronized_pool_resource arena;
+    AllPairsGravity batchGravity;   // Lane batches only; members keep their own solvers
+
+    std::vector<EnsembleMemberSpec> specs;
+    std::vector<std::unique_ptr<NEBULAEmergentGalaxy>> galaxies;
+    std::vector<EnsembleMemberSummary> summaries;
+    std::vector<std::unique_ptr<WorkUnit>> units;
+    size_t batchTotal = 0;
+};
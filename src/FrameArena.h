@@ -0,0 +1,185 @@
+// FrameArena.h
+// Per-thread bump arenas for temporaries that live no longer than a frame
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// Heap Allocation Counter
+// ============================================================================
+//
+// Counts calls to the global operator new. The counter only moves in a
+// program where exactly one translation unit defines
+// NEBULA_COUNT_HEAP_ALLOCATIONS before including this header; that unit then
+// supplies the replacement operators. Tests use it to check that steady-state
+// frames stay off the heap.
+
+namespace HeapCounter {
+    inline std::atomic<long> allocations{0};
+
+    inline long count() { return allocations.load(std::memory_order_relaxed); }
+}
+
+#ifdef NEBULA_COUNT_HEAP_ALLOCATIONS
+void* operator new(std::size_t bytes) {
+    HeapCounter::allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(bytes ? bytes : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t bytes) { return operator new(bytes); }
+// Kept out of line: once inlined, GCC pairs the free() with the builtin
+// operator new and reports a mismatched deallocation
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete[](void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#endif
+
+// ============================================================================
+// Bump Arena
+// ============================================================================
+//
+// Hands out memory by advancing a pointer; deallocation is a no-op and
+// reset() rewinds everything at once. When a frame overflows the current
+// block a larger one comes from upstream, and the next reset() folds all
+// blocks into a single block of the peak size, so after a warm-up frame or
+// two the same workload never reaches upstream again.
+
+class BumpArena : public std::pmr::memory_resource {
+public:
+    explicit BumpArena(size_t initialBytes = size_t(64) << 10,
+                       std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream(upstream), initialBytes(std::max<size_t>(initialBytes, 256)) {}
+
+    ~BumpArena() override { releaseBlocks(); }
+
+    BumpArena(const BumpArena&) = delete;
+    BumpArena& operator=(const BumpArena&) = delete;
+
+    // Constructs a trivially destructible object that lives until reset()
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "arena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T{std::forward<Args>(args)...};
+    }
+
+    void reset() {
+        if (blocks.size() > 1) {
+            size_t total = 0;
+            for (const Block& block : blocks) total += block.bytes;
+            releaseBlocks();
+            addBlock(total);
+        }
+        used = 0;
+    }
+
+    size_t upstreamAllocations() const { return upstreamCount; }
+    size_t capacity() const {
+        size_t total = 0;
+        for (const Block& block : blocks) total += block.bytes;
+        return total;
+    }
+
+private:
+    struct Block {
+        char* base;
+        size_t bytes;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        if (!blocks.empty()) {
+            const Block& block = blocks.back();
+            const uintptr_t start = reinterpret_cast<uintptr_t>(block.base) + used;
+            const size_t padding = (alignment - start % alignment) % alignment;
+            if (used + padding + bytes <= block.bytes) {
+                used += padding + bytes;
+                return block.base + used - bytes;
+            }
+        }
+        const size_t previous = blocks.empty() ? initialBytes / 2 : blocks.back().bytes;
+        addBlock(std::max(previous * 2, bytes + alignment));
+        const uintptr_t start = reinterpret_cast<uintptr_t>(blocks.back().base);
+        const size_t padding = (alignment - start % alignment) % alignment;
+        used = padding + bytes;
+        return blocks.back().base + padding;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    void addBlock(size_t bytes) {
+        blocks.push_back({static_cast<char*>(upstream->allocate(bytes, alignof(std::max_align_t))), bytes});
+        ++upstreamCount;
+        used = 0;
+    }
+
+    void releaseBlocks() {
+        for (const Block& block : blocks) upstream->deallocate(block.base, block.bytes, alignof(std::max_align_t));
+        blocks.clear();
+    }
+
+    std::pmr::memory_resource* upstream;
+    size_t initialBytes;
+    std::vector<Block> blocks;
+    size_t used = 0;
+    size_t upstreamCount = 0;
+};
+
+// ============================================================================
+// Frame Arena
+// ============================================================================
+//
+// One BumpArena per thread that has used it, so phases running concurrently
+// on the pool never share a bump pointer. A galaxy owns one FrameArena and
+// resets it when a frame (or a batch of frames) has fully finished; galaxies
+// sharing a pool keep separate arenas, so one galaxy's frame end never
+// rewinds memory another is still using. local() takes a short lock and is
+// meant to be called once per container, not per element.
+
+class FrameArena {
+public:
+    // The calling thread's arena, created on its first use
+    BumpArena& local() {
+        const std::thread::id self = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& lane : lanes) {
+            if (lane.first == self) return *lane.second;
+        }
+        lanes.emplace_back(self, std::make_unique<BumpArena>());
+        return *lanes.back().second;
+    }
+
+    // Rewinds every thread's arena; nothing allocated from them may be in use
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& lane : lanes) lane.second->reset();
+    }
+
+    // Blocks requested from the heap so far, summed over threads
+    size_t upstreamAllocations() {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t total = 0;
+        for (const auto& lane : lanes) total += lane.second->upstreamAllocations();
+        return total;
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::pair<std::thread::id, std::unique_ptr<BumpArena>>> lanes;
+};
@@ -0,0 +1,275 @@
+// FusionFission.h
+// Merging close, luminous neurons and splitting dim, heavy ones
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "ParallelPrimitives.h"
+#include "SpatialGrid.h"
+#include "ThreadPool.h"
+
+// ============================================================================
+// Fusion/Fission Parameters
+// ============================================================================
+//
+// A neuron's energy is its luminosity. Neurons with at least
+// fusionThreshold that are within fusionRadius of each other fuse, and
+// fusion is transitive: a chain of such pairs becomes one neuron. A neuron
+// below fissionThreshold that is at least fissionMinMass splits in two.
+// The thresholds default to those of the UE5 actor.
+
+struct FusionParams {
+    bool enabled = false;
+    float fusionThreshold = 1.0f;
+    float fusionRadius = 2.0f;
+    float fissionThreshold = 0.1f;
+    float fissionMinMass = 2.0f;        // Products are at least half this
+    float fissionSeparation = 10.0f;    // Distance between the two products
+    float fissionSpeed = 1.0f;          // Speed of each product relative to the parent
+    int updateEvery = 10;               // Frames between passes
+};
+
+struct FusionChanges {
+    size_t fused = 0;        // Neurons absorbed into another
+    size_t groups = 0;       // Fused neurons created
+    size_t split = 0;        // Neurons that split in two
+};
+
+// ============================================================================
+// Fusion/Fission Engine
+// ============================================================================
+//
+// A pass is planned, then applied into storage the caller sizes:
+//
+//  - plan() compacts the fusion candidates with a prefix sum, buckets them
+//    in a SpatialGrid with cells of fusionRadius and unites close pairs in
+//    a ConcurrentUnionFind from all threads at once. Each particle then
+//    gets an output count (0 absorbed, 1 kept or fused, 2 split), and a
+//    second prefix sum turns those into output offsets.
+//  - apply() writes every output entry in parallel: kept particles are
+//    copied, the smallest index of each group becomes the fused neuron,
+//    and split particles write both products.
+//
+// Survivors keep their relative order, so the cost of a pass is a few
+// linear sweeps whatever the number of changes. A fused neuron carries the
+// group's total mass, luminosity and momentum at its center of mass, with
+// mass-weighted temperature, age and activation. Fission products share
+// the parent's mass and luminosity equally and fly apart along a random
+// axis with equal and opposite velocity, so momentum is conserved. The
+// axis comes from a hash of the seed, the pass and the index, which keeps
+// results independent of the thread count.
+//
+// Superparticles (see LevelOfDetail.h) neither fuse nor split. Particles
+// need position, velocity, mass, luminosity, temperature, age, activation,
+// connections, synapses, an int `superparticle` and updateSpectrum().
+
+template <typename Particle>
+class FusionFissionEngine {
+public:
+    void setParams(const FusionParams& p) { fusionParams = p; }
+    const FusionParams& params() const { return fusionParams; }
+    void setSeed(uint64_t s) { seed = s; }
+
+    const FusionChanges& changes() const { return planned; }
+
+    // Continues another engine's passes (same parameters and random axes);
+    // scratch is not copied
+    void inherit(const FusionFissionEngine& parent) {
+        fusionParams = parent.fusionParams;
+        seed = parent.seed;
+        pass = parent.pass;
+    }
+
+    // Plans one pass over `particles` and returns the particle count after
+    // it; apply() must see the same particles
+    template <typename Source>
+    size_t plan(const Source& particles, ThreadPool& pool) {
+        const size_t n = particles.size();
+        planned = FusionChanges();
+        ++pass;
+
+        // Fusion candidates, compacted in index order
+        flags.assign(n, 0);
+        pool.parallelFor(0, n, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) flags[i] = canFuse(particles[i]) ? 1 : 0;
+        });
+        candidateOf.resize(n + 1);
+        const uint32_t m = parallelExclusiveScan(flags.data(), candidateOf.data(), n, pool);
+        candidates.resize(m);
+        pool.parallelFor(0, n, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                if (flags[i]) candidates[candidateOf[i]] = static_cast<uint32_t>(i);
+            }
+        });
+
+        // Unite every pair of candidates within fusionRadius
+        grid.build(m, [&](size_t k) -> const auto& { return particles[candidates[k]].position; },
+                   fusionParams.fusionRadius, pool);
+        unionFind.reset(m, pool);
+        pool.parallelFor(0, m, 256, [&](size_t begin, size_t end, unsigned) {
+            for (size_t k = begin; k < end; ++k) {
+                grid.forEachInRadius(particles[candidates[k]].position, fusionParams.fusionRadius,
+                    [&](uint32_t j, float) {
+                        if (j > k) unionFind.unite(static_cast<uint32_t>(k), j);
+                    });
+            }
+        });
+
+        // Groups: members listed contiguously per root, in index order
+        roots.resize(m);
+        pool.parallelFor(0, m, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t k = begin; k < end; ++k) roots[k] = unionFind.find(static_cast<uint32_t>(k));
+        });
+        memberStart.assign(m + 1, 0);
+        for (uint32_t k = 0; k < m; ++k) ++memberStart[roots[k] + 1];
+        for (uint32_t k = 0; k < m; ++k) {
+            const uint32_t size = memberStart[k + 1];
+            if (size > 1) {
+                ++planned.groups;
+                planned.fused += size - 1;
+            }
+            memberStart[k + 1] += memberStart[k];
+        }
+        members.resize(m);
+        std::vector<uint32_t>& cursor = flags;   // Free again; reused as scratch
+        cursor.assign(memberStart.begin(), memberStart.end() - 1);
+        for (uint32_t k = 0; k < m; ++k) members[cursor[roots[k]]++] = k;
+
+        // Output count of every particle, then offsets
+        counts.resize(n);
+        std::vector<size_t> slotSplits(pool.concurrency(), 0);
+        pool.parallelFor(0, n, 4096, [&](size_t begin, size_t end, unsigned slot) {
+            for (size_t i = begin; i < end; ++i) {
+                const Particle& p = particles[i];
+                uint32_t count = 1;
+                if (canFuse(p)) {
+                    if (roots[candidateOf[i]] != candidateOf[i]) count = 0;   // Absorbed by its root
+                } else if (canSplit(p)) {
+                    count = 2;
+                    ++slotSplits[slot];
+                }
+                counts[i] = count;
+            }
+        });
+        for (size_t s : slotSplits) planned.split += s;
+        offsets.resize(n + 1);
+        return parallelExclusiveScan(counts.data(), offsets.data(), n, pool);
+    }
+
+    // Writes the planned pass: out[0 .. plan()) from `particles`
+    template <typename Source, typename Target>
+    void apply(const Source& particles, Target& out, ThreadPool& pool) const {
+        const size_t n = particles.size();
+        pool.parallelFor(0, n, 1024, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                const uint32_t o = offsets[i];
+                const Particle& p = particles[i];
+                switch (counts[i]) {
+                    case 0:
+                        break;
+                    case 2:
+                        split(p, i, out[o], out[o + 1]);
+                        break;
+                    default:
+                        if (canFuse(p) && groupSize(candidateOf[i]) > 1) {
+                            fuse(particles, candidateOf[i], out[o]);
+                        } else {
+                            out[o] = p;
+                        }
+                }
+            }
+        });
+    }
+
+private:
+    FusionParams fusionParams;
+    uint64_t seed = 0;
+    uint64_t pass = 0;
+    FusionChanges planned;
+
+    SpatialGrid grid;
+    ConcurrentUnionFind unionFind;
+    std::vector<uint32_t> flags, candidateOf, candidates;
+    std::vector<uint32_t> roots, memberStart, members;
+    std::vector<uint32_t> counts, offsets;
+
+    bool canFuse(const Particle& p) const {
+        return p.superparticle < 0 && p.luminosity >= fusionParams.fusionThreshold;
+    }
+
+    bool canSplit(const Particle& p) const {
+        return p.superparticle < 0 && p.luminosity < fusionParams.fissionThreshold &&
+               p.mass >= fusionParams.fissionMinMass;
+    }
+
+    uint32_t groupSize(uint32_t root) const { return memberStart[root + 1] - memberStart[root]; }
+
+    // Combines the group rooted at candidate `root` into `out`
+    template <typename Source>
+    void fuse(const Source& particles, uint32_t root, Particle& out) const {
+        double mass = 0.0, luminosity = 0.0, temperature = 0.0, age = 0.0, activation = 0.0;
+        double x = 0.0, y = 0.0, z = 0.0, px = 0.0, py = 0.0, pz = 0.0;
+        int connections = 0;
+        for (uint32_t m = memberStart[root]; m < memberStart[root + 1]; ++m) {
+            const Particle& p = particles[candidates[members[m]]];
+            const double w = p.mass;
+            mass += w;
+            luminosity += p.luminosity;
+            x += w * p.position.x;
+            y += w * p.position.y;
+            z += w * p.position.z;
+            px += w * p.velocity.x;
+            py += w * p.velocity.y;
+            pz += w * p.velocity.z;
+            temperature += w * p.temperature;
+            age += w * p.age;
+            activation += w * p.activation;
+            connections = std::max(connections, p.connections);
+        }
+
+        out = particles[candidates[root]];
+        const double inverse = mass > 0.0 ? 1.0 / mass : 0.0;
+        out.position.x = static_cast<float>(x * inverse);
+        out.position.y = static_cast<float>(y * inverse);
+        out.position.z = static_cast<float>(z * inverse);
+        out.velocity.x = static_cast<float>(px * inverse);
+        out.velocity.y = static_cast<float>(py * inverse);
+        out.velocity.z = static_cast<float>(pz * inverse);
+        out.mass = static_cast<float>(mass);
+        out.luminosity = static_cast<float>(luminosity);
+        out.temperature = static_cast<float>(temperature * inverse);
+        out.age = static_cast<float>(age * inverse);
+        out.activation = static_cast<float>(activation * inverse);
+        out.connections = connections;
+        out.synapses.clear();
+        out.updateSpectrum();
+    }
+
+    void split(const Particle& p, size_t index, Particle& a, Particle& b) const {
+        // Uniform direction from two hashed uniforms
+        const uint64_t h = splitMix64(splitMix64(seed ^ (pass * 0x9E3779B97F4A7C15ull)) ^ index);
+        const float u = static_cast<float>(h >> 40) / static_cast<float>(1 << 24);
+        const float v = static_cast<float>((h >> 16) & 0xFFFFFF) / static_cast<float>(1 << 24);
+        const float cosTheta = 2.0f * u - 1.0f;
+        const float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+        const float phi = 6.2831853f * v;
+
+        a = p;
+        a.mass = 0.5f * p.mass;
+        a.luminosity = 0.5f * p.luminosity;
+        a.synapses.clear();
+        b = a;
+
+        const float dx = sinTheta * std::cos(phi), dy = cosTheta, dz = sinTheta * std::sin(phi);
+        const float offset = 0.5f * fusionParams.fissionSeparation, speed = fusionParams.fissionSpeed;
+        a.position.x += dx * offset; a.position.y += dy * offset; a.position.z += dz * offset;
+        b.position.x -= dx * offset; b.position.y -= dy * offset; b.position.z -= dz * offset;
+        a.velocity.x += dx * speed;  a.velocity.y += dy * speed;  a.velocity.z += dz * speed;
+        b.velocity.x -= dx * speed;  b.velocity.y -= dy * speed;  b.velocity.z -= dz * speed;
+    }
+};
@@ -0,0 +1,104 @@
+// InjectionQueue.h
+// Bounded lock-free multi-producer single-consumer queue for stimuli
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+// ============================================================================
+// MPSC Queue
+// ============================================================================
+//
+// A ring of cells, each tagged with a sequence number (Vyukov's bounded
+// queue, specialised to one consumer). A producer claims a position with
+// one compare-and-swap on the shared tail, writes its cell and publishes it
+// by advancing the cell's sequence; the consumer reads cells in position
+// order and hands each back to producers a lap later. Nothing blocks and
+// nothing allocates after construction: a push into a full queue fails and
+// the producer decides whether to retry, drop or slow down.
+//
+// Any number of threads may push. Only one thread at a time may pop or
+// drain, which for a galaxy is whichever thread runs the draining phase.
+
+template <typename T>
+class MpscQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit MpscQueue(size_t capacity = 4096) {
+        size_t cells = 2;
+        while (cells < capacity) cells <<= 1;
+        mask = cells - 1;
+        ring.reset(new Cell[cells]);
+        for (size_t i = 0; i < cells; ++i) ring[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // Safe from any thread; false when the queue is full
+    bool tryPush(T value) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &ring[position & mask];
+            const size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+            if (lag == 0) {
+                if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+            } else if (lag < 0) {
+                return false;   // The consumer has not freed this cell yet
+            } else {
+                position = tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only
+    bool tryPop(T& out) {
+        Cell& cell = ring[head & mask];
+        if (cell.sequence.load(std::memory_order_acquire) != head + 1) return false;
+        out = std::move(cell.value);
+        cell.sequence.store(head + mask + 1, std::memory_order_release);
+        ++head;
+        return true;
+    }
+
+    // Consumer only: pops at most `limit` items into visit(item), oldest
+    // first, and returns how many it took. Items pushed while draining may
+    // or may not be included.
+    template <typename Visit>
+    size_t drain(Visit&& visit, size_t limit = SIZE_MAX) {
+        size_t taken = 0;
+        T item;
+        while (taken < limit && tryPop(item)) {
+            visit(item);
+            ++taken;
+        }
+        return taken;
+    }
+
+    // Consumer only; a push in flight may not be visible yet
+    bool empty() const {
+        return ring[head & mask].sequence.load(std::memory_order_acquire) != head + 1;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    std::unique_ptr<Cell[]> ring;
+    size_t mask = 0;
+    alignas(64) std::atomic<size_t> tail{0};   // Next position producers claim
+    alignas(64) size_t head = 0;               // Next position the consumer reads
+};
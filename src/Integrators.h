@@ -0,0 +1,246 @@
+// Integrators.h
+// Compile-time integrator policies for the neuron dynamics stage
+
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// ============================================================================
+// Dynamics State and Workspace
+// ============================================================================
+//
+// Integrators advance positions and velocities given in SoA form. Forces come
+// from a callback with the signature
+//
+//     accel(const float* x, const float* y, const float* z,
+//           float* ax, float* ay, float* az)
+//
+// which must write the acceleration of every body for the given positions.
+// Each policy is a stateless struct with a static step() template, so the
+// choice of integrator is resolved at compile time and costs nothing per
+// frame. EVALUATES_AT_START is true when every step opens with a force
+// evaluation at the incoming positions, which callers may then supply from a
+// batched kernel.
+
+struct DynamicsState {
+    float* x = nullptr;
+    float* y = nullptr;
+    float* z = nullptr;
+    float* vx = nullptr;
+    float* vy = nullptr;
+    float* vz = nullptr;
+    size_t count = 0;
+};
+
+struct IntegratorWorkspace {
+    // Accelerations from the most recent force evaluation
+    std::vector<float> ax, ay, az;
+
+    // True when ax/ay/az hold accelerations for the current positions, which
+    // lets first-same-as-last schemes skip their opening force evaluation.
+    // Anything that moves bodies outside the integrator must clear it.
+    bool accelerationsCurrent = false;
+
+    // Stage storage for multi-stage schemes
+    std::vector<float> stageX, stageY, stageZ;
+    std::vector<float> stageVX, stageVY, stageVZ;
+    std::vector<float> sumX, sumY, sumZ, sumVX, sumVY, sumVZ;
+
+    long forceEvaluations = 0;
+
+    void resize(size_t count) {
+        if (ax.size() != count) {
+            accelerationsCurrent = false;
+            for (auto* v : {&ax, &ay, &az}) v->assign(count, 0.0f);
+        }
+    }
+
+    void resizeStages(size_t count) {
+        for (auto* v : {&stageX, &stageY, &stageZ, &stageVX, &stageVY, &stageVZ,
+                        &sumX, &sumY, &sumZ, &sumVX, &sumVY, &sumVZ}) {
+            v->resize(count);
+        }
+    }
+
+    void invalidate() { accelerationsCurrent = false; }
+
+    template <typename AccelFn>
+    void evaluate(const float* x, const float* y, const float* z, AccelFn& accel) {
+        accel(x, y, z, ax.data(), ay.data(), az.data());
+        ++forceEvaluations;
+    }
+};
+
+namespace integrator_detail {
+
+inline void drift(DynamicsState& s, float dt) {
+    for (size_t i = 0; i < s.count; ++i) {
+        s.x[i] += s.vx[i] * dt;
+        s.y[i] += s.vy[i] * dt;
+        s.z[i] += s.vz[i] * dt;
+    }
+}
+
+inline void kick(DynamicsState& s, const IntegratorWorkspace& w, float dt) {
+    for (size_t i = 0; i < s.count; ++i) {
+        s.vx[i] += w.ax[i] * dt;
+        s.vy[i] += w.ay[i] * dt;
+        s.vz[i] += w.az[i] * dt;
+    }
+}
+
+} // namespace integrator_detail
+
+// ============================================================================
+// Semi-Implicit Euler (original NEBULA scheme)
+// ============================================================================
+
+struct SemiImplicitEuler {
+    static constexpr const char* NAME = "euler";
+    static constexpr int ORDER = 1;
+    static constexpr bool EVALUATES_AT_START = true;
+
+    template <typename AccelFn>
+    static void step(DynamicsState& s, float dt, IntegratorWorkspace& w, AccelFn&& accel) {
+        w.resize(s.count);
+        w.evaluate(s.x, s.y, s.z, accel);
+        integrator_detail::kick(s, w, dt);
+        integrator_detail::drift(s, dt);
+        w.accelerationsCurrent = false;
+    }
+};
+
+// ============================================================================
+// Velocity Verlet (kick-drift-kick leapfrog)
+// ============================================================================
+
+struct VelocityVerlet {
+    static constexpr const char* NAME = "velocity-verlet";
+    static constexpr int ORDER = 2;
+    static constexpr bool EVALUATES_AT_START = false;
+
+    template <typename AccelFn>
+    static void step(DynamicsState& s, float dt, IntegratorWorkspace& w, AccelFn&& accel) {
+        w.resize(s.count);
+        if (!w.accelerationsCurrent) {
+            w.evaluate(s.x, s.y, s.z, accel);
+        }
+        integrator_detail::kick(s, w, 0.5f * dt);
+        integrator_detail::drift(s, dt);
+        w.evaluate(s.x, s.y, s.z, accel);
+        integrator_detail::kick(s, w, 0.5f * dt);
+        w.accelerationsCurrent = true;
+    }
+};
+
+// ============================================================================
+// Yoshida 4th-Order Symplectic
+// ============================================================================
+//
+// Triple-jump composition of leapfrog (Yoshida 1990): three force evaluations
+// per step, time-reversible and symplectic like Verlet, fourth-order accurate.
+
+struct Yoshida4 {
+    static constexpr const char* NAME = "yoshida4";
+    static constexpr int ORDER = 4;
+    static constexpr bool EVALUATES_AT_START = false;
+
+    template <typename AccelFn>
+    static void step(DynamicsState& s, float dt, IntegratorWorkspace& w, AccelFn&& accel) {
+        const double cbrt2 = std::cbrt(2.0);
+        const double w1 = 1.0 / (2.0 - cbrt2);
+        const double w0 = -cbrt2 / (2.0 - cbrt2);
+        const float c1 = static_cast<float>(0.5 * w1);
+        const float c2 = static_cast<float>(0.5 * (w0 + w1));
+        const float d1 = static_cast<float>(w1);
+        const float d2 = static_cast<float>(w0);
+
+        w.resize(s.count);
+        integrator_detail::drift(s, c1 * dt);
+        w.evaluate(s.x, s.y, s.z, accel);
+        integrator_detail::kick(s, w, d1 * dt);
+        integrator_detail::drift(s, c2 * dt);
+        w.evaluate(s.x, s.y, s.z, accel);
+        integrator_detail::kick(s, w, d2 * dt);
+        integrator_detail::drift(s, c2 * dt);
+        w.evaluate(s.x, s.y, s.z, accel);
+        integrator_detail::kick(s, w, d1 * dt);
+        integrator_detail::drift(s, c1 * dt);
+        w.accelerationsCurrent = false;
+    }
+};
+
+// ============================================================================
+// Classical Runge-Kutta 4
+// ============================================================================
+//
+// Four force evaluations per step. Not symplectic, so energy error grows
+// secularly, but very accurate over short horizons.
+
+struct RungeKutta4 {
+    static constexpr const char* NAME = "rk4";
+    static constexpr int ORDER = 4;
+    static constexpr bool EVALUATES_AT_START = true;
+
+    template <typename AccelFn>
+    static void step(DynamicsState& s, float dt, IntegratorWorkspace& w, AccelFn&& accel) {
+        const size_t n = s.count;
+        w.resize(n);
+        w.resizeStages(n);
+
+        // Stage k1 at the start state
+        w.evaluate(s.x, s.y, s.z, accel);
+        for (size_t i = 0; i < n; ++i) {
+            w.sumX[i] = s.vx[i];
+            w.sumY[i] = s.vy[i];
+            w.sumZ[i] = s.vz[i];
+            w.sumVX[i] = w.ax[i];
+            w.sumVY[i] = w.ay[i];
+            w.sumVZ[i] = w.az[i];
+        }
+
+        // Stages k2, k3 at half step, k4 at full step; the stage velocity of
+        // each is v0 + h·a(previous stage)
+        const float stageScale[3] = {0.5f * dt, 0.5f * dt, dt};
+        const float stageWeight[3] = {2.0f, 2.0f, 1.0f};
+        for (int k = 0; k < 3; ++k) {
+            const float h = stageScale[k];
+            const float* prevVX = (k == 0) ? s.vx : w.stageVX.data();
+            const float* prevVY = (k == 0) ? s.vy : w.stageVY.data();
+            const float* prevVZ = (k == 0) ? s.vz : w.stageVZ.data();
+            for (size_t i = 0; i < n; ++i) {
+                w.stageX[i] = s.x[i] + h * prevVX[i];
+                w.stageY[i] = s.y[i] + h * prevVY[i];
+                w.stageZ[i] = s.z[i] + h * prevVZ[i];
+            }
+            for (size_t i = 0; i < n; ++i) {
+                w.stageVX[i] = s.vx[i] + h * w.ax[i];
+                w.stageVY[i] = s.vy[i] + h * w.ay[i];
+                w.stageVZ[i] = s.vz[i] + h * w.az[i];
+            }
+            w.evaluate(w.stageX.data(), w.stageY.data(), w.stageZ.data(), accel);
+            const float weight = stageWeight[k];
+            for (size_t i = 0; i < n; ++i) {
+                w.sumX[i] += weight * w.stageVX[i];
+                w.sumY[i] += weight * w.stageVY[i];
+                w.sumZ[i] += weight * w.stageVZ[i];
+                w.sumVX[i] += weight * w.ax[i];
+                w.sumVY[i] += weight * w.ay[i];
+                w.sumVZ[i] += weight * w.az[i];
+            }
+        }
+
+        const float sixth = dt / 6.0f;
+        for (size_t i = 0; i < n; ++i) {
+            s.x[i] += sixth * w.sumX[i];
+            s.y[i] += sixth * w.sumY[i];
+            s.z[i] += sixth * w.sumZ[i];
+            s.vx[i] += sixth * w.sumVX[i];
+            s.vy[i] += sixth * w.sumVY[i];
+            s.vz[i] += sixth * w.sumVZ[i];
+        }
+        w.accelerationsCurrent = false;
+    }
+};
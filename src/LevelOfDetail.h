@@ -0,0 +1,351 @@
+// LevelOfDetail.h
+// Hierarchical superparticles standing in for far-field neurons
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// Level-of-Detail Parameters
+// ============================================================================
+//
+// Space is cut by a fixed grid anchored at the origin: a level-k cell has
+// edge cellSize * 2^(k-1), so every level-k cell holds exactly eight cells
+// of level k-1. A cell whose center is within refineRadius of a focus point
+// (an observer or hotspot) is kept as individual neurons; beyond that each
+// doubling of the distance allows one coarser level, up to maxLevel.
+// Coarsening needs the distance to exceed the threshold by `hysteresis`
+// (relative), refining only needs it to drop below, so an observer moving
+// back and forth across a boundary does not churn superparticles.
+
+struct LodParams {
+    bool enabled = false;
+    float cellSize = 250.0f;            // Edge of a level-1 cell
+    float refineRadius = 2000.0f;       // Individual neurons within this of a focus
+    int maxLevel = 4;
+    float hysteresis = 0.25f;
+    int minMembers = 8;                 // Smaller groups stay individual
+    float hotspotActivation = 0.05f;    // Neurons at least this active never coarsen
+    int updateEvery = 10;               // Frames between refine/coarsen passes
+};
+
+struct LodChanges {
+    size_t refined = 0;      // Superparticles expanded back into neurons
+    size_t coarsened = 0;    // Superparticles created
+};
+
+// ============================================================================
+// LOD Hierarchy
+// ============================================================================
+//
+// A superparticle is an ordinary entry of the particle array (so every
+// phase simulates it like any neuron; phases whose rules are per star, such
+// as stellar evolution, scale by the member count) carrying the id of the
+// group that stores its members. It has the members' total mass and luminosity, their
+// center of mass and momentum-weighted mean velocity, mass-weighted
+// temperature and age, and luminosity-weighted spectrum. The group also
+// keeps the aggregate as it was at coarsening (the anchor). On refinement
+// the members are moved by the superparticle's displacement since then and
+// their masses and luminosities rescaled so that they again sum exactly to
+// what the superparticle carries: nothing is created or lost by either
+// event, whatever the superparticle went through meanwhile.
+//
+// Particles need position, velocity, mass, luminosity, temperature, age,
+// activation, connections, spectrum (r, g, b) and an int `superparticle`
+// (-1 for an individual neuron).
+
+template <typename Particle>
+class LodHierarchy {
+public:
+    struct CellKey {
+        int level;
+        int64_t x, y, z;
+        bool operator<(const CellKey& o) const {
+            return std::tie(level, x, y, z) < std::tie(o.level, o.x, o.y, o.z);
+        }
+        bool operator==(const CellKey& o) const {
+            return level == o.level && x == o.x && y == o.y && z == o.z;
+        }
+    };
+
+    struct Group {
+        CellKey cell{0, 0, 0, 0};
+        Particle anchor;                  // The aggregate when the group formed
+        std::vector<Particle> members;
+    };
+
+    void setParams(const LodParams& p) { lodParams = p; }
+    const LodParams& params() const { return lodParams; }
+
+    size_t groupCount() const { return groups.size() - freeIds.size(); }
+
+    // Forgets every group, e.g. when the particle array is replaced
+    void clear() {
+        groups.clear();
+        freeIds.clear();
+    }
+
+    // Individual neurons represented, inside superparticles or not
+    template <typename Container>
+    size_t representedCount(const Container& particles) const {
+        size_t total = 0;
+        for (const Particle& p : particles) {
+            total += p.superparticle >= 0 ? groups[p.superparticle].members.size() : 1;
+        }
+        return total;
+    }
+
+    const Group& group(int id) const { return groups[id]; }
+
+    // Calls visit(member) for every neuron held in a superparticle
+    template <typename Visit>
+    void forEachMember(Visit&& visit) const {
+        for (const Group& g : groups) {
+            for (const Particle& m : g.members) visit(m);
+        }
+    }
+
+    // Appends copies of the members of superparticle `s` as they would be
+    // released now (see release()), leaving the group as it is
+    void expand(const Particle& s, std::vector<Particle>& out) const {
+        const Group& group = groups[s.superparticle];
+        const Particle& a = group.anchor;
+        const auto dx = s.position - a.position;
+        const auto dv = s.velocity - a.velocity;
+        const double massScale = a.mass > 0.0f ? double(s.mass) / a.mass : 1.0;
+        const double luminosityScale = a.luminosity > 0.0f ? double(s.luminosity) / a.luminosity : 1.0;
+        const float dTemperature = s.temperature - a.temperature;
+        const float dAge = s.age - a.age;
+
+        double massSoFar = 0.0, luminositySoFar = 0.0;
+        for (size_t k = 0; k < group.members.size(); ++k) {
+            Particle p = group.members[k];
+            p.position = p.position + dx;
+            p.velocity = p.velocity + dv;
+            p.temperature += dTemperature;
+            p.age += dAge;
+            if (k + 1 < group.members.size()) {
+                p.mass = float(p.mass * massScale);
+                p.luminosity = float(p.luminosity * luminosityScale);
+            } else {
+                // The last member takes the rounding remainder so the sums match
+                p.mass = float(std::max(0.0, double(s.mass) - massSoFar));
+                p.luminosity = float(std::max(0.0, double(s.luminosity) - luminositySoFar));
+            }
+            massSoFar += p.mass;
+            luminositySoFar += p.luminosity;
+            p.superparticle = -1;
+            out.push_back(std::move(p));
+        }
+    }
+
+    // Level a cell at `distance` from the nearest focus may be coarsened to
+    int levelFor(float distance) const {
+        if (!(distance >= lodParams.refineRadius)) return 0;
+        const int level = 1 + static_cast<int>(std::floor(std::log2(distance / lodParams.refineRadius)));
+        return std::min(level, lodParams.maxLevel);
+    }
+
+    // One refine/coarsen pass over `particles` (superparticles included)
+    // for the given focus points. Superparticles whose cell no longer fits
+    // their level, or that became hotspots, are expanded; individual
+    // neurons are then grouped into the coarsest cell allowed. With LOD
+    // disabled every superparticle is expanded. The array is rebuilt only
+    // if something changed: individual neurons first, in their previous
+    // order, then kept and new superparticles.
+    template <typename Point>
+    LodChanges update(std::vector<Particle>& particles, const std::vector<Point>& foci) {
+        LodChanges changes;
+        individuals.clear();
+        supers.clear();
+        individuals.reserve(particles.size());
+
+        for (Particle& p : particles) {
+            if (p.superparticle < 0) {
+                individuals.push_back(std::move(p));
+            } else if (lodParams.enabled && keeps(p, foci)) {
+                supers.push_back(std::move(p));
+            } else {
+                release(p, individuals);
+                ++changes.refined;
+            }
+        }
+
+        if (lodParams.enabled) {
+            // Coarsest allowed cell of every neuron that may coarsen
+            keyed.clear();
+            for (size_t i = 0; i < individuals.size(); ++i) {
+                const Particle& p = individuals[i];
+                if (p.activation >= lodParams.hotspotActivation) continue;
+                CellKey key;
+                if (coarsestCell(p.position, foci, key)) keyed.push_back({key, static_cast<uint32_t>(i)});
+            }
+            // Ties broken by index, which keeps the order stable without the
+            // temporary buffer std::stable_sort allocates
+            std::sort(keyed.begin(), keyed.end());
+
+            grouped.assign(individuals.size(), 0);
+            for (size_t begin = 0; begin < keyed.size();) {
+                size_t end = begin;
+                while (end < keyed.size() && keyed[end].first == keyed[begin].first) ++end;
+                if (end - begin >= static_cast<size_t>(std::max(1, lodParams.minMembers))) {
+                    grouping.clear();
+                    for (size_t k = begin; k < end; ++k) {
+                        grouping.push_back(std::move(individuals[keyed[k].second]));
+                        grouped[keyed[k].second] = 1;
+                    }
+                    supers.push_back(coarsen(keyed[begin].first, grouping));
+                    ++changes.coarsened;
+                }
+                begin = end;
+            }
+            if (changes.coarsened > 0) {
+                size_t kept = 0;
+                for (size_t i = 0; i < individuals.size(); ++i) {
+                    if (!grouped[i]) individuals[kept++] = std::move(individuals[i]);
+                }
+                individuals.resize(kept);
+            }
+        }
+
+        for (Particle& s : supers) individuals.push_back(std::move(s));
+        particles.swap(individuals);
+        return changes;
+    }
+
+private:
+    LodParams lodParams;
+    std::vector<Group> groups;
+    std::vector<int> freeIds;
+
+    // update() scratch, kept so passes that change nothing do not allocate;
+    // `individuals` trades buffers with the caller's array every pass
+    std::vector<Particle> individuals, supers, grouping;
+    std::vector<std::pair<CellKey, uint32_t>> keyed;
+    std::vector<uint8_t> grouped;
+
+    float edge(int level) const { return lodParams.cellSize * std::ldexp(1.0f, level - 1); }
+
+    template <typename Point>
+    CellKey cellOf(const Point& p, int level) const {
+        const float e = edge(level);
+        return CellKey{level, static_cast<int64_t>(std::floor(p.x / e)), static_cast<int64_t>(std::floor(p.y / e)),
+                       static_cast<int64_t>(std::floor(p.z / e))};
+    }
+
+    template <typename Point>
+    float focusDistance(const CellKey& cell, const std::vector<Point>& foci) const {
+        const float e = edge(cell.level);
+        const float cx = (cell.x + 0.5f) * e, cy = (cell.y + 0.5f) * e, cz = (cell.z + 0.5f) * e;
+        float nearest = std::numeric_limits<float>::max();
+        for (const Point& f : foci) {
+            const float dx = cx - f.x, dy = cy - f.y, dz = cz - f.z;
+            nearest = std::min(nearest, std::sqrt(dx * dx + dy * dy + dz * dz));
+        }
+        return nearest;
+    }
+
+    // Whether a cell of this level is far enough out to form a superparticle
+    template <typename Point>
+    bool mayCoarsen(const CellKey& cell, const std::vector<Point>& foci) const {
+        return levelFor(focusDistance(cell, foci) / (1.0f + lodParams.hysteresis)) >= cell.level;
+    }
+
+    // Descends from the top level to the first cell containing `p` that may
+    // coarsen; cells of one level therefore always nest inside the next
+    template <typename Point, typename Position>
+    bool coarsestCell(const Position& p, const std::vector<Point>& foci, CellKey& key) const {
+        for (int level = lodParams.maxLevel; level >= 1; --level) {
+            key = cellOf(p, level);
+            if (mayCoarsen(key, foci)) return true;
+        }
+        return false;
+    }
+
+    template <typename Point>
+    bool keeps(const Particle& s, const std::vector<Point>& foci) const {
+        const CellKey& cell = groups[s.superparticle].cell;
+        if (s.activation >= lodParams.hotspotActivation) return false;
+        if (levelFor(focusDistance(cell, foci)) < cell.level) return false;    // Too close: refine
+        if (cell.level >= lodParams.maxLevel) return true;
+        const CellKey parent{cell.level + 1, floorHalf(cell.x), floorHalf(cell.y), floorHalf(cell.z)};
+        return !mayCoarsen(parent, foci);                                      // Parent may coarsen: regroup
+    }
+
+    static int64_t floorHalf(int64_t v) { return v >= 0 ? v / 2 : -((-v + 1) / 2); }
+
+    Particle coarsen(const CellKey& cell, std::vector<Particle>& members) {
+        double mass = 0, luminosity = 0;
+        double px = 0, py = 0, pz = 0, vx = 0, vy = 0, vz = 0;
+        double temperature = 0, age = 0, r = 0, g = 0, b = 0;
+        for (const Particle& m : members) {
+            mass += m.mass;
+            luminosity += m.luminosity;
+            px += double(m.mass) * m.position.x;
+            py += double(m.mass) * m.position.y;
+            pz += double(m.mass) * m.position.z;
+            vx += double(m.mass) * m.velocity.x;
+            vy += double(m.mass) * m.velocity.y;
+            vz += double(m.mass) * m.velocity.z;
+            temperature += double(m.mass) * m.temperature;
+            age += double(m.mass) * m.age;
+            r += double(m.luminosity) * m.spectrum.r;
+            g += double(m.luminosity) * m.spectrum.g;
+            b += double(m.luminosity) * m.spectrum.b;
+        }
+        const double perMass = mass > 0.0 ? 1.0 / mass : 0.0;
+        const double perLuminosity = luminosity > 0.0 ? 1.0 / luminosity : 0.0;
+
+        Particle s = members.front();
+        s.position.x = float(px * perMass);
+        s.position.y = float(py * perMass);
+        s.position.z = float(pz * perMass);
+        s.velocity.x = float(vx * perMass);
+        s.velocity.y = float(vy * perMass);
+        s.velocity.z = float(vz * perMass);
+        s.mass = float(mass);
+        s.luminosity = float(luminosity);
+        s.temperature = float(temperature * perMass);
+        s.age = float(age * perMass);
+        if (luminosity > 0.0) {
+            s.spectrum.r = float(r * perLuminosity);
+            s.spectrum.g = float(g * perLuminosity);
+            s.spectrum.b = float(b * perLuminosity);
+        }
+        s.activation = 0.0f;
+        s.connections = 0;
+
+        int id;
+        if (!freeIds.empty()) {
+            id = freeIds.back();
+            freeIds.pop_back();
+        } else {
+            id = static_cast<int>(groups.size());
+            groups.emplace_back();
+        }
+        Group& group = groups[id];
+        group.cell = cell;
+        group.members.swap(members);
+        s.superparticle = id;
+        group.anchor = s;
+        members.clear();
+        return s;
+    }
+
+    // Appends the members of superparticle `s` to `out`, carried along with
+    // what happened to `s` since it formed, and dissolves its group
+    void release(const Particle& s, std::vector<Particle>& out) {
+        expand(s, out);
+        Group& group = groups[s.superparticle];
+        group.members.clear();
+        group.members.shrink_to_fit();
+        freeIds.push_back(s.superparticle);
+    }
+};
@@ -0,0 +1,278 @@
+// LiveState.h
+// Frame statistics and a decimated neuron view published to shared memory
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <sys/mman.h>
+
+#include "SharedMemory.h"
+
+// ============================================================================
+// Shared Layout
+// ============================================================================
+//
+// One segment per publishing simulator: a header holding the sequence
+// counter and the latest frame statistics, followed by a fixed-capacity
+// array of neuron samples. Everything is plain data so readers need
+// nothing but this header (not the simulation core) to interpret it.
+
+struct LiveStats {
+    int64_t frame;
+    double simulationTime;
+    float deltaTime;
+    float maxAcceleration;
+    float maxSpeed;
+    int32_t activePhotons;
+    int32_t numPhotons;
+    float avgLuminosity;
+    float avgTemperature;
+    float avgConnections;
+    float galaxyTemperature;
+    double phaseSeconds[5];   // dynamics, photons, connections, stellar, patterns
+
+    // From the core's FrameStats (or anything with the same fields)
+    template <typename Stats>
+    static LiveStats from(const Stats& s) {
+        LiveStats live{};
+        live.frame = s.frame;
+        live.simulationTime = s.simulationTime;
+        live.deltaTime = s.deltaTime;
+        live.maxAcceleration = s.maxAcceleration;
+        live.maxSpeed = s.maxSpeed;
+        live.activePhotons = s.activePhotons;
+        live.numPhotons = s.numPhotons;
+        live.avgLuminosity = s.avgLuminosity;
+        live.avgTemperature = s.avgTemperature;
+        live.avgConnections = s.avgConnections;
+        live.galaxyTemperature = s.galaxyTemperature;
+        live.phaseSeconds[0] = s.timings.dynamics;
+        live.phaseSeconds[1] = s.timings.photons;
+        live.phaseSeconds[2] = s.timings.connections;
+        live.phaseSeconds[3] = s.timings.stellar;
+        live.phaseSeconds[4] = s.timings.patterns;
+        return live;
+    }
+};
+
+struct LiveNeuron {
+    uint32_t index;           // Position in the galaxy's neuron array
+    float x, y, z;
+    float luminosity;
+    float temperature;
+    int32_t connections;
+};
+
+namespace LiveLayout {
+
+constexpr uint64_t MAGIC = 0x4e42554c4c495645ull;   // "NBULLIVE"
+constexpr uint32_t VERSION = 1;
+
+struct Header {
+    uint64_t magic;
+    uint32_t version;
+    uint32_t capacity;                        // Neuron samples the segment holds
+    std::atomic<uint32_t> live;               // 0 once the publisher has closed
+    alignas(64) std::atomic<uint64_t> sequence;   // Odd while a write is in progress
+    LiveStats stats;
+    uint64_t totalNeurons;                    // Neurons in the galaxy
+    uint32_t sampleCount;                     // Valid entries in the view
+    uint32_t stride;                          // Every stride-th neuron is sampled
+};
+
+static_assert(std::is_trivially_copyable<LiveStats>::value, "stats are copied as bytes");
+static_assert(std::is_trivially_copyable<LiveNeuron>::value, "samples are copied as bytes");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock-free");
+
+inline size_t bytesFor(uint32_t capacity) { return sizeof(Header) + size_t(capacity) * sizeof(LiveNeuron); }
+
+inline LiveNeuron* samples(Header* header) {
+    return reinterpret_cast<LiveNeuron*>(reinterpret_cast<char*>(header) + sizeof(Header));
+}
+inline const LiveNeuron* samples(const Header* header) {
+    return reinterpret_cast<const LiveNeuron*>(reinterpret_cast<const char*>(header) + sizeof(Header));
+}
+
+} // namespace LiveLayout
+
+// ============================================================================
+// Publisher
+// ============================================================================
+//
+// Single writer guarded by a seqlock: the sequence goes odd, the fields are
+// written in place, and it goes even again. The simulator never waits for
+// readers and readers never write, so any number of them can poll without
+// affecting the frame rate; the publisher's cost is one pass over the
+// sampled neurons.
+
+class LivePublisher {
+public:
+    LivePublisher() = default;
+    ~LivePublisher() { close(); }
+
+    LivePublisher(const LivePublisher&) = delete;
+    LivePublisher& operator=(const LivePublisher&) = delete;
+
+    // Creates the segment `name` (e.g. "/nebula_live") holding up to
+    // `capacity` neuron samples. A stale segment of the same name, left by a
+    // run that did not exit cleanly, is replaced.
+    bool open(const std::string& name, uint32_t capacity) {
+        close();
+        shm_unlink(name.c_str());
+        segment = SharedSegment(name, LiveLayout::bytesFor(capacity));
+        if (!segment.isOpen()) return false;
+
+        header = new (segment.data()) LiveLayout::Header();
+        header->magic = LiveLayout::MAGIC;
+        header->version = LiveLayout::VERSION;
+        header->capacity = capacity;
+        header->sequence.store(0, std::memory_order_relaxed);
+        header->stats = LiveStats{};
+        header->totalNeurons = 0;
+        header->sampleCount = 0;
+        header->stride = 1;
+        header->live.store(1, std::memory_order_release);
+        return true;
+    }
+
+    bool isOpen() const { return header != nullptr; }
+
+    // Publishes stats and every stride-th neuron, with the stride chosen so
+    // the samples fit the capacity. neuronAt(i) returns something with
+    // position, luminosity, temperature and connections members.
+    template <typename NeuronAt>
+    void publish(const LiveStats& stats, size_t neuronCount, NeuronAt&& neuronAt) {
+        if (!header) return;
+        const size_t capacity = header->capacity;
+        const size_t stride = capacity == 0 ? 1 : std::max<size_t>(1, (neuronCount + capacity - 1) / capacity);
+        const size_t samples = capacity == 0 ? 0 : std::min(capacity, (neuronCount + stride - 1) / stride);
+
+        const uint64_t sequence = header->sequence.load(std::memory_order_relaxed);
+        header->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        header->stats = stats;
+        header->totalNeurons = neuronCount;
+        header->stride = static_cast<uint32_t>(stride);
+        header->sampleCount = static_cast<uint32_t>(samples);
+        LiveNeuron* out = LiveLayout::samples(header);
+        for (size_t k = 0; k < samples; ++k) {
+            const size_t i = k * stride;
+            const auto& neuron = neuronAt(i);
+            out[k] = LiveNeuron{static_cast<uint32_t>(i), neuron.position.x, neuron.position.y, neuron.position.z,
+                                neuron.luminosity, neuron.temperature, static_cast<int32_t>(neuron.connections)};
+        }
+
+        header->sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    // Marks the segment closed for readers and removes its name
+    void close() {
+        if (!header) return;
+        header->live.store(0, std::memory_order_release);
+        header = nullptr;
+        segment = SharedSegment();
+    }
+
+private:
+    SharedSegment segment;
+    LiveLayout::Header* header = nullptr;
+};
+
+// ============================================================================
+// Reader
+// ============================================================================
+//
+// Attaches read-only. view() runs a visitor directly on the shared memory
+// (no copy) and reports whether the data stayed consistent for the whole
+// visit; read() copies one consistent snapshot, retrying while a write
+// overlaps it.
+
+struct LiveSnapshot {
+    uint64_t sequence = 0;
+    LiveStats stats{};
+    uint64_t totalNeurons = 0;
+    uint32_t stride = 1;
+    std::vector<LiveNeuron> neurons;
+};
+
+class LiveReader {
+public:
+    bool attach(const std::string& name) {
+        segment = SharedSegment::attach(name);
+        header = nullptr;
+        if (!segment.isOpen() || segment.size() < sizeof(LiveLayout::Header)) {
+            segment = SharedSegment();
+            return false;
+        }
+        const auto* candidate = static_cast<const LiveLayout::Header*>(segment.data());
+        if (candidate->magic != LiveLayout::MAGIC || candidate->version != LiveLayout::VERSION ||
+            segment.size() < LiveLayout::bytesFor(candidate->capacity)) {
+            std::cerr << "Error: " << name << " is not a NEBULA live-state segment" << std::endl;
+            segment = SharedSegment();
+            return false;
+        }
+        header = candidate;
+        return true;
+    }
+
+    bool isAttached() const { return header != nullptr; }
+    bool publisherLive() const { return header && header->live.load(std::memory_order_acquire) != 0; }
+
+    // Sequence of the last completed publication (even), or odd mid-write
+    uint64_t sequence() const { return header ? header->sequence.load(std::memory_order_acquire) : 0; }
+
+    // Calls visit(stats, samples, count) on the live memory. Returns true if
+    // no publication overlapped the visit; otherwise the visitor may have
+    // seen a torn mix and its results should be discarded.
+    template <typename Visit>
+    bool view(Visit&& visit) const {
+        if (!header) return false;
+        const uint64_t before = header->sequence.load(std::memory_order_acquire);
+        if (before & 1) return false;
+        const uint32_t count = std::min(header->sampleCount, header->capacity);
+        visit(header->stats, LiveLayout::samples(header), count);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return header->sequence.load(std::memory_order_relaxed) == before;
+    }
+
+    // Copies a consistent snapshot; false if none was obtained within
+    // `attempts` tries (the publisher writing continuously) or not attached
+    bool read(LiveSnapshot& out, int attempts = 1000) const {
+        if (!header) return false;
+        for (int attempt = 0; attempt < attempts; ++attempt) {
+            const uint64_t before = header->sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            out.stats = header->stats;
+            out.totalNeurons = header->totalNeurons;
+            out.stride = header->stride;
+            const uint32_t count = std::min(header->sampleCount, header->capacity);
+            out.neurons.resize(count);
+            std::memcpy(out.neurons.data(), LiveLayout::samples(header), count * sizeof(LiveNeuron));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header->sequence.load(std::memory_order_relaxed) == before) {
+                out.sequence = before;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    SharedSegment segment;
+    const LiveLayout::Header* header = nullptr;
+};
@@ -0,0 +1,255 @@
+// MemoryPlacement.h
+// NUMA placement, huge-page backing and CPU ordering for the simulation core
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// ============================================================================
+// Placement Options
+// ============================================================================
+
+enum class NumaPolicy {
+    FirstTouch,   // Kernel default: a page lands on the node of the thread that first writes it
+    Interleave,   // Pages spread round-robin over every online node
+    Node          // Pages bound to one node (PlacementOptions::node)
+};
+
+struct PlacementOptions {
+    NumaPolicy numa = NumaPolicy::FirstTouch;
+    int node = 0;              // Target node for NumaPolicy::Node
+    bool hugePages = false;    // Back the state arrays with 2 MB pages when the kernel allows
+    bool pinThreads = false;   // Pin pool workers to CPUs, filling one node before the next
+};
+
+// ============================================================================
+// Topology
+// ============================================================================
+//
+// Read from sysfs so no libnuma is needed. Machines without NUMA support
+// report a single node holding every CPU the process may run on.
+
+namespace Topology {
+
+// Parses a kernel CPU/node list such as "0-3,8,10-11"
+inline std::vector<int> parseList(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string range;
+    while (std::getline(stream, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        size_t dash = range.find('-');
+        int first = std::atoi(range.c_str());
+        int last = dash == std::string::npos ? first : std::atoi(range.c_str() + dash + 1);
+        for (int v = first; v <= last; ++v) values.push_back(v);
+    }
+    return values;
+}
+
+inline std::vector<int> readList(const std::string& path) {
+    std::ifstream file(path);
+    std::string text;
+    std::getline(file, text);
+    return parseList(text);
+}
+
+inline std::vector<int> onlineNodes() {
+    std::vector<int> nodes = readList("/sys/devices/system/node/online");
+    if (nodes.empty()) nodes.push_back(0);
+    return nodes;
+}
+
+inline std::vector<int> allowedCpus() {
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &set)) cpus.push_back(c);
+        }
+    }
+    return cpus;
+}
+
+// Allowed CPUs grouped node by node, so consecutive pool workers share a
+// node and its memory controller before the pool spills onto the next one
+inline std::vector<int> cpusByNode() {
+    const std::vector<int> allowed = allowedCpus();
+    std::vector<int> ordered;
+    for (int node : onlineNodes()) {
+        for (int cpu : readList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist")) {
+            if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end() &&
+                std::find(ordered.begin(), ordered.end(), cpu) == ordered.end()) {
+                ordered.push_back(cpu);
+            }
+        }
+    }
+    for (int cpu : allowed) {
+        if (std::find(ordered.begin(), ordered.end(), cpu) == ordered.end()) ordered.push_back(cpu);
+    }
+    return ordered;
+}
+
+// Applies `policy` to an existing mapping through the raw mbind syscall.
+// FirstTouch needs no call; returns false when the kernel refuses.
+inline bool bindMemory(void* address, size_t bytes, NumaPolicy policy, int node) {
+    if (policy == NumaPolicy::FirstTouch) return true;
+#ifdef SYS_mbind
+    constexpr int MPOL_BIND_MODE = 2;
+    constexpr int MPOL_INTERLEAVE_MODE = 3;
+    constexpr size_t MASK_BITS = 1024;
+    unsigned long mask[MASK_BITS / (8 * sizeof(unsigned long))] = {};
+    auto setNode = [&](int n) {
+        if (n >= 0 && static_cast<size_t>(n) < MASK_BITS) {
+            mask[n / (8 * sizeof(unsigned long))] |= 1UL << (n % (8 * sizeof(unsigned long)));
+        }
+    };
+    if (policy == NumaPolicy::Interleave) {
+        for (int n : onlineNodes()) setNode(n);
+    } else {
+        setNode(node);
+    }
+    const int mode = policy == NumaPolicy::Interleave ? MPOL_INTERLEAVE_MODE : MPOL_BIND_MODE;
+    return syscall(SYS_mbind, address, bytes, mode, mask, MASK_BITS + 1, 0) == 0;
+#else
+    (void)address; (void)bytes; (void)node;
+    return false;
+#endif
+}
+
+} // namespace Topology
+
+// ============================================================================
+// Placed Memory Resource
+// ============================================================================
+//
+// Serves allocations from large anonymous mappings aligned to 2 MB. With
+// huge pages requested each mapping first tries MAP_HUGETLB (reserved pages)
+// and otherwise asks for transparent huge pages with madvise; the NUMA policy
+// is applied with mbind before anything touches the pages. Allocation is a
+// bump pointer per mapping and memory is returned only when the resource is
+// destroyed, so it sits upstream of a pool resource that recycles blocks.
+
+class MappedRegionResource : public std::pmr::memory_resource {
+public:
+    static constexpr size_t HUGE_PAGE_BYTES = size_t(2) << 20;
+
+    MappedRegionResource(const PlacementOptions& options, size_t regionBytes = size_t(64) << 20)
+        : options(options), regionBytes(roundUp(regionBytes, HUGE_PAGE_BYTES)) {}
+
+    ~MappedRegionResource() override {
+        for (const Region& region : regions) munmap(region.base, region.bytes);
+    }
+
+    MappedRegionResource(const MappedRegionResource&) = delete;
+    MappedRegionResource& operator=(const MappedRegionResource&) = delete;
+
+    size_t hugeTlbRegions() const { return hugeTlbCount; }
+    size_t mappedBytes() const {
+        size_t total = 0;
+        for (const Region& region : regions) total += region.bytes;
+        return total;
+    }
+
+private:
+    struct Region {
+        char* base;
+        size_t bytes;
+    };
+
+    static size_t roundUp(size_t value, size_t multiple) {
+        return (value + multiple - 1) / multiple * multiple;
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        size_t offset = roundUp(used, std::max<size_t>(alignment, alignof(std::max_align_t)));
+        if (regions.empty() || offset + bytes > regions.back().bytes) {
+            if (!mapRegion(std::max(regionBytes, roundUp(bytes, HUGE_PAGE_BYTES)))) throw std::bad_alloc();
+            offset = 0;
+        }
+        used = offset + bytes;
+        return regions.back().base + offset;
+    }
+
+    void do_deallocate(void*, size_t, size_t) override {}
+
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+    bool mapRegion(size_t bytes) {
+        void* mapped = MAP_FAILED;
+#ifdef MAP_HUGETLB
+        if (options.hugePages) {
+            mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+            if (mapped != MAP_FAILED) ++hugeTlbCount;
+        }
+#endif
+        if (mapped == MAP_FAILED) {
+            // Over-map so the region can start on a huge-page boundary
+            const size_t padded = bytes + HUGE_PAGE_BYTES;
+            char* raw = static_cast<char*>(mmap(nullptr, padded, PROT_READ | PROT_WRITE,
+                                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+            if (raw == MAP_FAILED) return false;
+            char* aligned = reinterpret_cast<char*>(roundUp(reinterpret_cast<uintptr_t>(raw), HUGE_PAGE_BYTES));
+            if (aligned > raw) munmap(raw, aligned - raw);
+            if (raw + padded > aligned + bytes) munmap(aligned + bytes, raw + padded - (aligned + bytes));
+            mapped = aligned;
+#ifdef MADV_HUGEPAGE
+            if (options.hugePages) madvise(mapped, bytes, MADV_HUGEPAGE);
+#endif
+        }
+        Topology::bindMemory(mapped, bytes, options.numa, options.node);
+        regions.push_back({static_cast<char*>(mapped), bytes});
+        used = 0;
+        return true;
+    }
+
+    PlacementOptions options;
+    size_t regionBytes;
+    std::vector<Region> regions;
+    size_t used = 0;
+    size_t hugeTlbCount = 0;
+    std::mutex mutex;
+};
+
+// A thread-safe pool over placed mappings; what a galaxy owns when its
+// PlacementOptions ask for huge pages or an explicit NUMA policy
+class PlacedMemoryResource : public std::pmr::memory_resource {
+public:
+    explicit PlacedMemoryResource(const PlacementOptions& options)
+        : regions(options), pool(poolOptions(), &regions) {}
+
+    const MappedRegionResource& upstream() const { return regions; }
+
+private:
+    static std::pmr::pool_options poolOptions() {
+        std::pmr::pool_options options;
+        options.largest_required_pool_block = size_t(1) << 20;   // Array chunks stay pooled
+        return options;
+    }
+
+    void* do_allocate(size_t bytes, size_t alignment) override { return pool.allocate(bytes, alignment); }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override { pool.deallocate(p, bytes, alignment); }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override { return this == &other; }
+
+    MappedRegionResource regions;
+    std::pmr::synchronized_pool_resource pool;
+};
@@ -0,0 +1,222 @@
+// NEBULA_DOMAINS.cpp
+// Runs one NEBULA EMERGENT galaxy split into slab domains, one process each
+//
+// Initial conditions come from the regular galaxy initializer. Worker
+// processes exchange ghosts and migrating neurons through POSIX shared-memory
+// rings and re-cut their slabs by neuron count. With --verify the same
+// galaxy is also run as a single domain and the results are compared, to
+// floating-point rounding.
+
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "NEBULA_EMERGENT_CORE.h"
+#include "DomainDecomposition.h"
+
+struct DomainRun {
+    std::vector<NeuronRecord> neurons;      // Final state indexed by id
+    std::vector<DomainReport> reports;
+    double wallSeconds = 0.0;
+    bool ok = false;
+};
+
+static std::vector<NeuronRecord> initialRecords(int neuronCount, unsigned seed, GravityParams& gravity) {
+    GalaxyOptions options;
+    options.verbose = false;
+    NEBULAEmergentGalaxy galaxy(neuronCount, 0, seed, options);
+    gravity = galaxy.getGravityParams();
+
+    std::vector<NeuronRecord> records;
+    const auto& neurons = galaxy.getNeurons();
+    for (size_t i = 0; i < neurons.size(); ++i) {
+        const Neuron& n = neurons[i];
+        NeuronRecord r{};
+        r.id = static_cast<uint32_t>(i);
+        r.x = n.position.x;
+        r.y = n.position.y;
+        r.z = n.position.z;
+        r.vx = n.velocity.x;
+        r.vy = n.velocity.y;
+        r.vz = n.velocity.z;
+        r.mass = n.mass;
+        r.luminosity = n.luminosity;
+        r.temperature = n.temperature;
+        r.age = n.age;
+        r.activation = n.activation;
+        r.connections = n.connections;
+        records.push_back(r);
+    }
+    return records;
+}
+
+// Forks one worker process per domain and waits for all of them. Nothing
+// in this process may hold live threads at the fork.
+static DomainRun runDomains(const std::vector<NeuronRecord>& initial, int domains, long frames,
+                            const DomainParams& params, const std::string& prefix) {
+    DomainRun run;
+    DomainSharedState shared;
+    if (!shared.create(prefix, domains, initial.size(), 4096)) return run;
+
+    std::vector<float> xs;
+    for (const NeuronRecord& r : initial) xs.push_back(r.x);
+    const SlabDecomposition slabs = SlabDecomposition::balanced(xs, domains);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<pid_t> children;
+    for (int d = 0; d < domains; ++d) {
+        pid_t pid = fork();
+        if (pid < 0) {
+            std::cerr << "Error: fork failed for domain " << d << std::endl;
+            for (pid_t child : children) kill(child, SIGTERM);
+            for (pid_t child : children) waitpid(child, nullptr, 0);
+            return run;
+        }
+        if (pid == 0) {
+            std::vector<NeuronRecord> owned;
+            for (const NeuronRecord& r : initial) {
+                if (slabs.owner(r.x) == d) owned.push_back(r);
+            }
+            {
+                DomainWorker worker(d, shared, slabs, params, std::move(owned));
+                worker.run(frames);
+            }
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+
+    run.ok = true;
+    for (pid_t child : children) {
+        int status = 0;
+        waitpid(child, &status, 0);
+        run.ok = run.ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    run.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    run.neurons.assign(shared.resultTable(), shared.resultTable() + initial.size());
+    run.reports.assign(shared.getControl().reports, shared.getControl().reports + domains);
+    return run;
+}
+
+int main(int argc, char** argv) {
+    int domains = 4;
+    int neuronCount = 20000;
+    long frames = 20;
+    unsigned seed = 42;
+    bool verify = false;
+    DomainParams params;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* prefix) -> const char* {
+            size_t len = std::string(prefix).size();
+            return arg.compare(0, len, prefix) == 0 ? argv[i] + len : nullptr;
+        };
+
+        if (const char* v = value("--domains=")) {
+            domains = std::atoi(v);
+        } else if (const char* v = value("--neurons=")) {
+            neuronCount = std::atoi(v);
+        } else if (const char* v = value("--frames=")) {
+            frames = std::atol(v);
+        } else if (const char* v = value("--dt=")) {
+            params.deltaTime = std::strtof(v, nullptr);
+        } else if (const char* v = value("--seed=")) {
+            seed = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+        } else if (const char* v = value("--ghost-width=")) {
+            params.ghostWidth = std::strtof(v, nullptr);
+        } else if (const char* v = value("--rebalance-every=")) {
+            params.rebalanceEvery = std::atoi(v);
+        } else if (const char* v = value("--threads-per-domain=")) {
+            params.threadsPerDomain = static_cast<unsigned>(std::atoi(v));
+        } else if (arg == "--verify") {
+            verify = true;
+        } else {
+            std::cerr << "Usage: nebula_domains [--domains=K] [--neurons=N] [--frames=F] [--dt=DT] "
+                         "[--seed=S] [--ghost-width=W] [--rebalance-every=R] "
+                         "[--threads-per-domain=T] [--verify]" << std::endl;
+            return 1;
+        }
+    }
+    if (domains < 1 || domains > DomainSharedState::MAX_DOMAINS) {
+        std::cerr << "Error: --domains must be between 1 and " << DomainSharedState::MAX_DOMAINS << std::endl;
+        return 1;
+    }
+
+    std::cout << "🌌 NEBULA EMERGENT Domain Decomposition" << std::endl;
+    std::cout << "================================================" << std::endl;
+    std::cout << "   Neurons: " << neuronCount << ", domains: " << domains << ", frames: " << frames << std::endl;
+    std::cout << "   Ghost width: " << params.ghostWidth << ", rebalance every " << params.rebalanceEvery
+              << " frames" << std::endl;
+
+    params.seed = seed;
+    const std::vector<NeuronRecord> initial = initialRecords(neuronCount, seed, params.gravity);
+    const std::string prefix = "/nebula_domains_" + std::to_string(getpid());
+
+    DomainRun run = runDomains(initial, domains, frames, params, prefix);
+    if (!run.ok) {
+        std::cerr << "❌ Domain run failed" << std::endl;
+        return 1;
+    }
+
+    std::cout << "\n" << std::setw(7) << "domain" << std::setw(10) << "neurons" << std::setw(9) << "ghosts"
+              << std::setw(11) << "migrated" << std::setw(13) << "compute_s" << std::setw(13) << "exchange_s"
+              << std::endl;
+    for (int d = 0; d < domains; ++d) {
+        const DomainReport& r = run.reports[d];
+        std::cout << std::setw(7) << d << std::setw(10) << r.neurons << std::setw(9) << r.ghosts
+                  << std::setw(11) << r.migratedOut << std::fixed << std::setprecision(3)
+                  << std::setw(13) << r.computeSeconds << std::setw(13) << r.exchangeSeconds << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+    std::cout << "\n📊 Wall time: " << std::fixed << std::setprecision(3) << run.wallSeconds << " s" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+
+    if (verify) {
+        DomainRun reference = runDomains(initial, 1, frames, params, prefix + "_ref");
+        if (!reference.ok) {
+            std::cerr << "❌ Reference run failed" << std::endl;
+            return 1;
+        }
+
+        // Sums over bodies and neighbors run in a different order for each
+        // slab layout (see DomainWorker), so agreement is to rounding, not
+        // bit for bit. Positions are allowed 1e-3 absolute, about ten ulps
+        // of a coordinate 2000 out, for rounding carried through a few
+        // frames of integration; luminosities 1e-5 relative, about a
+        // hundred ulps. Connection counts must match exactly.
+        double maxPositionError = 0.0;
+        double maxLuminosityError = 0.0;
+        long connectionMismatches = 0;
+        long bitwiseMismatches = 0;
+        for (size_t i = 0; i < initial.size(); ++i) {
+            const NeuronRecord& a = run.neurons[i];
+            const NeuronRecord& b = reference.neurons[i];
+            bitwiseMismatches += a.x != b.x || a.y != b.y || a.z != b.z || a.luminosity != b.luminosity;
+            double dx = a.x - b.x, dy = a.y - b.y, dz = a.z - b.z;
+            maxPositionError = std::max(maxPositionError, std::sqrt(dx * dx + dy * dy + dz * dz));
+            maxLuminosityError = std::max(maxLuminosityError,
+                                          std::abs(double(a.luminosity) - b.luminosity) / std::max(1e-6f, b.luminosity));
+            connectionMismatches += a.connections != b.connections;
+        }
+
+        const bool pass = connectionMismatches == 0 && maxPositionError < 1e-3 && maxLuminosityError < 1e-5;
+        std::cout << "\n🔍 Versus single domain (" << std::setprecision(3) << reference.wallSeconds << " s):" << std::endl;
+        std::cout << "   Max position error: " << maxPositionError << std::endl;
+        std::cout << "   Max relative luminosity error: " << maxLuminosityError << std::endl;
+        std::cout << "   Connection mismatches: " << connectionMismatches << std::endl;
+        std::cout << "   Neurons not bitwise identical: " << bitwiseMismatches << std::endl;
+        std::cout << "   Result: " << (pass ? "PASS" : "FAIL") << std::endl;
+        if (!pass) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,1743 @@
+// NEBULA_EMERGENT_CORE.h
+// Neural galaxy simulation core shared by the standalone driver and tools
+
+#pragma once
+
+#include <iostream>
+#include <vector>
+#include <memory>
+#include <random>
+#include <cmath>
+#include <chrono>
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <string>
+#include <memory_resource>
+#include <utility>
+
+#include "ActiveSet.h"
+#include "AllPairsGravity.h"
+#include "Clustering.h"
+#include "ClusterTracking.h"
+#include "DiversityMaintenance.h"
+#include "CowArray.h"
+#include "FrameArena.h"
+#include "FusionFission.h"
+#include "InjectionQueue.h"
+#include "Integrators.h"
+#include "LevelOfDetail.h"
+#include "CellStreaming.h"
+#include "MemoryPlacement.h"
+#include "PhaseScheduler.h"
+#include "SlotMap.h"
+#include "SnapshotLoader.h"
+#include "SpatialGrid.h"
+#include "TaskGraph.h"
+#include "ThreadPool.h"
+#include "TimestepController.h"
+
+// ============================================================================
+// Basic Data Structures
+// ============================================================================
+
+struct Vector3 {
+    float x, y, z;
+    
+    Vector3() : x(0), y(0), z(0) {}
+    Vector3(float x_, float y_, float z_) : x(x_), y(y_), z(z_) {}
+    
+    Vector3 operator+(const Vector3& other) const {
+        return Vector3(x + other.x, y + other.y, z + other.z);
+    }
+    
+    Vector3 operator-(const Vector3& other) const {
+        return Vector3(x - other.x, y - other.y, z - other.z);
+    }
+    
+    Vector3 operator*(float scalar) const {
+        return Vector3(x * scalar, y * scalar, z * scalar);
+    }
+    
+    float magnitude() const {
+        return std::sqrt(x*x + y*y + z*z);
+    }
+    
+    Vector3 normalized() const {
+        float mag = magnitude();
+        if (mag > 0.0001f) {
+            return Vector3(x/mag, y/mag, z/mag);
+        }
+        return Vector3(0, 0, 0);
+    }
+};
+
+struct Color {
+    float r, g, b, a;
+    
+    Color() : r(1.0f), g(1.0f), b(1.0f), a(1.0f) {}
+    Color(float r_, float g_, float b_, float a_ = 1.0f) : r(r_), g(g_), b(b_), a(a_) {}
+};
+
+// Stable reference to a neuron across fusion, fission, LOD and streaming
+// passes (see NEBULAEmergentGalaxy::neuronHandle)
+using NeuronHandle = SlotHandle;
+
+// ============================================================================
+// Neuron Structure
+// ============================================================================
+
+struct Neuron {
+    Vector3 position;
+    Vector3 velocity;
+    float mass;
+    float luminosity;
+    Color spectrum;
+    float temperature;
+    float age;
+    int connections;
+    float activation;
+    std::vector<NeuronHandle> synapses;
+    int superparticle = -1;   // LOD group this entry stands for; -1: an individual neuron
+    uint32_t slot = SlotTable::NONE;   // Handle slot, assigned by the galaxy
+    
+    Neuron() : mass(1.0f), luminosity(1.0f), temperature(2700.0f), age(0.0f), 
+               connections(0), activation(0.0f) {
+        // Random initial position in galaxy. One generator per thread:
+        // seeding a fresh one per neuron dominated building large arrays.
+        static thread_local std::mt19937 gen(std::random_device{}());
+        std::uniform_real_distribution<float> pos_dist(-1000.0f, 1000.0f);
+        std::uniform_real_distribution<float> vel_dist(-10.0f, 10.0f);
+        
+        position = Vector3(pos_dist(gen), pos_dist(gen), pos_dist(gen));
+        velocity = Vector3(vel_dist(gen), vel_dist(gen), vel_dist(gen));
+        
+        // Spectral characteristics based on temperature
+        updateSpectrum();
+    }
+    
+    void updateSpectrum() {
+        // Wien's displacement law approximation
+        float wavelength_peak = 2.898e-3f / temperature; // meters
+        
+        // Convert to RGB approximation
+        if (temperature < 3500) {
+            spectrum = Color(1.0f, 0.3f, 0.1f); // Red giant
+        } else if (temperature < 5000) {
+            spectrum = Color(1.0f, 0.8f, 0.4f); // Orange
+        } else if (temperature < 6000) {
+            spectrum = Color(1.0f, 1.0f, 0.8f); // Yellow
+        } else if (temperature < 7500) {
+            spectrum = Color(0.9f, 0.9f, 1.0f); // White
+        } else {
+            spectrum = Color(0.6f, 0.7f, 1.0f); // Blue giant
+        }
+    }
+};
+
+// ============================================================================
+// Photon Structure for Ray Tracing
+// ============================================================================
+
+struct Photon {
+    Vector3 position;
+    Vector3 direction;
+    Color energy;
+    float wavelength;
+    float intensity;
+    bool active;
+    NeuronHandle source;        // Emitting neuron; invalid for injected photons
+    
+    Photon() : wavelength(550e-9f), intensity(1.0f), active(true) {}
+    
+    void propagate(float deltaTime) {
+        const float SPEED_OF_LIGHT = 299792458.0f;
+        position = position + direction * (SPEED_OF_LIGHT * deltaTime);
+    }
+};
+
+// ============================================================================
+// Stimuli
+// ============================================================================
+//
+// Queued from any thread while the galaxy runs and applied when the phase
+// that owns the affected fields next starts.
+
+struct PhotonBurst {
+    Vector3 origin;
+    Vector3 direction;          // Zero: photons leave in random directions
+    int photons = 10;
+    float wavelength = 550e-9f;
+    float intensity = 1.0f;
+};
+
+struct NeuronPerturbation {
+    Vector3 center;
+    float radius = 100.0f;
+    Vector3 velocityKick;       // Added to every neuron within radius of center
+};
+
+// ============================================================================
+// NEBULA EMERGENT Galaxy System
+// ============================================================================
+
+// Integrator used by evolveFrame; override with -DNEBULA_INTEGRATOR=VelocityVerlet
+// (or Yoshida4, RungeKutta4). Resolved at compile time.
+#ifndef NEBULA_INTEGRATOR
+#define NEBULA_INTEGRATOR SemiImplicitEuler
+#endif
+
+enum class GravityMode {
+    Sampled,     // 100 random partners per neuron (fast, noisy)
+    ExactTiled   // Exact cache-blocked all-pairs reference
+};
+
+// Shared infrastructure a galaxy may borrow instead of creating its own,
+// e.g. when many galaxies run in one process
+struct GalaxyOptions {
+    ThreadPool* threadPool = nullptr;                // nullptr: galaxy owns a pool
+    std::pmr::memory_resource* memory = nullptr;     // nullptr: default resource, or a placed one below
+    bool verbose = true;                             // Print initialization progress
+    PlacementOptions placement;                      // NUMA policy, huge pages and pinning for owned resources
+};
+
+enum class ExecutionMode {
+    Deterministic,  // Phases run one after another in their original order
+    TaskGraph       // Independent phases (and frames) overlap on the thread pool
+};
+
+enum class TimestepMode {
+    Fixed,      // evolveFrame advances by exactly the dt it is given
+    Adaptive    // TimestepController picks dt, bounded by the dt given
+};
+
+inline const char* gravityModeName(GravityMode mode) {
+    switch (mode) {
+        case GravityMode::Sampled:    return "sampled";
+        case GravityMode::ExactTiled: return "exact";
+    }
+    return "unknown";
+}
+
+// Wall-clock seconds spent in each evolveFrame phase during the last frame
+struct PhaseTimings {
+    double dynamics = 0.0;
+    double photons = 0.0;
+    double connections = 0.0;
+    double stellar = 0.0;
+    double patterns = 0.0;
+    
+    double total() const { return dynamics + photons + connections + stellar + patterns; }
+    
+    double& operator[](PhaseId phase) {
+        switch (phase) {
+            case PhaseId::Dynamics:    return dynamics;
+            case PhaseId::Photons:     return photons;
+            case PhaseId::Connections: return connections;
+            case PhaseId::Stellar:     return stellar;
+            default:                   return patterns;
+        }
+    }
+};
+
+// Aggregate galaxy observables, as reported by printStatus()
+struct FrameStats {
+    long frame = 0;
+    float simulationTime = 0.0f;
+    float deltaTime = 0.0f;           // dt taken by the last frame
+    float maxAcceleration = 0.0f;     // peak |a| seen by the last dynamics step
+    float maxSpeed = 0.0f;            // peak |v| after the last dynamics step
+    int activePhotons = 0;
+    int numPhotons = 0;
+    float avgLuminosity = 0.0f;
+    float avgTemperature = 0.0f;
+    float avgConnections = 0.0f;
+    float galaxyTemperature = 0.0f;
+    int activeNeurons = 0;            // Neurons on the active list (all without sparse updates)
+    int superparticles = 0;           // LOD entries standing for groups of neurons
+    int frozenNeurons = 0;            // Streamed out, held in memory
+    int evictedNeurons = 0;           // Streamed out to disk
+    long fusedNeurons = 0;            // Absorbed by fusion so far
+    long fissions = 0;                // Neurons split so far
+    float diversityTemperature = 0.0f;   // Annealing temperature of diversity maintenance
+    PhaseTimings timings;
+};
+
+class NEBULAEmergentGalaxy {
+private:
+    std::shared_ptr<std::pmr::memory_resource> ownedMemory;   // Placed resource, shared with forks
+    std::pmr::memory_resource* memory;
+    std::shared_ptr<ThreadPool> ownedPool;   // Shared with forks of this galaxy
+    ThreadPool* threadPool;
+    bool verbose;
+    
+    // Chunked and shared copy-on-write with forks (see fork())
+    CowArray<Neuron> neurons;
+    CowArray<Photon> photons;
+    
+    // Gravity solver state
+    GravityMode gravityMode = GravityMode::Sampled;
+    AllPairsGravity allPairsGravity;
+    std::pmr::vector<float> bodyX, bodyY, bodyZ, bodyMass;
+    std::pmr::vector<float> bodyVX, bodyVY, bodyVZ;
+    std::pmr::vector<float> accelX, accelY, accelZ;
+    IntegratorWorkspace integratorWorkspace;
+    bool pendingAccelerations = false;   // Workspace holds forces supplied from outside
+    
+    // Physics constants
+    const float GRAVITATIONAL_CONSTANT = 6.67430e-11f;
+    const float SPEED_OF_LIGHT = 299792458.0f;
+    const float PLANCK_CONSTANT = 6.62607015e-34f;
+    
+    // Simulation parameters
+    int numNeurons;
+    int numPhotons;
+    float simulationTime;
+    float temperature;
+    long frameCount = 0;
+    PhaseTimings lastTimings;
+    PhaseScheduler phaseScheduler;
+    
+    // Timestep control: measured each frame, consumed by the next one
+    TimestepMode timestepMode = TimestepMode::Fixed;
+    TimestepController timestepController;
+    float lastDeltaTime = 0.0f;
+    float lastMaxAcceleration = 0.0f;
+    float lastMaxSpeed = 0.0f;
+    float photonInteractionRate = 0.0f;   // interactions per active photon per second
+    std::vector<float> slotMaxAcceleration, slotMaxSpeed;
+    
+    // Random number generation
+    std::mt19937 rng;
+    std::uniform_real_distribution<float> uniform_dist;
+    std::normal_distribution<float> normal_dist;
+    
+    // Independent streams per phase so phases can run concurrently and still
+    // reproduce the same results for a given seed
+    std::mt19937 dynamicsRng;
+    std::mt19937 photonRng;
+    std::mt19937 stellarRng;
+    
+    // Phase execution
+    ExecutionMode executionMode = ExecutionMode::Deterministic;
+    TaskGraph frameGraph;
+    
+    // Transient per-frame buffers; rewound once a frame has fully finished
+    FrameArena frameArena;
+    
+    // Stimuli pushed by other threads, drained by the phase they affect
+    MpscQueue<PhotonBurst> photonInjections;
+    MpscQueue<NeuronPerturbation> perturbationInjections;
+    size_t photonCursor = 0;   // Where the search for a free photon resumes
+    
+    // Spatial index over neuron positions, built on demand by spatialIndex()
+    std::shared_ptr<SpatialGrid> spatialGrid;
+    static constexpr float connectionRadius = 100.0f;   // Neurons closer than this connect
+    float spatialCellSize = connectionRadius;
+    uint64_t positionEpoch = 0;                  // Bumped whenever positions change
+    uint64_t spatialGridEpoch = UINT64_MAX;      // positionEpoch the grid was built at
+    
+    // Sparse updates: connections and stellar evolution visit active neurons
+    // and a rotating slice of dormant ones
+    ActivityParams activity;
+    ActiveSet activeSet;
+    size_t connectionsCursor = 0;      // Next dormant neuron each phase revisits
+    size_t stellarCursor = 0;
+    float stellarClock = 0.0f;         // Time the stellar phase has covered
+    std::vector<float> stellarUpdatedAt;   // stellarClock at each neuron's last update
+    
+    // Level of detail: far-field neurons folded into superparticles
+    LodHierarchy<Neuron> lod;
+    std::vector<Vector3> observers;    // Shared by LOD and cell streaming
+    std::vector<Neuron> passEntries;   // Working copy of the array for LOD and streaming passes
+    
+    // Cell streaming: neurons far from every observer frozen or on disk
+    CellStreamer<Neuron> streamer;
+    
+    // Fusion and fission of neurons, with running totals
+    FusionFissionEngine<Neuron> fusion;
+    long fusedTotal = 0;
+    long fissionTotal = 0;
+    
+    // DBSCAN clustering of the current neurons, and persistent identities
+    ClusterEngine clustering;
+    ClusterTracker clusterTracker;
+    
+    // Diversity maintenance, and the simulation time of its last pass
+    DiversityController diversity;
+    float diversityClock = 0.0f;
+    
+    // Handle slots of every neuron, simulated or held by LOD or streaming
+    SlotTable neuronSlots;
+    std::vector<uint8_t> slotState;   // Scratch for reindexNeurons()
+    
+public:
+    // A seed of 0 draws one from std::random_device; any other value makes
+    // initialization and evolution reproducible
+    NEBULAEmergentGalaxy(int neuronCount = 100000, int photonCount = 50000, unsigned seed = 0,
+                         const GalaxyOptions& options = GalaxyOptions()) 
+        : ownedMemory(makePlacedMemory(options)),
+          memory(options.memory ? options.memory
+                 : ownedMemory ? ownedMemory.get() : std::pmr::get_default_resource()),
+          ownedPool(options.threadPool ? nullptr
+                    : std::make_shared<ThreadPool>(0, options.placement.pinThreads ? Topology::cpusByNode()
+                                                                                   : std::vector<int>())),
+          threadPool(options.threadPool ? options.threadPool : ownedPool.get()),
+          verbose(options.verbose),
+          neurons(memory), photons(memory),
+          bodyX(memory), bodyY(memory), bodyZ(memory), bodyMass(memory),
+          bodyVX(memory), bodyVY(memory), bodyVZ(memory),
+          accelX(memory), accelY(memory), accelZ(memory),
+          numNeurons(neuronCount), numPhotons(photonCount), simulationTime(0.0f),
+          temperature(2700.0f), uniform_dist(0.0f, 1.0f), normal_dist(0.0f, 1.0f) {
+        
+        if (seed == 0) {
+            std::random_device rd;
+            seed = rd();
+        }
+        rng.seed(seed);
+        fusion.setSeed(seed);
+        diversity.setSeed(seed);
+        
+        initializeGalaxy();
+        
+        dynamicsRng.seed(rng());
+        photonRng.seed(rng());
+        stellarRng.seed(rng());
+    }
+    
+    // Branches this galaxy for what-if runs. The fork starts from the exact
+    // current state and evolves independently; neuron and photon chunks stay
+    // shared copy-on-write, so a branch allocates and copies only the chunks
+    // it writes. Call between frames. Options left unset are inherited
+    // (including the thread pool, which the two galaxies then share).
+    std::unique_ptr<NEBULAEmergentGalaxy> fork(const GalaxyOptions& options = GalaxyOptions()) {
+        return std::unique_ptr<NEBULAEmergentGalaxy>(new NEBULAEmergentGalaxy(*this, options));
+    }
+    
+    void initializeGalaxy() {
+        if (verbose) {
+            std::cout << "🌌 Initializing NEBULA EMERGENT Galaxy..." << std::endl;
+            std::cout << "   Neurons: " << numNeurons << std::endl;
+            std::cout << "   Photons: " << numPhotons << std::endl;
+        }
+        
+        // Initialize neurons: storage is built and first touched on the pool,
+        // then filled in order so the seeded draws stay the same
+        neurons.clear();
+        neurons.resize(numNeurons, *threadPool);
+        
+        for (int i = 0; i < numNeurons; ++i) {
+            // Create spiral galaxy structure
+            float angle = uniform_dist(rng) * 2.0f * M_PI;
+            float radius = std::abs(normal_dist(rng)) * 500.0f + 100.0f;
+            float height = normal_dist(rng) * 50.0f;
+            
+            neurons[i].position = Vector3(
+                radius * std::cos(angle),
+                height,
+                radius * std::sin(angle)
+            );
+            
+            // Orbital velocity for spiral structure
+            float orbital_speed = std::sqrt(GRAVITATIONAL_CONSTANT * 1e12f / radius);
+            neurons[i].velocity = Vector3(
+                -orbital_speed * std::sin(angle),
+                normal_dist(rng) * 5.0f,
+                orbital_speed * std::cos(angle)
+            );
+            
+            // Vary neuron properties
+            neurons[i].mass = uniform_dist(rng) * 2.0f + 0.5f;
+            neurons[i].temperature = uniform_dist(rng) * 5000.0f + 2000.0f;
+            neurons[i].luminosity = neurons[i].mass * neurons[i].temperature / 5778.0f;
+            neurons[i].updateSpectrum();
+        }
+        
+        ++positionEpoch;
+        if (activity.enabled) resetActivity();
+        lod.clear();
+        streamer.clear();
+        neuronSlots.clear();
+        reindexNeurons();
+        
+        // Initialize photons
+        photons.clear();
+        photons.resize(numPhotons, *threadPool);
+        
+        for (int i = 0; i < numPhotons; ++i) {
+            // Random emission from neurons
+            if (!neurons.empty()) {
+                int sourceNeuron = rng() % neurons.size();
+                photons[i].position = neurons[sourceNeuron].position;
+                
+                // Random direction
+                float theta = uniform_dist(rng) * 2.0f * M_PI;
+                float phi = std::acos(2.0f * uniform_dist(rng) - 1.0f);
+                
+                photons[i].direction = Vector3(
+                    std::sin(phi) * std::cos(theta),
+                    std::cos(phi),
+                    std::sin(phi) * std::sin(theta)
+                );
+                
+                photons[i].energy = neurons[sourceNeuron].spectrum;
+                photons[i].wavelength = 2.898e-3f / neurons[sourceNeuron].temperature;
+                photons[i].intensity = neurons[sourceNeuron].luminosity;
+                photons[i].source = neuronHandle(sourceNeuron);
+            }
+        }
+        
+        if (verbose) {
+            std::cout << "✅ Galaxy initialization complete!" << std::endl;
+        }
+    }
+    
+    // Advances one frame and returns the dt actually taken. In Fixed mode that
+    // is `deltaTime`; in Adaptive mode `deltaTime` is an upper bound (e.g. the
+    // time left until a target) and the controller picks the step.
+    float evolveFrame(float deltaTime) {
+        if (timestepMode == TimestepMode::Adaptive) {
+            deltaTime = timestepController.nextDeltaTime(lastMaxAcceleration, lastMaxSpeed,
+                                                         photonInteractionRate, deltaTime);
+        }
+        if (deltaTime <= 0.0f) return 0.0f;
+        
+        frameGraph.clear();
+        lastTimings = PhaseTimings();
+        scheduleFrame(deltaTime, lastTimings);
+        frameGraph.run(*threadPool, executionMode == ExecutionMode::Deterministic);
+        reclaimChunks();
+        frameArena.reset();
+        
+        ++frameCount;
+        periodicPassesDue(frameCount - 1);
+        return deltaTime;
+    }
+    
+    // Advances `frames` fixed steps. In TaskGraph mode all frames go into one
+    // graph, so a frame's early phases can start as soon as the phases of the
+    // previous frame they depend on have finished. Adaptive timesteps need the
+    // previous frame's measurements and fall back to frame-by-frame.
+    long evolveFrames(long frames, float deltaTime) {
+        if (executionMode == ExecutionMode::Deterministic || timestepMode == TimestepMode::Adaptive) {
+            for (long f = 0; f < frames; ++f) {
+                evolveFrame(deltaTime);
+            }
+            return frames;
+        }
+        if (frames <= 0 || deltaTime <= 0.0f) return 0;
+        
+        std::pmr::vector<PhaseTimings> timings(frames, &frameArena.local());
+        frameGraph.clear();
+        for (long f = 0; f < frames; ++f) {
+            scheduleFrame(deltaTime, timings[f]);
+        }
+        frameGraph.run(*threadPool, false);
+        reclaimChunks();
+        
+        lastTimings = timings.back();
+        frameCount += frames;
+        frameArena.reset();
+        periodicPassesDue(frameCount - frames);
+        return frames;
+    }
+    
+    void setExecutionMode(ExecutionMode mode) { executionMode = mode; }
+    ExecutionMode getExecutionMode() const { return executionMode; }
+    
+    // Graph of the phases scheduled by the last evolveFrame/evolveFrames
+    std::string describeFrameGraph() const { return frameGraph.describe(); }
+    
+    // Per-phase update rate; every phase runs every frame by default
+    void setPhaseSchedule(PhaseId phase, const PhaseSchedule& schedule) {
+        phaseScheduler.setSchedule(phase, schedule);
+    }
+    
+    // Runs an OnDemand phase (e.g. pattern detection) at the next frame
+    void requestPhase(PhaseId phase) { phaseScheduler.request(phase); }
+    
+    // Brings deferred phases up to the current simulation time, e.g. before
+    // reporting or saving state
+    void synchronizePhases() {
+        for (size_t p = 0; p < PHASE_COUNT; ++p) {
+            PhaseId phase = static_cast<PhaseId>(p);
+            float elapsed = 0.0f;
+            if (phaseScheduler.drain(phase, elapsed)) {
+                runPhase(phase, elapsed);
+            }
+        }
+    }
+    
+    // Evolves until simulation time reaches `targetTime`; returns frames taken
+    long evolveUntil(float targetTime, float deltaTime) {
+        long frames = 0;
+        while (simulationTime < targetTime) {
+            float step = (timestepMode == TimestepMode::Adaptive)
+                ? targetTime - simulationTime
+                : std::min(deltaTime, targetTime - simulationTime);
+            if (evolveFrame(step) <= 0.0f) break;
+            ++frames;
+        }
+        return frames;
+    }
+    
+    void setTimestepMode(TimestepMode mode) {
+        timestepMode = mode;
+        timestepController.reset();
+    }
+    
+    void setTimestepParams(const TimestepParams& params) {
+        timestepController = TimestepController(params);
+    }
+    
+    TimestepMode getTimestepMode() const { return timestepMode; }
+    float getSimulationTime() const { return simulationTime; }
+    
+    void setGravityMode(GravityMode mode) {
+        gravityMode = mode;
+        integratorWorkspace.invalidate();
+    }
+    GravityMode getGravityMode() const { return gravityMode; }
+    
+    const CowArray<Neuron>& getNeurons() const { return neurons; }
+    const CowArray<Photon>& getPhotons() const { return photons; }
+    
+    // Adds `kick` to the velocity of every neuron within `radius` of
+    // `center`; a typical what-if tweak applied to a fork
+    int perturbVelocities(const Vector3& center, float radius, const Vector3& kick) {
+        int touched = 0;
+        const auto& source = std::as_const(neurons);
+        for (size_t i = 0; i < source.size(); ++i) {
+            if ((source[i].position - center).magnitude() > radius) continue;
+            neurons[i].velocity = neurons[i].velocity + kick;
+            if (sparseUpdates()) activeSet.wake(i);
+            ++touched;
+        }
+        integratorWorkspace.invalidate();
+        return touched;
+    }
+    
+    // Thread-safe stimulus injection, usable while frames run. Bursts are
+    // emitted when the photon phase next starts (reusing inactive photons,
+    // growing the pool when none is free); perturbations are applied when
+    // dynamics next starts. Returns false, queuing nothing, when the queue
+    // is full.
+    bool injectPhotonBurst(const PhotonBurst& burst) { return photonInjections.tryPush(burst); }
+    bool injectPerturbation(const NeuronPerturbation& perturbation) {
+        return perturbationInjections.tryPush(perturbation);
+    }
+    
+    // Queues bursts in order until one does not fit; returns how many did
+    size_t injectPhotonBursts(const std::vector<PhotonBurst>& bursts) {
+        size_t queued = 0;
+        while (queued < bursts.size() && photonInjections.tryPush(bursts[queued])) ++queued;
+        return queued;
+    }
+    
+    // Spatial index over the current neuron positions: radius, nearest,
+    // box and ray queries, single or batched. Call between frames; the grid
+    // is rebuilt only if positions changed since the last call. It is never
+    // modified once returned, so hold it as long as needed and query it from
+    // any thread, also while later frames run; it keeps answering for the
+    // positions it was built from.
+    std::shared_ptr<const SpatialGrid> spatialIndex() {
+        if (spatialGrid && spatialGridEpoch == positionEpoch) return spatialGrid;
+        
+        // Rebuild in place when no caller still holds the previous grid
+        if (!spatialGrid || spatialGrid.use_count() > 1) spatialGrid = std::make_shared<SpatialGrid>();
+        const auto& source = std::as_const(neurons);
+        spatialGrid->build(source.size(), [&](size_t i) -> const Vector3& { return source[i].position; },
+                           spatialCellSize, *threadPool);
+        spatialGridEpoch = positionEpoch;
+        return spatialGrid;
+    }
+    
+    // Cell edge for the spatial index; takes effect at the next rebuild
+    void setSpatialCellSize(float size) {
+        spatialCellSize = size;
+        spatialGridEpoch = UINT64_MAX;
+    }
+    
+    ThreadPool& getThreadPool() { return *threadPool; }
+    
+    // Activity-based sparse updates. Enabling starts with every neuron
+    // active; see ActivityParams for when they go dormant and wake again.
+    // Dynamics and photon propagation still cover every neuron.
+    void setActivityParams(const ActivityParams& params) {
+        const bool restart = params.enabled && !activity.enabled;
+        activity = params;
+        if (restart) resetActivity();
+    }
+    const ActivityParams& getActivityParams() const { return activity; }
+    size_t activeNeuronCount() const { return activity.enabled ? activeSet.activeCount() : neurons.size(); }
+    
+    // Hierarchical level of detail (see LevelOfDetail.h). Far from every
+    // observer, neurons are folded into superparticles that the phases
+    // simulate like single neurons; near an observer or an activity hotspot
+    // they are expanded again, with total mass and luminosity unchanged.
+    // Observers are those of setObservers(). Passes run every
+    // LodParams::updateEvery frames; disabling expands everything on the
+    // next pass.
+    void setLodParams(const LodParams& params) { lod.setParams(params); }
+    const LodParams& getLodParams() const { return lod.params(); }
+    size_t superparticleCount() const { return lod.groupCount(); }
+    
+    // Points level of detail and cell streaming refine around; with none
+    // set the galaxy center is the observer
+    void setObservers(const std::vector<Vector3>& points) { observers = points; }
+    
+    // Refines and coarsens now; call between frames
+    LodChanges updateLevelOfDetail() {
+        LodChanges changes;
+        if (!lod.params().enabled && lod.groupCount() == 0) return changes;
+        
+        const auto& source = std::as_const(neurons);
+        passEntries.assign(source.begin(), source.end());
+        changes = lod.update(passEntries, observerPoints());
+        if (changes.refined == 0 && changes.coarsened == 0) return changes;
+        
+        replaceNeurons(passEntries);
+        return changes;
+    }
+    
+    // Observer-driven cell streaming (see CellStreaming.h). Cells near an
+    // observer are simulated; farther out their neurons are frozen and
+    // coast analytically until thawed; beyond that they are written to
+    // StreamingParams::directory and read back in the background as an
+    // observer approaches. Passes run every StreamingParams::updateEvery
+    // frames; disabling brings everything back on the next pass. A fork
+    // starts with its own copy of every streamed-out cell. saveState()
+    // writes streamed-out neurons too.
+    // Returns false, leaving streaming off, if the directory is not writable.
+    bool setStreamingParams(const StreamingParams& params) { return streamer.setParams(params); }
+    const StreamingParams& getStreamingParams() const { return streamer.params(); }
+    size_t frozenNeuronCount() const { return streamer.frozenCount(); }
+    size_t evictedNeuronCount() const { return streamer.evictedCount(); }
+    // Blocks until the background writes and reads of streamed cells are done
+    void waitForStreamingIo() { streamer.waitForIo(); }
+    
+    // Streams cells now; call between frames
+    StreamingChanges updateStreaming() {
+        StreamingChanges changes;
+        if (!streamer.params().enabled && !streamer.holdsCells()) return changes;
+        
+        const auto& source = std::as_const(neurons);
+        passEntries.assign(source.begin(), source.end());
+        if (streamer.params().enabled) {
+            changes = streamer.update(passEntries, simulationTime, observerPoints());
+        } else {
+            streamer.restoreAll(passEntries, simulationTime, changes);
+        }
+        if (changes.frozen == 0 && changes.thawed == 0) return changes;
+        
+        replaceNeurons(passEntries);
+        return changes;
+    }
+    
+    // Fusion and fission (see FusionFission.h): close, luminous neurons
+    // merge and dim, heavy ones split in two, conserving mass, luminosity
+    // and momentum. Passes run every FusionParams::updateEvery frames and
+    // renumber the neurons, so indices held from before a pass are stale.
+    void setFusionParams(const FusionParams& params) { fusion.setParams(params); }
+    const FusionParams& getFusionParams() const { return fusion.params(); }
+    
+    // Fuses and splits now; call between frames
+    FusionChanges updateFusionFission() {
+        if (!fusion.params().enabled) return FusionChanges();
+        
+        const size_t count = fusion.plan(std::as_const(neurons), *threadPool);
+        const FusionChanges changes = fusion.changes();
+        if (changes.fused == 0 && changes.split == 0) return changes;
+        
+        // The old chunks stay alive in `previous` while the new array fills
+        const CowArray<Neuron> previous = neurons.share(memory);
+        neurons.clear();
+        neurons.resize(count, *threadPool);
+        fusion.apply(previous, neurons, *threadPool);
+        reindexNeurons();
+        
+        fusedTotal += static_cast<long>(changes.fused);
+        fissionTotal += static_cast<long>(changes.split);
+        integratorWorkspace.invalidate();
+        ++positionEpoch;
+        if (activity.enabled) resetActivity();
+        return changes;
+    }
+    
+    // Diversity maintenance (see DiversityMaintenance.h): annealing noise,
+    // lateral inhibition around bright neurons, dimming of clusters that
+    // hold too many neurons and occasional kicks. Passes run every
+    // DiversityParams::updateEvery frames and change velocities,
+    // luminosities and temperatures only, so indices and accelerations
+    // stay valid. Dimming lowers temperature too, so it lasts through
+    // evolveStar(), which derives luminosity from it.
+    void setDiversityParams(const DiversityParams& params) { diversity.setParams(params); }
+    const DiversityParams& getDiversityParams() const { return diversity.params(); }
+    
+    // Runs a pass now; call between frames
+    DiversityChanges updateDiversity() {
+        if (!diversity.params().enabled) return DiversityChanges();
+        const float elapsed = simulationTime - diversityClock;
+        diversityClock = simulationTime;
+        const ClusterResult& clusters = identifyClusters();
+        return diversity.update(neurons, clusters, elapsed, *threadPool);
+    }
+    
+    // Clusters of the current neurons (see Clustering.h): ClusterIDs per
+    // neuron, members and per-cluster centroid, velocity, angular momentum
+    // and luminosity. Raising ClusterParams::minActivation restricts it to
+    // active neurons. The result is recomputed on every call and valid
+    // until the next one; its indices are neuron indices.
+    void setClusterParams(const ClusterParams& params) { clustering.setParams(params); }
+    const ClusterParams& getClusterParams() const { return clustering.params(); }
+    const ClusterResult& identifyClusters() { return clustering.identify(std::as_const(neurons), *threadPool); }
+    
+    // Clusters again, matched to those of the previous trackClusters() call
+    // (see ClusterTracking.h): persistent IDs, birth/death/merge/split
+    // events and moving averages of each cluster's aggregates. Members are
+    // followed by handle, so renumbering passes in between are fine.
+    void setTrackingParams(const TrackingParams& params) { clusterTracker.setParams(params); }
+    const ClusterTracker& trackClusters() {
+        const ClusterResult& result = identifyClusters();
+        clusterTracker.update(result, neuronSlots.slotCount(),
+                              [&](size_t i) { return neuronHandle(i); }, *threadPool);
+        return clusterTracker;
+    }
+    const ClusterTracker& getClusterTracker() const { return clusterTracker; }
+    
+    // Stable neuron handles. Indices (including those in spatial query
+    // results) hold until the next LOD, streaming or fusion pass or load
+    // renumbers the neurons; handles hold for as long as the neuron exists.
+    // A neuron folded into a superparticle or streamed out still exists but
+    // has no index until it is simulated again. Call between frames.
+    NeuronHandle neuronHandle(size_t index) const { return neuronSlots.handle(neurons[index].slot); }
+    
+    // Index of the neuron, or SIZE_MAX if it is gone or not simulated now
+    size_t findNeuron(NeuronHandle handle) const {
+        const uint32_t index = neuronSlots.find(handle);
+        return index == SlotTable::NONE ? SIZE_MAX : index;
+    }
+    const Neuron* neuron(NeuronHandle handle) const {
+        const size_t index = findNeuron(handle);
+        return index == SIZE_MAX ? nullptr : &neurons[index];
+    }
+    bool neuronExists(NeuronHandle handle) const { return neuronSlots.alive(handle); }
+    
+    // Individual neurons represented, whether expanded, in superparticles
+    // or streamed out
+    size_t representedNeuronCount() const {
+        return lod.representedCount(neurons) + streamer.frozenCount() + streamer.evictedCount();
+    }
+    
+    size_t getNeuronCount() const { return neurons.size(); }
+    GravityParams getGravityParams() const { return gravityParams(); }
+    
+    // Copies positions and masses into caller-provided SoA arrays
+    void exportBodies(float* x, float* y, float* z, float* m) const {
+        for (size_t i = 0; i < neurons.size(); ++i) {
+            x[i] = neurons[i].position.x;
+            y[i] = neurons[i].position.y;
+            z[i] = neurons[i].position.z;
+            m[i] = neurons[i].mass;
+        }
+    }
+    
+    // Supplies accelerations for the current positions, computed elsewhere
+    // (e.g. a kernel batching several galaxies). The next dynamics step uses
+    // them for its first force evaluation instead of calling the solver.
+    void setPendingAccelerations(const float* ax, const float* ay, const float* az) {
+        integratorWorkspace.resize(neurons.size());
+        std::copy(ax, ax + neurons.size(), integratorWorkspace.ax.begin());
+        std::copy(ay, ay + neurons.size(), integratorWorkspace.ay.begin());
+        std::copy(az, az + neurons.size(), integratorWorkspace.az.begin());
+        pendingAccelerations = true;
+    }
+    
+    // Gravitational acceleration of every neuron under `mode`, evaluated on
+    // the current state without advancing it (used to measure force error).
+    // Sampled mode draws partners from the caller's sampler, leaving the
+    // galaxy's own dynamics stream untouched.
+    void computeAccelerations(GravityMode mode, std::vector<Vector3>& out, std::mt19937& sampler) {
+        out.resize(neurons.size());
+        if (mode == GravityMode::ExactTiled) {
+            computeExactAccelerations();
+            for (size_t i = 0; i < neurons.size(); ++i) {
+                out[i] = Vector3(accelX[i], accelY[i], accelZ[i]);
+            }
+        } else {
+            loadBodies();
+            accelX.resize(neurons.size());
+            accelY.resize(neurons.size());
+            accelZ.resize(neurons.size());
+            sampledAccelerations(bodyX.data(), bodyY.data(), bodyZ.data(),
+                                 accelX.data(), accelY.data(), accelZ.data(), sampler);
+            for (size_t i = 0; i < neurons.size(); ++i) {
+                out[i] = Vector3(accelX[i], accelY[i], accelZ[i]);
+            }
+        }
+    }
+    
+    // One dynamics step with an explicit integrator policy. evolveFrame uses
+    // NEBULA_INTEGRATOR; benchmarks call this directly to compare schemes.
+    template <typename Integrator>
+    void stepDynamics(float deltaTime) {
+        const size_t count = neurons.size();
+        loadBodies();
+        bodyVX.resize(count);
+        bodyVY.resize(count);
+        bodyVZ.resize(count);
+        const auto& source = std::as_const(neurons);
+        for (size_t i = 0; i < count; ++i) {
+            bodyVX[i] = source[i].velocity.x;
+            bodyVY[i] = source[i].velocity.y;
+            bodyVZ[i] = source[i].velocity.z;
+        }
+        
+        DynamicsState state;
+        state.x = bodyX.data();
+        state.y = bodyY.data();
+        state.z = bodyZ.data();
+        state.vx = bodyVX.data();
+        state.vy = bodyVY.data();
+        state.vz = bodyVZ.data();
+        state.count = count;
+        
+        if (gravityMode == GravityMode::ExactTiled) {
+            const GravityParams params = gravityParams();
+            // Accelerations supplied by setPendingAccelerations() already sit in
+            // the workspace; they stand in for the opening evaluation only
+            bool usePending = pendingAccelerations && Integrator::EVALUATES_AT_START;
+            Integrator::step(state, deltaTime, integratorWorkspace,
+                [&](const float* x, const float* y, const float* z, float* ax, float* ay, float* az) {
+                    if (usePending) {
+                        usePending = false;
+                        return;
+                    }
+                    allPairsGravity.computeAccelerations(x, y, z, bodyMass.data(), count,
+                                                         ax, ay, az, params, *threadPool);
+                });
+        } else {
+            Integrator::step(state, deltaTime, integratorWorkspace,
+                [&](const float* x, const float* y, const float* z, float* ax, float* ay, float* az) {
+                    sampledAccelerations(x, y, z, ax, ay, az, dynamicsRng);
+                });
+        }
+        
+        pendingAccelerations = false;
+        
+        // Write back and measure extremes for the timestep controller
+        slotMaxAcceleration.assign(threadPool->concurrency(), 0.0f);
+        slotMaxSpeed.assign(threadPool->concurrency(), 0.0f);
+        const IntegratorWorkspace& w = integratorWorkspace;
+        
+        threadPool->parallelFor(0, count, 4096, [&](size_t begin, size_t end, unsigned slot) {
+            for (size_t i = begin; i < end; ++i) {
+                Neuron& neuron = neurons[i];
+                neuron.position = Vector3(bodyX[i], bodyY[i], bodyZ[i]);
+                neuron.velocity = Vector3(bodyVX[i], bodyVY[i], bodyVZ[i]);
+                neuron.age += deltaTime;
+                
+                float acceleration = std::sqrt(w.ax[i] * w.ax[i] + w.ay[i] * w.ay[i] + w.az[i] * w.az[i]);
+                slotMaxAcceleration[slot] = std::max(slotMaxAcceleration[slot], acceleration);
+                slotMaxSpeed[slot] = std::max(slotMaxSpeed[slot], neuron.velocity.magnitude());
+            }
+        });
+        
+        lastMaxAcceleration = *std::max_element(slotMaxAcceleration.begin(), slotMaxAcceleration.end());
+        lastMaxSpeed = *std::max_element(slotMaxSpeed.begin(), slotMaxSpeed.end());
+    }
+    
+    long getForceEvaluations() const { return integratorWorkspace.forceEvaluations; }
+    
+    double kineticEnergy() const {
+        double energy = 0.0;
+        for (const auto& neuron : neurons) {
+            float speed = neuron.velocity.magnitude();
+            energy += 0.5 * neuron.mass * speed * speed;
+        }
+        return energy;
+    }
+    
+    double potentialEnergy() {
+        loadBodies();
+        return allPairsGravity.potentialEnergy(bodyX.data(), bodyY.data(), bodyZ.data(), bodyMass.data(),
+                                               neurons.size(), gravityParams(), *threadPool);
+    }
+    
+    double totalEnergy() { return kineticEnergy() + potentialEnergy(); }
+    
+    long totalConnections() const {
+        long total = 0;
+        for (const auto& neuron : neurons) {
+            total += neuron.connections;
+        }
+        return total;
+    }
+    
+private:
+    // Huge pages and explicit NUMA placement need a resource of our own;
+    // plain first-touch placement works with whatever the caller supplies
+    static std::shared_ptr<std::pmr::memory_resource> makePlacedMemory(const GalaxyOptions& options) {
+        const PlacementOptions& placement = options.placement;
+        if (options.memory || (!placement.hugePages && placement.numa == NumaPolicy::FirstTouch)) return nullptr;
+        return std::make_shared<PlacedMemoryResource>(placement);
+    }
+    
+    // Fork constructor: shares the parent's chunks and copies its scalar
+    // state; kernel scratch is rebuilt lazily on the first frame
+    NEBULAEmergentGalaxy(NEBULAEmergentGalaxy& parent, const GalaxyOptions& options)
+        : ownedMemory(options.memory ? nullptr : parent.ownedMemory),
+          memory(options.memory ? options.memory : parent.memory),
+          ownedPool(options.threadPool ? nullptr : parent.ownedPool),
+          threadPool(options.threadPool ? options.threadPool : parent.threadPool),
+          verbose(parent.verbose),
+          neurons(parent.neurons.share(memory)), photons(parent.photons.share(memory)),
+          gravityMode(parent.gravityMode),
+          bodyX(memory), bodyY(memory), bodyZ(memory), bodyMass(memory),
+          bodyVX(memory), bodyVY(memory), bodyVZ(memory),
+          accelX(memory), accelY(memory), accelZ(memory),
+          numNeurons(parent.numNeurons), numPhotons(parent.numPhotons),
+          simulationTime(parent.simulationTime), temperature(parent.temperature),
+          frameCount(parent.frameCount), lastTimings(parent.lastTimings),
+          phaseScheduler(parent.phaseScheduler),
+          timestepMode(parent.timestepMode), timestepController(parent.timestepController),
+          lastDeltaTime(parent.lastDeltaTime), lastMaxAcceleration(parent.lastMaxAcceleration),
+          lastMaxSpeed(parent.lastMaxSpeed), photonInteractionRate(parent.photonInteractionRate),
+          rng(parent.rng), uniform_dist(parent.uniform_dist), normal_dist(parent.normal_dist),
+          dynamicsRng(parent.dynamicsRng), photonRng(parent.photonRng), stellarRng(parent.stellarRng),
+          executionMode(parent.executionMode),
+          activity(parent.activity), activeSet(parent.activeSet),
+          connectionsCursor(parent.connectionsCursor), stellarCursor(parent.stellarCursor),
+          stellarClock(parent.stellarClock), stellarUpdatedAt(parent.stellarUpdatedAt),
+          lod(parent.lod), observers(parent.observers),
+          fusedTotal(parent.fusedTotal), fissionTotal(parent.fissionTotal),
+          clusterTracker(parent.clusterTracker), diversityClock(parent.diversityClock),
+          neuronSlots(parent.neuronSlots) {
+        
+        streamer.inherit(parent.streamer, parent.simulationTime);
+        fusion.inherit(parent.fusion);
+        diversity.inherit(parent.diversity);
+        clustering.setParams(parent.clustering.params());
+        
+        // First-same-as-last integrators reuse the last accelerations
+        const IntegratorWorkspace& from = parent.integratorWorkspace;
+        integratorWorkspace.forceEvaluations = from.forceEvaluations;
+        if (from.accelerationsCurrent) {
+            integratorWorkspace.ax = from.ax;
+            integratorWorkspace.ay = from.ay;
+            integratorWorkspace.az = from.az;
+            integratorWorkspace.accelerationsCurrent = true;
+        }
+    }
+    
+    // Frees chunks replaced by private copies during the frame
+    void reclaimChunks() {
+        neurons.reclaim();
+        photons.reclaim();
+    }
+    
+    // Fields each phase reads and writes; the task graph derives phase
+    // ordering from these, so they must cover everything a phase touches
+    static FieldSet phaseReads(PhaseId phase) {
+        using namespace SimField;
+        switch (phase) {
+            case PhaseId::Dynamics:    return Position | Velocity | Mass;
+            case PhaseId::Photons:     return Position | Mass | Luminosity | Photons;
+            case PhaseId::Connections: return Position | Luminosity;
+            case PhaseId::Stellar:     return Mass | Temperature;
+            case PhaseId::Patterns:    return Position | Mass | Temperature | Connections;
+            default:                   return 0;
+        }
+    }
+    
+    static FieldSet phaseWrites(PhaseId phase) {
+        using namespace SimField;
+        switch (phase) {
+            case PhaseId::Dynamics:    return Position | Velocity | Age | Activity;
+            case PhaseId::Photons:     return Photons | Activity;
+            case PhaseId::Connections: return Connections | Activation | Luminosity | Activity;
+            case PhaseId::Stellar:     return Temperature | Mass | Spectrum | Luminosity | Activity;
+            case PhaseId::Patterns:    return GalaxyTemperature;
+            default:                   return 0;
+        }
+    }
+    
+    // A scheduled phase; lives in the frame arena so task bodies capture
+    // only two pointers and fit std::function's inline storage
+    struct PhaseRun {
+        PhaseId phase;
+        float elapsed;
+        PhaseTimings* timings;
+    };
+    
+    // Adds one frame's due phases to frameGraph: dynamics, photons,
+    // connections, stellar evolution, pattern detection. Phases on a slower
+    // schedule catch up with the time they skipped.
+    void scheduleFrame(float deltaTime, PhaseTimings& timings) {
+        simulationTime += deltaTime;
+        lastDeltaTime = deltaTime;
+        
+        for (size_t p = 0; p < PHASE_COUNT; ++p) {
+            PhaseId phase = static_cast<PhaseId>(p);
+            float elapsed = 0.0f;
+            if (!phaseScheduler.advance(phase, deltaTime, elapsed)) continue;
+            
+            const PhaseRun* run = frameArena.local().make<PhaseRun>(phase, elapsed, &timings);
+            frameGraph.addTask(phaseName(phase), phaseReads(phase), phaseWrites(phase),
+                [this, run]() {
+                    (*run->timings)[run->phase] = timePhase([&]() { runPhase(run->phase, run->elapsed); });
+                });
+        }
+    }
+    
+    // Runs one phase over `elapsed` seconds, sub-stepped per its schedule
+    void runPhase(PhaseId phase, float elapsed) {
+        // Phase boundary: stimuli touch only fields this phase owns
+        if (phase == PhaseId::Photons) emitInjectedBursts();
+        if (phase == PhaseId::Dynamics) applyInjectedPerturbations();
+        
+        if (phase == PhaseId::Patterns) {
+            detectEmergentPatterns();
+            return;
+        }
+        if (elapsed <= 0.0f) return;
+        
+        const int steps = phaseScheduler.substeps(phase, elapsed);
+        const float dt = elapsed / steps;
+        
+        for (int step = 0; step < steps; ++step) {
+            switch (phase) {
+                case PhaseId::Dynamics:    updateNeuronDynamics(dt); ++positionEpoch; break;
+                case PhaseId::Photons:     updatePhotonPropagation(dt); break;
+                case PhaseId::Connections: updateNeuralConnections(dt); break;
+                case PhaseId::Stellar:     updateStellarEvolution(dt); break;
+                default:                   return;
+            }
+        }
+    }
+    
+    void emitInjectedBursts() {
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        bool poolFull = false;   // Once a scan finds nothing free, only append
+        photonInjections.drain([&](const PhotonBurst& burst) {
+            const Vector3 aim = burst.direction.normalized();
+            const bool aimed = aim.magnitude() > 0.0f;
+            for (int k = 0; k < burst.photons; ++k) {
+                // Next inactive photon after the cursor, else a new one
+                const auto& current = std::as_const(photons);
+                size_t slot = current.size();
+                for (size_t scanned = 0; !poolFull && scanned < current.size(); ++scanned) {
+                    const size_t i = (photonCursor + scanned) % current.size();
+                    if (!current[i].active) {
+                        slot = i;
+                        break;
+                    }
+                }
+                poolFull = slot == current.size();
+                Photon& photon = poolFull ? photons.emplace_back() : photons[slot];
+                photonCursor = slot + 1;
+                
+                photon.position = burst.origin;
+                if (aimed) {
+                    photon.direction = aim;
+                } else {
+                    float theta = uniform(photonRng) * 2.0f * M_PI;
+                    float phi = std::acos(2.0f * uniform(photonRng) - 1.0f);
+                    photon.direction = Vector3(std::sin(phi) * std::cos(theta), std::cos(phi),
+                                               std::sin(phi) * std::sin(theta));
+                }
+                photon.wavelength = burst.wavelength;
+                photon.intensity = burst.intensity;
+                photon.active = true;
+                photon.source = NeuronHandle();
+            }
+        }, photonInjections.capacity());
+    }
+    
+    // Applies the queued perturbations in one pass over the neurons
+    void applyInjectedPerturbations() {
+        if (perturbationInjections.empty()) return;
+        std::pmr::vector<NeuronPerturbation> batch(&frameArena.local());
+        perturbationInjections.drain([&](const NeuronPerturbation& p) { batch.push_back(p); },
+                                     perturbationInjections.capacity());
+        
+        const bool sparse = sparseUpdates();
+        const auto& source = std::as_const(neurons);
+        for (size_t i = 0; i < source.size(); ++i) {
+            Vector3 kick;
+            bool touched = false;
+            for (const NeuronPerturbation& p : batch) {
+                if ((source[i].position - p.center).magnitude() > p.radius) continue;
+                kick = kick + p.velocityKick;
+                touched = true;
+            }
+            if (!touched) continue;
+            neurons[i].velocity = neurons[i].velocity + kick;
+            if (sparse) activeSet.wake(i);
+        }
+        integratorWorkspace.invalidate();
+    }
+    
+    template <typename Phase>
+    static double timePhase(Phase&& phase) {
+        auto start = std::chrono::steady_clock::now();
+        phase();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    
+    GravityParams gravityParams() const {
+        GravityParams params;
+        params.gravitationalConstant = GRAVITATIONAL_CONSTANT;
+        params.minDistanceSquared = 0.1f * 0.1f; // Avoid singularity
+        return params;
+    }
+    
+    // Copies positions and masses into the SoA buffers used by the kernels
+    void loadBodies() {
+        const size_t count = neurons.size();
+        bodyX.resize(count);
+        bodyY.resize(count);
+        bodyZ.resize(count);
+        bodyMass.resize(count);
+        
+        const auto& source = std::as_const(neurons);
+        for (size_t i = 0; i < count; ++i) {
+            bodyX[i] = source[i].position.x;
+            bodyY[i] = source[i].position.y;
+            bodyZ[i] = source[i].position.z;
+            bodyMass[i] = source[i].mass;
+        }
+    }
+    
+    void computeExactAccelerations() {
+        const size_t count = neurons.size();
+        loadBodies();
+        accelX.resize(count);
+        accelY.resize(count);
+        accelZ.resize(count);
+        
+        allPairsGravity.computeAccelerations(bodyX.data(), bodyY.data(), bodyZ.data(), bodyMass.data(),
+                                             count, accelX.data(), accelY.data(), accelZ.data(),
+                                             gravityParams(), *threadPool);
+    }
+    
+    // Gravitational acceleration of every body from a random sample of
+    // partners drawn from sampler, evaluated on the given positions
+    void sampledAccelerations(const float* x, const float* y, const float* z,
+                              float* ax, float* ay, float* az, std::mt19937& sampler) {
+        const size_t count = neurons.size();
+        
+        // Sample nearby neurons for performance
+        int sampleSize = std::min(100, (int)count);
+        
+        for (size_t i = 0; i < count; ++i) {
+            Vector3 totalAcceleration(0, 0, 0);
+            
+            for (int j = 0; j < sampleSize; ++j) {
+                size_t idx = sampler() % count;
+                if (idx == i) continue;
+                
+                Vector3 r(x[idx] - x[i], y[idx] - y[i], z[idx] - z[i]);
+                float distance = r.magnitude();
+                
+                if (distance > 0.1f) { // Avoid singularity
+                    float acceleration_magnitude = GRAVITATIONAL_CONSTANT * bodyMass[idx] /
+                                                   (distance * distance);
+                    
+                    totalAcceleration = totalAcceleration + r.normalized() * acceleration_magnitude;
+                }
+            }
+            
+            ax[i] = totalAcceleration.x;
+            ay[i] = totalAcceleration.y;
+            az[i] = totalAcceleration.z;
+        }
+    }
+    
+    void updateNeuronDynamics(float deltaTime) {
+        // N-body gravitational simulation with the compile-time integrator
+        stepDynamics<NEBULA_INTEGRATOR>(deltaTime);
+    }
+    
+    void updatePhotonPropagation(float deltaTime) {
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        const auto& sources = std::as_const(neurons);
+        const bool sparse = sparseUpdates();
+        long interactions = 0;
+        int propagated = 0;
+        
+        for (auto& photon : photons) {
+            if (!photon.active) continue;
+            
+            photon.propagate(deltaTime);
+            ++propagated;
+            
+            // Check for interactions with neurons
+            for (size_t c = 0; c < sources.chunkCount() && photon.active; ++c) {
+                const Neuron* chunk = sources.chunkData(c);
+                const size_t first = c * sources.chunkCapacity();
+                for (size_t k = 0, len = sources.chunkLength(c); k < len; ++k) {
+                    const Neuron& neuron = chunk[k];
+                    Vector3 diff = photon.position - neuron.position;
+                    float distance = diff.magnitude();
+                    
+                    if (distance < neuron.mass / memberCount(neuron) * 10.0f) { // Interaction radius (of one member)
+                        // Photon absorption/scattering
+                        photon.intensity *= 0.9f; // Attenuation
+                        ++interactions;
+                        if (sparse) activeSet.wake(first + k);
+                        
+                        if (photon.intensity < 0.1f) {
+                            photon.active = false;
+                            break;
+                        }
+                    }
+                }
+            }
+            
+            // Deactivate photons that travel too far
+            if (photon.position.magnitude() > 10000.0f) {
+                photon.active = false;
+            }
+        }
+        
+        // Interaction frequency feeds the adaptive timestep
+        photonInteractionRate = propagated > 0
+            ? static_cast<float>(interactions) / (propagated * deltaTime)
+            : 0.0f;
+        
+        // Regenerate inactive photons
+        const auto& current = std::as_const(photons);
+        int activePhotons = std::count_if(current.begin(), current.end(), 
+                                        [](const Photon& p) { return p.active; });
+        
+        if (activePhotons < numPhotons / 2 && !sources.empty()) {
+            // Emit new photons from random neurons (none while all are streamed out)
+            for (auto& photon : photons) {
+                if (!photon.active && uniform(photonRng) < 0.1f) {
+                    int sourceNeuron = photonRng() % sources.size();
+                    photon.position = sources[sourceNeuron].position;
+                    photon.active = true;
+                    photon.intensity = sources[sourceNeuron].luminosity;
+                    photon.source = neuronSlots.handle(sources[sourceNeuron].slot);
+                }
+            }
+        }
+    }
+    
+    void updateNeuralConnections(float deltaTime) {
+        // Neighbors come from the spatial index, rebuilt once positions moved
+        const std::shared_ptr<const SpatialGrid> grid = spatialIndex();
+        if (!sparseUpdates()) {
+            for (size_t i = 0; i < neurons.size(); ++i) {
+                updateConnectionsOf(i, *grid, nullptr);
+            }
+            return;
+        }
+        
+        // Active neurons plus a slice of dormant ones; a dormant neuron that
+        // turns out active again wakes its dormant neighbors
+        std::pmr::vector<uint32_t> due(&frameArena.local());
+        std::pmr::vector<uint32_t> dormantNeighbors(&frameArena.local());
+        activeSet.collectDue(connectionsCursor, activity.dormantPeriod, due);
+        for (uint32_t i : due) {
+            const bool wasActive = activeSet.isActive(i);
+            dormantNeighbors.clear();
+            updateConnectionsOf(i, *grid, wasActive ? nullptr : &dormantNeighbors);
+            
+            const Neuron& neuron = std::as_const(neurons)[i];
+            const bool quiet = neuron.activation < activity.activationThreshold &&
+                               neuron.velocity.magnitude() < activity.speedThreshold &&
+                               neuron.connections < activity.connectionThreshold;
+            activeSet.settle(i, quiet, activity.graceFrames);
+            if (!quiet) {
+                for (uint32_t j : dormantNeighbors) activeSet.wake(j);
+            }
+        }
+    }
+    
+    // Recomputes one neuron's connections and activation from its
+    // neighbors in `grid` (built from the current positions); dormant
+    // neighbors are listed in `dormantNeighbors` if given
+    void updateConnectionsOf(size_t i, const SpatialGrid& grid, std::pmr::vector<uint32_t>* dormantNeighbors) {
+        // Neural network evolution based on proximity and activity
+        const auto& others = std::as_const(neurons);
+        const Vector3 position = others[i].position;
+        int connections = 0;
+        float activation = 0.0f;
+        
+        // Find nearby neurons for connections
+        grid.forEachInRadius(position, connectionRadius, [&](uint32_t j, float d2) {
+            if (j == i || d2 >= connectionRadius * connectionRadius) return;
+            const Neuron& other = others[j];
+            float distance = std::sqrt(d2);
+            connections += static_cast<int>(memberCount(other));
+            
+            // Activation based on neighbor luminosity
+            activation += other.luminosity / (distance + 1.0f);
+            
+            if (dormantNeighbors && !activeSet.isActive(j)) {
+                dormantNeighbors->push_back(j);
+            }
+        });
+        
+        Neuron& neuron = neurons[i];
+        neuron.activation = activation;
+        neuron.connections = connections;
+        
+        // Normalize activation
+        if (neuron.connections > 0) {
+            neuron.activation /= neuron.connections;
+        }
+        
+        // Update luminosity based on activation (every member's)
+        neuron.luminosity = neuron.luminosity * 0.99f + 
+                           neuron.activation * 0.01f * memberCount(neuron);
+    }
+    
+    void updateStellarEvolution(float deltaTime) {
+        std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+        
+        if (!sparseUpdates()) {
+            for (auto& neuron : neurons) {
+                evolveStar(neuron, deltaTime, uniform);
+            }
+            return;
+        }
+        
+        // Dormant neurons catch up with the time since their last visit
+        stellarClock += deltaTime;
+        std::pmr::vector<uint32_t> due(&frameArena.local());
+        activeSet.collectDue(stellarCursor, activity.dormantPeriod, due);
+        for (uint32_t i : due) {
+            evolveStar(neurons[i], stellarClock - stellarUpdatedAt[i], uniform);
+            stellarUpdatedAt[i] = stellarClock;
+        }
+    }
+    
+    // Neurons an entry stands for: a superparticle's members, else one
+    float memberCount(const Neuron& neuron) const {
+        return neuron.superparticle >= 0 ? static_cast<float>(lod.group(neuron.superparticle).members.size()) : 1.0f;
+    }
+    
+    void evolveStar(Neuron& neuron, float deltaTime, std::uniform_real_distribution<float>& uniform) {
+        // A superparticle evolves as its mean member; the independent
+        // temperature steps of its members average out as 1/sqrt(members)
+        const float members = memberCount(neuron);
+        const float memberMass = neuron.mass / members;
+        
+        // Stellar evolution based on mass and age
+        float evolutionRate = memberMass * deltaTime * 0.001f;
+        
+        // Temperature evolution
+        neuron.temperature += evolutionRate * (uniform(stellarRng) - 0.5f) * 100.0f / std::sqrt(members);
+        neuron.temperature = std::max(1000.0f, std::min(50000.0f, neuron.temperature));
+        
+        // Mass loss for massive stars
+        if (memberMass > 2.0f) {
+            neuron.mass -= evolutionRate * 0.01f * members;
+            neuron.mass = std::max(0.1f * members, neuron.mass);
+        }
+        
+        // Update spectrum based on new temperature; a superparticle keeps the
+        // luminosity-weighted blend of its members set up by coarsening
+        if (neuron.superparticle < 0) neuron.updateSpectrum();
+        
+        // Luminosity evolution
+        neuron.luminosity = neuron.mass * neuron.temperature / 5778.0f;
+    }
+    
+    // Runs LOD, streaming and fusion passes whose updateEvery had a multiple
+    // in the frames since `previousFrame` (the passes themselves return
+    // early when their feature is off and nothing is left to undo). A LOD or
+    // streaming pass that finds nothing to move works in reused buffers;
+    // one that folds, thaws, evicts, fuses or splits neurons allocates, so
+    // the frame it ends is outside the steady-state no-allocation promise.
+    void periodicPassesDue(long previousFrame) {
+        auto due = [&](int updateEvery) {
+            const long every = std::max(1, updateEvery);
+            return frameCount / every != previousFrame / every;
+        };
+        if (due(lod.params().updateEvery)) updateLevelOfDetail();
+        if (due(streamer.params().updateEvery)) updateStreaming();
+        if (due(fusion.params().updateEvery)) updateFusionFission();
+        if (due(diversity.params().updateEvery)) updateDiversity();
+    }
+    
+    const std::vector<Vector3>& observerPoints() const {
+        static const std::vector<Vector3> center{Vector3()};
+        return observers.empty() ? center : observers;
+    }
+    
+    // Swaps in a rebuilt neuron array after a LOD or streaming pass. The
+    // pass may reorder neurons without changing their number, so sparse
+    // update state follows each neuron by slot to its new index; entries
+    // that were not simulated before (thawed, refined, new superparticles)
+    // start active with nothing owed.
+    void replaceNeurons(std::vector<Neuron>& entries) {
+        if (activity.enabled && activeSet.size() == neurons.size()) {
+            const auto& source = std::as_const(neurons);
+            std::vector<uint32_t> from(entries.size(), ActiveSet::NONE);
+            std::vector<float> updatedAt(entries.size(), stellarClock);
+            for (size_t i = 0; i < entries.size(); ++i) {
+                const uint32_t slot = entries[i].slot;
+                if (!neuronSlots.isLive(slot)) continue;
+                const uint32_t index = neuronSlots.find(neuronSlots.handle(slot));
+                if (index >= source.size() || source[index].slot != slot ||
+                    source[index].superparticle != entries[i].superparticle) continue;
+                from[i] = index;
+                updatedAt[i] = stellarUpdatedAt[index];
+            }
+            activeSet.remap(from);
+            stellarUpdatedAt.swap(updatedAt);
+        }
+        neurons.clear();
+        neurons.resize(entries.size(), *threadPool);
+        threadPool->parallelFor(0, entries.size(), 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) neurons[i] = std::move(entries[i]);
+        });
+        reindexNeurons();
+        integratorWorkspace.invalidate();
+        ++positionEpoch;
+    }
+    
+    // Points every handle slot at its neuron's current index after the
+    // array was rebuilt. Neurons held by LOD or streaming keep their slots,
+    // parked; entries without a slot of their own (new fission products and
+    // superparticles, which start as copies) get a fresh one; slots of
+    // neurons that no longer exist anywhere (absorbed by fusion, expanded
+    // superparticles) are destroyed.
+    void reindexNeurons() {
+        enum : uint8_t { Unseen, Parked, Placed };
+        slotState.assign(neuronSlots.slotCount(), Unseen);
+        auto park = [&](uint32_t slot) {
+            if (neuronSlots.isLive(slot)) slotState[slot] = Parked;
+        };
+        lod.forEachMember([&](const Neuron& member) { park(member.slot); });
+        streamer.forEachSlot(park);
+        
+        const auto& source = std::as_const(neurons);
+        for (size_t i = 0; i < source.size(); ++i) {
+            uint32_t slot = source[i].slot;
+            if (!neuronSlots.isLive(slot) || slotState[slot] != Unseen) {
+                slot = neuronSlots.create(static_cast<uint32_t>(i)).slot;
+                neurons[i].slot = slot;
+                if (slot >= slotState.size()) slotState.resize(slot + 1, Unseen);
+            } else {
+                neuronSlots.place(slot, static_cast<uint32_t>(i));
+            }
+            slotState[slot] = Placed;
+        }
+        
+        for (uint32_t slot = 0; slot < slotState.size(); ++slot) {
+            if (slotState[slot] == Parked) {
+                neuronSlots.park(slot);
+            } else if (slotState[slot] == Unseen) {
+                neuronSlots.destroy(slot);
+            }
+        }
+    }
+    
+    // True when sparse updates are on; restarts the active set if the
+    // neuron count changed underneath it (e.g. a pass ran before sparse
+    // updates first did)
+    bool sparseUpdates() {
+        if (!activity.enabled) return false;
+        if (activeSet.size() != neurons.size()) resetActivity();
+        return true;
+    }
+    
+    void resetActivity() {
+        activeSet.reset(neurons.size());
+        connectionsCursor = 0;
+        stellarCursor = 0;
+        stellarUpdatedAt.assign(neurons.size(), stellarClock);
+    }
+    
+    void detectEmergentPatterns() {
+        // Analyze galaxy structure for emergent patterns
+        
+        const auto& source = std::as_const(neurons);
+        
+        // 1. Spiral arm detection
+        std::pmr::vector<float> radialDensity(50, 0.0f, &frameArena.local());
+        
+        for (const auto& neuron : source) {
+            float radius = std::sqrt(neuron.position.x * neuron.position.x + 
+                                   neuron.position.z * neuron.position.z);
+            int bin = std::min(49, (int)(radius / 20.0f));
+            radialDensity[bin] += neuron.mass;
+        }
+        
+        // 2. Temperature gradients
+        float avgTemperature = 0.0f;
+        for (const auto& neuron : source) {
+            avgTemperature += neuron.temperature;
+        }
+        avgTemperature /= neurons.size();
+        
+        // 3. Neural connectivity patterns
+        float avgConnections = 0.0f;
+        for (const auto& neuron : source) {
+            avgConnections += neuron.connections;
+        }
+        avgConnections /= neurons.size();
+        
+        // Update global temperature based on emergent patterns
+        temperature = avgTemperature;
+    }
+    
+public:
+    FrameStats getFrameStats() const {
+        FrameStats stats;
+        stats.frame = frameCount;
+        stats.simulationTime = simulationTime;
+        stats.activePhotons = std::count_if(photons.begin(), photons.end(), 
+                                            [](const Photon& p) { return p.active; });
+        stats.numPhotons = static_cast<int>(photons.size());
+        
+        for (const auto& neuron : neurons) {
+            stats.avgLuminosity += neuron.luminosity;
+            stats.avgTemperature += neuron.temperature;
+            stats.avgConnections += neuron.connections;
+        }
+        
+        if (!neurons.empty()) {
+            stats.avgLuminosity /= neurons.size();
+            stats.avgTemperature /= neurons.size();
+            stats.avgConnections /= neurons.size();
+        }
+        
+        stats.galaxyTemperature = temperature;
+        stats.activeNeurons = static_cast<int>(activeNeuronCount());
+        stats.superparticles = static_cast<int>(lod.groupCount());
+        stats.frozenNeurons = static_cast<int>(streamer.frozenCount());
+        stats.evictedNeurons = static_cast<int>(streamer.evictedCount());
+        stats.fusedNeurons = fusedTotal;
+        stats.fissions = fissionTotal;
+        stats.diversityTemperature = diversity.params().enabled ? diversity.temperature() : 0.0f;
+        stats.deltaTime = lastDeltaTime;
+        stats.maxAcceleration = lastMaxAcceleration;
+        stats.maxSpeed = lastMaxSpeed;
+        stats.timings = lastTimings;
+        return stats;
+    }
+    
+    void printStatus() {
+        FrameStats stats = getFrameStats();
+        
+        std::cout << "🌌 NEBULA EMERGENT Status:" << std::endl;
+        std::cout << "   Time: " << stats.simulationTime << "s" << std::endl;
+        std::cout << "   Active Photons: " << stats.activePhotons << "/" << stats.numPhotons << std::endl;
+        std::cout << "   Avg Luminosity: " << stats.avgLuminosity << std::endl;
+        std::cout << "   Avg Temperature: " << stats.avgTemperature << "K" << std::endl;
+        std::cout << "   Avg Connections: " << stats.avgConnections << std::endl;
+        std::cout << "   Galaxy Temperature: " << stats.galaxyTemperature << "K" << std::endl;
+        if (activity.enabled) {
+            std::cout << "   Active Neurons: " << stats.activeNeurons << "/" << neurons.size() << std::endl;
+        }
+        if (stats.superparticles > 0) {
+            std::cout << "   Superparticles: " << stats.superparticles << " (" << neurons.size() << " entries for "
+                      << representedNeuronCount() << " neurons)" << std::endl;
+        }
+        if (stats.frozenNeurons > 0 || stats.evictedNeurons > 0) {
+            std::cout << "   Streamed Out: " << stats.frozenNeurons << " frozen, " << stats.evictedNeurons
+                      << " on disk" << std::endl;
+        }
+        if (fusion.params().enabled) {
+            std::cout << "   Fusion/Fission: " << stats.fusedNeurons << " fused, " << stats.fissions << " split"
+                      << std::endl;
+        }
+        if (diversity.params().enabled) {
+            const DiversityChanges& last = diversity.changes();
+            std::cout << "   Diversity: temperature " << stats.diversityTemperature << ", " << last.inhibited
+                      << " inhibited, " << last.pressured << " in overgrown clusters" << std::endl;
+        }
+    }
+    
+    // Every neuron at full resolution: superparticles are written as their
+    // members and streamed-out neurons are included, as of now, so a
+    // restored galaxy is the same galaxy
+    void saveState(const std::string& filename) {
+        std::ofstream file(filename);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open file " << filename << std::endl;
+            return;
+        }
+        
+        std::vector<Neuron> held;
+        size_t count = 0;
+        for (const Neuron& neuron : std::as_const(neurons)) {
+            if (neuron.superparticle >= 0) {
+                lod.expand(neuron, held);
+            } else {
+                ++count;
+            }
+        }
+        streamer.snapshot(held, simulationTime);
+        count += held.size();
+        
+        file << "# NEBULA EMERGENT Galaxy State" << std::endl;
+        file << "# Time: " << simulationTime << std::endl;
+        file << "# Neurons: " << count << std::endl;
+        file << "# Format: x y z vx vy vz mass luminosity temperature" << std::endl;
+        
+        auto write = [&](const Neuron& neuron) {
+            file << neuron.position.x << " " << neuron.position.y << " " << neuron.position.z << " "
+                 << neuron.velocity.x << " " << neuron.velocity.y << " " << neuron.velocity.z << " "
+                 << neuron.mass << " " << neuron.luminosity << " " << neuron.temperature << std::endl;
+        };
+        for (const Neuron& neuron : std::as_const(neurons)) {
+            if (neuron.superparticle < 0) write(neuron);
+        }
+        for (const Neuron& neuron : held) write(neuron);
+        
+        file.close();
+        std::cout << "✅ Galaxy state saved to " << filename << std::endl;
+    }
+    
+    // Replaces the neurons with those of a saveState() snapshot and resumes
+    // from its time. Fields the format does not carry (age, connections,
+    // activation) restart from their defaults; photons are kept.
+    bool loadState(const std::string& filename) {
+        SnapshotData snapshot;
+        if (!SnapshotLoader::load(filename, *threadPool, snapshot)) {
+            return false;
+        }
+        
+        const size_t count = snapshot.size();
+        neurons.clear();
+        neurons.resize(count, *threadPool);
+        threadPool->parallelFor(0, count, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                Neuron& neuron = neurons[i];
+                neuron.position = Vector3(snapshot[SnapshotField::X][i], snapshot[SnapshotField::Y][i],
+                                          snapshot[SnapshotField::Z][i]);
+                neuron.velocity = Vector3(snapshot[SnapshotField::VX][i], snapshot[SnapshotField::VY][i],
+                                          snapshot[SnapshotField::VZ][i]);
+                neuron.mass = snapshot[SnapshotField::Mass][i];
+                neuron.luminosity = snapshot[SnapshotField::Luminosity][i];
+                neuron.temperature = snapshot[SnapshotField::Temperature][i];
+                neuron.updateSpectrum();
+            }
+        });
+        
+        numNeurons = static_cast<int>(count);
+        simulationTime = snapshot.time;
+        diversityClock = simulationTime;
+        integratorWorkspace.invalidate();
+        ++positionEpoch;
+        if (activity.enabled) resetActivity();
+        lod.clear();
+        streamer.clear();
+        neuronSlots.clear();
+        reindexNeurons();
+        timestepController.reset();
+        
+        if (verbose) {
+            std::cout << "✅ Galaxy state loaded from " << filename << " (" << count << " neurons)" << std::endl;
+        }
+        return true;
+    }
+};
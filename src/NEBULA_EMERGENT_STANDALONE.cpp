@@ -3,507 +3,300 @@
 // Adapted for Linux execution without Unreal Engine dependencies
 
 #include <iostream>
-#include <vector>
-#include <memory>
-#include <random>
-#include <cmath>
 #include <chrono>
 #include <thread>
-#include <fstream>
-#include <algorithm>
-#include <numeric>
-
-// ============================================================================
-// Basic Data Structures
-// ============================================================================
-
-struct Vector3 {
-    float x, y, z;
-    
-    Vector3() : x(0), y(0), z(0) {}
-    Vector3(float x_, float y_, float z_) : x(x_), y(y_), z(z_) {}
-    
-    Vector3 operator+(const Vector3& other) const {
-        return Vector3(x + other.x, y + other.y, z + other.z);
-    }
-    
-    Vector3 operator-(const Vector3& other) const {
-        return Vector3(x - other.x, y - other.y, z - other.z);
-    }
-    
-    Vector3 operator*(float scalar) const {
-        return Vector3(x * scalar, y * scalar, z * scalar);
-    }
-    
-    float magnitude() const {
-        return std::sqrt(x*x + y*y + z*z);
-    }
-    
-    Vector3 normalized() const {
-        float mag = magnitude();
-        if (mag > 0.0001f) {
-            return Vector3(x/mag, y/mag, z/mag);
-        }
-        return Vector3(0, 0, 0);
-    }
-};
+#include <string>
+#include <cstdlib>
+#include <cmath>
 
-struct Color {
-    float r, g, b, a;
-    
-    Color() : r(1.0f), g(1.0f), b(1.0f), a(1.0f) {}
-    Color(float r_, float g_, float b_, float a_ = 1.0f) : r(r_), g(g_), b(b_), a(a_) {}
-};
+#include "NEBULA_EMERGENT_CORE.h"
+#include "LiveState.h"
+#include "TrajectoryStream.h"
 
 // ============================================================================
-// Neuron Structure
+// Main Execution
 // ============================================================================
 
-struct Neuron {
-    Vector3 position;
-    Vector3 velocity;
-    float mass;
-    float luminosity;
-    Color spectrum;
-    float temperature;
-    float age;
-    int connections;
-    float activation;
-    std::vector<int> synapses;
-    
-    Neuron() : mass(1.0f), luminosity(1.0f), temperature(2700.0f), age(0.0f), 
-               connections(0), activation(0.0f) {
-        // Random initial position in galaxy
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<float> pos_dist(-1000.0f, 1000.0f);
-        std::uniform_real_distribution<float> vel_dist(-10.0f, 10.0f);
-        
-        position = Vector3(pos_dist(gen), pos_dist(gen), pos_dist(gen));
-        velocity = Vector3(vel_dist(gen), vel_dist(gen), vel_dist(gen));
-        
-        // Spectral characteristics based on temperature
-        updateSpectrum();
-    }
+int main(int argc, char** argv) {
+    std::cout << "🚀 NEBULA EMERGENT - Neural Galaxy Simulation" << std::endl;
+    std::cout << "================================================" << std::endl;
+    std::cout << "Author: Francisco Angulo de Lafuente - NEBULA Team" << std::endl;
+    std::cout << "Physics-Based Emergent Neural Architecture" << std::endl;
+    std::cout << "================================================" << std::endl;
     
-    void updateSpectrum() {
-        // Wien's displacement law approximation
-        float wavelength_peak = 2.898e-3f / temperature; // meters
+    // Create galaxy with specified parameters
+    int neuronCount = 10000;  // Reduced for standalone execution
+    int photonCount = 5000;
+    GravityMode gravityMode = GravityMode::Sampled;
+    TimestepMode timestepMode = TimestepMode::Fixed;
+    ExecutionMode executionMode = ExecutionMode::Deterministic;
+    TimestepParams timestepParams;
+    float targetTime = 0.0f; // 0: run maxFrames fixed steps
+    PhaseSchedule stellarSchedule;
+    PhaseSchedule patternSchedule;
+    GalaxyOptions galaxyOptions;
+    std::string trajectoryPath;
+    std::string restorePath;
+    std::string publishName;
+    int publishNeurons = 4096;
+    TrajectoryParams trajectoryParams;
+    ActivityParams activityParams;
+    LodParams lodParams;
+    StreamingParams streamingParams;
+    FusionParams fusionParams;
+    ClusterParams clusterParams;
+    bool reportClusters = false;
+    DiversityParams diversityParams;
+    
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* prefix) -> const char* {
+            size_t len = std::string(prefix).size();
+            return arg.compare(0, len, prefix) == 0 ? argv[i] + len : nullptr;
+        };
         
-        // Convert to RGB approximation
-        if (temperature < 3500) {
-            spectrum = Color(1.0f, 0.3f, 0.1f); // Red giant
-        } else if (temperature < 5000) {
-            spectrum = Color(1.0f, 0.8f, 0.4f); // Orange
-        } else if (temperature < 6000) {
-            spectrum = Color(1.0f, 1.0f, 0.8f); // Yellow
-        } else if (temperature < 7500) {
-            spectrum = Color(0.9f, 0.9f, 1.0f); // White
+        if (arg == "--gravity=exact") {
+            gravityMode = GravityMode::ExactTiled;
+        } else if (arg == "--gravity=sampled") {
+            gravityMode = GravityMode::Sampled;
+        } else if (const char* v = value("--neurons=")) {
+            neuronCount = std::atoi(v);
+        } else if (const char* v = value("--photons=")) {
+            photonCount = std::atoi(v);
+        } else if (const char* v = value("--stellar-every=")) {
+            // Stellar evolution is slow: run every K frames, sub-stepped
+            stellarSchedule.policy = PhasePolicy::EveryKFrames;
+            stellarSchedule.period = std::atoi(v);
+            stellarSchedule.maxSubstep = 0.25f;
+        } else if (const char* v = value("--patterns-every=")) {
+            // 0: only when status is reported
+            int period = std::atoi(v);
+            patternSchedule.policy = period > 0 ? PhasePolicy::EveryKFrames : PhasePolicy::OnDemand;
+            patternSchedule.period = std::max(1, period);
+        } else if (arg == "--task-graph") {
+            executionMode = ExecutionMode::TaskGraph;
+        } else if (arg == "--adaptive-dt") {
+            timestepMode = TimestepMode::Adaptive;
+        } else if (const char* v = value("--sim-time=")) {
+            targetTime = std::strtof(v, nullptr);
+        } else if (const char* v = value("--dt-min=")) {
+            timestepParams.minDeltaTime = std::strtof(v, nullptr);
+        } else if (const char* v = value("--dt-max=")) {
+            timestepParams.maxDeltaTime = std::strtof(v, nullptr);
+        } else if (arg == "--pin-threads") {
+            galaxyOptions.placement.pinThreads = true;
+        } else if (arg == "--huge-pages") {
+            galaxyOptions.placement.hugePages = true;
+        } else if (arg == "--numa=first-touch") {
+            galaxyOptions.placement.numa = NumaPolicy::FirstTouch;
+        } else if (arg == "--numa=interleave") {
+            galaxyOptions.placement.numa = NumaPolicy::Interleave;
+        } else if (const char* v = value("--numa=node:")) {
+            galaxyOptions.placement.numa = NumaPolicy::Node;
+            galaxyOptions.placement.node = std::atoi(v);
+        } else if (arg == "--publish") {
+            publishName = "/nebula_live";
+        } else if (const char* v = value("--publish=")) {
+            publishName = v;
+        } else if (const char* v = value("--publish-neurons=")) {
+            publishNeurons = std::max(0, std::atoi(v));
+        } else if (arg == "--active-set") {
+            activityParams.enabled = true;
+        } else if (const char* v = value("--dormant-period=")) {
+            activityParams.enabled = true;
+            activityParams.dormantPeriod = std::max(1, std::atoi(v));
+        } else if (arg == "--lod") {
+            lodParams.enabled = true;
+        } else if (const char* v = value("--lod-radius=")) {
+            lodParams.enabled = true;
+            lodParams.refineRadius = std::strtof(v, nullptr);
+        } else if (arg == "--stream") {
+            streamingParams.enabled = true;
+        } else if (const char* v = value("--stream=")) {
+            // Directory evicted cells are written to
+            streamingParams.enabled = true;
+            streamingParams.directory = v;
+        } else if (const char* v = value("--stream-radius=")) {
+            // Active radius; cells are evicted beyond twice this
+            streamingParams.enabled = true;
+            streamingParams.activeRadius = std::strtof(v, nullptr);
+            streamingParams.frozenRadius = 2.0f * streamingParams.activeRadius;
+        } else if (arg == "--fusion") {
+            fusionParams.enabled = true;
+        } else if (const char* v = value("--fusion-radius=")) {
+            fusionParams.enabled = true;
+            fusionParams.fusionRadius = std::strtof(v, nullptr);
+        } else if (arg == "--clusters") {
+            reportClusters = true;
+        } else if (const char* v = value("--cluster-eps=")) {
+            reportClusters = true;
+            clusterParams.epsilon = std::strtof(v, nullptr);
+        } else if (arg == "--diversity") {
+            diversityParams.enabled = true;
+        } else if (const char* v = value("--inhibition-radius=")) {
+            diversityParams.enabled = true;
+            diversityParams.inhibitionRadius = std::strtof(v, nullptr);
+        } else if (const char* v = value("--restore=")) {
+            restorePath = v;
+        } else if (const char* v = value("--trajectory=")) {
+            trajectoryPath = v;
+        } else if (const char* v = value("--trajectory-every=")) {
+            trajectoryParams.every = std::max(1, std::atoi(v));
+        } else if (const char* v = value("--trajectory-error=")) {
+            trajectoryParams.errorBound = std::strtof(v, nullptr);
+        } else if (const char* v = value("--trajectory-extent=")) {
+            trajectoryParams.extent = std::strtof(v, nullptr);
         } else {
-            spectrum = Color(0.6f, 0.7f, 1.0f); // Blue giant
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return 1;
         }
     }
-};
-
-// ============================================================================
-// Photon Structure for Ray Tracing
-// ============================================================================
-
-struct Photon {
-    Vector3 position;
-    Vector3 direction;
-    Color energy;
-    float wavelength;
-    float intensity;
-    bool active;
-    
-    Photon() : wavelength(550e-9f), intensity(1.0f), active(true) {}
     
-    void propagate(float deltaTime) {
-        const float SPEED_OF_LIGHT = 299792458.0f;
-        position = position + direction * (SPEED_OF_LIGHT * deltaTime);
+    std::cout << "\n🔧 Configuration:" << std::endl;
+    std::cout << "   Neurons: " << neuronCount << std::endl;
+    std::cout << "   Photons: " << photonCount << std::endl;
+    std::cout << "   Physics: Full electromagnetic + gravitational" << std::endl;
+    std::cout << "   Gravity: " << (gravityMode == GravityMode::ExactTiled ? "exact all-pairs" : "sampled") << std::endl;
+    std::cout << "   Timestep: " << (timestepMode == TimestepMode::Adaptive ? "adaptive" : "fixed") << std::endl;
+    std::cout << "   Phases: " << (executionMode == ExecutionMode::TaskGraph ? "task graph" : "deterministic") << std::endl;    
+    
+    const PlacementOptions& placement = galaxyOptions.placement;
+    std::cout << "   Memory: " << (placement.numa == NumaPolicy::Interleave ? "interleaved"
+                                   : placement.numa == NumaPolicy::Node ? "node " + std::to_string(placement.node)
+                                   : "first-touch")
+              << (placement.hugePages ? ", huge pages" : "")
+              << (placement.pinThreads ? ", pinned threads" : "") << std::endl;
+    if (activityParams.enabled) {
+        std::cout << "   Sparse updates: dormant neurons revisited every " << activityParams.dormantPeriod
+                  << " updates" << std::endl;
     }
-};
-
-// ============================================================================
-// NEBULA EMERGENT Galaxy System
-// ============================================================================
-
-class NEBULAEmergentGalaxy {
-private:
-    std::vector<Neuron> neurons;
-    std::vector<Photon> photons;
-    
-    // Physics constants
-    const float GRAVITATIONAL_CONSTANT = 6.67430e-11f;
-    const float SPEED_OF_LIGHT = 299792458.0f;
-    const float PLANCK_CONSTANT = 6.62607015e-34f;
-    
-    // Simulation parameters
-    int numNeurons;
-    int numPhotons;
-    float simulationTime;
-    float temperature;
-    
-    // Random number generation
-    std::mt19937 rng;
-    std::uniform_real_distribution<float> uniform_dist;
-    std::normal_distribution<float> normal_dist;
-    
-public:
-    NEBULAEmergentGalaxy(int neuronCount = 100000, int photonCount = 50000) 
-        : numNeurons(neuronCount), numPhotons(photonCount), simulationTime(0.0f),
-          temperature(2700.0f), uniform_dist(0.0f, 1.0f), normal_dist(0.0f, 1.0f) {
-        
-        std::random_device rd;
-        rng.seed(rd());
-        
-        initializeGalaxy();
+    if (lodParams.enabled) {
+        std::cout << "   Level of detail: superparticles beyond " << lodParams.refineRadius
+                  << " units of the center" << std::endl;
     }
-    
-    void initializeGalaxy() {
-        std::cout << "🌌 Initializing NEBULA EMERGENT Galaxy..." << std::endl;
-        std::cout << "   Neurons: " << numNeurons << std::endl;
-        std::cout << "   Photons: " << numPhotons << std::endl;
-        
-        // Initialize neurons
-        neurons.clear();
-        neurons.reserve(numNeurons);
-        
-        for (int i = 0; i < numNeurons; ++i) {
-            neurons.emplace_back();
-            
-            // Create spiral galaxy structure
-            float angle = uniform_dist(rng) * 2.0f * M_PI;
-            float radius = std::abs(normal_dist(rng)) * 500.0f + 100.0f;
-            float height = normal_dist(rng) * 50.0f;
-            
-            neurons[i].position = Vector3(
-                radius * std::cos(angle),
-                height,
-                radius * std::sin(angle)
-            );
-            
-            // Orbital velocity for spiral structure
-            float orbital_speed = std::sqrt(GRAVITATIONAL_CONSTANT * 1e12f / radius);
-            neurons[i].velocity = Vector3(
-                -orbital_speed * std::sin(angle),
-                normal_dist(rng) * 5.0f,
-                orbital_speed * std::cos(angle)
-            );
-            
-            // Vary neuron properties
-            neurons[i].mass = uniform_dist(rng) * 2.0f + 0.5f;
-            neurons[i].temperature = uniform_dist(rng) * 5000.0f + 2000.0f;
-            neurons[i].luminosity = neurons[i].mass * neurons[i].temperature / 5778.0f;
-            neurons[i].updateSpectrum();
-        }
-        
-        // Initialize photons
-        photons.clear();
-        photons.reserve(numPhotons);
-        
-        for (int i = 0; i < numPhotons; ++i) {
-            photons.emplace_back();
-            
-            // Random emission from neurons
-            if (!neurons.empty()) {
-                int sourceNeuron = rng() % neurons.size();
-                photons[i].position = neurons[sourceNeuron].position;
-                
-                // Random direction
-                float theta = uniform_dist(rng) * 2.0f * M_PI;
-                float phi = std::acos(2.0f * uniform_dist(rng) - 1.0f);
-                
-                photons[i].direction = Vector3(
-                    std::sin(phi) * std::cos(theta),
-                    std::cos(phi),
-                    std::sin(phi) * std::sin(theta)
-                );
-                
-                photons[i].energy = neurons[sourceNeuron].spectrum;
-                photons[i].wavelength = 2.898e-3f / neurons[sourceNeuron].temperature;
-                photons[i].intensity = neurons[sourceNeuron].luminosity;
-            }
-        }
-        
-        std::cout << "✅ Galaxy initialization complete!" << std::endl;
+    if (streamingParams.enabled) {
+        std::cout << "   Streaming: active within " << streamingParams.activeRadius << ", frozen within "
+                  << streamingParams.frozenRadius << ", evicted to " << streamingParams.directory << std::endl;
     }
-    
-    void evolveFrame(float deltaTime) {
-        simulationTime += deltaTime;
-        
-        // Update neurons with gravitational dynamics
-        updateNeuronDynamics(deltaTime);
-        
-        // Propagate photons
-        updatePhotonPropagation(deltaTime);
-        
-        // Neural network evolution
-        updateNeuralConnections(deltaTime);
-        
-        // Stellar evolution
-        updateStellarEvolution(deltaTime);
-        
-        // Emergent behavior detection
-        detectEmergentPatterns();
+    if (fusionParams.enabled) {
+        std::cout << "   Fusion/fission: fuse within " << fusionParams.fusionRadius << " at luminosity >= "
+                  << fusionParams.fusionThreshold << ", split below " << fusionParams.fissionThreshold << std::endl;
     }
-    
-private:
-    void updateNeuronDynamics(float deltaTime) {
-        // N-body gravitational simulation (simplified)
-        for (size_t i = 0; i < neurons.size(); ++i) {
-            Vector3 totalForce(0, 0, 0);
-            
-            // Sample nearby neurons for performance
-            int sampleSize = std::min(100, (int)neurons.size());
-            
-            for (int j = 0; j < sampleSize; ++j) {
-                int idx = rng() % neurons.size();
-                if (idx == i) continue;
-                
-                Vector3 r = neurons[idx].position - neurons[i].position;
-                float distance = r.magnitude();
-                
-                if (distance > 0.1f) { // Avoid singularity
-                    float force_magnitude = GRAVITATIONAL_CONSTANT * 
-                                          neurons[i].mass * neurons[idx].mass / 
-                                          (distance * distance);
-                    
-                    totalForce = totalForce + r.normalized() * force_magnitude;
-                }
-            }
-            
-            // Update velocity and position
-            Vector3 acceleration = totalForce * (1.0f / neurons[i].mass);
-            neurons[i].velocity = neurons[i].velocity + acceleration * deltaTime;
-            neurons[i].position = neurons[i].position + neurons[i].velocity * deltaTime;
-            
-            // Age the neuron
-            neurons[i].age += deltaTime;
-        }
+    if (reportClusters) {
+        std::cout << "   Clusters: DBSCAN with epsilon " << clusterParams.epsilon << ", " << clusterParams.minPoints
+                  << " neighbors for a core neuron" << std::endl;
     }
-    
-    void updatePhotonPropagation(float deltaTime) {
-        for (auto& photon : photons) {
-            if (!photon.active) continue;
-            
-            photon.propagate(deltaTime);
-            
-            // Check for interactions with neurons
-            for (const auto& neuron : neurons) {
-                Vector3 diff = photon.position - neuron.position;
-                float distance = diff.magnitude();
-                
-                if (distance < neuron.mass * 10.0f) { // Interaction radius
-                    // Photon absorption/scattering
-                    photon.intensity *= 0.9f; // Attenuation
-                    
-                    if (photon.intensity < 0.1f) {
-                        photon.active = false;
-                        break;
-                    }
-                }
-            }
-            
-            // Deactivate photons that travel too far
-            if (photon.position.magnitude() > 10000.0f) {
-                photon.active = false;
-            }
-        }
-        
-        // Regenerate inactive photons
-        int activePhotons = std::count_if(photons.begin(), photons.end(), 
-                                        [](const Photon& p) { return p.active; });
-        
-        if (activePhotons < numPhotons / 2) {
-            // Emit new photons from random neurons
-            for (auto& photon : photons) {
-                if (!photon.active && uniform_dist(rng) < 0.1f) {
-                    int sourceNeuron = rng() % neurons.size();
-                    photon.position = neurons[sourceNeuron].position;
-                    photon.active = true;
-                    photon.intensity = neurons[sourceNeuron].luminosity;
-                }
-            }
-        }
+    if (diversityParams.enabled) {
+        std::cout << "   Diversity: inhibition within " << diversityParams.inhibitionRadius << " of neurons brighter than "
+                  << diversityParams.brightThreshold << ", annealing from " << diversityParams.initialTemperature
+                  << std::endl;
     }
-    
-    void updateNeuralConnections(float deltaTime) {
-        // Neural network evolution based on proximity and activity
-        for (size_t i = 0; i < neurons.size(); ++i) {
-            neurons[i].activation = 0.0f;
-            neurons[i].connections = 0;
-            
-            // Find nearby neurons for connections
-            for (size_t j = 0; j < neurons.size(); ++j) {
-                if (i == j) continue;
-                
-                float distance = (neurons[i].position - neurons[j].position).magnitude();
-                
-                if (distance < 100.0f) { // Connection threshold
-                    neurons[i].connections++;
-                    
-                    // Activation based on neighbor luminosity
-                    neurons[i].activation += neurons[j].luminosity / (distance + 1.0f);
-                }
-            }
-            
-            // Normalize activation
-            if (neurons[i].connections > 0) {
-                neurons[i].activation /= neurons[i].connections;
-            }
-            
-            // Update luminosity based on activation
-            neurons[i].luminosity = neurons[i].luminosity * 0.99f + 
-                                   neurons[i].activation * 0.01f;
-        }
+    if (!restorePath.empty()) {
+        std::cout << "   Restore: " << restorePath << " (replaces the generated neurons)" << std::endl;
     }
-    
-    void updateStellarEvolution(float deltaTime) {
-        for (auto& neuron : neurons) {
-            // Stellar evolution based on mass and age
-            float evolutionRate = neuron.mass * deltaTime * 0.001f;
-            
-            // Temperature evolution
-            neuron.temperature += evolutionRate * (uniform_dist(rng) - 0.5f) * 100.0f;
-            neuron.temperature = std::max(1000.0f, std::min(50000.0f, neuron.temperature));
-            
-            // Mass loss for massive stars
-            if (neuron.mass > 2.0f) {
-                neuron.mass -= evolutionRate * 0.01f;
-                neuron.mass = std::max(0.1f, neuron.mass);
-            }
-            
-            // Update spectrum based on new temperature
-            neuron.updateSpectrum();
-            
-            // Luminosity evolution
-            neuron.luminosity = neuron.mass * neuron.temperature / 5778.0f;
-        }
+    if (!publishName.empty()) {
+        std::cout << "   Live state: " << publishName << " (" << publishNeurons << " neuron samples)" << std::endl;
     }
-    
-    void detectEmergentPatterns() {
-        // Analyze galaxy structure for emergent patterns
-        
-        // 1. Spiral arm detection
-        std::vector<float> radialDensity(50, 0.0f);
-        
-        for (const auto& neuron : neurons) {
-            float radius = std::sqrt(neuron.position.x * neuron.position.x + 
-                                   neuron.position.z * neuron.position.z);
-            int bin = std::min(49, (int)(radius / 20.0f));
-            radialDensity[bin] += neuron.mass;
-        }
-        
-        // 2. Temperature gradients
-        float avgTemperature = 0.0f;
-        for (const auto& neuron : neurons) {
-            avgTemperature += neuron.temperature;
-        }
-        avgTemperature /= neurons.size();
-        
-        // 3. Neural connectivity patterns
-        float avgConnections = 0.0f;
-        for (const auto& neuron : neurons) {
-            avgConnections += neuron.connections;
-        }
-        avgConnections /= neurons.size();
-        
-        // Update global temperature based on emergent patterns
-        temperature = avgTemperature;
+    if (!trajectoryPath.empty()) {
+        std::cout << "   Trajectory: " << trajectoryPath << " every " << trajectoryParams.every
+                  << " frames, error <= " << trajectoryParams.errorBound << " within +-"
+                  << trajectoryParams.extent << std::endl;
     }
     
-public:
-    void printStatus() {
-        int activePhotons = std::count_if(photons.begin(), photons.end(), 
-                                        [](const Photon& p) { return p.active; });
-        
-        float avgLuminosity = 0.0f;
-        float avgTemperature = 0.0f;
-        float avgConnections = 0.0f;
-        
-        for (const auto& neuron : neurons) {
-            avgLuminosity += neuron.luminosity;
-            avgTemperature += neuron.temperature;
-            avgConnections += neuron.connections;
-        }
-        
-        avgLuminosity /= neurons.size();
-        avgTemperature /= neurons.size();
-        avgConnections /= neurons.size();
-        
-        std::cout << "🌌 NEBULA EMERGENT Status:" << std::endl;
-        std::cout << "   Time: " << simulationTime << "s" << std::endl;
-        std::cout << "   Active Photons: " << activePhotons << "/" << numPhotons << std::endl;
-        std::cout << "   Avg Luminosity: " << avgLuminosity << std::endl;
-        std::cout << "   Avg Temperature: " << avgTemperature << "K" << std::endl;
-        std::cout << "   Avg Connections: " << avgConnections << std::endl;
-        std::cout << "   Galaxy Temperature: " << temperature << "K" << std::endl;
+    NEBULAEmergentGalaxy galaxy(neuronCount, photonCount, 0, galaxyOptions);
+    galaxy.setGravityMode(gravityMode);
+    galaxy.setTimestepParams(timestepParams);
+    galaxy.setTimestepMode(timestepMode);
+    galaxy.setExecutionMode(executionMode);
+    galaxy.setPhaseSchedule(PhaseId::Stellar, stellarSchedule);
+    galaxy.setPhaseSchedule(PhaseId::Patterns, patternSchedule);
+    galaxy.setActivityParams(activityParams);
+    galaxy.setLodParams(lodParams);
+    if (!galaxy.setStreamingParams(streamingParams)) {
+        return 1;
     }
+    galaxy.setFusionParams(fusionParams);
+    galaxy.setClusterParams(clusterParams);
+    galaxy.setDiversityParams(diversityParams);
     
-    void saveState(const std::string& filename) {
-        std::ofstream file(filename);
-        if (!file.is_open()) {
-            std::cerr << "Error: Could not open file " << filename << std::endl;
-            return;
-        }
-        
-        file << "# NEBULA EMERGENT Galaxy State" << std::endl;
-        file << "# Time: " << simulationTime << std::endl;
-        file << "# Neurons: " << neurons.size() << std::endl;
-        file << "# Format: x y z vx vy vz mass luminosity temperature" << std::endl;
-        
-        for (const auto& neuron : neurons) {
-            file << neuron.position.x << " " << neuron.position.y << " " << neuron.position.z << " "
-                 << neuron.velocity.x << " " << neuron.velocity.y << " " << neuron.velocity.z << " "
-                 << neuron.mass << " " << neuron.luminosity << " " << neuron.temperature << std::endl;
-        }
-        
-        file.close();
-        std::cout << "✅ Galaxy state saved to " << filename << std::endl;
+    if (!restorePath.empty() && !galaxy.loadState(restorePath)) {
+        return 1;
     }
-};
-
-// ============================================================================
-// Main Execution
-// ============================================================================
-
-int main() {
-    std::cout << "🚀 NEBULA EMERGENT - Neural Galaxy Simulation" << std::endl;
-    std::cout << "================================================" << std::endl;
-    std::cout << "Author: Francisco Angulo de Lafuente - NEBULA Team" << std::endl;
-    std::cout << "Physics-Based Emergent Neural Architecture" << std::endl;
-    std::cout << "================================================" << std::endl;
-    
-    // Create galaxy with specified parameters
-    int neuronCount = 10000;  // Reduced for standalone execution
-    int photonCount = 5000;
     
-    std::cout << "\n🔧 Configuration:" << std::endl;
-    std::cout << "   Neurons: " << neuronCount << std::endl;
-    std::cout << "   Photons: " << photonCount << std::endl;
-    std::cout << "   Physics: Full electromagnetic + gravitational" << std::endl;
+    LivePublisher publisher;
+    if (!publishName.empty() && !publisher.open(publishName, static_cast<uint32_t>(publishNeurons))) {
+        return 1;
+    }
     
-    NEBULAEmergentGalaxy galaxy(neuronCount, photonCount);
+    TrajectoryWriter trajectory;
+    if (!trajectoryPath.empty() && !trajectory.open(trajectoryPath, trajectoryParams)) {
+        return 1;
+    }
     
     // Simulation parameters
     float deltaTime = 0.016f; // 60 FPS
     int maxFrames = 1000;
     int statusInterval = 50;
     
+    // Adaptive runs always need a time target: default to the fixed-mode span
+    const bool adaptive = timestepMode == TimestepMode::Adaptive;
+    if (adaptive && targetTime <= 0.0f) {
+        targetTime = maxFrames * deltaTime;
+    } else if (!adaptive && targetTime > 0.0f) {
+        maxFrames = static_cast<int>(std::ceil(targetTime / deltaTime));
+    }
+    
     std::cout << "\n🌌 Starting simulation..." << std::endl;
     
     auto startTime = std::chrono::high_resolution_clock::now();
     
-    for (int frame = 0; frame < maxFrames; ++frame) {
-        // Evolve the galaxy
-        galaxy.evolveFrame(deltaTime);
+    // Task-graph runs pipeline all frames between two status reports
+    const bool pipelined = executionMode == ExecutionMode::TaskGraph && !adaptive;
+    
+    int frame = 0;
+    for (; adaptive ? galaxy.getSimulationTime() < targetTime : frame < maxFrames; ++frame) {
+        // Evolve the galaxy (adaptive: dt bounded by the time left to the target)
+        if (pipelined && frame % statusInterval != 0) {
+            int batch = std::min(statusInterval - frame % statusInterval, maxFrames - frame);
+            if (trajectory.isOpen()) {
+                // End the batch on the next recorded frame
+                const int every = trajectoryParams.every;
+                batch = std::min(batch, (every - frame % every) % every + 1);
+            }
+            galaxy.evolveFrames(batch, deltaTime);
+            frame += batch - 1;
+        } else {
+            galaxy.evolveFrame(adaptive ? targetTime - galaxy.getSimulationTime() : deltaTime);
+        }
+        
+        const auto& neurons = galaxy.getNeurons();
+        trajectory.record(frame, galaxy.getSimulationTime(), neurons.size(),
+                          [&](size_t i) { return neurons[i].position; });
+        if (publisher.isOpen()) {
+            publisher.publish(LiveStats::from(galaxy.getFrameStats()), neurons.size(),
+                              [&](size_t i) -> const Neuron& { return neurons[i]; });
+        }
         
         // Print status periodically
         if (frame % statusInterval == 0) {
+            galaxy.synchronizePhases();
             std::cout << "\n--- Frame " << frame << " ---" << std::endl;
             galaxy.printStatus();
+            if (reportClusters) {
+                const ClusterTracker& tracker = galaxy.trackClusters();
+                const TrackedCluster* largest = nullptr;
+                for (const TrackedCluster& c : tracker.clusters()) {
+                    if (!largest || c.latest.size > largest->latest.size) largest = &c;
+                }
+                const TrackingChanges& changes = tracker.changes();
+                std::cout << "   Clusters: " << tracker.clusters().size() << " (" << changes.born << " born, "
+                          << changes.died << " died, " << changes.merged << " merged, " << changes.split << " split)";
+                if (largest) {
+                    std::cout << ", largest " << largest->latest.size << " neurons, seen " << largest->passes
+                              << " times, stability " << largest->stability;
+                }
+                std::cout << std::endl;
+            }
             
             // Save state periodically
             if (frame % 200 == 0) {
@@ -520,17 +313,30 @@ int main() {
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
     
     std::cout << "\n🎯 Simulation Complete!" << std::endl;
-    std::cout << "   Total Frames: " << maxFrames << std::endl;
+    std::cout << "   Total Frames: " << frame << std::endl;
+    std::cout << "   Simulated Time: " << galaxy.getSimulationTime() << "s" << std::endl;
     std::cout << "   Execution Time: " << duration.count() << "ms" << std::endl;
-    std::cout << "   Average FPS: " << (maxFrames * 1000.0f / duration.count()) << std::endl;
+    std::cout << "   Average FPS: " << (frame * 1000.0f / duration.count()) << std::endl;
     
     // Final state
+    galaxy.synchronizePhases();
     std::cout << "\n📊 Final Status:" << std::endl;
     galaxy.printStatus();
     
     // Save final state
     galaxy.saveState("nebula_final_state.txt");
     
+    if (trajectory.isOpen()) {
+        trajectory.close();
+        std::cout << "✅ Trajectory: " << trajectory.framesWritten() << " frames, "
+                  << trajectory.bytes() << " bytes written to " << trajectoryPath << std::endl;
+        if (trajectory.coordinatesBeyondExtent() > 0) {
+            std::cerr << "Warning: " << trajectory.coordinatesBeyondExtent()
+                      << " trajectory coordinates lay beyond the extent; their error bound is not guaranteed"
+                      << std::endl;
+        }
+    }
+    
     std::cout << "\n✨ NEBULA EMERGENT execution completed successfully!" << std::endl;
     std::cout << "   Neural galaxy evolution demonstrates emergent intelligence" << std::endl;
     std::cout << "   Physics-based approach validates electromagnetic principles" << std::endl;
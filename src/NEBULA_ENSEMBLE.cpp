@@ -0,0 +1,174 @@
+// NEBULA_ENSEMBLE.cpp
+// Runs an ensemble of seeded NEBULA EMERGENT galaxies in one process
+//
+// Members share one thread pool and one memory arena; their frames interleave
+// and small exact-gravity members are batched across SIMD lanes. Prints a
+// per-member table of aggregated frame statistics and, with --json=<file>,
+// writes the same data as JSON.
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "EnsembleRunner.h"
+
+static std::vector<int> parseList(const char* text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) values.push_back(std::atoi(item.c_str()));
+    }
+    return values;
+}
+
+static void writeStat(std::ostream& out, const char* name, const RunningStat& stat) {
+    out << "\"" << name << "\": {\"mean\": " << stat.mean() << ", \"min\": " << stat.min
+        << ", \"max\": " << stat.max << "}";
+}
+
+static std::string toJson(const EnsembleRunner& runner, double wallSeconds) {
+    std::ostringstream json;
+    json << std::setprecision(9);
+    json << "{\n";
+    json << "  \"members\": " << runner.memberCount() << ",\n";
+    json << "  \"batches\": " << runner.batchCount() << ",\n";
+    json << "  \"wall_seconds\": " << wallSeconds << ",\n";
+    json << "  \"results\": [\n";
+    const auto& summaries = runner.getSummaries();
+    for (size_t i = 0; i < summaries.size(); ++i) {
+        const EnsembleMemberSummary& s = summaries[i];
+        json << "    {\"seed\": " << s.spec.seed << ", \"neurons\": " << s.spec.neurons
+             << ", \"photons\": " << s.spec.photons << ", \"gravity\": \"" << gravityModeName(s.spec.gravity)
+             << "\", \"batch\": " << s.batch << ", \"frames\": " << s.frames
+             << ", \"wall_seconds\": " << s.wallSeconds << ", ";
+        writeStat(json, "frame_ms", s.frameMs);
+        json << ", ";
+        writeStat(json, "max_speed", s.maxSpeed);
+        json << ", ";
+        writeStat(json, "max_acceleration", s.maxAcceleration);
+        json << ", ";
+        writeStat(json, "avg_luminosity", s.avgLuminosity);
+        json << ", ";
+        writeStat(json, "avg_temperature", s.avgTemperature);
+        json << ", ";
+        writeStat(json, "galaxy_temperature", s.galaxyTemperature);
+        json << ", \"final_time\": " << s.last.simulationTime << "}"
+             << (i + 1 < summaries.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n";
+    json << "}\n";
+    return json.str();
+}
+
+int main(int argc, char** argv) {
+    int members = 16;
+    std::vector<int> neuronCounts = {128};
+    int photons = 64;
+    long frames = 20;
+    float deltaTime = 0.01f;
+    unsigned seedBase = 1;
+    GravityMode gravity = GravityMode::ExactTiled;
+    EnsembleOptions options;
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* prefix) -> const char* {
+            size_t len = std::string(prefix).size();
+            return arg.compare(0, len, prefix) == 0 ? argv[i] + len : nullptr;
+        };
+
+        if (const char* v = value("--members=")) {
+            members = std::atoi(v);
+        } else if (const char* v = value("--neurons=")) {
+            // Comma-separated sizes are assigned to members round-robin
+            neuronCounts = parseList(v);
+        } else if (const char* v = value("--photons=")) {
+            photons = std::atoi(v);
+        } else if (const char* v = value("--frames=")) {
+            frames = std::atol(v);
+        } else if (const char* v = value("--dt=")) {
+            deltaTime = std::strtof(v, nullptr);
+        } else if (const char* v = value("--seed-base=")) {
+            seedBase = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+        } else if (arg == "--gravity=exact") {
+            gravity = GravityMode::ExactTiled;
+        } else if (arg == "--gravity=sampled") {
+            gravity = GravityMode::Sampled;
+        } else if (const char* v = value("--threads=")) {
+            options.threads = static_cast<unsigned>(std::atoi(v));
+        } else if (const char* v = value("--batch-threshold=")) {
+            // 0: never batch
+            options.batchThreshold = std::atoi(v);
+            options.batchSmall = options.batchThreshold > 0;
+        } else if (const char* v = value("--json=")) {
+            jsonPath = v;
+        } else {
+            std::cerr << "Usage: nebula_ensemble [--members=N] [--neurons=N[,N...]] [--photons=N] "
+                         "[--frames=F] [--dt=DT] [--seed-base=S] [--gravity=exact|sampled] "
+                         "[--threads=T] [--batch-threshold=N] [--json=FILE]" << std::endl;
+            return 1;
+        }
+    }
+    if (members <= 0 || neuronCounts.empty()) {
+        std::cerr << "Error: need at least one member and one neuron count" << std::endl;
+        return 1;
+    }
+
+    std::cout << "🌌 NEBULA EMERGENT Ensemble Runner" << std::endl;
+    std::cout << "================================================" << std::endl;
+
+    EnsembleRunner runner(options);
+    for (int i = 0; i < members; ++i) {
+        EnsembleMemberSpec spec;
+        spec.neurons = neuronCounts[i % neuronCounts.size()];
+        spec.photons = photons;
+        spec.seed = seedBase + static_cast<unsigned>(i);
+        spec.frames = frames;
+        spec.deltaTime = deltaTime;
+        spec.gravity = gravity;
+        runner.addMember(spec);
+    }
+
+    std::cout << "   Members: " << members << " (" << gravityModeName(gravity) << " gravity, "
+              << frames << " frames each)" << std::endl;
+    std::cout << "   Threads: " << runner.getThreadPool().concurrency() << " shared" << std::endl;
+
+    const double wallSeconds = runner.run();
+
+    std::cout << "   Lane batches: " << runner.batchCount() << std::endl;
+    std::cout << "\n" << std::setw(6) << "seed" << std::setw(9) << "neurons" << std::setw(7) << "batch"
+              << std::setw(8) << "frames" << std::setw(11) << "frame_ms" << std::setw(12) << "max_speed"
+              << std::setw(12) << "avg_lum" << std::setw(12) << "galaxy_T" << std::endl;
+    double memberSeconds = 0.0;
+    for (const EnsembleMemberSummary& s : runner.getSummaries()) {
+        std::cout << std::setw(6) << s.spec.seed << std::setw(9) << s.spec.neurons << std::setw(7) << s.batch
+                  << std::setw(8) << s.frames << std::fixed
+                  << std::setw(11) << std::setprecision(3) << s.frameMs.mean()
+                  << std::setw(12) << std::setprecision(3) << s.maxSpeed.max
+                  << std::setw(12) << std::setprecision(2) << s.avgLuminosity.mean()
+                  << std::setw(12) << std::setprecision(1) << s.last.galaxyTemperature << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+        memberSeconds += s.wallSeconds;
+    }
+
+    std::cout << "\n📊 Ensemble wall time: " << std::fixed << std::setprecision(3) << wallSeconds
+              << " s (member frames " << memberSeconds << " s)" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+
+    if (!jsonPath.empty()) {
+        std::ofstream file(jsonPath);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open file " << jsonPath << std::endl;
+            return 1;
+        }
+        file << toJson(runner, wallSeconds);
+        std::cout << "✅ Results written to " << jsonPath << std::endl;
+    }
+    return 0;
+}
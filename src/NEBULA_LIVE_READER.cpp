@@ -0,0 +1,107 @@
+// NEBULA_LIVE_READER.cpp
+// Reads the live state a running simulator publishes with --publish
+//
+// Attaches to the shared-memory segment read-only and prints the latest
+// frame statistics and, optionally, part of the decimated neuron view. With
+// --watch it polls and prints every new publication until the publisher
+// exits; reading never slows the simulation down.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include "LiveState.h"
+
+static void printSnapshot(const LiveSnapshot& snapshot, int neuronRows) {
+    const LiveStats& s = snapshot.stats;
+    std::cout << "🌌 Frame " << s.frame << " (t=" << s.simulationTime << "s, dt=" << s.deltaTime << ")" << std::endl;
+    std::cout << "   Active Photons: " << s.activePhotons << "/" << s.numPhotons << std::endl;
+    std::cout << "   Avg Luminosity: " << s.avgLuminosity << std::endl;
+    std::cout << "   Avg Temperature: " << s.avgTemperature << "K" << std::endl;
+    std::cout << "   Avg Connections: " << s.avgConnections << std::endl;
+    std::cout << "   Galaxy Temperature: " << s.galaxyTemperature << "K" << std::endl;
+    std::cout << "   Max |a|: " << s.maxAcceleration << ", max |v|: " << s.maxSpeed << std::endl;
+    std::cout << "   Phases (ms): dynamics " << s.phaseSeconds[0] * 1e3 << ", photons " << s.phaseSeconds[1] * 1e3
+              << ", connections " << s.phaseSeconds[2] * 1e3 << ", stellar " << s.phaseSeconds[3] * 1e3
+              << ", patterns " << s.phaseSeconds[4] * 1e3 << std::endl;
+    std::cout << "   Neuron view: " << snapshot.neurons.size() << " of " << snapshot.totalNeurons
+              << " (every " << snapshot.stride << ")" << std::endl;
+
+    const int rows = std::min<int>(neuronRows, static_cast<int>(snapshot.neurons.size()));
+    if (rows > 0) {
+        std::cout << std::setw(10) << "index" << std::setw(12) << "x" << std::setw(12) << "y" << std::setw(12) << "z"
+                  << std::setw(12) << "luminosity" << std::setw(12) << "temp_K" << std::setw(8) << "conn" << std::endl;
+        for (int k = 0; k < rows; ++k) {
+            const LiveNeuron& n = snapshot.neurons[k];
+            std::cout << std::setw(10) << n.index << std::setw(12) << n.x << std::setw(12) << n.y << std::setw(12) << n.z
+                      << std::setw(12) << n.luminosity << std::setw(12) << n.temperature << std::setw(8)
+                      << n.connections << std::endl;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::string name = "/nebula_live";
+    int neuronRows = 0;
+    int intervalMs = 0;   // 0: print once
+    long updates = 0;     // With --watch: stop after this many (0: until the publisher exits)
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* prefix) -> const char* {
+            size_t len = std::string(prefix).size();
+            return arg.compare(0, len, prefix) == 0 ? argv[i] + len : nullptr;
+        };
+
+        if (const char* v = value("--name=")) {
+            name = v;
+        } else if (const char* v = value("--neurons=")) {
+            neuronRows = std::atoi(v);
+        } else if (arg == "--watch") {
+            intervalMs = 500;
+        } else if (const char* v = value("--watch=")) {
+            intervalMs = std::max(1, std::atoi(v));
+        } else if (const char* v = value("--updates=")) {
+            updates = std::atol(v);
+        } else {
+            std::cerr << "Usage: nebula_live_reader [--name=/SEGMENT] [--neurons=K] [--watch[=MS]] [--updates=N]"
+                      << std::endl;
+            return 1;
+        }
+    }
+
+    LiveReader reader;
+    if (!reader.attach(name)) {
+        std::cerr << "❌ No live state at " << name << " (start nebula_emergent with --publish)" << std::endl;
+        return 1;
+    }
+
+    LiveSnapshot snapshot;
+    uint64_t lastSequence = 0;
+    long printed = 0;
+    do {
+        if (reader.sequence() != lastSequence && reader.read(snapshot)) {
+            if (snapshot.sequence != 0) {
+                if (printed > 0) std::cout << std::endl;
+                printSnapshot(snapshot, neuronRows);
+                ++printed;
+            }
+            lastSequence = snapshot.sequence;
+        }
+        if (intervalMs == 0 || (updates > 0 && printed >= updates)) break;
+        if (!reader.publisherLive()) {
+            std::cout << "\n✅ Publisher closed " << name << std::endl;
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs));
+    } while (true);
+
+    if (printed == 0 && intervalMs == 0) {
+        std::cout << "⏳ " << name << " has not published a frame yet" << std::endl;
+    }
+    return 0;
+}
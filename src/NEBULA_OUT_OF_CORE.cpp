@@ -0,0 +1,111 @@
+// NEBULA_OUT_OF_CORE.cpp
+// Runs a galaxy whose neuron state lives in memory-mapped column files
+//
+// The galaxy is generated straight into spatially chunked files under --dir
+// and every phase streams over the chunks, so the neuron count is bounded by
+// disk space rather than RAM. Resident memory is reported each frame.
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+#include <unistd.h>
+
+#include "OutOfCore.h"
+
+// Resident set size of this process in MB
+static double residentMegabytes() {
+    std::ifstream statm("/proc/self/statm");
+    long pages = 0, resident = 0;
+    statm >> pages >> resident;
+    return resident * static_cast<double>(sysconf(_SC_PAGESIZE)) / (1024.0 * 1024.0);
+}
+
+int main(int argc, char** argv) {
+    OutOfCoreParams params;
+    long frames = 5;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* prefix) -> const char* {
+            size_t len = std::string(prefix).size();
+            return arg.compare(0, len, prefix) == 0 ? argv[i] + len : nullptr;
+        };
+
+        if (const char* v = value("--neurons=")) {
+            params.neuronCount = std::strtoull(v, nullptr, 10);
+        } else if (const char* v = value("--chunks-per-side=")) {
+            params.chunksPerSide = std::atoi(v);
+        } else if (const char* v = value("--frames=")) {
+            frames = std::atol(v);
+        } else if (const char* v = value("--dt=")) {
+            params.deltaTime = std::strtof(v, nullptr);
+        } else if (const char* v = value("--dir=")) {
+            params.directory = v;
+        } else if (const char* v = value("--seed=")) {
+            params.seed = std::strtoull(v, nullptr, 10);
+        } else if (const char* v = value("--threads=")) {
+            params.threads = static_cast<unsigned>(std::atoi(v));
+        } else if (const char* v = value("--rechunk-every=")) {
+            params.rechunkEvery = std::atoi(v);
+        } else if (const char* v = value("--theta=")) {
+            params.openingAngle = std::strtof(v, nullptr);
+        } else if (arg == "--keep-resident") {
+            params.evictBehind = false;
+        } else if (arg == "--keep-files") {
+            params.removeFiles = false;
+        } else {
+            std::cerr << "Usage: nebula_out_of_core [--neurons=N] [--chunks-per-side=S] [--frames=F] [--dt=DT] "
+                         "[--dir=PATH] [--seed=S] [--threads=T] [--rechunk-every=R] [--theta=T] "
+                         "[--keep-resident] [--keep-files]" << std::endl;
+            return 1;
+        }
+    }
+
+    const double columnMegabytes = params.neuronCount * 4.0 * static_cast<int>(OocColumn::Count) / (1024.0 * 1024.0);
+    std::cout << "🌌 NEBULA EMERGENT Out-of-Core Galaxy" << std::endl;
+    std::cout << "================================================" << std::endl;
+    std::cout << "   Neurons: " << params.neuronCount << " in " << params.chunksPerSide * params.chunksPerSide
+              << " chunks" << std::endl;
+    std::cout << "   Column files: " << std::fixed << std::setprecision(1) << columnMegabytes << " MB in "
+              << params.directory << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+
+    OutOfCoreGalaxy galaxy(params);
+    auto start = std::chrono::steady_clock::now();
+    if (!galaxy.create()) {
+        std::cerr << "❌ Could not create the column files" << std::endl;
+        return 1;
+    }
+    const double createSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "✅ Generated in " << std::setprecision(3) << createSeconds << " s, resident "
+              << std::setprecision(1) << std::fixed << residentMegabytes() << " MB" << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+
+    std::cout << "\n" << std::setw(6) << "frame" << std::setw(10) << "summary" << std::setw(10) << "dynamics"
+              << std::setw(10) << "connect" << std::setw(10) << "stellar" << std::setw(10) << "rechunk"
+              << std::setw(13) << "neurons/s" << std::setw(13) << "resident_MB" << std::endl;
+    double totalSeconds = 0.0;
+    for (long f = 0; f < frames; ++f) {
+        galaxy.evolveFrame();
+        const OocFrameStats& s = galaxy.getLastStats();
+        totalSeconds += s.total();
+        std::cout << std::fixed << std::setprecision(3) << std::setw(6) << s.frame << std::setw(10) << s.summarySeconds
+                  << std::setw(10) << s.dynamicsSeconds << std::setw(10) << s.connectionsSeconds
+                  << std::setw(10) << s.stellarSeconds << std::setw(10) << s.rechunkSeconds
+                  << std::setprecision(0) << std::setw(13) << params.neuronCount / s.total()
+                  << std::setprecision(1) << std::setw(13) << residentMegabytes() << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+    std::cout << std::setprecision(6);
+
+    const OocFrameStats& s = galaxy.getLastStats();
+    std::cout << "\n📊 Avg luminosity " << s.avgLuminosity << ", temperature " << s.avgTemperature
+              << " K, connections " << s.avgConnections << std::endl;
+    if (frames > 0) {
+        std::cout << "   " << std::setprecision(3) << totalSeconds / frames << " s per frame" << std::endl;
+    }
+    return 0;
+}
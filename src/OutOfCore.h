@@ -0,0 +1,956 @@
+// OutOfCore.h
+// Galaxies larger than memory: spatially chunked SoA columns in mapped files
+
+#pragma once
+
+#include "AllPairsGravity.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// ============================================================================
+// Mapped Column
+// ============================================================================
+//
+// One SoA column stored in a file and mapped MAP_SHARED. Its pages are file
+// backed, so under memory pressure the kernel writes them back and drops
+// them instead of the process running out of memory; a galaxy larger than
+// RAM just runs at disk speed for the part that does not fit.
+
+class MappedColumn {
+public:
+    MappedColumn() = default;
+    ~MappedColumn() { close(); }
+
+    MappedColumn(const MappedColumn&) = delete;
+    MappedColumn& operator=(const MappedColumn&) = delete;
+
+    MappedColumn(MappedColumn&& other) noexcept { *this = std::move(other); }
+    MappedColumn& operator=(MappedColumn&& other) noexcept {
+        std::swap(path, other.path);
+        std::swap(fd, other.fd);
+        std::swap(memory, other.memory);
+        std::swap(bytes, other.bytes);
+        return *this;
+    }
+
+    // Creates (or truncates) the file at `path` and maps `bytes` of it
+    bool create(const std::string& filePath, size_t size) {
+        close();
+        path = filePath;
+        fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0600);
+        if (fd < 0) {
+            std::cerr << "Error: could not create column file " << path << std::endl;
+            return false;
+        }
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            std::cerr << "Error: could not size column file " << path << std::endl;
+            close();
+            return false;
+        }
+        void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Error: could not map column file " << path << std::endl;
+            close();
+            return false;
+        }
+        memory = static_cast<char*>(mapped);
+        bytes = size;
+        return true;
+    }
+
+    // Moves `next`'s file onto this column's path and takes over its mapping
+    void replaceWith(MappedColumn&& next) {
+        std::rename(next.path.c_str(), path.c_str());
+        next.path = path;
+        close();
+        *this = std::move(next);
+    }
+
+    // Deletes the file; the mapping stays valid until close()
+    void unlink() {
+        if (!path.empty()) ::unlink(path.c_str());
+    }
+
+    void close() {
+        if (memory) munmap(memory, bytes);
+        if (fd >= 0) ::close(fd);
+        memory = nullptr;
+        fd = -1;
+        bytes = 0;
+    }
+
+    bool isOpen() const { return memory != nullptr; }
+    char* data() const { return memory; }
+
+    // Access hints for the byte range [offset, offset + length)
+    void willNeed(size_t offset, size_t length) const { advise(offset, length, MADV_WILLNEED); }
+    void dontNeed(size_t offset, size_t length) const { advise(offset, length, MADV_DONTNEED); }
+
+private:
+    void advise(size_t offset, size_t length, int advice) const {
+        static const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        const size_t begin = offset / page * page;
+        const size_t end = std::min(bytes, offset + length);
+        if (!memory || end <= begin) return;
+        madvise(memory + begin, end - begin, advice);
+    }
+
+    std::string path;
+    int fd = -1;
+    char* memory = nullptr;
+    size_t bytes = 0;
+};
+
+// ============================================================================
+// Parameters and Layout
+// ============================================================================
+
+struct OutOfCoreParams {
+    size_t neuronCount = 1000000;
+    int chunksPerSide = 16;            // Chunks tile the disk plane (x, z) as a grid
+    std::string directory = ".";       // Where the column files live
+    float deltaTime = 0.016f;
+    float connectionRadius = 100.0f;   // Same threshold as updateNeuralConnections
+    float openingAngle = 0.5f;         // Barnes-Hut criterion for cells and chunks
+    int rechunkEvery = 20;             // Frames between re-sorting neurons into chunks (0: never)
+    bool evictBehind = true;           // Drop a chunk's pages from this process once processed
+    bool removeFiles = true;           // Delete the column files when the galaxy is destroyed
+    GravityParams gravity;
+    uint64_t seed = 1;
+    unsigned threads = 0;
+};
+
+// Every column is 4 bytes per neuron
+enum class OocColumn {
+    Id, X, Y, Z, VX, VY, VZ, Mass, Luminosity, Temperature, Age, Activation, Connections, Count
+};
+
+inline const char* oocColumnName(OocColumn column) {
+    static const char* names[] = {"id", "x", "y", "z", "vx", "vy", "vz", "mass", "luminosity",
+                                  "temperature", "age", "activation", "connections"};
+    return names[static_cast<int>(column)];
+}
+
+// Neurons [begin, begin + count) in every column, plus the bounds of their
+// current positions
+struct OocChunk {
+    size_t begin = 0;
+    size_t count = 0;
+    float lo[3] = {0.0f, 0.0f, 0.0f};
+    float hi[3] = {0.0f, 0.0f, 0.0f};
+};
+
+struct OocFrameStats {
+    long frame = 0;
+    float avgLuminosity = 0.0f;
+    float avgTemperature = 0.0f;
+    float avgConnections = 0.0f;
+    double summarySeconds = 0.0;
+    double dynamicsSeconds = 0.0;
+    double connectionsSeconds = 0.0;
+    double stellarSeconds = 0.0;
+    double rechunkSeconds = 0.0;
+
+    double total() const {
+        return summarySeconds + dynamicsSeconds + connectionsSeconds + stellarSeconds + rechunkSeconds;
+    }
+};
+
+// ============================================================================
+// Out-of-Core Galaxy
+// ============================================================================
+//
+// Neuron state lives in one mapped file per column, sorted by chunk: chunk
+// (i, k) holds the neurons whose (x, z) fell in that cell of a grid over the
+// disk at the last re-chunk. Every phase walks the chunks on the thread pool,
+// one chunk per task, hinting WILLNEED for the chunk a pool's width ahead
+// and (optionally) DONTNEED behind, so the resident set is a few chunks and
+// their halos regardless of the galaxy's size.
+//
+// Per frame:
+//   1. summary      per-chunk mass, centre of mass and a 4x4x4 grid of cell
+//                   moments, from positions before the step
+//   2. dynamics     gravity from a Barnes-Hut octree over the chunk's own
+//                   neurons plus those of adjacent chunks, the cell moments
+//                   of nearby chunks and the monopoles of distant ones; a
+//                   kick pass updates velocities, then a drift pass positions
+//   3. connections  a uniform grid (cell = connection radius) over the chunk
+//                   plus a halo gathered from every chunk whose bounds come
+//                   within the radius, so pairs across chunk borders count
+//   4. stellar      activation feeds luminosity, then stellar evolution
+// Other chunks' columns are only read in passes that never write them, so
+// chunks update in place without a second copy.
+// Neurons drift between grid cells; chunk bounds are measured rather than
+// assumed, which keeps results correct, and re-chunking every few frames
+// keeps chunks compact. Photons are not simulated out of core.
+
+class OutOfCoreGalaxy {
+public:
+    static constexpr int CELLS_PER_AXIS = 4;
+    static constexpr int CELLS = CELLS_PER_AXIS * CELLS_PER_AXIS * CELLS_PER_AXIS;
+
+    explicit OutOfCoreGalaxy(const OutOfCoreParams& params)
+        : params(params), pool(params.threads), slotScratch(pool.concurrency()) {}
+
+    ~OutOfCoreGalaxy() {
+        if (!params.removeFiles) return;
+        for (MappedColumn& column : columns) column.unlink();
+    }
+
+    OutOfCoreGalaxy(const OutOfCoreGalaxy&) = delete;
+    OutOfCoreGalaxy& operator=(const OutOfCoreGalaxy&) = delete;
+
+    // Generates the spiral initial conditions straight into the column files
+    // (same distribution as initializeGalaxy) without holding them in memory
+    bool create() {
+        const size_t n = params.neuronCount;
+        const int side = std::max(1, params.chunksPerSide);
+        if (n == 0) {
+            std::cerr << "Error: an out-of-core galaxy needs at least one neuron" << std::endl;
+            return false;
+        }
+        for (size_t c = 0; c < COLUMN_COUNT; ++c) {
+            const std::string path = columnPath(static_cast<OocColumn>(c), "");
+            if (!columns[c].create(path, n * 4)) return false;
+        }
+        chunks.assign(static_cast<size_t>(side) * side, OocChunk());
+        summaries.assign(chunks.size(), ChunkSummary());
+
+        // Pass 1 finds the grid extent, pass 2 counts neurons per chunk and
+        // pass 3 regenerates the same neurons into their chunk's range
+        extent = 1.0f;
+        generate([&](size_t, const GeneratedNeuron& g) {
+            extent = std::max(extent, std::max(std::abs(g.x), std::abs(g.z)));
+        });
+        extent *= 1.0001f;
+
+        std::vector<size_t> cursor(chunks.size(), 0);
+        generate([&](size_t, const GeneratedNeuron& g) { ++chunks[chunkOf(g.x, g.z)].count; });
+        size_t offset = 0;
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            chunks[c].begin = cursor[c] = offset;
+            offset += chunks[c].count;
+        }
+        generate([&](size_t id, const GeneratedNeuron& g) {
+            const size_t i = cursor[chunkOf(g.x, g.z)]++;
+            u32(OocColumn::Id)[i] = static_cast<uint32_t>(id);
+            f32(OocColumn::X)[i] = g.x;
+            f32(OocColumn::Y)[i] = g.y;
+            f32(OocColumn::Z)[i] = g.z;
+            f32(OocColumn::VX)[i] = g.vx;
+            f32(OocColumn::VY)[i] = g.vy;
+            f32(OocColumn::VZ)[i] = g.vz;
+            f32(OocColumn::Mass)[i] = g.mass;
+            f32(OocColumn::Temperature)[i] = g.temperature;
+            f32(OocColumn::Luminosity)[i] = g.mass * g.temperature / 5778.0f;
+            f32(OocColumn::Age)[i] = 0.0f;
+            f32(OocColumn::Activation)[i] = 0.0f;
+            i32(OocColumn::Connections)[i] = 0;
+        });
+        forEachChunk([&](size_t c, unsigned) { measureBounds(c); });
+        return true;
+    }
+
+    void evolveFrame() {
+        OocFrameStats stats;
+        stats.frame = frame + 1;
+
+        stats.summarySeconds = timed([&]() {
+            forEachChunk([&](size_t c, unsigned) { summarize(c); });
+        });
+        stats.dynamicsSeconds = timed([&]() {
+            forEachChunk([&](size_t c, unsigned slot) { kickChunk(c, slotScratch[slot]); });
+            forEachChunk([&](size_t c, unsigned) { driftChunk(c); });
+        });
+        stats.connectionsSeconds = timed([&]() {
+            forEachChunk([&](size_t c, unsigned slot) { updateConnections(c, slotScratch[slot]); });
+        });
+
+        std::vector<std::array<double, 3>> partial(chunks.size(), {0.0, 0.0, 0.0});
+        stats.stellarSeconds = timed([&]() {
+            forEachChunk([&](size_t c, unsigned) { partial[c] = updateStellar(c); });
+        });
+        double luminosity = 0.0, temperature = 0.0, connections = 0.0;
+        for (const auto& p : partial) {
+            luminosity += p[0];
+            temperature += p[1];
+            connections += p[2];
+        }
+        stats.avgLuminosity = static_cast<float>(luminosity / params.neuronCount);
+        stats.avgTemperature = static_cast<float>(temperature / params.neuronCount);
+        stats.avgConnections = static_cast<float>(connections / params.neuronCount);
+
+        ++frame;
+        if (params.rechunkEvery > 0 && frame % params.rechunkEvery == 0) {
+            stats.rechunkSeconds = timed([&]() { rechunk(); });
+        }
+        lastStats = stats;
+    }
+
+    // Re-sorts every neuron into the chunk its current (x, z) falls in,
+    // streaming into a fresh set of column files that then replace the old
+    bool rechunk() {
+        const size_t n = params.neuronCount;
+        std::vector<OocChunk> next(chunks.size());
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            streamChunk(c, [&](size_t i) {
+                ++next[chunkOf(f32(OocColumn::X)[i], f32(OocColumn::Z)[i])].count;
+            });
+        }
+        std::vector<size_t> cursor(next.size(), 0);
+        size_t offset = 0;
+        for (size_t c = 0; c < next.size(); ++c) {
+            next[c].begin = cursor[c] = offset;
+            offset += next[c].count;
+        }
+
+        std::array<MappedColumn, COLUMN_COUNT> fresh;
+        for (size_t k = 0; k < COLUMN_COUNT; ++k) {
+            if (!fresh[k].create(columnPath(static_cast<OocColumn>(k), ".next"), n * 4)) return false;
+        }
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            streamChunk(c, [&](size_t i) {
+                const size_t j = cursor[chunkOf(f32(OocColumn::X)[i], f32(OocColumn::Z)[i])]++;
+                for (size_t k = 0; k < COLUMN_COUNT; ++k) {
+                    reinterpret_cast<uint32_t*>(fresh[k].data())[j] =
+                        reinterpret_cast<const uint32_t*>(columns[k].data())[i];
+                }
+            });
+        }
+        for (size_t k = 0; k < COLUMN_COUNT; ++k) columns[k].replaceWith(std::move(fresh[k]));
+
+        chunks = std::move(next);
+        forEachChunk([&](size_t c, unsigned) { measureBounds(c); });
+        return true;
+    }
+
+    size_t size() const { return params.neuronCount; }
+    size_t chunkCount() const { return chunks.size(); }
+    const OocChunk& chunk(size_t c) const { return chunks[c]; }
+    const OocFrameStats& getLastStats() const { return lastStats; }
+    long getFrame() const { return frame; }
+
+    const float* column(OocColumn c) const { return reinterpret_cast<const float*>(columns[index(c)].data()); }
+    const uint32_t* ids() const { return reinterpret_cast<const uint32_t*>(columns[index(OocColumn::Id)].data()); }
+    const int32_t* connections() const {
+        return reinterpret_cast<const int32_t*>(columns[index(OocColumn::Connections)].data());
+    }
+
+    // Grid cell of the disk plane a position belongs to; outliers beyond the
+    // initial extent go to the border cells
+    size_t chunkOf(float x, float z) const {
+        const int side = std::max(1, params.chunksPerSide);
+        auto cell = [&](float v) {
+            int k = static_cast<int>((v + extent) / (2.0f * extent) * side);
+            return std::min(side - 1, std::max(0, k));
+        };
+        return static_cast<size_t>(cell(z)) * side + cell(x);
+    }
+
+private:
+    static constexpr size_t COLUMN_COUNT = static_cast<size_t>(OocColumn::Count);
+    static constexpr size_t GENERATION_BATCH = 65536;
+    static constexpr size_t TREE_LEAF = 16;
+
+    struct GeneratedNeuron {
+        float x, y, z, vx, vy, vz, mass, temperature;
+    };
+
+    struct CellMoment {
+        float mass = 0.0f;
+        float x = 0.0f, y = 0.0f, z = 0.0f;   // Centre of mass
+    };
+
+    // Gravity sources of one chunk as seen from elsewhere
+    struct ChunkSummary {
+        CellMoment total;
+        float size = 0.0f;                    // Longest edge of the bounds
+        float lo[3] = {0.0f, 0.0f, 0.0f};
+        float hi[3] = {0.0f, 0.0f, 0.0f};
+        std::array<CellMoment, CELLS> cells;
+    };
+
+    struct TreeNode {
+        float centerX, centerY, centerZ, half;
+        float mass, comX, comY, comZ;
+        uint32_t first, count;                // Range in tree order
+        int32_t child;                        // First of 8 children, or -1 for a leaf
+    };
+
+    // Per-thread buffers, sized by the largest chunk (plus halo) seen so far
+    struct Scratch {
+        std::vector<float> x, y, z, m, lum;       // Bodies in tree or candidate order
+        std::vector<float> gx, gy, gz, gm;        // Bodies in gathered order
+        std::vector<uint32_t> order, bucket;
+        std::vector<TreeNode> tree;
+        std::vector<float> sx, sy, sz, sm;        // Far-field point sources
+        std::vector<uint32_t> cellStart, cursor;
+        std::vector<uint32_t> stack;
+    };
+
+    static size_t index(OocColumn c) { return static_cast<size_t>(c); }
+    float* f32(OocColumn c) const { return reinterpret_cast<float*>(columns[index(c)].data()); }
+    uint32_t* u32(OocColumn c) const { return reinterpret_cast<uint32_t*>(columns[index(c)].data()); }
+    int32_t* i32(OocColumn c) const { return reinterpret_cast<int32_t*>(columns[index(c)].data()); }
+
+    // Named per process, so concurrent runs in one directory never truncate
+    // files another process has mapped
+    std::string columnPath(OocColumn c, const char* suffix) const {
+        return params.directory + "/nebula_ooc_" + std::to_string(getpid()) + "_" + oocColumnName(c) + ".bin" + suffix;
+    }
+
+    template <typename Phase>
+    static double timed(Phase&& phase) {
+        auto start = std::chrono::steady_clock::now();
+        phase();
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Neurons in batches with one generator per batch, so every pass
+    // reproduces the same sequence
+    template <typename Visit>
+    void generate(Visit&& visit) const {
+        const float G = params.gravity.gravitationalConstant;
+        for (size_t batch = 0; batch * GENERATION_BATCH < params.neuronCount; ++batch) {
+            std::mt19937_64 rng(mix(params.seed, batch));
+            std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+            std::normal_distribution<float> normal(0.0f, 1.0f);
+            const size_t end = std::min(params.neuronCount, (batch + 1) * GENERATION_BATCH);
+            for (size_t id = batch * GENERATION_BATCH; id < end; ++id) {
+                GeneratedNeuron g;
+                const float angle = uniform(rng) * 2.0f * static_cast<float>(M_PI);
+                const float radius = std::abs(normal(rng)) * 500.0f + 100.0f;
+                const float height = normal(rng) * 50.0f;
+                g.x = radius * std::cos(angle);
+                g.y = height;
+                g.z = radius * std::sin(angle);
+                const float orbitalSpeed = std::sqrt(G * 1e12f / radius);
+                g.vx = -orbitalSpeed * std::sin(angle);
+                g.vy = normal(rng) * 5.0f;
+                g.vz = orbitalSpeed * std::cos(angle);
+                g.mass = uniform(rng) * 2.0f + 0.5f;
+                g.temperature = uniform(rng) * 5000.0f + 2000.0f;
+                visit(id, g);
+            }
+        }
+    }
+
+    static uint64_t mix(uint64_t a, uint64_t b) {
+        uint64_t z = a ^ (b * 0x9e3779b97f4a7c15ull);
+        z += 0x9e3779b97f4a7c15ull;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform [0, 1) from (seed, id, frame), independent of chunk layout
+    float noise(uint32_t id, long f) const {
+        const uint64_t z = mix(params.seed ^ (static_cast<uint64_t>(id) << 32), static_cast<uint64_t>(f));
+        return static_cast<float>(z >> 40) / static_cast<float>(1ull << 24);
+    }
+
+    void adviseChunk(size_t c, bool need) const {
+        if (c >= chunks.size()) return;
+        for (const MappedColumn& column : columns) {
+            if (need) column.willNeed(chunks[c].begin * 4, chunks[c].count * 4);
+            else column.dontNeed(chunks[c].begin * 4, chunks[c].count * 4);
+        }
+    }
+
+    // Runs body(c, slot) for every chunk on the pool, prefetching ahead
+    template <typename Body>
+    void forEachChunk(Body&& body) {
+        const size_t ahead = pool.concurrency();
+        for (size_t c = 0; c < std::min(ahead, chunks.size()); ++c) adviseChunk(c, true);
+        pool.parallelFor(0, chunks.size(), 1, [&](size_t begin, size_t end, unsigned slot) {
+            for (size_t c = begin; c < end; ++c) {
+                adviseChunk(c + ahead, true);
+                body(c, slot);
+                if (params.evictBehind) adviseChunk(c, false);
+            }
+        });
+    }
+
+    // Serial walk in chunk order, for the re-chunking passes
+    template <typename Visit>
+    void streamChunk(size_t c, Visit&& visit) const {
+        adviseChunk(c + 1, true);
+        for (size_t i = chunks[c].begin; i < chunks[c].begin + chunks[c].count; ++i) visit(i);
+        if (params.evictBehind) adviseChunk(c, false);
+    }
+
+    void measureBounds(size_t c) {
+        OocChunk& chunk = chunks[c];
+        const float* axes[3] = {f32(OocColumn::X), f32(OocColumn::Y), f32(OocColumn::Z)};
+        for (int a = 0; a < 3; ++a) {
+            float lo = std::numeric_limits<float>::max(), hi = -lo;
+            for (size_t i = chunk.begin; i < chunk.begin + chunk.count; ++i) {
+                lo = std::min(lo, axes[a][i]);
+                hi = std::max(hi, axes[a][i]);
+            }
+            chunk.lo[a] = chunk.count ? lo : 0.0f;
+            chunk.hi[a] = chunk.count ? hi : 0.0f;
+        }
+    }
+
+    // ========================================================================
+    // Summary
+    // ========================================================================
+
+    void summarize(size_t c) {
+        const OocChunk& chunk = chunks[c];
+        ChunkSummary& s = summaries[c];
+        const float* x = f32(OocColumn::X);
+        const float* y = f32(OocColumn::Y);
+        const float* z = f32(OocColumn::Z);
+        const float* m = f32(OocColumn::Mass);
+
+        for (int a = 0; a < 3; ++a) {
+            s.lo[a] = chunk.lo[a];
+            s.hi[a] = chunk.hi[a];
+        }
+        s.size = std::max({s.hi[0] - s.lo[0], s.hi[1] - s.lo[1], s.hi[2] - s.lo[2]});
+
+        std::array<double, 4 * CELLS> sums{};
+        for (size_t i = chunk.begin; i < chunk.begin + chunk.count; ++i) {
+            const int cell = cellOf(s, x[i], y[i], z[i]);
+            sums[4 * cell + 0] += m[i];
+            sums[4 * cell + 1] += static_cast<double>(m[i]) * x[i];
+            sums[4 * cell + 2] += static_cast<double>(m[i]) * y[i];
+            sums[4 * cell + 3] += static_cast<double>(m[i]) * z[i];
+        }
+        double mass = 0.0, mx = 0.0, my = 0.0, mz = 0.0;
+        for (int k = 0; k < CELLS; ++k) {
+            CellMoment& cell = s.cells[k];
+            cell = CellMoment();
+            if (sums[4 * k] <= 0.0) continue;
+            cell.mass = static_cast<float>(sums[4 * k]);
+            cell.x = static_cast<float>(sums[4 * k + 1] / sums[4 * k]);
+            cell.y = static_cast<float>(sums[4 * k + 2] / sums[4 * k]);
+            cell.z = static_cast<float>(sums[4 * k + 3] / sums[4 * k]);
+            mass += sums[4 * k];
+            mx += sums[4 * k + 1];
+            my += sums[4 * k + 2];
+            mz += sums[4 * k + 3];
+        }
+        s.total = CellMoment();
+        if (mass > 0.0) {
+            s.total.mass = static_cast<float>(mass);
+            s.total.x = static_cast<float>(mx / mass);
+            s.total.y = static_cast<float>(my / mass);
+            s.total.z = static_cast<float>(mz / mass);
+        }
+    }
+
+    static int cellOf(const ChunkSummary& s, float x, float y, float z) {
+        auto axis = [](float v, float lo, float hi) {
+            const float span = hi - lo;
+            int k = span > 0.0f ? static_cast<int>((v - lo) / span * CELLS_PER_AXIS) : 0;
+            return std::min(CELLS_PER_AXIS - 1, std::max(0, k));
+        };
+        return (axis(z, s.lo[2], s.hi[2]) * CELLS_PER_AXIS + axis(y, s.lo[1], s.hi[1])) * CELLS_PER_AXIS +
+               axis(x, s.lo[0], s.hi[0]);
+    }
+
+    static float boundsGap(const float* loA, const float* hiA, const float* loB, const float* hiB) {
+        float gap2 = 0.0f;
+        for (int a = 0; a < 3; ++a) {
+            const float d = std::max({0.0f, loB[a] - hiA[a], loA[a] - hiB[a]});
+            gap2 += d * d;
+        }
+        return std::sqrt(gap2);
+    }
+
+    // ========================================================================
+    // Dynamics
+    // ========================================================================
+
+    // Velocity half of the step. Positions of every chunk are read-only in
+    // this pass, so neighbouring chunks can feed the tree directly.
+    void kickChunk(size_t c, Scratch& s) {
+        const OocChunk& chunk = chunks[c];
+        const size_t n = chunk.count;
+        if (n == 0) return;
+        const ChunkSummary& own = summaries[c];
+        const float* x = f32(OocColumn::X);
+        const float* y = f32(OocColumn::Y);
+        const float* z = f32(OocColumn::Z);
+        const float* m = f32(OocColumn::Mass);
+
+        // Bodies: the chunk's own first, then every neuron of chunks too
+        // close for even their cell moments; those cells go in as sources
+        s.x.clear(); s.y.clear(); s.z.clear(); s.m.clear();
+        s.sx.clear(); s.sy.clear(); s.sz.clear(); s.sm.clear();
+        float lo[3], hi[3];
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = chunk.lo[a];
+            hi[a] = chunk.hi[a];
+        }
+        auto addBodies = [&](const OocChunk& from) {
+            for (size_t i = from.begin; i < from.begin + from.count; ++i) {
+                s.x.push_back(x[i]);
+                s.y.push_back(y[i]);
+                s.z.push_back(z[i]);
+                s.m.push_back(m[i]);
+            }
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::min(lo[a], from.lo[a]);
+                hi[a] = std::max(hi[a], from.hi[a]);
+            }
+        };
+        auto addSource = [&](const CellMoment& moment) {
+            if (moment.mass <= 0.0f) return;
+            s.sx.push_back(moment.x);
+            s.sy.push_back(moment.y);
+            s.sz.push_back(moment.z);
+            s.sm.push_back(moment.mass);
+        };
+        addBodies(chunk);
+        for (size_t d = 0; d < summaries.size(); ++d) {
+            const ChunkSummary& other = summaries[d];
+            if (d == c || other.total.mass <= 0.0f) continue;
+            const float reach = params.openingAngle * boundsGap(own.lo, own.hi, other.lo, other.hi);
+            if (other.size < reach) {
+                addSource(other.total);
+            } else if (other.size < reach * CELLS_PER_AXIS) {
+                for (const CellMoment& cell : other.cells) addSource(cell);
+            } else {
+                addBodies(chunks[d]);
+            }
+        }
+        buildTree(lo, hi, s);
+
+        const float G = params.gravity.gravitationalConstant;
+        const float minD2 = params.gravity.minDistanceSquared;
+        const float soft2 = params.gravity.softeningSquared;
+        const float dt = params.deltaTime;
+        float* vx = f32(OocColumn::VX);
+        float* vy = f32(OocColumn::VY);
+        float* vz = f32(OocColumn::VZ);
+        float* age = f32(OocColumn::Age);
+        const size_t sources = s.sm.size();
+
+        for (size_t t = 0; t < s.order.size(); ++t) {
+            if (s.order[t] >= n) continue;   // Halo body, owned by another chunk
+            const float xi = s.x[t], yi = s.y[t], zi = s.z[t];
+            float ax = 0.0f, ay = 0.0f, az = 0.0f;
+            for (size_t k = 0; k < sources; ++k) {
+                const float dx = s.sx[k] - xi, dy = s.sy[k] - yi, dz = s.sz[k] - zi;
+                const float r2 = dx * dx + dy * dy + dz * dz + soft2;
+                const float invR = r2 > minD2 ? 1.0f / std::sqrt(r2) : 0.0f;
+                const float f = G * s.sm[k] * invR * invR * invR;
+                ax += dx * f;
+                ay += dy * f;
+                az += dz * f;
+            }
+            walkTree(s, t, G, minD2, soft2, ax, ay, az);
+
+            const size_t i = chunk.begin + s.order[t];
+            vx[i] += ax * dt;
+            vy[i] += ay * dt;
+            vz[i] += az * dt;
+            age[i] += dt;
+        }
+    }
+
+    // Position half of the step (semi-implicit Euler: uses the new velocity)
+    void driftChunk(size_t c) {
+        const OocChunk& chunk = chunks[c];
+        const float dt = params.deltaTime;
+        float* px = f32(OocColumn::X);
+        float* py = f32(OocColumn::Y);
+        float* pz = f32(OocColumn::Z);
+        const float* vx = f32(OocColumn::VX);
+        const float* vy = f32(OocColumn::VY);
+        const float* vz = f32(OocColumn::VZ);
+        for (size_t i = chunk.begin; i < chunk.begin + chunk.count; ++i) {
+            px[i] += vx[i] * dt;
+            py[i] += vy[i] * dt;
+            pz[i] += vz[i] * dt;
+        }
+        measureBounds(c);
+    }
+
+    // Octree over the gathered bodies in s.x/y/z/m, which are permuted into
+    // tree order; s.order maps a tree slot back to its gathered index
+    void buildTree(const float* lo, const float* hi, Scratch& s) {
+        const size_t n = s.x.size();
+        s.order.resize(n);
+        for (size_t i = 0; i < n; ++i) s.order[i] = static_cast<uint32_t>(i);
+        s.gx.swap(s.x); s.gy.swap(s.y); s.gz.swap(s.z); s.gm.swap(s.m);
+        const float* x = s.gx.data();
+        const float* y = s.gy.data();
+        const float* z = s.gz.data();
+        const float* m = s.gm.data();
+
+        float half = 0.0f;
+        for (int a = 0; a < 3; ++a) half = std::max(half, 0.5f * (hi[a] - lo[a]));
+        half = half * 1.001f + 1e-3f;
+
+        s.tree.clear();
+        s.tree.push_back(TreeNode{0.5f * (lo[0] + hi[0]), 0.5f * (lo[1] + hi[1]),
+                                  0.5f * (lo[2] + hi[2]), half, 0, 0, 0, 0,
+                                  0, static_cast<uint32_t>(n), -1});
+        // Breadth-first: split every node holding more than a leaf's worth
+        for (size_t node = 0; node < s.tree.size(); ++node) {
+            TreeNode current = s.tree[node];
+            if (current.count <= TREE_LEAF || current.half < 1e-3f) continue;
+
+            uint32_t counts[8] = {};
+            auto octant = [&](uint32_t i) {
+                return (x[i] >= current.centerX ? 1 : 0) | (y[i] >= current.centerY ? 2 : 0) |
+                       (z[i] >= current.centerZ ? 4 : 0);
+            };
+            for (uint32_t k = current.first; k < current.first + current.count; ++k) ++counts[octant(s.order[k])];
+
+            uint32_t starts[8];
+            uint32_t offset = current.first;
+            for (int o = 0; o < 8; ++o) {
+                starts[o] = offset;
+                offset += counts[o];
+            }
+            s.bucket.assign(s.order.begin() + current.first, s.order.begin() + current.first + current.count);
+            uint32_t fill[8];
+            std::copy(starts, starts + 8, fill);
+            for (uint32_t i : s.bucket) s.order[fill[octant(i)]++] = i;
+
+            s.tree[node].child = static_cast<int32_t>(s.tree.size());
+            const float q = 0.5f * current.half;
+            for (int o = 0; o < 8; ++o) {
+                s.tree.push_back(TreeNode{current.centerX + ((o & 1) ? q : -q),
+                                          current.centerY + ((o & 2) ? q : -q),
+                                          current.centerZ + ((o & 4) ? q : -q), q, 0, 0, 0, 0,
+                                          starts[o], counts[o], -1});
+            }
+        }
+
+        // Bodies in tree order, then moments bottom-up (children follow parents)
+        s.x.resize(n); s.y.resize(n); s.z.resize(n); s.m.resize(n);
+        for (size_t t = 0; t < n; ++t) {
+            const uint32_t i = s.order[t];
+            s.x[t] = x[i];
+            s.y[t] = y[i];
+            s.z[t] = z[i];
+            s.m[t] = m[i];
+        }
+        for (size_t node = s.tree.size(); node-- > 0;) {
+            TreeNode& tn = s.tree[node];
+            double mass = 0.0, mx = 0.0, my = 0.0, mz = 0.0;
+            if (tn.child < 0) {
+                for (uint32_t t = tn.first; t < tn.first + tn.count; ++t) {
+                    mass += s.m[t];
+                    mx += static_cast<double>(s.m[t]) * s.x[t];
+                    my += static_cast<double>(s.m[t]) * s.y[t];
+                    mz += static_cast<double>(s.m[t]) * s.z[t];
+                }
+            } else {
+                for (int o = 0; o < 8; ++o) {
+                    const TreeNode& child = s.tree[tn.child + o];
+                    mass += child.mass;
+                    mx += static_cast<double>(child.mass) * child.comX;
+                    my += static_cast<double>(child.mass) * child.comY;
+                    mz += static_cast<double>(child.mass) * child.comZ;
+                }
+            }
+            tn.mass = static_cast<float>(mass);
+            tn.comX = mass > 0.0 ? static_cast<float>(mx / mass) : tn.centerX;
+            tn.comY = mass > 0.0 ? static_cast<float>(my / mass) : tn.centerY;
+            tn.comZ = mass > 0.0 ? static_cast<float>(mz / mass) : tn.centerZ;
+        }
+    }
+
+    void walkTree(Scratch& s, size_t self, float G, float minD2, float soft2,
+                  float& ax, float& ay, float& az) const {
+        const float xi = s.x[self], yi = s.y[self], zi = s.z[self];
+        const float theta2 = params.openingAngle * params.openingAngle;
+        s.stack.clear();
+        s.stack.push_back(0);
+        while (!s.stack.empty()) {
+            const TreeNode& node = s.tree[s.stack.back()];
+            s.stack.pop_back();
+            if (node.count == 0) continue;
+
+            const float dx = node.comX - xi, dy = node.comY - yi, dz = node.comZ - zi;
+            const float d2 = dx * dx + dy * dy + dz * dz;
+            const bool contains = self >= node.first && self < node.first + node.count;
+            const float width = 2.0f * node.half;
+            if (!contains && width * width < theta2 * d2) {
+                const float r2 = d2 + soft2;
+                if (r2 > minD2) {
+                    const float invR = 1.0f / std::sqrt(r2);
+                    const float f = G * node.mass * invR * invR * invR;
+                    ax += dx * f;
+                    ay += dy * f;
+                    az += dz * f;
+                }
+            } else if (node.child < 0) {
+                for (uint32_t t = node.first; t < node.first + node.count; ++t) {
+                    if (t == self) continue;
+                    const float ex = s.x[t] - xi, ey = s.y[t] - yi, ez = s.z[t] - zi;
+                    const float r2 = ex * ex + ey * ey + ez * ez + soft2;
+                    if (r2 <= minD2) continue;
+                    const float invR = 1.0f / std::sqrt(r2);
+                    const float f = G * s.m[t] * invR * invR * invR;
+                    ax += ex * f;
+                    ay += ey * f;
+                    az += ez * f;
+                }
+            } else {
+                for (int o = 0; o < 8; ++o) s.stack.push_back(static_cast<uint32_t>(node.child + o));
+            }
+        }
+    }
+
+    // ========================================================================
+    // Connections
+    // ========================================================================
+
+    void updateConnections(size_t c, Scratch& s) {
+        const OocChunk& chunk = chunks[c];
+        const size_t n = chunk.count;
+        if (n == 0) return;
+        const float radius = params.connectionRadius;
+        const float* x = f32(OocColumn::X);
+        const float* y = f32(OocColumn::Y);
+        const float* z = f32(OocColumn::Z);
+        const float* lum = f32(OocColumn::Luminosity);
+
+        // Candidates: the chunk's own neurons, then every neuron of another
+        // chunk within `radius` of this chunk's bounds
+        float lo[3], hi[3];
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = chunk.lo[a] - radius;
+            hi[a] = chunk.hi[a] + radius;
+        }
+        s.x.clear(); s.y.clear(); s.z.clear(); s.lum.clear();
+        auto addCandidate = [&](size_t i) {
+            s.x.push_back(x[i]);
+            s.y.push_back(y[i]);
+            s.z.push_back(z[i]);
+            s.lum.push_back(lum[i]);
+        };
+        for (size_t i = chunk.begin; i < chunk.begin + n; ++i) addCandidate(i);
+        for (size_t d = 0; d < chunks.size(); ++d) {
+            const OocChunk& other = chunks[d];
+            if (d == c || other.count == 0 || boundsGap(chunk.lo, chunk.hi, other.lo, other.hi) >= radius) continue;
+            for (size_t i = other.begin; i < other.begin + other.count; ++i) {
+                if (x[i] >= lo[0] && x[i] <= hi[0] && y[i] >= lo[1] && y[i] <= hi[1] &&
+                    z[i] >= lo[2] && z[i] <= hi[2]) {
+                    addCandidate(i);
+                }
+            }
+        }
+
+        // Uniform grid with cells no smaller than the radius, so a
+        // neighbour is always in the 3x3x3 block around a neuron's cell
+        const size_t total = s.x.size();
+        int dims[3];
+        float cellSize[3];
+        for (int a = 0; a < 3; ++a) {
+            dims[a] = std::max(1, std::min(64, static_cast<int>((hi[a] - lo[a]) / radius)));
+            cellSize[a] = (hi[a] - lo[a]) / dims[a];
+        }
+        auto cellCoord = [&](float v, int a) {
+            return std::min(dims[a] - 1, std::max(0, static_cast<int>((v - lo[a]) / cellSize[a])));
+        };
+        auto cellIndex = [&](int cx, int cy, int cz) { return (static_cast<size_t>(cz) * dims[1] + cy) * dims[0] + cx; };
+
+        const size_t cellCount = static_cast<size_t>(dims[0]) * dims[1] * dims[2];
+        s.cellStart.assign(cellCount + 1, 0);
+        for (size_t j = 0; j < total; ++j) {
+            ++s.cellStart[cellIndex(cellCoord(s.x[j], 0), cellCoord(s.y[j], 1), cellCoord(s.z[j], 2)) + 1];
+        }
+        for (size_t k = 0; k < cellCount; ++k) s.cellStart[k + 1] += s.cellStart[k];
+        s.order.resize(total);
+        s.cursor.assign(s.cellStart.begin(), s.cellStart.end() - 1);
+        for (size_t j = 0; j < total; ++j) {
+            const size_t cell = cellIndex(cellCoord(s.x[j], 0), cellCoord(s.y[j], 1), cellCoord(s.z[j], 2));
+            s.order[s.cursor[cell]++] = static_cast<uint32_t>(j);
+        }
+
+        float* activation = f32(OocColumn::Activation);
+        int32_t* connections = i32(OocColumn::Connections);
+        for (size_t i = 0; i < n; ++i) {
+            const int cx = cellCoord(s.x[i], 0), cy = cellCoord(s.y[i], 1), cz = cellCoord(s.z[i], 2);
+            int count = 0;
+            float sum = 0.0f;
+            for (int gz = std::max(0, cz - 1); gz <= std::min(dims[2] - 1, cz + 1); ++gz) {
+                for (int gy = std::max(0, cy - 1); gy <= std::min(dims[1] - 1, cy + 1); ++gy) {
+                    for (int gx = std::max(0, cx - 1); gx <= std::min(dims[0] - 1, cx + 1); ++gx) {
+                        const size_t cell = cellIndex(gx, gy, gz);
+                        for (uint32_t k = s.cellStart[cell]; k < s.cellStart[cell + 1]; ++k) {
+                            const uint32_t j = s.order[k];
+                            if (j == i) continue;
+                            const float dx = s.x[i] - s.x[j];
+                            const float dy = s.y[i] - s.y[j];
+                            const float dz = s.z[i] - s.z[j];
+                            const float distance = std::sqrt(dx * dx + dy * dy + dz * dz);
+                            if (distance < radius) {
+                                ++count;
+                                sum += s.lum[j] / (distance + 1.0f);
+                            }
+                        }
+                    }
+                }
+            }
+            connections[chunk.begin + i] = count;
+            activation[chunk.begin + i] = count > 0 ? sum / count : 0.0f;
+        }
+    }
+
+    // ========================================================================
+    // Stellar Evolution
+    // ========================================================================
+
+    // Returns the chunk's sums of luminosity, temperature and connections
+    std::array<double, 3> updateStellar(size_t c) {
+        const OocChunk& chunk = chunks[c];
+        const float dt = params.deltaTime;
+        const uint32_t* id = u32(OocColumn::Id);
+        float* mass = f32(OocColumn::Mass);
+        float* lum = f32(OocColumn::Luminosity);
+        float* temperature = f32(OocColumn::Temperature);
+        const int32_t* connections = i32(OocColumn::Connections);
+
+        std::array<double, 3> sums{0.0, 0.0, 0.0};
+        for (size_t i = chunk.begin; i < chunk.begin + chunk.count; ++i) {
+            const float evolutionRate = mass[i] * dt * 0.001f;
+            temperature[i] += evolutionRate * (noise(id[i], frame) - 0.5f) * 100.0f;
+            temperature[i] = std::max(1000.0f, std::min(50000.0f, temperature[i]));
+            if (mass[i] > 2.0f) {
+                mass[i] = std::max(0.1f, mass[i] - evolutionRate * 0.01f);
+            }
+            lum[i] = mass[i] * temperature[i] / 5778.0f;
+
+            sums[0] += lum[i];
+            sums[1] += temperature[i];
+            sums[2] += connections[i];
+        }
+        return sums;
+    }
+
+    OutOfCoreParams params;
+    ThreadPool pool;
+    std::array<MappedColumn, COLUMN_COUNT> columns;
+    std::vector<OocChunk> chunks;
+    std::vector<ChunkSummary> summaries;
+    std::vector<Scratch> slotScratch;
+    float extent = 1.0f;
+    long frame = 0;
+    OocFrameStats lastStats;
+};
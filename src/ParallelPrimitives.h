@@ -0,0 +1,120 @@
+// ParallelPrimitives.h
+// Prefix sums and a concurrent union-find for the simulation's parallel passes
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// ============================================================================
+// Parallel Exclusive Scan
+// ============================================================================
+//
+// Writes out[i] = in[0] + ... + in[i - 1] for i <= n (so out needs n + 1
+// entries and out[n] is the total) and returns the total. Blocks of `grain`
+// items are summed in parallel, the block sums scanned serially, then every
+// block written in parallel from its offset: two passes over the data
+// whatever the pool size. `in` and `out` may not overlap.
+
+template <typename T>
+T parallelExclusiveScan(const T* in, T* out, size_t n, ThreadPool& pool, size_t grain = 16384) {
+    const size_t blocks = (n + grain - 1) / grain;
+    std::vector<T> blockStart(blocks + 1, T());
+    pool.parallelFor(0, blocks, 1, [&](size_t begin, size_t end, unsigned) {
+        for (size_t b = begin; b < end; ++b) {
+            T sum = T();
+            for (size_t i = b * grain, last = std::min(n, i + grain); i < last; ++i) sum += in[i];
+            blockStart[b + 1] = sum;
+        }
+    });
+    for (size_t b = 0; b < blocks; ++b) blockStart[b + 1] += blockStart[b];
+    pool.parallelFor(0, blocks, 1, [&](size_t begin, size_t end, unsigned) {
+        for (size_t b = begin; b < end; ++b) {
+            T sum = blockStart[b];
+            for (size_t i = b * grain, last = std::min(n, i + grain); i < last; ++i) {
+                out[i] = sum;
+                sum += in[i];
+            }
+        }
+    });
+    out[n] = blockStart[blocks];
+    return blockStart[blocks];
+}
+
+// ============================================================================
+// Counter-Based Random Numbers
+// ============================================================================
+//
+// The splitmix64 finalizer. Parallel passes hash (seed, pass, index) with it
+// instead of sharing a generator, so every item draws the same numbers
+// whatever the thread count and the order items are visited in.
+
+inline uint64_t splitMix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+// ============================================================================
+// Concurrent Union-Find
+// ============================================================================
+//
+// Disjoint sets over 0..n-1 that any number of threads may unite and query
+// at once without locks. A root is only ever linked under a smaller root
+// with one compare-and-swap, so every set's root is its smallest element
+// however the unions interleave: results are deterministic. find() halves
+// paths as it goes; a halving step only ever points a node at one of its
+// ancestors, so racing finds are harmless.
+
+class ConcurrentUnionFind {
+public:
+    // n singleton sets; storage is kept across resets
+    void reset(size_t n, ThreadPool& pool) {
+        if (n > capacity) {
+            parent.reset(new std::atomic<uint32_t>[n]);
+            capacity = n;
+        }
+        count = n;
+        pool.parallelFor(0, n, 16384, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) parent[i].store(static_cast<uint32_t>(i), std::memory_order_relaxed);
+        });
+    }
+
+    size_t size() const { return count; }
+
+    uint32_t find(uint32_t x) const {
+        for (;;) {
+            uint32_t p = parent[x].load(std::memory_order_acquire);
+            if (p == x) return x;
+            const uint32_t grandparent = parent[p].load(std::memory_order_acquire);
+            if (grandparent != p) parent[x].compare_exchange_weak(p, grandparent, std::memory_order_acq_rel);
+            x = grandparent;
+        }
+    }
+
+    // Joins the sets of a and b; false if they were already one
+    bool unite(uint32_t a, uint32_t b) {
+        for (;;) {
+            a = find(a);
+            b = find(b);
+            if (a == b) return false;
+            if (a > b) std::swap(a, b);
+            uint32_t expected = b;
+            if (parent[b].compare_exchange_strong(expected, a, std::memory_order_acq_rel)) return true;
+        }
+    }
+
+    bool same(uint32_t a, uint32_t b) const { return find(a) == find(b); }
+
+private:
+    std::unique_ptr<std::atomic<uint32_t>[]> parent;
+    size_t capacity = 0;
+    size_t count = 0;
+};
@@ -0,0 +1,128 @@
+// PhaseScheduler.h
+// Multi-rate scheduling of the evolveFrame phases
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+
+// ============================================================================
+// Phase Identifiers and Schedules
+// ============================================================================
+
+enum class PhaseId {
+    Dynamics,
+    Photons,
+    Connections,
+    Stellar,
+    Patterns,
+    Count
+};
+
+constexpr size_t PHASE_COUNT = static_cast<size_t>(PhaseId::Count);
+
+inline const char* phaseName(PhaseId phase) {
+    switch (phase) {
+        case PhaseId::Dynamics:    return "dynamics";
+        case PhaseId::Photons:     return "photons";
+        case PhaseId::Connections: return "connections";
+        case PhaseId::Stellar:     return "stellar";
+        case PhaseId::Patterns:    return "patterns";
+        case PhaseId::Count:       break;
+    }
+    return "unknown";
+}
+
+enum class PhasePolicy {
+    EveryFrame,    // Runs every frame with that frame's dt
+    EveryKFrames,  // Runs once every `period` frames with the accumulated dt
+    OnDemand       // Runs only after requestPhase(), with the accumulated dt
+};
+
+struct PhaseSchedule {
+    PhasePolicy policy = PhasePolicy::EveryFrame;
+    int period = 1;            // Frames between runs for EveryKFrames
+    float maxSubstep = 0.0f;   // Split accumulated dt into steps no longer than this (0: one step)
+};
+
+// ============================================================================
+// Phase Scheduler
+// ============================================================================
+//
+// Tracks, per phase, how much simulated time has elapsed since the phase last
+// ran. Slow phases (stellar evolution changes temperature thousands of times
+// slower than dynamics) can run every k frames and catch up with the time
+// they skipped, optionally sub-stepped, so the per-frame cost is dominated by
+// the phases that actually need per-frame resolution.
+
+class PhaseScheduler {
+public:
+    void setSchedule(PhaseId phase, const PhaseSchedule& schedule) {
+        PhaseState& state = states[index(phase)];
+        state.schedule = schedule;
+        state.schedule.period = std::max(1, schedule.period);
+    }
+
+    const PhaseSchedule& getSchedule(PhaseId phase) const {
+        return states[index(phase)].schedule;
+    }
+
+    void request(PhaseId phase) { states[index(phase)].requested = true; }
+
+    // Accounts for one frame of `deltaTime` and reports whether the phase
+    // should run now; if so `elapsed` receives the time it has to cover.
+    bool advance(PhaseId phase, float deltaTime, float& elapsed) {
+        PhaseState& state = states[index(phase)];
+        state.pendingTime += deltaTime;
+        state.pendingFrames += 1;
+
+        bool due = false;
+        switch (state.schedule.policy) {
+            case PhasePolicy::EveryFrame:   due = true; break;
+            case PhasePolicy::EveryKFrames: due = state.pendingFrames >= state.schedule.period; break;
+            case PhasePolicy::OnDemand:     due = state.requested; break;
+        }
+        if (!due) return false;
+
+        elapsed = take(state);
+        return true;
+    }
+
+    // Reports the time a phase still owes (e.g. at the end of a run) and
+    // clears it; returns false when nothing is pending
+    bool drain(PhaseId phase, float& elapsed) {
+        PhaseState& state = states[index(phase)];
+        if (state.pendingFrames == 0 && !state.requested) return false;
+        elapsed = take(state);
+        return true;
+    }
+
+    // Splits `elapsed` into equal sub-steps no longer than the phase's limit
+    int substeps(PhaseId phase, float elapsed) const {
+        const float limit = states[index(phase)].schedule.maxSubstep;
+        if (limit <= 0.0f || elapsed <= limit) return 1;
+        return static_cast<int>(std::ceil(elapsed / limit));
+    }
+
+private:
+    struct PhaseState {
+        PhaseSchedule schedule;
+        float pendingTime = 0.0f;
+        int pendingFrames = 0;
+        bool requested = false;
+    };
+
+    static size_t index(PhaseId phase) { return static_cast<size_t>(phase); }
+
+    static float take(PhaseState& state) {
+        float elapsed = state.pendingTime;
+        state.pendingTime = 0.0f;
+        state.pendingFrames = 0;
+        state.requested = false;
+        return elapsed;
+    }
+
+    std::array<PhaseState, PHASE_COUNT> states;
+};
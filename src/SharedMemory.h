@@ -0,0 +1,193 @@
+// SharedMemory.h
+// POSIX shared-memory segments, ring buffers and barriers for local processes
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// ============================================================================
+// Shared Segment
+// ============================================================================
+//
+// A named POSIX shared-memory object mapped read/write. Processes forked
+// after creation inherit the mapping; only the creating process unlinks the
+// name, so children may exit normally without tearing it down. attach()
+// maps an existing object read-only for unrelated processes and never
+// unlinks it.
+
+class SharedSegment {
+public:
+    SharedSegment() = default;
+
+    SharedSegment(const std::string& name, size_t bytes) : name(name), bytes(bytes), creator(getpid()) {
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd < 0) {
+            std::cerr << "Error: shm_open failed for " << name << std::endl;
+            return;
+        }
+        if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+            std::cerr << "Error: could not size shared segment " << name << std::endl;
+            close(fd);
+            shm_unlink(name.c_str());
+            return;
+        }
+        void* mapped = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Error: could not map shared segment " << name << std::endl;
+            shm_unlink(name.c_str());
+            return;
+        }
+        memory = mapped;
+    }
+
+    static SharedSegment attach(const std::string& name) {
+        SharedSegment segment;
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) return segment;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (mapped != MAP_FAILED) {
+                segment.name = name;
+                segment.memory = mapped;
+                segment.bytes = static_cast<size_t>(info.st_size);
+            }
+        }
+        close(fd);
+        return segment;
+    }
+
+    ~SharedSegment() {
+        if (!memory) return;
+        munmap(memory, bytes);
+        if (getpid() == creator) shm_unlink(name.c_str());
+    }
+
+    SharedSegment(const SharedSegment&) = delete;
+    SharedSegment& operator=(const SharedSegment&) = delete;
+
+    SharedSegment(SharedSegment&& other) noexcept { *this = std::move(other); }
+    SharedSegment& operator=(SharedSegment&& other) noexcept {
+        std::swap(name, other.name);
+        std::swap(memory, other.memory);
+        std::swap(bytes, other.bytes);
+        std::swap(creator, other.creator);
+        return *this;
+    }
+
+    bool isOpen() const { return memory != nullptr; }
+    void* data() const { return memory; }
+    size_t size() const { return bytes; }
+
+private:
+    std::string name;
+    void* memory = nullptr;
+    size_t bytes = 0;
+    pid_t creator = 0;
+};
+
+// ============================================================================
+// Single-Producer Single-Consumer Ring
+// ============================================================================
+//
+// Fixed-capacity ring of trivially copyable records placed in shared memory.
+// Head and tail are lock-free atomics on separate cache lines, which is all
+// that cross-process synchronization needs; neither side ever blocks, so
+// callers interleave pushing and popping to avoid deadlock when two
+// processes exchange more than a ring's worth in both directions.
+
+template <typename T>
+class ShmRing {
+    static_assert(std::is_trivially_copyable<T>::value, "ring records are copied as bytes");
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared atomics must be lock-free");
+
+    struct Header {
+        alignas(64) std::atomic<uint64_t> head;   // Next slot to read
+        alignas(64) std::atomic<uint64_t> tail;   // Next slot to write
+        alignas(64) uint64_t capacity;
+    };
+
+public:
+    static size_t bytesFor(size_t capacity) { return sizeof(Header) + capacity * sizeof(T); }
+
+    ShmRing() = default;
+
+    // Views a ring at `memory`; the creating side initializes it once
+    ShmRing(void* memory, size_t capacity, bool initialize)
+        : header(static_cast<Header*>(memory)),
+          slots(reinterpret_cast<T*>(static_cast<char*>(memory) + sizeof(Header))) {
+        if (initialize) {
+            new (header) Header();
+            header->head.store(0);
+            header->tail.store(0);
+            header->capacity = capacity;
+        }
+    }
+
+    bool tryPush(const T& record) {
+        const uint64_t tail = header->tail.load(std::memory_order_relaxed);
+        if (tail - header->head.load(std::memory_order_acquire) == header->capacity) return false;
+        slots[tail % header->capacity] = record;
+        header->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& record) {
+        const uint64_t head = header->head.load(std::memory_order_relaxed);
+        if (head == header->tail.load(std::memory_order_acquire)) return false;
+        record = slots[head % header->capacity];
+        header->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    Header* header = nullptr;
+    T* slots = nullptr;
+};
+
+// ============================================================================
+// Process Barrier
+// ============================================================================
+//
+// Sense-reversing spin barrier for a fixed number of processes. Waiters
+// yield between polls so oversubscribed hosts still make progress.
+
+class ShmBarrier {
+public:
+    void initialize(uint32_t count) {
+        parties = count;
+        arrived.store(0);
+        generation.store(0);
+    }
+
+    void wait() {
+        const uint32_t current = generation.load(std::memory_order_acquire);
+        if (arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == parties) {
+            arrived.store(0, std::memory_order_relaxed);
+            generation.store(current + 1, std::memory_order_release);
+            return;
+        }
+        while (generation.load(std::memory_order_acquire) == current) {
+            std::this_thread::yield();
+        }
+    }
+
+private:
+    std::atomic<uint32_t> arrived{0};
+    std::atomic<uint32_t> generation{0};
+    uint32_t parties = 1;
+};
@@ -0,0 +1,180 @@
+// SlotMap.h
+// Generational handles that survive compaction and reordering
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// ============================================================================
+// Slot Handle
+// ============================================================================
+//
+// Names an object by slot and generation. Destroying the object bumps its
+// slot's generation, so a handle held from before fails every lookup even
+// after the slot is reused: stale references are detected, never aliased.
+
+struct SlotHandle {
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    uint32_t slot = NONE;
+    uint32_t generation = 0;
+
+    bool valid() const { return slot != NONE; }
+    bool operator==(const SlotHandle& o) const { return slot == o.slot && generation == o.generation; }
+    bool operator!=(const SlotHandle& o) const { return !(*this == o); }
+};
+
+// ============================================================================
+// Slot Table
+// ============================================================================
+//
+// Maps slots to positions in dense storage kept elsewhere. create(),
+// destroy() and find() are O(1); freed slots are reused last-in first-out.
+// The owner of the storage calls place() whenever an object moves, so
+// holders of handles never fix up indices themselves. A live slot may also
+// be parked: the object exists but is not in the dense storage right now,
+// and find() reports it as absent until it is placed again.
+
+class SlotTable {
+public:
+    static constexpr uint32_t NONE = SlotHandle::NONE;
+
+    SlotHandle create(uint32_t index) {
+        uint32_t slot;
+        if (!freeSlots.empty()) {
+            slot = freeSlots.back();
+            freeSlots.pop_back();
+        } else {
+            slot = static_cast<uint32_t>(entries.size());
+            entries.emplace_back();
+        }
+        Entry& e = entries[slot];
+        e.index = index;
+        e.live = true;
+        ++live;
+        return SlotHandle{slot, e.generation};
+    }
+
+    void destroy(uint32_t slot) {
+        Entry& e = entries[slot];
+        if (!e.live) return;
+        e.live = false;
+        e.index = NONE;
+        ++e.generation;
+        --live;
+        freeSlots.push_back(slot);
+    }
+
+    void place(uint32_t slot, uint32_t index) { entries[slot].index = index; }
+    void park(uint32_t slot) { entries[slot].index = NONE; }
+
+    // Dense index of the object, or NONE if it was destroyed or is parked
+    uint32_t find(SlotHandle h) const {
+        if (h.slot >= entries.size()) return NONE;
+        const Entry& e = entries[h.slot];
+        return e.live && e.generation == h.generation ? e.index : NONE;
+    }
+
+    // Whether the object still exists, placed or parked
+    bool alive(SlotHandle h) const {
+        return h.slot < entries.size() && entries[h.slot].live && entries[h.slot].generation == h.generation;
+    }
+
+    bool isLive(uint32_t slot) const { return slot < entries.size() && entries[slot].live; }
+    SlotHandle handle(uint32_t slot) const {
+        return slot < entries.size() ? SlotHandle{slot, entries[slot].generation} : SlotHandle();
+    }
+
+    size_t slotCount() const { return entries.size(); }
+    size_t liveCount() const { return live; }
+
+    // Destroys everything; generations are kept so old handles stay invalid
+    void clear() {
+        for (uint32_t s = 0; s < entries.size(); ++s) destroy(s);
+    }
+
+private:
+    struct Entry {
+        uint32_t index = NONE;
+        uint32_t generation = 0;
+        bool live = false;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<uint32_t> freeSlots;
+    size_t live = 0;
+};
+
+// ============================================================================
+// Slot Map
+// ============================================================================
+//
+// Objects in one dense array (iteration touches only live objects,
+// contiguously) addressed by handles. erase() moves the last object into
+// the hole, so insert, erase and lookup are all O(1) and the dense order is
+// unspecified.
+
+template <typename T>
+class SlotMap {
+public:
+    SlotHandle insert(T value) {
+        const SlotHandle h = table.create(static_cast<uint32_t>(dense.size()));
+        dense.push_back(std::move(value));
+        denseSlots.push_back(h.slot);
+        return h;
+    }
+
+    bool erase(SlotHandle h) {
+        const uint32_t index = table.find(h);
+        if (index == SlotTable::NONE) return false;
+        const uint32_t last = static_cast<uint32_t>(dense.size() - 1);
+        if (index != last) {
+            dense[index] = std::move(dense[last]);
+            denseSlots[index] = denseSlots[last];
+            table.place(denseSlots[index], index);
+        }
+        dense.pop_back();
+        denseSlots.pop_back();
+        table.destroy(h.slot);
+        return true;
+    }
+
+    T* get(SlotHandle h) {
+        const uint32_t index = table.find(h);
+        return index == SlotTable::NONE ? nullptr : &dense[index];
+    }
+    const T* get(SlotHandle h) const {
+        const uint32_t index = table.find(h);
+        return index == SlotTable::NONE ? nullptr : &dense[index];
+    }
+    bool contains(SlotHandle h) const { return table.find(h) != SlotTable::NONE; }
+
+    size_t size() const { return dense.size(); }
+    bool empty() const { return dense.empty(); }
+    SlotHandle handleAt(size_t index) const { return table.handle(denseSlots[index]); }
+
+    // Current handle of a slot, for callers that index side tables by slot
+    SlotHandle handleOfSlot(uint32_t slot) const { return table.handle(slot); }
+    size_t slotCount() const { return table.slotCount(); }
+
+    T& operator[](size_t index) { return dense[index]; }
+    const T& operator[](size_t index) const { return dense[index]; }
+    typename std::vector<T>::iterator begin() { return dense.begin(); }
+    typename std::vector<T>::iterator end() { return dense.end(); }
+    typename std::vector<T>::const_iterator begin() const { return dense.begin(); }
+    typename std::vector<T>::const_iterator end() const { return dense.end(); }
+
+    void clear() {
+        dense.clear();
+        denseSlots.clear();
+        table.clear();
+    }
+
+private:
+    std::vector<T> dense;
+    std::vector<uint32_t> denseSlots;
+    SlotTable table;
+};
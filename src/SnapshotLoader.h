@@ -0,0 +1,274 @@
+// SnapshotLoader.h
+// Parallel reader for the text snapshots written by saveState()
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ThreadPool.h"
+
+// ============================================================================
+// Snapshot Data
+// ============================================================================
+//
+// Snapshots are text: '#' header lines (Time, Neurons, Format) followed by
+// one neuron per line. Columns are matched to fields by the names on the
+// Format line, so files with reordered or extra columns still load; x, y
+// and z are required and missing fields take the Neuron defaults.
+
+enum class SnapshotField { X, Y, Z, VX, VY, VZ, Mass, Luminosity, Temperature, Count };
+
+constexpr size_t SNAPSHOT_FIELDS = static_cast<size_t>(SnapshotField::Count);
+
+inline const char* snapshotFieldName(SnapshotField field) {
+    static const char* const names[SNAPSHOT_FIELDS] = {
+        "x", "y", "z", "vx", "vy", "vz", "mass", "luminosity", "temperature"};
+    return names[static_cast<size_t>(field)];
+}
+
+inline float snapshotFieldDefault(SnapshotField field) {
+    switch (field) {
+        case SnapshotField::Mass: return 1.0f;
+        case SnapshotField::Luminosity: return 1.0f;
+        case SnapshotField::Temperature: return 2700.0f;
+        default: return 0.0f;
+    }
+}
+
+struct SnapshotData {
+    float time = 0.0f;
+    std::array<std::vector<float>, SNAPSHOT_FIELDS> columns;
+
+    size_t size() const { return columns[0].size(); }
+    const std::vector<float>& operator[](SnapshotField field) const { return columns[static_cast<size_t>(field)]; }
+    std::vector<float>& operator[](SnapshotField field) { return columns[static_cast<size_t>(field)]; }
+};
+
+// ============================================================================
+// Snapshot Loader
+// ============================================================================
+//
+// The file is mapped read-only and its body cut into line-aligned pieces,
+// a few per pool thread. One parallel pass counts the neuron lines in each
+// piece; a prefix sum then gives every piece its output offset, and a
+// second parallel pass parses the floats with std::from_chars straight
+// into the columns. No line is copied and no locale is consulted.
+
+class SnapshotLoader {
+public:
+    static bool load(const std::string& path, ThreadPool& pool, SnapshotData& out) {
+        const int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            std::cerr << "Error: Could not open file " << path << std::endl;
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            std::cerr << "Error: " << path << " is empty or unreadable" << std::endl;
+            close(fd);
+            return false;
+        }
+        const size_t bytes = static_cast<size_t>(info.st_size);
+        void* mapped = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (mapped == MAP_FAILED) {
+            std::cerr << "Error: could not map " << path << std::endl;
+            return false;
+        }
+        madvise(mapped, bytes, MADV_WILLNEED);
+
+        const bool ok = parse(static_cast<const char*>(mapped), bytes, pool, out, path);
+        munmap(mapped, bytes);
+        return ok;
+    }
+
+private:
+    static constexpr size_t MIN_PIECE_BYTES = size_t(64) << 10;
+    static constexpr int SKIP = -1;
+
+    struct Piece {
+        const char* begin;
+        const char* end;
+        size_t neurons = 0;       // Neuron lines in the piece
+        size_t lines = 0;         // All lines, for error messages
+        size_t offset = 0;        // First output row
+        size_t errorLine = 0;     // Line within the piece, 1-based; 0: none
+    };
+
+    static bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+    static const char* lineEnd(const char* p, const char* end) {
+        const void* newline = std::memchr(p, '\n', end - p);
+        return newline ? static_cast<const char*>(newline) : end;
+    }
+
+    // A neuron line has something other than blanks and is not a comment
+    static bool isNeuronLine(const char* p, const char* end) {
+        while (p < end && isSpace(*p)) ++p;
+        return p < end && *p != '#';
+    }
+
+    static bool startsWith(const char* p, const char* end, const char* prefix) {
+        const size_t n = std::strlen(prefix);
+        return static_cast<size_t>(end - p) >= n && std::memcmp(p, prefix, n) == 0;
+    }
+
+    static bool parse(const char* data, size_t bytes, ThreadPool& pool, SnapshotData& out,
+                      const std::string& path) {
+        const char* const end = data + bytes;
+
+        // Header: leading '#' lines; the Format line names the columns
+        std::vector<int> fieldOfColumn;
+        out.time = 0.0f;
+        const char* body = data;
+        size_t headerLines = 0;
+        while (body < end && *body == '#') {
+            const char* next = lineEnd(body, end);
+            if (startsWith(body, next, "# Time:")) {
+                out.time = std::strtof(std::string(body + 7, next).c_str(), nullptr);
+            } else if (startsWith(body, next, "# Format:")) {
+                fieldOfColumn = formatColumns(body + 9, next);
+            }
+            body = next < end ? next + 1 : end;
+            ++headerLines;
+        }
+        if (fieldOfColumn.empty()) {
+            // Headerless files are taken to be in the saveState() order
+            for (size_t f = 0; f < SNAPSHOT_FIELDS; ++f) fieldOfColumn.push_back(static_cast<int>(f));
+        }
+        bool present[SNAPSHOT_FIELDS] = {};
+        for (int field : fieldOfColumn) {
+            if (field != SKIP) present[field] = true;
+        }
+        if (!present[0] || !present[1] || !present[2]) {
+            std::cerr << "Error: " << path << " has no x, y and z columns" << std::endl;
+            return false;
+        }
+
+        // Line-aligned pieces of the body
+        const size_t bodyBytes = end - body;
+        const size_t pieceCount = std::max<size_t>(1, std::min<size_t>(pool.concurrency() * 4,
+                                                                        bodyBytes / MIN_PIECE_BYTES));
+        std::vector<Piece> pieces(pieceCount);
+        const char* cut = body;
+        for (size_t k = 0; k < pieceCount; ++k) {
+            pieces[k].begin = cut;
+            if (k + 1 == pieceCount) {
+                cut = end;
+            } else {
+                const char* target = std::max(cut, body + bodyBytes * (k + 1) / pieceCount);
+                cut = target < end ? lineEnd(target, end) : end;
+                if (cut < end) ++cut;
+            }
+            pieces[k].end = cut;
+        }
+
+        pool.parallelFor(0, pieceCount, 1, [&](size_t begin, size_t finish, unsigned) {
+            for (size_t k = begin; k < finish; ++k) {
+                Piece& piece = pieces[k];
+                for (const char* p = piece.begin; p < piece.end;) {
+                    const char* next = lineEnd(p, piece.end);
+                    piece.neurons += isNeuronLine(p, next);
+                    ++piece.lines;
+                    p = next + 1;
+                }
+            }
+        });
+        size_t total = 0;
+        for (Piece& piece : pieces) {
+            piece.offset = total;
+            total += piece.neurons;
+        }
+        for (size_t f = 0; f < SNAPSHOT_FIELDS; ++f) {
+            out.columns[f].resize(total);
+        }
+
+        pool.parallelFor(0, pieceCount, 1, [&](size_t begin, size_t finish, unsigned) {
+            for (size_t k = begin; k < finish; ++k) parsePiece(pieces[k], fieldOfColumn, present, out);
+        });
+
+        size_t line = headerLines;
+        for (const Piece& piece : pieces) {
+            if (piece.errorLine != 0) {
+                std::cerr << "Error: " << path << ":" << line + piece.errorLine << ": expected "
+                          << fieldOfColumn.size() << " numbers" << std::endl;
+                for (auto& column : out.columns) column.clear();
+                return false;
+            }
+            line += piece.lines;
+        }
+        return true;
+    }
+
+    // Field index of each name on the Format line, SKIP for unknown names
+    static std::vector<int> formatColumns(const char* p, const char* end) {
+        std::vector<int> fields;
+        while (p < end) {
+            while (p < end && isSpace(*p)) ++p;
+            const char* word = p;
+            while (p < end && !isSpace(*p)) ++p;
+            if (word == p) break;
+            int field = SKIP;
+            for (size_t f = 0; f < SNAPSHOT_FIELDS; ++f) {
+                const char* name = snapshotFieldName(static_cast<SnapshotField>(f));
+                if (std::strlen(name) == static_cast<size_t>(p - word) && std::memcmp(name, word, p - word) == 0) {
+                    field = static_cast<int>(f);
+                }
+            }
+            fields.push_back(field);
+        }
+        return fields;
+    }
+
+    static void parsePiece(Piece& piece, const std::vector<int>& fieldOfColumn, const bool* present,
+                           SnapshotData& out) {
+        float* columns[SNAPSHOT_FIELDS];
+        for (size_t f = 0; f < SNAPSHOT_FIELDS; ++f) columns[f] = out.columns[f].data();
+
+        size_t row = piece.offset;
+        size_t line = 0;
+        for (const char* p = piece.begin; p < piece.end;) {
+            const char* next = lineEnd(p, piece.end);
+            ++line;
+            if (isNeuronLine(p, next)) {
+                for (size_t f = 0; f < SNAPSHOT_FIELDS; ++f) {
+                    if (!present[f]) columns[f][row] = snapshotFieldDefault(static_cast<SnapshotField>(f));
+                }
+                const char* q = p;
+                for (int field : fieldOfColumn) {
+                    while (q < next && isSpace(*q)) ++q;
+                    float value = 0.0f;
+                    const std::from_chars_result parsed = std::from_chars(q, next, value);
+                    if (parsed.ec != std::errc() && parsed.ec != std::errc::result_out_of_range) {
+                        piece.errorLine = line;
+                        return;
+                    }
+                    q = parsed.ptr;
+                    if (field != SKIP) columns[field][row] = value;
+                }
+                while (q < next && isSpace(*q)) ++q;
+                if (q != next) {
+                    piece.errorLine = line;
+                    return;
+                }
+                ++row;
+            }
+            p = next + 1;
+        }
+    }
+};
@@ -0,0 +1,446 @@
+// SpatialGrid.h
+// Uniform grid over neuron positions with radius, kNN, box and ray queries
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "ThreadPool.h"
+
+// ============================================================================
+// Query Results
+// ============================================================================
+//
+// A hit names a neuron by its index in the array the grid was built from.
+// `distance` is the distance to the query point for radius and nearest
+// queries, the position along the ray for ray queries and 0 for boxes.
+
+struct SpatialHit {
+    uint32_t index;
+    float distance;
+};
+
+// Answers to a batch of queries, packed: query q's hits are
+// hits[offsets[q] .. offsets[q + 1])
+struct SpatialQueryResults {
+    std::vector<size_t> offsets{0};
+    std::vector<SpatialHit> hits;
+
+    size_t queries() const { return offsets.size() - 1; }
+    size_t count(size_t q) const { return offsets[q + 1] - offsets[q]; }
+    const SpatialHit* begin(size_t q) const { return hits.data() + offsets[q]; }
+    const SpatialHit* end(size_t q) const { return hits.data() + offsets[q + 1]; }
+};
+
+// ============================================================================
+// Spatial Grid
+// ============================================================================
+//
+// Positions are bucketed into cubic cells over their bounding box with a
+// counting sort, and copied in cell order (x fastest), so every query reads
+// contiguous runs of floats and a row of cells along x is one run. The grid
+// keeps its own copy of the positions: it answers for the state it was
+// built from until the next build, whatever happens to the source
+// meanwhile, and any number of threads may query it concurrently. Cells
+// grow beyond the requested size when the box would otherwise need more
+// than about two cells per point.
+//
+// Point types only need x, y and z members.
+
+class SpatialGrid {
+public:
+    static constexpr size_t BATCH_BLOCK = 64;   // Queries per parallel work item
+
+    // positionAt(i) returns something with x, y and z for i < count; it is
+    // called from the pool's threads
+    template <typename PositionAt>
+    void build(size_t count, PositionAt&& positionAt, float cellSize, ThreadPool& pool) {
+        points = count;
+        px.resize(count);
+        py.resize(count);
+        pz.resize(count);
+        ids.resize(count);
+        if (count == 0) {
+            nx = ny = nz = 0;
+            cellStart.assign(1, 0);
+            return;
+        }
+
+        // Bounding box, one partial box per participating thread
+        const unsigned slots = pool.concurrency();
+        lows.assign(slots * 3, std::numeric_limits<float>::max());
+        highs.assign(slots * 3, std::numeric_limits<float>::lowest());
+        pool.parallelFor(0, count, 4096, [&](size_t begin, size_t end, unsigned slot) {
+            float* lo = &lows[slot * 3];
+            float* hi = &highs[slot * 3];
+            for (size_t i = begin; i < end; ++i) {
+                const auto& p = positionAt(i);
+                lo[0] = std::min(lo[0], p.x); hi[0] = std::max(hi[0], p.x);
+                lo[1] = std::min(lo[1], p.y); hi[1] = std::max(hi[1], p.y);
+                lo[2] = std::min(lo[2], p.z); hi[2] = std::max(hi[2], p.z);
+            }
+        });
+        float lo[3] = {lows[0], lows[1], lows[2]};
+        float hi[3] = {highs[0], highs[1], highs[2]};
+        for (unsigned s = 1; s < slots; ++s) {
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::min(lo[a], lows[s * 3 + a]);
+                hi[a] = std::max(hi[a], highs[s * 3 + a]);
+            }
+        }
+        minX = lo[0];
+        minY = lo[1];
+        minZ = lo[2];
+
+        // Cell size: as asked, unless that needs far more cells than points
+        cell = cellSize > 0.0f ? cellSize : 1.0f;
+        const double maxCells = std::max<double>(64.0, 2.0 * count);
+        // Per-axis counts are clamped in double before the cast so a tiny cell
+        // or a huge extent cannot overflow int; the loop then grows the cell
+        const auto axisCells = [&](int a) {
+            const double span = (double(hi[a]) - double(lo[a])) / cell;
+            return static_cast<int>(span < maxCells ? span : maxCells) + 1;
+        };
+        for (;;) {
+            nx = axisCells(0);
+            ny = axisCells(1);
+            nz = axisCells(2);
+            const double cells = double(nx) * ny * nz;
+            if (cells <= maxCells) break;
+            cell *= static_cast<float>(std::max(1.01, std::cbrt(cells / maxCells)));
+        }
+        inverseCell = 1.0f / cell;
+
+        // Counting sort by cell; the scatter runs in index order so the
+        // layout, and therefore query output order, is deterministic
+        keys.resize(count);
+        pool.parallelFor(0, count, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t i = begin; i < end; ++i) {
+                const auto& p = positionAt(i);
+                keys[i] = static_cast<uint32_t>(key(coord(p.x, minX, nx), coord(p.y, minY, ny),
+                                                    coord(p.z, minZ, nz)));
+            }
+        });
+        const size_t cells = size_t(nx) * ny * nz;
+        cellStart.assign(cells + 1, 0);
+        for (uint32_t k : keys) ++cellStart[k + 1];
+        for (size_t c = 0; c < cells; ++c) cellStart[c + 1] += cellStart[c];
+        cursor.assign(cellStart.begin(), cellStart.end() - 1);
+        for (size_t i = 0; i < count; ++i) ids[cursor[keys[i]]++] = static_cast<uint32_t>(i);
+
+        pool.parallelFor(0, count, 4096, [&](size_t begin, size_t end, unsigned) {
+            for (size_t j = begin; j < end; ++j) {
+                const auto& p = positionAt(ids[j]);
+                px[j] = p.x;
+                py[j] = p.y;
+                pz[j] = p.z;
+            }
+        });
+    }
+
+    size_t size() const { return points; }
+    bool empty() const { return points == 0; }
+    float cellSize() const { return cell; }
+    size_t cellCount() const { return cellStart.size() - 1; }
+
+    // ------------------------------------------------------------------
+    // Single queries (any thread)
+    // ------------------------------------------------------------------
+
+    // Calls visit(index, distanceSquared) for every point within `radius`
+    template <typename Point, typename Visit>
+    void forEachInRadius(const Point& center, float radius, Visit&& visit) const {
+        if (points == 0 || !(radius >= 0.0f)) return;
+        const float r2 = radius * radius;
+        int lo[3], hi[3];
+        if (!cellRange(center.x - radius, center.y - radius, center.z - radius,
+                       center.x + radius, center.y + radius, center.z + radius, lo, hi)) return;
+        for (int z = lo[2]; z <= hi[2]; ++z) {
+            for (int y = lo[1]; y <= hi[1]; ++y) {
+                const size_t row = key(0, y, z);
+                for (size_t j = cellStart[row + lo[0]], end = cellStart[row + hi[0] + 1]; j < end; ++j) {
+                    const float dx = px[j] - center.x, dy = py[j] - center.y, dz = pz[j] - center.z;
+                    const float d2 = dx * dx + dy * dy + dz * dz;
+                    if (d2 <= r2) visit(ids[j], d2);
+                }
+            }
+        }
+    }
+
+    // Number of points within `radius`, counting no further than `limit`
+    template <typename Point>
+    size_t countInRadius(const Point& center, float radius, size_t limit) const {
+        if (points == 0 || !(radius >= 0.0f) || limit == 0) return 0;
+        const float r2 = radius * radius;
+        int lo[3], hi[3];
+        if (!cellRange(center.x - radius, center.y - radius, center.z - radius,
+                       center.x + radius, center.y + radius, center.z + radius, lo, hi)) return 0;
+        size_t found = 0;
+        for (int z = lo[2]; z <= hi[2]; ++z) {
+            for (int y = lo[1]; y <= hi[1]; ++y) {
+                const size_t row = key(0, y, z);
+                for (size_t j = cellStart[row + lo[0]], end = cellStart[row + hi[0] + 1]; j < end; ++j) {
+                    const float dx = px[j] - center.x, dy = py[j] - center.y, dz = pz[j] - center.z;
+                    if (dx * dx + dy * dy + dz * dz <= r2 && ++found == limit) return found;
+                }
+            }
+        }
+        return found;
+    }
+
+    // Points within `radius` of `center`, in grid order
+    template <typename Point>
+    void radius(const Point& center, float radius, std::vector<SpatialHit>& out) const {
+        out.clear();
+        forEachInRadius(center, radius, [&](uint32_t index, float d2) {
+            out.push_back(SpatialHit{index, std::sqrt(d2)});
+        });
+    }
+
+    // Points inside the box [low, high] (inclusive), in grid order
+    template <typename Point>
+    void box(const Point& low, const Point& high, std::vector<SpatialHit>& out) const {
+        out.clear();
+        int lo[3], hi[3];
+        if (points == 0 || !cellRange(low.x, low.y, low.z, high.x, high.y, high.z, lo, hi)) return;
+        for (int z = lo[2]; z <= hi[2]; ++z) {
+            for (int y = lo[1]; y <= hi[1]; ++y) {
+                const size_t row = key(0, y, z);
+                for (size_t j = cellStart[row + lo[0]], end = cellStart[row + hi[0] + 1]; j < end; ++j) {
+                    if (px[j] >= low.x && px[j] <= high.x && py[j] >= low.y && py[j] <= high.y &&
+                        pz[j] >= low.z && pz[j] <= high.z) {
+                        out.push_back(SpatialHit{ids[j], 0.0f});
+                    }
+                }
+            }
+        }
+    }
+
+    // The k points nearest `center`, closest first (fewer if the grid holds
+    // fewer). Searches shells of cells outwards from the query's cell and
+    // stops once no unvisited cell can hold anything closer.
+    template <typename Point>
+    void nearest(const Point& center, size_t k, std::vector<SpatialHit>& out) const {
+        out.clear();
+        if (points == 0 || k == 0) return;
+        k = std::min(k, points);
+        auto farther = [](const SpatialHit& a, const SpatialHit& b) { return a.distance < b.distance; };
+
+        const int cx = coord(center.x, minX, nx), cy = coord(center.y, minY, ny), cz = coord(center.z, minZ, nz);
+        const int shells = std::max(nx, std::max(ny, nz));
+        for (int shell = 0; shell < shells; ++shell) {
+            // Anything in this shell or beyond is at least (shell - 1) cells away
+            const float bound = (shell - 1) * cell;
+            if (out.size() == k && bound > 0.0f && bound * bound > out.front().distance) break;
+
+            for (int z = cz - shell; z <= cz + shell; ++z) {
+                if (z < 0 || z >= nz) continue;
+                for (int y = cy - shell; y <= cy + shell; ++y) {
+                    if (y < 0 || y >= ny) continue;
+                    const bool face = z == cz - shell || z == cz + shell || y == cy - shell || y == cy + shell;
+                    const int step = face ? 1 : std::max(1, 2 * shell);
+                    for (int x = cx - shell; x <= cx + shell; x += step) {
+                        if (x < 0 || x >= nx) continue;
+                        const size_t c = key(x, y, z);
+                        for (size_t j = cellStart[c]; j < cellStart[c + 1]; ++j) {
+                            const float dx = px[j] - center.x, dy = py[j] - center.y, dz = pz[j] - center.z;
+                            const float d2 = dx * dx + dy * dy + dz * dz;
+                            if (out.size() < k) {
+                                out.push_back(SpatialHit{ids[j], d2});
+                                std::push_heap(out.begin(), out.end(), farther);
+                            } else if (d2 < out.front().distance) {
+                                std::pop_heap(out.begin(), out.end(), farther);
+                                out.back() = SpatialHit{ids[j], d2};
+                                std::push_heap(out.begin(), out.end(), farther);
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        std::sort_heap(out.begin(), out.end(), farther);
+        for (SpatialHit& hit : out) hit.distance = std::sqrt(hit.distance);
+    }
+
+    // Points within `radius` of the segment from `origin` along `direction`
+    // (need not be normalized) for `length`, ordered along the ray. A
+    // radius of 0 finds only points exactly on it. Cells are walked with a
+    // 3D DDA, widened by the radius.
+    template <typename Point>
+    void ray(const Point& origin, const Point& direction, float length, float radius,
+             std::vector<SpatialHit>& out) const {
+        out.clear();
+        const float norm = std::sqrt(direction.x * direction.x + direction.y * direction.y +
+                                     direction.z * direction.z);
+        if (points == 0 || norm <= 0.0f || !(length >= 0.0f) || !(radius >= 0.0f)) return;
+        const float o[3] = {origin.x, origin.y, origin.z};
+        const float d[3] = {direction.x / norm, direction.y / norm, direction.z / norm};
+        const float base[3] = {minX, minY, minZ};
+        const int dims[3] = {nx, ny, nz};
+
+        // Clip to the grid's box widened by the radius
+        float enter = 0.0f, exit = length;
+        for (int a = 0; a < 3; ++a) {
+            const float lo = base[a] - radius, hi = base[a] + dims[a] * cell + radius;
+            if (d[a] == 0.0f) {
+                if (o[a] < lo || o[a] > hi) return;
+                continue;
+            }
+            float t0 = (lo - o[a]) / d[a], t1 = (hi - o[a]) / d[a];
+            if (t0 > t1) std::swap(t0, t1);
+            enter = std::max(enter, t0);
+            exit = std::min(exit, t1);
+        }
+        if (enter > exit) return;
+
+        // Cells the segment crosses, each widened by `reach` cells
+        const int reach = static_cast<int>(std::ceil(radius * inverseCell));
+        std::vector<uint32_t> candidates;
+        int c[3], step[3];
+        float next[3], delta[3];
+        for (int a = 0; a < 3; ++a) {
+            c[a] = static_cast<int>(std::floor((o[a] + d[a] * enter - base[a]) * inverseCell));
+            step[a] = d[a] > 0.0f ? 1 : (d[a] < 0.0f ? -1 : 0);
+            const float boundary = base[a] + (c[a] + (step[a] > 0)) * cell;
+            next[a] = step[a] ? (boundary - o[a]) / d[a] : std::numeric_limits<float>::infinity();
+            delta[a] = step[a] ? cell / std::abs(d[a]) : std::numeric_limits<float>::infinity();
+        }
+        for (;;) {
+            int lo[3], hi[3];
+            bool inside = true;
+            for (int a = 0; a < 3; ++a) {
+                lo[a] = std::max(0, c[a] - reach);
+                hi[a] = std::min(dims[a] - 1, c[a] + reach);
+                inside = inside && lo[a] <= hi[a];
+            }
+            if (inside) {
+                for (int z = lo[2]; z <= hi[2]; ++z) {
+                    for (int y = lo[1]; y <= hi[1]; ++y) {
+                        for (int x = lo[0]; x <= hi[0]; ++x) candidates.push_back(static_cast<uint32_t>(key(x, y, z)));
+                    }
+                }
+            }
+            const int a = next[0] < next[1] ? (next[0] < next[2] ? 0 : 2) : (next[1] < next[2] ? 1 : 2);
+            if (next[a] > exit) break;
+            c[a] += step[a];
+            next[a] += delta[a];
+        }
+        std::sort(candidates.begin(), candidates.end());
+        candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+        const float r2 = radius * radius;
+        for (uint32_t cellKey : candidates) {
+            for (size_t j = cellStart[cellKey]; j < cellStart[cellKey + 1]; ++j) {
+                const float rx = px[j] - o[0], ry = py[j] - o[1], rz = pz[j] - o[2];
+                const float t = std::min(length, std::max(0.0f, rx * d[0] + ry * d[1] + rz * d[2]));
+                const float ex = rx - d[0] * t, ey = ry - d[1] * t, ez = rz - d[2] * t;
+                if (ex * ex + ey * ey + ez * ez <= r2) out.push_back(SpatialHit{ids[j], t});
+            }
+        }
+        std::sort(out.begin(), out.end(), [](const SpatialHit& a, const SpatialHit& b) {
+            return a.distance < b.distance || (a.distance == b.distance && a.index < b.index);
+        });
+    }
+
+    // ------------------------------------------------------------------
+    // Batched queries: one result list per query, answered on the pool
+    // ------------------------------------------------------------------
+
+    template <typename Point>
+    void radiusBatch(const std::vector<Point>& centers, float radius, ThreadPool& pool,
+                     SpatialQueryResults& out) const {
+        runBatch(centers.size(), pool, out, [&](size_t q, std::vector<SpatialHit>& hits) {
+            this->radius(centers[q], radius, hits);
+        });
+    }
+
+    template <typename Point>
+    void boxBatch(const std::vector<Point>& lows, const std::vector<Point>& highs, ThreadPool& pool,
+                  SpatialQueryResults& out) const {
+        runBatch(std::min(lows.size(), highs.size()), pool, out, [&](size_t q, std::vector<SpatialHit>& hits) {
+            box(lows[q], highs[q], hits);
+        });
+    }
+
+    template <typename Point>
+    void nearestBatch(const std::vector<Point>& centers, size_t k, ThreadPool& pool,
+                      SpatialQueryResults& out) const {
+        runBatch(centers.size(), pool, out, [&](size_t q, std::vector<SpatialHit>& hits) {
+            nearest(centers[q], k, hits);
+        });
+    }
+
+    template <typename Point>
+    void rayBatch(const std::vector<Point>& origins, const std::vector<Point>& directions, float length,
+                  float radius, ThreadPool& pool, SpatialQueryResults& out) const {
+        runBatch(std::min(origins.size(), directions.size()), pool, out,
+                 [&](size_t q, std::vector<SpatialHit>& hits) {
+                     ray(origins[q], directions[q], length, radius, hits);
+                 });
+    }
+
+private:
+    size_t points = 0;
+    float cell = 1.0f, inverseCell = 1.0f;
+    float minX = 0.0f, minY = 0.0f, minZ = 0.0f;
+    int nx = 0, ny = 0, nz = 0;
+    std::vector<uint32_t> cellStart{0};   // Cell c holds sorted slots [cellStart[c], cellStart[c + 1])
+    std::vector<float> px, py, pz;         // Positions in cell order
+    std::vector<uint32_t> ids;             // Source index of each sorted slot
+
+    // Build scratch, kept so that rebuilding a grid stays off the heap
+    std::vector<float> lows, highs;
+    std::vector<uint32_t> keys, cursor;
+
+    size_t key(int x, int y, int z) const { return (size_t(z) * ny + y) * nx + x; }
+
+    int coord(float v, float base, int n) const {
+        const float c = (v - base) * inverseCell;
+        if (!(c >= 0.0f)) return 0;
+        return c >= n ? n - 1 : static_cast<int>(c);
+    }
+
+    // Cells overlapping [low, high]; false if the box misses the grid
+    bool cellRange(float lx, float ly, float lz, float hx, float hy, float hz, int* lo, int* hi) const {
+        const float low[3] = {lx, ly, lz}, high[3] = {hx, hy, hz}, base[3] = {minX, minY, minZ};
+        const int dims[3] = {nx, ny, nz};
+        for (int a = 0; a < 3; ++a) {
+            const float l = (low[a] - base[a]) * inverseCell, h = (high[a] - base[a]) * inverseCell;
+            if (!(l <= h) || h < 0.0f || l >= dims[a]) return false;
+            lo[a] = l <= 0.0f ? 0 : static_cast<int>(l);
+            hi[a] = h >= dims[a] ? dims[a] - 1 : static_cast<int>(h);
+        }
+        return true;
+    }
+
+    // Runs query(q, hits) for every q in blocks on the pool, then packs the
+    // per-block hit lists in query order
+    template <typename Query>
+    void runBatch(size_t queries, ThreadPool& pool, SpatialQueryResults& out, Query&& query) const {
+        const size_t blocks = (queries + BATCH_BLOCK - 1) / BATCH_BLOCK;
+        std::vector<std::vector<SpatialHit>> blockHits(blocks);
+        out.offsets.assign(queries + 1, 0);
+        pool.parallelFor(0, blocks, 1, [&](size_t begin, size_t end, unsigned) {
+            std::vector<SpatialHit> hits;
+            for (size_t b = begin; b < end; ++b) {
+                for (size_t q = b * BATCH_BLOCK, last = std::min(queries, q + BATCH_BLOCK); q < last; ++q) {
+                    query(q, hits);
+                    blockHits[b].insert(blockHits[b].end(), hits.begin(), hits.end());
+                    out.offsets[q + 1] = hits.size();
+                }
+            }
+        });
+        for (size_t q = 0; q < queries; ++q) out.offsets[q + 1] += out.offsets[q];
+        out.hits.resize(out.offsets[queries]);
+        pool.parallelFor(0, blocks, 1, [&](size_t begin, size_t end, unsigned) {
+            for (size_t b = begin; b < end; ++b) {
+                std::copy(blockHits[b].begin(), blockHits[b].end(), out.hits.begin() + out.offsets[b * BATCH_BLOCK]);
+            }
+        });
+    }
+};
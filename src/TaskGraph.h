@@ -0,0 +1,194 @@
+// TaskGraph.h
+// Phase dependency graph derived from field read/write sets
+
+#pragma once
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// ============================================================================
+// Simulation Fields
+// ============================================================================
+//
+// Coarse-grained data a phase may read or write. Two tasks conflict when one
+// writes a field the other reads or writes; conflicting tasks keep their
+// insertion order, everything else may run concurrently.
+
+using FieldSet = uint32_t;
+
+namespace SimField {
+    constexpr FieldSet Position          = 1u << 0;
+    constexpr FieldSet Velocity          = 1u << 1;
+    constexpr FieldSet Mass              = 1u << 2;
+    constexpr FieldSet Age               = 1u << 3;
+    constexpr FieldSet Luminosity        = 1u << 4;
+    constexpr FieldSet Temperature       = 1u << 5;
+    constexpr FieldSet Spectrum          = 1u << 6;
+    constexpr FieldSet Connections       = 1u << 7;
+    constexpr FieldSet Activation        = 1u << 8;
+    constexpr FieldSet Photons           = 1u << 9;
+    constexpr FieldSet GalaxyTemperature = 1u << 10;
+    constexpr FieldSet Activity          = 1u << 11;   // Active/dormant neuron lists
+}
+
+// ============================================================================
+// Task Graph
+// ============================================================================
+//
+// clear() keeps task records and their edge lists for reuse, so rebuilding a
+// graph of the same shape every frame does not touch the heap once bodies
+// fit std::function's inline storage (two pointers).
+
+class TaskGraph {
+public:
+    // Adds a task ordered after every earlier task it conflicts with and
+    // returns its index. Per field only the last writer and the readers since
+    // that write are linked; older conflicts are implied transitively.
+    size_t addTask(const std::string& name, FieldSet reads, FieldSet writes, std::function<void()> body) {
+        if (taskCount == tasks.size()) {
+            tasks.push_back(std::make_unique<Task>());
+        }
+        Task* task = tasks[taskCount].get();
+        task->name = name;
+        task->reads = reads;
+        task->writes = writes;
+        task->body = std::move(body);
+
+        task->predecessors.clear();
+        task->successors.clear();
+
+        const size_t index = taskCount;
+        auto link = [&](size_t u) {
+            auto& preds = task->predecessors;
+            if (std::find(preds.begin(), preds.end(), u) != preds.end()) return;
+            preds.push_back(u);
+            tasks[u]->successors.push_back(index);
+        };
+
+        for (size_t f = 0; f < FIELD_COUNT; ++f) {
+            const FieldSet bit = FieldSet(1) << f;
+            if ((reads | writes) & bit) {
+                if (lastWriter[f] != NO_TASK) link(lastWriter[f]);
+            }
+            if (writes & bit) {
+                for (size_t reader : readersSinceWrite[f]) link(reader);
+            }
+        }
+
+        for (size_t f = 0; f < FIELD_COUNT; ++f) {
+            const FieldSet bit = FieldSet(1) << f;
+            if (writes & bit) {
+                lastWriter[f] = index;
+                readersSinceWrite[f].clear();
+            } else if (reads & bit) {
+                readersSinceWrite[f].push_back(index);
+            }
+        }
+
+        ++taskCount;
+        return index;
+    }
+
+    size_t size() const { return taskCount; }
+
+    const std::vector<size_t>& predecessors(size_t task) const { return tasks[task]->predecessors; }
+
+    void clear() {
+        taskCount = 0;
+        for (size_t f = 0; f < FIELD_COUNT; ++f) {
+            lastWriter[f] = NO_TASK;
+            readersSinceWrite[f].clear();
+        }
+    }
+
+    // Deterministic: tasks run one after another in insertion order on the
+    // calling thread. Otherwise every task is released to the pool as soon as
+    // its predecessors finish, and the caller helps until all are done.
+    void run(ThreadPool& pool, bool deterministic) {
+        if (deterministic) {
+            for (size_t t = 0; t < taskCount; ++t) {
+                tasks[t]->body();
+            }
+            return;
+        }
+
+        runPool = &pool;
+        completed.store(0);
+        for (size_t t = 0; t < taskCount; ++t) {
+            tasks[t]->remaining.store(static_cast<int>(tasks[t]->predecessors.size()));
+        }
+        for (size_t t = 0; t < taskCount; ++t) {
+            if (tasks[t]->predecessors.empty()) {
+                release(t);
+            }
+        }
+
+        const size_t total = taskCount;
+        pool.helpUntil([&]() { return completed.load(std::memory_order_acquire) == total; });
+    }
+
+    // One line per task: "name <- predecessor, ..."
+    std::string describe() const {
+        std::ostringstream out;
+        for (size_t t = 0; t < taskCount; ++t) {
+            const auto& task = tasks[t];
+            out << task->name << " <-";
+            if (task->predecessors.empty()) out << " (ready)";
+            for (size_t u : task->predecessors) {
+                out << " " << tasks[u]->name;
+            }
+            out << "\n";
+        }
+        return out.str();
+    }
+
+private:
+    struct Task {
+        std::string name;
+        FieldSet reads = 0;
+        FieldSet writes = 0;
+        std::function<void()> body;
+        std::vector<size_t> predecessors;
+        std::vector<size_t> successors;
+        std::atomic<int> remaining{0};
+    };
+
+    // Captures stay within std::function's inline storage
+    void release(size_t index) {
+        runPool->submit([this, index]() {
+            Task& task = *tasks[index];
+            task.body();
+            for (size_t s : task.successors) {
+                if (tasks[s]->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    release(s);
+                }
+            }
+            completed.fetch_add(1, std::memory_order_release);
+        });
+    }
+
+    static constexpr size_t FIELD_COUNT = 32;
+    static constexpr size_t NO_TASK = static_cast<size_t>(-1);
+
+    std::vector<std::unique_ptr<Task>> tasks;   // First taskCount are live; the rest await reuse
+    size_t taskCount = 0;
+    ThreadPool* runPool = nullptr;
+    std::atomic<size_t> completed{0};
+    std::array<size_t, FIELD_COUNT> lastWriter = makeNoWriters();
+    std::array<std::vector<size_t>, FIELD_COUNT> readersSinceWrite;
+
+    static std::array<size_t, FIELD_COUNT> makeNoWriters() {
+        std::array<size_t, FIELD_COUNT> writers;
+        writers.fill(NO_TASK);
+        return writers;
+    }
+};
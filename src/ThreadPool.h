@@ -0,0 +1,222 @@
+// ThreadPool.h
+// Fixed-size worker pool shared by the NEBULA simulation phases
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+// ============================================================================
+// Thread Pool
+// ============================================================================
+//
+// parallelFor() splits [begin, end) into chunks of `grain` items that are
+// claimed dynamically by the calling thread and any idle workers. The body
+// receives (chunkBegin, chunkEnd, slot) where `slot` is unique among the
+// threads participating in that call and always < concurrency(), so callers
+// can index per-thread scratch buffers without atomics. Nested parallelFor
+// calls are safe: the caller always participates and can finish its own
+// job alone.
+//
+// submit() queues an independent task. Threads waiting in helpUntil() run
+// queued tasks themselves, so task graphs also make progress on a pool with
+// no workers and never deadlock on nested waits.
+//
+// Given a CPU list, worker i is pinned to cpus[i % cpus.size()] so threads
+// (and the pages they first touch) stay put; the calling thread is left alone.
+
+class ThreadPool {
+public:
+    explicit ThreadPool(unsigned threadCount = 0, const std::vector<int>& cpus = {}) {
+        if (threadCount == 0) {
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        }
+        for (unsigned i = 1; i < threadCount; ++i) {
+            workers.emplace_back([this]() { workerLoop(); });
+            if (!cpus.empty()) {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                CPU_SET(cpus[(i - 1) % cpus.size()], &set);
+                pthread_setaffinity_np(workers.back().native_handle(), sizeof(set), &set);
+            }
+        }
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wakeup.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads that can take part in a parallelFor (workers + caller)
+    unsigned concurrency() const {
+        return static_cast<unsigned>(workers.size()) + 1;
+    }
+
+    template <typename Body>
+    void parallelFor(size_t begin, size_t end, size_t grain, Body&& body) {
+        if (begin >= end) return;
+        grain = std::max<size_t>(1, grain);
+
+        if (workers.empty() || end - begin <= grain) {
+            body(begin, end, 0u);
+            return;
+        }
+
+        ParallelJob job;
+        job.next.store(begin);
+        job.end = end;
+        job.grain = grain;
+        job.body = [&body](size_t chunkBegin, size_t chunkEnd, unsigned slot) {
+            body(chunkBegin, chunkEnd, slot);
+        };
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job.active.fetch_add(1);
+            jobs.push_back(&job);
+        }
+        wakeup.notify_all();
+
+        runJob(job);
+
+        // Wait for helpers that joined before the job ran dry
+        while (job.active.load(std::memory_order_acquire) != 0) {
+            std::this_thread::yield();
+        }
+    }
+
+    void submit(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+        wakeup.notify_one();
+    }
+
+    // Runs queued tasks on the calling thread until `done()` holds
+    template <typename Predicate>
+    void helpUntil(Predicate&& done) {
+        while (!done()) {
+            if (!runOneTask()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+private:
+    bool runOneTask() {
+        std::function<void()> task;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty()) return false;
+            task = tasks.pop();
+        }
+        task();
+        return true;
+    }
+
+    struct ParallelJob {
+        std::atomic<size_t> next{0};
+        size_t end = 0;
+        size_t grain = 1;
+        std::function<void(size_t, size_t, unsigned)> body;
+        std::atomic<unsigned> slots{0};
+        std::atomic<unsigned> active{0};
+    };
+
+    // Runs chunks until the job is exhausted; `active` must already count us
+    void runJob(ParallelJob& job) {
+        const unsigned slot = job.slots.fetch_add(1);
+
+        for (;;) {
+            size_t chunkBegin = job.next.fetch_add(job.grain);
+            if (chunkBegin >= job.end) break;
+            size_t chunkEnd = std::min(job.end, chunkBegin + job.grain);
+            job.body(chunkBegin, chunkEnd, slot);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = std::find(jobs.begin(), jobs.end(), &job);
+            if (it != jobs.end()) jobs.erase(it);
+        }
+        job.active.fetch_sub(1, std::memory_order_release);
+    }
+
+    void workerLoop() {
+        for (;;) {
+            ParallelJob* job = nullptr;
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wakeup.wait(lock, [this]() { return stopping || !jobs.empty() || !tasks.empty(); });
+                if (stopping) return;
+
+                // Loop chunks first: they unblock a thread already waiting
+                if (!jobs.empty()) {
+                    job = jobs.front();
+                    if (job->next.load() >= job->end) {
+                        jobs.erase(jobs.begin());
+                        continue;
+                    }
+                    job->active.fetch_add(1);
+                } else {
+                    task = tasks.pop();
+                }
+            }
+            if (job) {
+                runJob(*job);
+            } else {
+                task();
+            }
+        }
+    }
+
+    std::vector<std::thread> workers;
+    // FIFO over a vector that keeps its capacity, so a steady stream of
+    // tasks stops allocating once the queue has reached its working size
+    class TaskQueue {
+    public:
+        bool empty() const { return head == items.size(); }
+        void push_back(std::function<void()> task) { items.push_back(std::move(task)); }
+        std::function<void()> pop() {
+            std::function<void()> task = std::move(items[head++]);
+            if (head == items.size()) {
+                items.clear();
+                head = 0;
+            } else if (head > 64 && head * 2 > items.size()) {
+                items.erase(items.begin(), items.begin() + head);
+                head = 0;
+            }
+            return task;
+        }
+
+    private:
+        std::vector<std::function<void()>> items;
+        size_t head = 0;
+    };
+
+    std::vector<ParallelJob*> jobs;
+    TaskQueue tasks;
+    std::mutex mutex;
+    std::condition_variable wakeup;
+    bool stopping = false;
+};
@@ -0,0 +1,72 @@
+// TimestepController.h
+// Adaptive global timestep selection (CFL-style) for the galaxy frame loop
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+
+// ============================================================================
+// Timestep Parameters
+// ============================================================================
+
+struct TimestepParams {
+    float courantFactor = 0.3f;            // η: safety factor applied to every criterion
+    float accelerationLength = 1.0f;       // ε: dt ≤ η·sqrt(ε / |a|max)
+    float velocityLength = 10.0f;          // ℓ: dt ≤ η·ℓ / |v|max (max distance per step)
+    float maxPhotonInteractions = 1.0f;    // dt ≤ η·k / ν, ν = interactions per photon per second
+    float minDeltaTime = 1.0e-4f;          // s
+    float maxDeltaTime = 0.1f;             // s
+    float initialDeltaTime = 1.0e-3f;      // s, used before any dynamics have been measured
+    float maxGrowth = 1.25f;               // dt may grow by at most this factor per frame
+};
+
+// ============================================================================
+// Timestep Controller
+// ============================================================================
+//
+// Picks the next frame's dt from quantities measured during the previous
+// frame: peak acceleration, peak speed and photon interaction frequency. The
+// smallest criterion wins, growth is rate-limited to avoid oscillation, and
+// the result is clamped to [minDeltaTime, maxDeltaTime] and to the caller's
+// upper bound (e.g. the time left until a simulation-time target).
+
+class TimestepController {
+public:
+    TimestepController() = default;
+    explicit TimestepController(const TimestepParams& params) : params(params) {}
+
+    const TimestepParams& getParams() const { return params; }
+
+    void reset() { previousDeltaTime = 0.0f; }
+
+    float nextDeltaTime(float maxAcceleration, float maxSpeed, float photonInteractionRate,
+                        float upperBound) {
+        float dt = params.maxDeltaTime;
+
+        if (previousDeltaTime <= 0.0f) {
+            dt = params.initialDeltaTime;
+        } else {
+            if (maxAcceleration > 0.0f) {
+                dt = std::min(dt, params.courantFactor * std::sqrt(params.accelerationLength / maxAcceleration));
+            }
+            if (maxSpeed > 0.0f) {
+                dt = std::min(dt, params.courantFactor * params.velocityLength / maxSpeed);
+            }
+            if (photonInteractionRate > 0.0f) {
+                dt = std::min(dt, params.courantFactor * params.maxPhotonInteractions / photonInteractionRate);
+            }
+            dt = std::min(dt, previousDeltaTime * params.maxGrowth);
+        }
+
+        dt = std::max(params.minDeltaTime, std::min(params.maxDeltaTime, dt));
+        previousDeltaTime = dt;
+
+        // The caller's bound may undercut minDeltaTime (landing on a target time)
+        return std::min(dt, upperBound);
+    }
+
+private:
+    TimestepParams params;
+    float previousDeltaTime = 0.0f;
+};
@@ -0,0 +1,477 @@
+// TrajectoryStream.h
+// Compressed per-frame position history with a bounded quantization error
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// Format
+// ============================================================================
+//
+// A position p is stored as the integer g = round(p / q), so q * g is
+// within q / 2 of p, and is decoded to the nearest float, which adds at
+// most the float spacing u at |p|. For every |p| <= extent the quantum is
+// q = 2 * (errorBound - u(extent)), so the decoded float is within
+// errorBound of p; a bound no larger than u(extent) cannot be met and is
+// rejected. The high bits of g name a spatial cell 65536 quanta wide and
+// the low 16 bits are the offset inside it.
+//
+// Keyframes store every neuron's cell and 16-bit offset per axis. The
+// frames after one store g minus a prediction: the previous recorded
+// frame's g for the first, then the straight-line extrapolation
+// 2 * g[t-1] - g[t-2], so a neuron coasting at any speed costs only its
+// change in velocity, a handful of bits. Both are zigzag-coded and
+// bit-packed in blocks of 128 values, each block using the width of its
+// largest value. Decoding is exact integer arithmetic, so residuals never
+// accumulate error.
+//
+// File: FileHeader, then per recorded frame a FrameHeader followed by
+// payloadBytes of packed blocks (x, y, z in turn).
+
+struct TrajectoryParams {
+    float errorBound = 0.01f;     // Maximum position error per coordinate
+    float extent = 10000.0f;      // Largest |coordinate| the bound is guaranteed for
+    int every = 1;                // Record every k-th frame
+    int keyframeInterval = 100;   // Recorded frames between keyframes
+    size_t queueDepth = 4;        // Frames buffered for the writer thread
+};
+
+namespace TrajectoryFormat {
+
+constexpr char MAGIC[8] = {'N', 'E', 'B', 'T', 'R', 'A', 'J', '3'};
+constexpr int OFFSET_BITS = 16;
+constexpr size_t BLOCK = 128;
+
+struct FileHeader {
+    char magic[8];
+    double quantum;
+    uint32_t every;
+    uint32_t keyframeInterval;
+    float errorBound;            // Guaranteed for coordinates within +-extent
+    float extent;
+};
+
+struct FrameHeader {
+    int64_t frame;
+    double time;
+    uint32_t count;              // Neurons in this frame
+    uint32_t keyframe;           // 1: absolute cells and offsets, 0: deltas
+    uint64_t payloadBytes;
+};
+
+// Spacing of floats just above |v|, an upper bound on the rounding error
+// of any float of magnitude at most |v|
+inline double floatSpacing(float v) {
+    const float a = std::abs(v);
+    return static_cast<double>(std::nextafter(a, INFINITY)) - a;
+}
+
+// Quantum meeting errorBound after decoding to float for |p| <= extent;
+// 0 when the bound is at or below float resolution there
+inline double quantumFor(float errorBound, float extent) {
+    const double margin = static_cast<double>(errorBound) - floatSpacing(extent);
+    return margin > 0.0 ? 2.0 * margin : 0.0;
+}
+
+inline uint64_t zigzag(int64_t v) { return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63); }
+inline int64_t unzigzag(uint64_t v) { return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1); }
+
+// Quantized coordinates are clamped to +-LIMIT so predictions and
+// residuals stay within int64
+constexpr double LIMIT = 1e18;
+
+// Prediction for a delta frame from the two frames before it; `older` is
+// empty for the first frame after a keyframe
+inline int64_t predict(const std::vector<int64_t>& previous, const std::vector<int64_t>& older, size_t i) {
+    return older.empty() ? previous[i] : 2 * previous[i] - older[i];
+}
+
+// Appends values in blocks of BLOCK: one width byte, then the values
+// little-endian at that many bits each
+inline void packBlocks(const uint64_t* values, size_t count, std::vector<uint8_t>& out) {
+    for (size_t begin = 0; begin < count; begin += BLOCK) {
+        const size_t end = std::min(count, begin + BLOCK);
+        uint64_t all = 0;
+        for (size_t i = begin; i < end; ++i) all |= values[i];
+        int width = 0;
+        while (width < 64 && (all >> width) != 0) ++width;
+        out.push_back(static_cast<uint8_t>(width));
+        if (width == 0) continue;
+
+        uint64_t buffer = 0;
+        int buffered = 0;
+        auto put = [&](uint64_t bits, int n) {
+            buffer |= bits << buffered;
+            buffered += n;
+            while (buffered >= 8) {
+                out.push_back(static_cast<uint8_t>(buffer));
+                buffer >>= 8;
+                buffered -= 8;
+            }
+        };
+        for (size_t i = begin; i < end; ++i) {
+            // At most 32 bits per put keeps the 64-bit buffer from overflowing
+            if (width > 32) {
+                put(values[i] & 0xFFFFFFFFull, 32);
+                put(values[i] >> 32, width - 32);
+            } else {
+                put(values[i], width);
+            }
+        }
+        if (buffered > 0) out.push_back(static_cast<uint8_t>(buffer));
+    }
+}
+
+// Reads `count` values written by packBlocks; returns the bytes consumed,
+// or 0 when the input ends early
+inline size_t unpackBlocks(const uint8_t* data, size_t bytes, uint64_t* values, size_t count) {
+    size_t pos = 0;
+    for (size_t begin = 0; begin < count; begin += BLOCK) {
+        const size_t end = std::min(count, begin + BLOCK);
+        if (pos >= bytes) return 0;
+        const int width = data[pos++];
+        if (width > 64) return 0;
+        const size_t blockBytes = ((end - begin) * width + 7) / 8;
+        if (pos + blockBytes > bytes) return 0;
+
+        uint64_t buffer = 0;
+        int buffered = 0;
+        size_t next = pos;
+        auto take = [&](int n) {
+            while (buffered < n) {
+                buffer |= static_cast<uint64_t>(data[next++]) << buffered;
+                buffered += 8;
+            }
+            const uint64_t bits = n == 64 ? buffer : buffer & ((1ull << n) - 1);
+            buffer = n == 64 ? 0 : buffer >> n;
+            buffered -= n;
+            return bits;
+        };
+        for (size_t i = begin; i < end; ++i) {
+            if (width > 32) {
+                const uint64_t low = take(32);
+                values[i] = low | (take(width - 32) << 32);
+            } else {
+                values[i] = width ? take(width) : 0;
+            }
+        }
+        pos += blockBytes;
+    }
+    return pos;
+}
+
+} // namespace TrajectoryFormat
+
+// ============================================================================
+// Trajectory Writer
+// ============================================================================
+//
+// record() copies the positions into a recycled frame buffer and returns;
+// a background thread quantizes, encodes and writes them in order. When
+// the writer falls queueDepth frames behind, record() waits rather than
+// dropping frames.
+
+class TrajectoryWriter {
+public:
+    TrajectoryWriter() = default;
+    ~TrajectoryWriter() { close(); }
+
+    TrajectoryWriter(const TrajectoryWriter&) = delete;
+    TrajectoryWriter& operator=(const TrajectoryWriter&) = delete;
+
+    bool open(const std::string& path, const TrajectoryParams& trajectoryParams) {
+        close();
+        params = trajectoryParams;
+        params.every = std::max(1, params.every);
+        params.keyframeInterval = std::max(1, params.keyframeInterval);
+        params.queueDepth = std::max<size_t>(1, params.queueDepth);
+        if (!(params.errorBound > 0.0f) || !(params.extent > 0.0f) || !std::isfinite(params.extent)) {
+            std::cerr << "Error: trajectory error bound and extent must be positive" << std::endl;
+            return false;
+        }
+        quantum = TrajectoryFormat::quantumFor(params.errorBound, params.extent);
+        if (quantum == 0.0) {
+            std::cerr << "Error: trajectory error bound " << params.errorBound
+                      << " is below float resolution at extent " << params.extent << std::endl;
+            return false;
+        }
+
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open file " << path << std::endl;
+            return false;
+        }
+        TrajectoryFormat::FileHeader header{};
+        std::memcpy(header.magic, TrajectoryFormat::MAGIC, sizeof(header.magic));
+        header.quantum = quantum;
+        header.every = static_cast<uint32_t>(params.every);
+        header.keyframeInterval = static_cast<uint32_t>(params.keyframeInterval);
+        header.errorBound = params.errorBound;
+        header.extent = params.extent;
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        bytesWritten = sizeof(header);
+
+        slots.assign(params.queueDepth, Slot());
+        freeSlots.clear();
+        for (size_t s = 0; s < slots.size(); ++s) freeSlots.push_back(s);
+        readySlots.assign(slots.size(), 0);
+        readyHead = readyCount = 0;
+        for (auto& axis : previous) axis.clear();
+        for (auto& axis : older) axis.clear();
+        recorded = 0;
+        beyondExtent = 0;
+        stopping = false;
+        writer = std::thread([this]() { writeLoop(); });
+        return true;
+    }
+
+    bool isOpen() const { return writer.joinable(); }
+
+    // Whether record() would store `frame`
+    bool due(long frame) const { return isOpen() && frame % params.every == 0; }
+
+    // Queues frame `frame`'s positions when it is due; positionAt(i) returns
+    // anything with x, y and z members
+    template <typename PositionAt>
+    void record(long frame, double time, size_t count, PositionAt&& positionAt) {
+        if (!due(frame)) return;
+        size_t s;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            slotFreed.wait(lock, [&]() { return !freeSlots.empty(); });
+            s = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        Slot& slot = slots[s];
+        slot.frame = frame;
+        slot.time = time;
+        slot.x.resize(count);
+        slot.y.resize(count);
+        slot.z.resize(count);
+        for (size_t i = 0; i < count; ++i) {
+            const auto p = positionAt(i);
+            slot.x[i] = p.x;
+            slot.y[i] = p.y;
+            slot.z[i] = p.z;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            readySlots[(readyHead + readyCount) % readySlots.size()] = s;
+            ++readyCount;
+        }
+        slotReady.notify_one();
+    }
+
+    // Writes everything queued, then stops the thread and closes the file
+    void close() {
+        if (!writer.joinable()) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        slotReady.notify_one();
+        writer.join();
+        file.close();
+    }
+
+    // Totals so far; exact once close() has returned
+    size_t framesWritten() const { return recorded; }
+    size_t bytes() const { return bytesWritten; }
+    // Coordinates recorded outside +-extent, where the bound is not guaranteed
+    size_t coordinatesBeyondExtent() const { return beyondExtent; }
+
+private:
+    struct Slot {
+        long frame = 0;
+        double time = 0.0;
+        std::vector<float> x, y, z;
+    };
+
+    void writeLoop() {
+        for (;;) {
+            size_t s;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                slotReady.wait(lock, [&]() { return readyCount > 0 || stopping; });
+                if (readyCount == 0) return;
+                s = readySlots[readyHead];
+                readyHead = (readyHead + 1) % readySlots.size();
+                --readyCount;
+            }
+            encode(slots[s]);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                freeSlots.push_back(s);
+            }
+            slotFreed.notify_one();
+        }
+    }
+
+    void encode(const Slot& slot) {
+        using namespace TrajectoryFormat;
+        const size_t n = slot.x.size();
+        const bool keyframe = recorded % params.keyframeInterval == 0 || n != previous[0].size();
+
+        payload.clear();
+        const std::vector<float>* axes[3] = {&slot.x, &slot.y, &slot.z};
+        for (int a = 0; a < 3; ++a) {
+            std::vector<int64_t>& prev = previous[a];
+            std::vector<int64_t>& old = older[a];
+            current.resize(n);
+            for (size_t i = 0; i < n; ++i) {
+                if (!(std::abs((*axes[a])[i]) <= params.extent)) ++beyondExtent;
+                const double v = static_cast<double>((*axes[a])[i]) / quantum;
+                current[i] = std::isfinite(v) ? std::llround(std::max(-LIMIT, std::min(LIMIT, v))) : 0;
+            }
+            codes.resize(n);
+            if (keyframe) {
+                for (size_t i = 0; i < n; ++i) codes[i] = zigzag(current[i] >> OFFSET_BITS);
+                packBlocks(codes.data(), n, payload);
+                for (size_t i = 0; i < n; ++i) codes[i] = static_cast<uint64_t>(current[i]) & 0xFFFF;
+                packBlocks(codes.data(), n, payload);
+                old.clear();
+                prev.swap(current);
+            } else {
+                for (size_t i = 0; i < n; ++i) codes[i] = zigzag(current[i] - predict(prev, old, i));
+                packBlocks(codes.data(), n, payload);
+                old.swap(prev);
+                prev.swap(current);
+            }
+        }
+
+        FrameHeader header{};
+        header.frame = slot.frame;
+        header.time = slot.time;
+        header.count = static_cast<uint32_t>(n);
+        header.keyframe = keyframe ? 1 : 0;
+        header.payloadBytes = payload.size();
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(payload.data()), static_cast<std::streamsize>(payload.size()));
+        bytesWritten += sizeof(header) + payload.size();
+        ++recorded;
+    }
+
+    TrajectoryParams params;
+    double quantum = 0.02;
+    std::ofstream file;
+
+    // Frame buffers handed between record() and the writer thread
+    std::vector<Slot> slots;
+    std::vector<size_t> freeSlots;
+    std::vector<size_t> readySlots;   // Ring of slot indices in frame order
+    size_t readyHead = 0, readyCount = 0;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable slotReady, slotFreed;
+    std::thread writer;
+
+    // Writer-thread state: the last two recorded frames, quantized
+    std::vector<int64_t> previous[3], older[3];
+    std::vector<int64_t> current;
+    std::vector<uint64_t> codes;
+    std::vector<uint8_t> payload;
+    std::atomic<size_t> recorded{0};
+    std::atomic<size_t> bytesWritten{0};
+    std::atomic<size_t> beyondExtent{0};
+};
+
+// ============================================================================
+// Trajectory Reader
+// ============================================================================
+
+struct TrajectoryFrame {
+    long frame = 0;
+    double time = 0.0;
+    bool keyframe = false;
+    std::vector<float> x, y, z;
+};
+
+class TrajectoryReader {
+public:
+    bool open(const std::string& path) {
+        file.close();
+        file.clear();
+        file.open(path, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open file " << path << std::endl;
+            return false;
+        }
+        if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+            std::memcmp(header.magic, TrajectoryFormat::MAGIC, sizeof(header.magic)) != 0) {
+            std::cerr << "Error: " << path << " is not a trajectory stream" << std::endl;
+            file.close();
+            return false;
+        }
+        for (auto& axis : previous) axis.clear();
+        for (auto& axis : older) axis.clear();
+        return true;
+    }
+
+    double quantum() const { return header.quantum; }
+    float errorBound() const { return header.errorBound; }
+    float extent() const { return header.extent; }
+
+    // Decodes the next recorded frame; false at the end of the stream or
+    // on a truncated or inconsistent record
+    bool next(TrajectoryFrame& out) {
+        using namespace TrajectoryFormat;
+        FrameHeader frameHeader{};
+        if (!file.is_open() || !file.read(reinterpret_cast<char*>(&frameHeader), sizeof(frameHeader))) return false;
+        payload.resize(frameHeader.payloadBytes);
+        if (!file.read(reinterpret_cast<char*>(payload.data()), static_cast<std::streamsize>(payload.size()))) {
+            return false;
+        }
+        const size_t n = frameHeader.count;
+        if (!frameHeader.keyframe && previous[0].size() != n) return false;
+
+        out.frame = static_cast<long>(frameHeader.frame);
+        out.time = frameHeader.time;
+        out.keyframe = frameHeader.keyframe != 0;
+        std::vector<float>* axes[3] = {&out.x, &out.y, &out.z};
+        codes.resize(n);
+        size_t pos = 0;
+        for (int a = 0; a < 3; ++a) {
+            std::vector<int64_t>& g = current[a];
+            g.resize(n);
+            size_t used = unpackBlocks(payload.data() + pos, payload.size() - pos, codes.data(), n);
+            if (used == 0 && n > 0) return false;
+            pos += used;
+            if (out.keyframe) {
+                for (size_t i = 0; i < n; ++i) g[i] = unzigzag(codes[i]) * (int64_t(1) << OFFSET_BITS);
+                used = unpackBlocks(payload.data() + pos, payload.size() - pos, codes.data(), n);
+                if (used == 0 && n > 0) return false;
+                pos += used;
+                for (size_t i = 0; i < n; ++i) g[i] += static_cast<int64_t>(codes[i]);
+                older[a].clear();
+            } else {
+                for (size_t i = 0; i < n; ++i) g[i] = predict(previous[a], older[a], i) + unzigzag(codes[i]);
+                older[a].swap(previous[a]);
+            }
+            previous[a].swap(g);
+            const std::vector<int64_t>& decoded = previous[a];
+            axes[a]->resize(n);
+            for (size_t i = 0; i < n; ++i) (*axes[a])[i] = static_cast<float>(decoded[i] * header.quantum);
+        }
+        return true;
+    }
+
+private:
+    std::ifstream file;
+    TrajectoryFormat::FileHeader header{};
+    std::vector<int64_t> previous[3], older[3], current[3];
+    std::vector<uint64_t> codes;
+    std::vector<uint8_t> payload;
+};
@@ -0,0 +1,215 @@
+// NEBULA EMERGENT Accuracy-versus-Cost Harness
+// Author: Francisco Angulo de Lafuente - NEBULA Team
+//
+// Runs the same seeded galaxy through every gravity mode for K frames and
+// reports, per mode:
+//   - RMS force error relative to exact all-pairs gravity on the same state
+//   - relative total-energy drift of the dynamics over the run (stellar
+//     and pattern phases are held back while measuring)
+//   - total connection-count error against the exact-mode run
+//   - wall time per frame (whole frame and dynamics phase)
+// as a table on stdout and as JSON (stdout or --json=<file>).
+
+#include "../src/NEBULA_EMERGENT_CORE.h"
+
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+struct ModeSpec {
+    std::string name;
+    GravityMode gravity;
+};
+
+struct ModeResult {
+    std::string name;
+    double rmsForceError = 0.0;
+    double energyDrift = 0.0;
+    double connectionError = 0.0;
+    long connections = 0;
+    double frameMs = 0.0;
+    double dynamicsMs = 0.0;
+};
+
+struct HarnessConfig {
+    int neurons = 2000;
+    int photons = 500;
+    int frames = 10;
+    unsigned seed = 42;
+    float deltaTime = 0.016f;
+    std::string jsonPath;
+};
+
+static bool parseArgs(int argc, char** argv, HarnessConfig& config) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&](const char* prefix) -> const char* {
+            size_t len = std::string(prefix).size();
+            return arg.compare(0, len, prefix) == 0 ? argv[i] + len : nullptr;
+        };
+
+        if (const char* v = value("--neurons=")) config.neurons = std::atoi(v);
+        else if (const char* v = value("--photons=")) config.photons = std::atoi(v);
+        else if (const char* v = value("--frames=")) config.frames = std::atoi(v);
+        else if (const char* v = value("--seed=")) config.seed = static_cast<unsigned>(std::strtoul(v, nullptr, 10));
+        else if (const char* v = value("--dt=")) config.deltaTime = std::strtof(v, nullptr);
+        else if (const char* v = value("--json=")) config.jsonPath = v;
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            std::cerr << "Usage: accuracy_harness [--neurons=N] [--photons=P] [--frames=K] "
+                         "[--seed=S] [--dt=DT] [--json=FILE]" << std::endl;
+            return false;
+        }
+    }
+    return config.neurons > 1 && config.frames > 0;
+}
+
+static ModeResult runMode(const ModeSpec& mode, const HarnessConfig& config) {
+    NEBULAEmergentGalaxy galaxy(config.neurons, config.photons, config.seed);
+    galaxy.setGravityMode(mode.gravity);
+    // Stellar mass loss and pattern passes are independent of the force
+    // mode, so they are held back and the energy drift is the dynamics
+    // step's own. Photons and connections stay on: they move no mass and
+    // the connection count is compared across modes.
+    PhaseSchedule held;
+    held.policy = PhasePolicy::OnDemand;
+    galaxy.setPhaseSchedule(PhaseId::Stellar, held);
+    galaxy.setPhaseSchedule(PhaseId::Patterns, held);
+
+    ModeResult result;
+    result.name = mode.name;
+
+    const double initialEnergy = galaxy.totalEnergy();
+    std::vector<Vector3> approx, exact;
+    double errorSquared = 0.0;
+    double referenceSquared = 0.0;
+    double frameSeconds = 0.0;
+    double dynamicsSeconds = 0.0;
+    // Sample indices come from a local stream, decorrelated from the galaxy's
+    // own seed, so measuring never perturbs the run
+    std::seed_seq samplerSeed{config.seed, 1u};
+    std::mt19937 sampler(samplerSeed);
+
+    for (int frame = 0; frame < config.frames; ++frame) {
+        // Force error is measured on the state this mode is about to advance
+        galaxy.computeAccelerations(mode.gravity, approx, sampler);
+        galaxy.computeAccelerations(GravityMode::ExactTiled, exact, sampler);
+        for (size_t i = 0; i < exact.size(); ++i) {
+            Vector3 diff = approx[i] - exact[i];
+            float diffMag = diff.magnitude();
+            float refMag = exact[i].magnitude();
+            errorSquared += diffMag * diffMag;
+            referenceSquared += refMag * refMag;
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        galaxy.evolveFrame(config.deltaTime);
+        frameSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        dynamicsSeconds += galaxy.getFrameStats().timings.dynamics;
+    }
+
+    const double finalEnergy = galaxy.totalEnergy();
+    result.rmsForceError = referenceSquared > 0.0 ? std::sqrt(errorSquared / referenceSquared) : 0.0;
+    result.energyDrift = initialEnergy != 0.0 ? std::abs(finalEnergy - initialEnergy) / std::abs(initialEnergy) : 0.0;
+    result.connections = galaxy.totalConnections();
+    result.frameMs = 1000.0 * frameSeconds / config.frames;
+    result.dynamicsMs = 1000.0 * dynamicsSeconds / config.frames;
+    return result;
+}
+
+static void printTable(const std::vector<ModeResult>& results) {
+    std::cout << std::left << std::setw(12) << "mode"
+              << std::right << std::setw(14) << "rms_force_err"
+              << std::setw(14) << "energy_drift"
+              << std::setw(14) << "conn_err"
+              << std::setw(12) << "frame_ms"
+              << std::setw(14) << "dynamics_ms" << std::endl;
+
+    for (const auto& r : results) {
+        std::cout << std::left << std::setw(12) << r.name << std::right << std::scientific << std::setprecision(3)
+                  << std::setw(14) << r.rmsForceError
+                  << std::setw(14) << r.energyDrift
+                  << std::setw(14) << r.connectionError
+                  << std::fixed << std::setprecision(2)
+                  << std::setw(12) << r.frameMs
+                  << std::setw(14) << r.dynamicsMs << std::endl;
+    }
+    std::cout.unsetf(std::ios::floatfield);
+}
+
+static std::string toJson(const HarnessConfig& config, const std::vector<ModeResult>& results) {
+    std::ostringstream json;
+    json << std::setprecision(9);
+    json << "{\n";
+    json << "  \"neurons\": " << config.neurons << ",\n";
+    json << "  \"photons\": " << config.photons << ",\n";
+    json << "  \"frames\": " << config.frames << ",\n";
+    json << "  \"seed\": " << config.seed << ",\n";
+    json << "  \"dt\": " << config.deltaTime << ",\n";
+    json << "  \"modes\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        json << "    {\"mode\": \"" << r.name << "\""
+             << ", \"rms_force_error\": " << r.rmsForceError
+             << ", \"energy_drift\": " << r.energyDrift
+             << ", \"connection_error\": " << r.connectionError
+             << ", \"connections\": " << r.connections
+             << ", \"frame_ms\": " << r.frameMs
+             << ", \"dynamics_ms\": " << r.dynamicsMs << "}"
+             << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    json << "  ]\n";
+    json << "}\n";
+    return json.str();
+}
+
+int main(int argc, char** argv) {
+    HarnessConfig config;
+    if (!parseArgs(argc, argv, config)) return 1;
+
+    std::cout << "📏 NEBULA EMERGENT Accuracy-versus-Cost Harness" << std::endl;
+    std::cout << "================================================" << std::endl;
+    std::cout << "Neurons: " << config.neurons << ", Photons: " << config.photons
+              << ", Frames: " << config.frames << ", Seed: " << config.seed << std::endl;
+
+    // The exact mode runs first: it is the reference for connection counts
+    std::vector<ModeSpec> modes = {
+        {gravityModeName(GravityMode::ExactTiled), GravityMode::ExactTiled},
+        {gravityModeName(GravityMode::Sampled), GravityMode::Sampled},
+    };
+
+    std::vector<ModeResult> results;
+    for (const auto& mode : modes) {
+        results.push_back(runMode(mode, config));
+    }
+
+    const long referenceConnections = results.front().connections;
+    for (auto& r : results) {
+        r.connectionError = referenceConnections > 0
+            ? std::abs(static_cast<double>(r.connections - referenceConnections)) / referenceConnections
+            : 0.0;
+    }
+
+    std::cout << std::endl;
+    printTable(results);
+
+    std::string json = toJson(config, results);
+    if (config.jsonPath.empty()) {
+        std::cout << std::endl << json;
+    } else {
+        std::ofstream file(config.jsonPath);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not open file " << config.jsonPath << std::endl;
+            return 1;
+        }
+        file << json;
+        std::cout << "\n✅ Results written to " << config.jsonPath << std::endl;
+    }
+
+    return 0;
+}
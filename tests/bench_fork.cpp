@@ -0,0 +1,137 @@
+// NEBULA EMERGENT Fork Benchmark
+// Author: Francisco Angulo de Lafuente - NEBULA Team
+//
+// Branches one galaxy into many what-if variants with copy-on-write fork()
+// and compares memory and time against deep-copying the neuron and photon
+// arrays per branch. Also checks that a fork evolves exactly like its parent
+// and that writes to a branch never reach the parent.
+
+#include "../src/NEBULA_EMERGENT_CORE.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+template <typename Array>
+static double uniqueMegabytes(const Array& array) {
+    const size_t unique = array.chunkCount() - array.sharedChunkCount();
+    return unique * Array::chunkBytes() / (1024.0 * 1024.0);
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// A fork must reproduce its parent bit for bit, and a branch's writes must
+// leave the parent untouched
+static bool checkForkSemantics() {
+    GalaxyOptions options;
+    options.verbose = false;
+    NEBULAEmergentGalaxy parent(1500, 300, 11, options);
+    parent.evolveFrame(0.01f);
+
+    auto twin = parent.fork();
+    auto branch = parent.fork();
+    branch->perturbVelocities(Vector3(0, 0, 0), 500.0f, Vector3(50.0f, 0.0f, 0.0f));
+    for (int f = 0; f < 3; ++f) {
+        parent.evolveFrame(0.01f);
+        twin->evolveFrame(0.01f);
+        branch->evolveFrame(0.01f);
+    }
+
+    bool identical = true;
+    bool diverged = false;
+    const auto& a = parent.getNeurons();
+    const auto& b = twin->getNeurons();
+    const auto& c = branch->getNeurons();
+    for (size_t i = 0; i < a.size(); ++i) {
+        identical = identical && a[i].position.x == b[i].position.x && a[i].velocity.y == b[i].velocity.y &&
+                    a[i].luminosity == b[i].luminosity && a[i].temperature == b[i].temperature;
+        diverged = diverged || a[i].position.x != c[i].position.x;
+    }
+    std::cout << "Fork reproduces parent: " << (identical ? "PASS" : "FAIL") << std::endl;
+    std::cout << "Branch writes isolated: " << (diverged ? "PASS" : "FAIL") << std::endl;
+    return identical && diverged;
+}
+
+int main(int argc, char** argv) {
+    int neurons = 200000;
+    int photons = 20000;
+    int branches = 20;
+    float radius = 300.0f;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--neurons=", 0) == 0) neurons = std::atoi(arg.c_str() + 10);
+        else if (arg.rfind("--photons=", 0) == 0) photons = std::atoi(arg.c_str() + 10);
+        else if (arg.rfind("--branches=", 0) == 0) branches = std::atoi(arg.c_str() + 11);
+        else if (arg.rfind("--radius=", 0) == 0) radius = std::strtof(arg.c_str() + 9, nullptr);
+        else {
+            std::cerr << "Usage: bench_fork [--neurons=N] [--photons=N] [--branches=B] [--radius=R]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "🌿 NEBULA EMERGENT Fork Benchmark" << std::endl;
+    std::cout << "================================================" << std::endl;
+    if (!checkForkSemantics()) return 1;
+
+    GalaxyOptions options;
+    options.verbose = false;
+    NEBULAEmergentGalaxy galaxy(neurons, photons, 7, options);
+    std::cout << "\nGalaxy: " << neurons << " neurons, " << photons << " photons, "
+              << branches << " branches" << std::endl;
+
+    // Baseline: every branch deep-copies the state arrays
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::vector<Neuron>> neuronCopies;
+    std::vector<std::vector<Photon>> photonCopies;
+    for (int b = 0; b < branches; ++b) {
+        neuronCopies.emplace_back(galaxy.getNeurons().begin(), galaxy.getNeurons().end());
+        photonCopies.emplace_back(galaxy.getPhotons().begin(), galaxy.getPhotons().end());
+    }
+    const double copySeconds = secondsSince(start);
+    const double copyMegabytes = branches * (neurons * sizeof(Neuron) + photons * sizeof(Photon)) / (1024.0 * 1024.0);
+    neuronCopies.clear();
+    photonCopies.clear();
+
+    // Copy-on-write forks
+    start = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<NEBULAEmergentGalaxy>> forks;
+    for (int b = 0; b < branches; ++b) forks.push_back(galaxy.fork());
+    const double forkSeconds = secondsSince(start);
+
+    double forkMegabytes = 0.0;
+    for (const auto& f : forks) forkMegabytes += uniqueMegabytes(f->getNeurons()) + uniqueMegabytes(f->getPhotons());
+
+    // Each branch perturbs its own region of the galaxy
+    start = std::chrono::steady_clock::now();
+    long touched = 0;
+    for (int b = 0; b < branches; ++b) {
+        float angle = 6.2831853f * b / branches;
+        Vector3 center(600.0f * std::cos(angle), 0.0f, 600.0f * std::sin(angle));
+        touched += forks[b]->perturbVelocities(center, radius, Vector3(0.0f, 5.0f, 0.0f));
+    }
+    const double perturbSeconds = secondsSince(start);
+
+    double branchMegabytes = 0.0;
+    for (const auto& f : forks) branchMegabytes += uniqueMegabytes(f->getNeurons()) + uniqueMegabytes(f->getPhotons());
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\n" << std::left << std::setw(28) << "strategy" << std::right
+              << std::setw(12) << "time_ms" << std::setw(14) << "private_MB" << std::endl;
+    std::cout << std::left << std::setw(28) << "deep copy" << std::right
+              << std::setw(12) << 1000.0 * copySeconds << std::setw(14) << copyMegabytes << std::endl;
+    std::cout << std::left << std::setw(28) << "fork" << std::right
+              << std::setw(12) << 1000.0 * forkSeconds << std::setw(14) << forkMegabytes << std::endl;
+    std::cout << std::left << std::setw(28) << "fork + regional perturbation" << std::right
+              << std::setw(12) << 1000.0 * (forkSeconds + perturbSeconds) << std::setw(14) << branchMegabytes
+              << std::endl;
+    std::cout << "\nPerturbed " << touched << " neurons in total ("
+              << 100.0 * touched / (static_cast<double>(neurons) * branches) << "% per branch on average)" << std::endl;
+    std::cout << "Note: neurons are stored in generation order, so a spatial region still" << std::endl;
+    std::cout << "touches many chunks; a full evolveFrame writes every chunk." << std::endl;
+    return 0;
+}
@@ -0,0 +1,195 @@
+// NEBULA EMERGENT Integrator Benchmark
+// Author: Francisco Angulo de Lafuente - NEBULA Team
+//
+// Integrates one softened Plummer sphere (G = 1, total mass 1) with each
+// compile-time integrator policy over a sweep of timesteps, records the
+// relative energy error and cost, then reports the cheapest timestep each
+// scheme needs to stay within a set of energy-error budgets.
+
+#include "../src/AllPairsGravity.h"
+#include "../src/Integrators.h"
+#include "../src/ThreadPool.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+struct PlummerSphere {
+    std::vector<float> x, y, z, vx, vy, vz, m;
+};
+
+static PlummerSphere makePlummer(size_t count, unsigned seed) {
+    PlummerSphere p;
+    for (auto* v : {&p.x, &p.y, &p.z, &p.vx, &p.vy, &p.vz, &p.m}) v->resize(count);
+
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    auto isotropic = [&](double magnitude, float& ox, float& oy, float& oz) {
+        double cosTheta = 2.0 * uniform(gen) - 1.0;
+        double sinTheta = std::sqrt(1.0 - cosTheta * cosTheta);
+        double phi = 2.0 * M_PI * uniform(gen);
+        ox = static_cast<float>(magnitude * sinTheta * std::cos(phi));
+        oy = static_cast<float>(magnitude * sinTheta * std::sin(phi));
+        oz = static_cast<float>(magnitude * cosTheta);
+    };
+
+    // Aarseth, Hénon & Wielen (1974) sampling, scale radius 1
+    for (size_t i = 0; i < count; ++i) {
+        double r;
+        do {
+            r = 1.0 / std::sqrt(std::pow(uniform(gen), -2.0 / 3.0) - 1.0);
+        } while (r > 10.0);
+        isotropic(r, p.x[i], p.y[i], p.z[i]);
+
+        double q, g;
+        do {
+            q = uniform(gen);
+            g = 0.1 * uniform(gen);
+        } while (g > q * q * std::pow(1.0 - q * q, 3.5));
+        double escape = std::sqrt(2.0) * std::pow(1.0 + r * r, -0.25);
+        isotropic(q * escape, p.vx[i], p.vy[i], p.vz[i]);
+
+        p.m[i] = 1.0f / count;
+    }
+    return p;
+}
+
+static double totalEnergy(const PlummerSphere& p, const GravityParams& params,
+                          AllPairsGravity& gravity, ThreadPool& pool) {
+    double kinetic = 0.0;
+    for (size_t i = 0; i < p.m.size(); ++i) {
+        double v2 = double(p.vx[i]) * p.vx[i] + double(p.vy[i]) * p.vy[i] + double(p.vz[i]) * p.vz[i];
+        kinetic += 0.5 * p.m[i] * v2;
+    }
+    return kinetic + gravity.potentialEnergy(p.x.data(), p.y.data(), p.z.data(), p.m.data(),
+                                             p.m.size(), params, pool);
+}
+
+struct RunResult {
+    std::string scheme;
+    double dt = 0.0;
+    double energyError = 0.0;
+    long forceEvaluations = 0;
+    double wallMs = 0.0;
+};
+
+template <typename Integrator>
+static void sweep(const PlummerSphere& initial, double horizon, const std::vector<double>& timesteps,
+                  ThreadPool& pool, std::vector<RunResult>& results) {
+    GravityParams params;
+    params.gravitationalConstant = 1.0f;
+    params.minDistanceSquared = 0.0f;
+    params.softeningSquared = 0.01f * 0.01f;
+    AllPairsGravity gravity;
+
+    for (double dt : timesteps) {
+        PlummerSphere p = initial;
+        const double e0 = totalEnergy(p, params, gravity, pool);
+
+        DynamicsState state;
+        state.x = p.x.data();
+        state.y = p.y.data();
+        state.z = p.z.data();
+        state.vx = p.vx.data();
+        state.vy = p.vy.data();
+        state.vz = p.vz.data();
+        state.count = p.m.size();
+
+        IntegratorWorkspace workspace;
+        auto accel = [&](const float* x, const float* y, const float* z, float* ax, float* ay, float* az) {
+            gravity.computeAccelerations(x, y, z, p.m.data(), p.m.size(), ax, ay, az, params, pool);
+        };
+
+        const long steps = std::lround(horizon / dt);
+        double maxError = 0.0;
+        double seconds = 0.0;
+        for (long s = 0; s < steps; ++s) {
+            auto start = std::chrono::steady_clock::now();
+            Integrator::step(state, static_cast<float>(dt), workspace, accel);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            if ((s + 1) % std::max(1L, steps / 8) == 0 || s + 1 == steps) {
+                double e = totalEnergy(p, params, gravity, pool);
+                maxError = std::max(maxError, std::abs((e - e0) / e0));
+            }
+        }
+
+        RunResult r;
+        r.scheme = Integrator::NAME;
+        r.dt = dt;
+        r.energyError = maxError;
+        r.forceEvaluations = workspace.forceEvaluations;
+        r.wallMs = 1000.0 * seconds;
+        results.push_back(r);
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t bodies = 512;
+    double horizon = 2.0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--bodies=", 0) == 0) bodies = std::strtoul(arg.c_str() + 9, nullptr, 10);
+        else if (arg.rfind("--time=", 0) == 0) horizon = std::strtod(arg.c_str() + 7, nullptr);
+        else {
+            std::cerr << "Usage: bench_integrators [--bodies=N] [--time=T]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::cout << "⏱️  NEBULA EMERGENT Integrator Benchmark" << std::endl;
+    std::cout << "================================================" << std::endl;
+    std::cout << "Plummer sphere: " << bodies << " bodies, horizon " << horizon << " (N-body units)" << std::endl;
+
+    ThreadPool pool;
+    PlummerSphere initial = makePlummer(bodies, 2025);
+    const std::vector<double> timesteps = {1.0 / 8, 1.0 / 16, 1.0 / 32, 1.0 / 64, 1.0 / 128, 1.0 / 256, 1.0 / 512};
+
+    std::vector<RunResult> results;
+    sweep<SemiImplicitEuler>(initial, horizon, timesteps, pool, results);
+    sweep<VelocityVerlet>(initial, horizon, timesteps, pool, results);
+    sweep<Yoshida4>(initial, horizon, timesteps, pool, results);
+    sweep<RungeKutta4>(initial, horizon, timesteps, pool, results);
+
+    std::cout << "\n" << std::left << std::setw(18) << "scheme" << std::right
+              << std::setw(10) << "dt" << std::setw(14) << "energy_err"
+              << std::setw(12) << "force_evals" << std::setw(12) << "wall_ms" << std::endl;
+    for (const auto& r : results) {
+        std::cout << std::left << std::setw(18) << r.scheme << std::right
+                  << std::setw(10) << std::setprecision(4) << r.dt
+                  << std::setw(14) << std::scientific << std::setprecision(3) << r.energyError
+                  << std::setw(12) << r.forceEvaluations
+                  << std::setw(12) << std::fixed << std::setprecision(1) << r.wallMs << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+    }
+
+    // Equal-accuracy comparison: cheapest run of each scheme within budget
+    std::cout << "\nCost at equal accuracy (cheapest run meeting each energy-error budget):" << std::endl;
+    for (double budget : {1e-3, 1e-4, 1e-5}) {
+        std::cout << "  budget " << std::scientific << std::setprecision(0) << budget << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+        for (const char* scheme : {SemiImplicitEuler::NAME, VelocityVerlet::NAME, Yoshida4::NAME, RungeKutta4::NAME}) {
+            const RunResult* best = nullptr;
+            for (const auto& r : results) {
+                if (r.scheme != scheme || r.energyError > budget) continue;
+                if (!best || r.forceEvaluations < best->forceEvaluations) best = &r;
+            }
+            std::cout << "    " << std::left << std::setw(18) << scheme << std::right;
+            if (best) {
+                std::cout << "dt=" << std::setw(9) << std::setprecision(4) << best->dt
+                          << "  force_evals=" << std::setw(6) << best->forceEvaluations
+                          << "  wall_ms=" << std::fixed << std::setprecision(1) << best->wallMs << std::endl;
+                std::cout.unsetf(std::ios::floatfield);
+            } else {
+                std::cout << "not reached in sweep" << std::endl;
+            }
+        }
+    }
+
+    return 0;
+}
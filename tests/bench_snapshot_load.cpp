@@ -0,0 +1,119 @@
+// NEBULA EMERGENT Snapshot Loader Benchmark
+// Author: Francisco Angulo de Lafuente - NEBULA Team
+//
+// Writes a large snapshot in the saveState() format, then times the
+// parallel mmap/from_chars loader against a plain ifstream >> reader and
+// restoring a galaxy from the file. The loaded values must match the
+// stream reader's exactly.
+
+#include "../src/NEBULA_EMERGENT_CORE.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void writeSnapshot(const std::string& path, size_t neurons) {
+    std::ofstream file(path);
+    file << "# NEBULA EMERGENT Galaxy State" << std::endl;
+    file << "# Time: 3.2" << std::endl;
+    file << "# Neurons: " << neurons << std::endl;
+    file << "# Format: x y z vx vy vz mass luminosity temperature" << std::endl;
+    std::mt19937 rng(7);
+    std::normal_distribution<float> normal(0.0f, 1.0f);
+    std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+    for (size_t i = 0; i < neurons; ++i) {
+        float mass = uniform(rng) * 2.0f + 0.5f;
+        float temperature = uniform(rng) * 5000.0f + 2000.0f;
+        file << normal(rng) * 500.0f << " " << normal(rng) * 50.0f << " " << normal(rng) * 500.0f << " "
+             << normal(rng) * 0.3f << " " << normal(rng) * 5.0f << " " << normal(rng) * 0.3f << " "
+             << mass << " " << mass * temperature / 5778.0f << " " << temperature << "\n";
+    }
+}
+
+// The obvious reader, for comparison
+static bool streamLoad(const std::string& path, std::vector<float>& values) {
+    std::ifstream file(path);
+    std::string line;
+    values.clear();
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        std::istringstream fields(line);
+        float v;
+        while (fields >> v) values.push_back(v);
+    }
+    return !values.empty();
+}
+
+int main(int argc, char** argv) {
+    size_t neurons = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const std::string path = "/tmp/nebula_bench_snapshot_" + std::to_string(getpid()) + ".txt";
+
+    std::cout << "📊 NEBULA EMERGENT Snapshot Loader Benchmark" << std::endl;
+    std::cout << "================================================" << std::endl;
+    auto start = std::chrono::steady_clock::now();
+    writeSnapshot(path, neurons);
+    std::cout << "   Wrote " << neurons << " lines in " << std::setprecision(3) << secondsSince(start) << " s"
+              << std::endl;
+
+    start = std::chrono::steady_clock::now();
+    std::vector<float> reference;
+    streamLoad(path, reference);
+    const double streamSeconds = secondsSince(start);
+
+    std::cout << "\n" << std::setw(8) << "threads" << std::setw(12) << "load_ms" << std::setw(12) << "speedup"
+              << std::setw(10) << "match" << std::endl;
+    std::cout << std::setw(8) << "stream" << std::fixed << std::setprecision(2) << std::setw(12)
+              << streamSeconds * 1e3 << std::setw(12) << 1.0 << std::setw(10) << "-" << std::endl;
+
+    bool allMatch = true;
+    const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= hardware; threads *= 2) {
+        ThreadPool pool(threads);
+        SnapshotData snapshot;
+        double best = 1e30;
+        for (int repeat = 0; repeat < 3; ++repeat) {
+            start = std::chrono::steady_clock::now();
+            SnapshotLoader::load(path, pool, snapshot);
+            best = std::min(best, secondsSince(start));
+        }
+        bool match = snapshot.size() * SNAPSHOT_FIELDS == reference.size();
+        for (size_t i = 0; match && i < snapshot.size(); ++i) {
+            for (size_t f = 0; f < SNAPSHOT_FIELDS; ++f) {
+                match = match && snapshot.columns[f][i] == reference[i * SNAPSHOT_FIELDS + f];
+            }
+        }
+        allMatch = allMatch && match;
+        std::cout << std::setw(8) << threads << std::setw(12) << best * 1e3 << std::setw(12)
+                  << streamSeconds / best << std::setw(10) << (match ? "yes" : "NO") << std::endl;
+        if (threads == hardware) break;
+        if (threads * 2 > hardware) threads = hardware / 2;
+    }
+
+    GalaxyOptions options;
+    options.verbose = false;
+    NEBULAEmergentGalaxy galaxy(1000, 0, 1, options);
+    start = std::chrono::steady_clock::now();
+    const bool restored = galaxy.loadState(path);
+    std::cout << "\n   Galaxy restore: " << secondsSince(start) * 1e3 << " ms, "
+              << galaxy.getNeurons().size() << " neurons at t=" << galaxy.getSimulationTime() << std::endl;
+    std::cout.unsetf(std::ios::floatfield);
+
+    unlink(path.c_str());
+    const bool pass = allMatch && restored && galaxy.getNeurons().size() == neurons;
+    std::cout << "   Result: " << (pass ? "PASS" : "FAIL") << std::endl;
+    return pass ? 0 : 1;
+}
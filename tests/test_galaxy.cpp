@@ -0,0 +1,598 @@
+// NEBULA EMERGENT Galaxy Integration Test Suite
+// Author: Francisco Angulo de Lafuente - NEBULA Team
+//
+// Exercises whole galaxies through NEBULAEmergentGalaxy, where the physics
+// suite tests each component on synthetic particles.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#define NEBULA_COUNT_HEAP_ALLOCATIONS
+#include "../src/NEBULA_EMERGENT_CORE.h"
+#include "../src/TrajectoryStream.h"
+
+class GalaxyValidator {
+public:
+    static bool testSnapshotCompleteness() {
+        std::cout << "Testing snapshots of streamed and coarsened galaxies..." << std::endl;
+
+        NEBULAEmergentGalaxy galaxy(3000, 100, 7, quiet());
+        const double mass0 = totalMass(galaxy.getNeurons());
+
+        // Far cells streamed out (frozen and on disk), then the rest folded
+        // into superparticles outside a small radius
+        char scratch[] = "/tmp/nebula_galaxy_XXXXXX";
+        if (!mkdtemp(scratch)) return false;
+        galaxy.setObservers({Vector3(1500, 0, 0)});
+        StreamingParams streaming;
+        streaming.enabled = true;
+        streaming.activeRadius = 800.0f;
+        streaming.frozenRadius = 1500.0f;
+        streaming.directory = scratch;
+        galaxy.setStreamingParams(streaming);
+        galaxy.updateStreaming();
+        LodParams lod;
+        lod.enabled = true;
+        lod.refineRadius = 300.0f;
+        galaxy.setLodParams(lod);
+        galaxy.updateLevelOfDetail();
+        const bool held = galaxy.frozenNeuronCount() > 0 && galaxy.evictedNeuronCount() > 0 &&
+                          galaxy.superparticleCount() > 0 && galaxy.getNeurons().size() < 3000;
+
+        const std::string path = std::string(scratch) + "/snapshot.txt";
+        galaxy.saveState(path);
+        NEBULAEmergentGalaxy restored(10, 10, 7, quiet());
+        const bool loaded = restored.loadState(path);
+        const double mass1 = totalMass(restored.getNeurons());
+        bool individual = true;
+        for (const Neuron& n : restored.getNeurons()) individual = individual && n.superparticle < 0;
+
+        const bool complete = loaded && restored.getNeurons().size() == 3000 && individual &&
+                              std::abs(mass1 - mass0) < 1e-5 * mass0 &&
+                              galaxy.representedNeuronCount() == 3000;
+        std::remove(path.c_str());
+
+        bool result = held && complete;
+        std::cout << "  Simulated entries: " << galaxy.getNeurons().size() << ", frozen: "
+                  << galaxy.frozenNeuronCount() << ", on disk: " << galaxy.evictedNeuronCount()
+                  << ", restored: " << restored.getNeurons().size() << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+
+        galaxy.setStreamingParams(StreamingParams());
+        galaxy.updateStreaming();
+        rmdir(scratch);
+        return result;
+    }
+
+    static bool testDiversityDimmingPersists() {
+        std::cout << "Testing that diversity pressure outlasts stellar evolution..." << std::endl;
+
+        // Twin galaxies; one gets a pressure-only pass (no noise, no
+        // inhibition, no kicks), then both take a frame
+        NEBULAEmergentGalaxy plain(3000, 100, 11, quiet());
+        NEBULAEmergentGalaxy pressured(3000, 100, 11, quiet());
+        ClusterParams clusters;
+        clusters.epsilon = 150.0f;
+        pressured.setClusterParams(clusters);
+        DiversityParams params;
+        params.enabled = true;
+        params.initialTemperature = params.minTemperature = 0.0f;
+        params.brightThreshold = 1e9f;
+        params.perturbEvery = 1 << 30;
+        params.updateEvery = 1 << 30;
+        pressured.setDiversityParams(params);
+        const size_t count = pressured.updateDiversity().pressured;
+
+        const auto& before = pressured.getNeurons();
+        std::vector<bool> hit(before.size());
+        for (size_t i = 0; i < before.size(); ++i) {
+            hit[i] = before[i].luminosity < 0.9f * plain.getNeurons()[i].luminosity;
+        }
+        plain.evolveFrame(0.016f);
+        pressured.evolveFrame(0.016f);
+
+        double dimmedRatio = 0.0, otherRatio = 0.0;
+        size_t dimmed = 0, others = 0;
+        const auto& a = plain.getNeurons();
+        const auto& b = pressured.getNeurons();
+        for (size_t i = 0; i < a.size(); ++i) {
+            const double ratio = b[i].luminosity / a[i].luminosity;
+            if (hit[i]) {
+                dimmedRatio += ratio;
+                ++dimmed;
+            } else {
+                otherRatio += ratio;
+                ++others;
+            }
+        }
+        dimmedRatio /= std::max<size_t>(dimmed, 1);
+        otherRatio /= std::max<size_t>(others, 1);
+
+        const float factor = params.pressureDimming * params.pressureEnergyLoss;
+        bool result = count > 300 && dimmed == count && std::abs(dimmedRatio - factor) < 0.02 &&
+                      std::abs(otherRatio - 1.0) < 0.02;
+        std::cout << "  Pressured: " << count << ", luminosity ratio after a frame: " << dimmedRatio
+                  << " (others " << otherRatio << ")" << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+
+    static bool testSuperparticleStellarEvolution() {
+        std::cout << "Testing stellar evolution of coarsened regions..." << std::endl;
+
+        // The same galaxy run fine and with everything folded into
+        // superparticles (observer far away, no passes afterwards)
+        NEBULAEmergentGalaxy fine(2000, 100, 13, quiet());
+        NEBULAEmergentGalaxy coarse(2000, 100, 13, quiet());
+        coarse.setObservers({Vector3(100000, 0, 0)});
+        LodParams lod;
+        lod.enabled = true;
+        lod.refineRadius = 300.0f;
+        lod.updateEvery = 1 << 30;
+        coarse.setLodParams(lod);
+        coarse.updateLevelOfDetail();
+        const size_t entries = coarse.getNeurons().size();
+        std::vector<Color> blended;
+        for (const Neuron& n : coarse.getNeurons()) blended.push_back(n.spectrum);
+
+        for (int frame = 0; frame < 200; ++frame) {
+            fine.evolveFrame(1.0f);
+            coarse.evolveFrame(1.0f);
+        }
+        double fineMass = 0, fineLuminosity = 0, coarseMass = 0, coarseLuminosity = 0;
+        for (const Neuron& n : fine.getNeurons()) {
+            fineMass += n.mass;
+            fineLuminosity += n.luminosity;
+        }
+        for (const Neuron& n : coarse.getNeurons()) {
+            coarseMass += n.mass;
+            coarseLuminosity += n.luminosity;
+        }
+        const double massError = std::abs(coarseMass - fineMass) / fineMass;
+        const double luminosityError = std::abs(coarseLuminosity - fineLuminosity) / fineLuminosity;
+
+        // Superparticles still carry the luminosity-weighted spectrum of
+        // their members after the stellar phase has run, not the palette
+        // colour of their mean temperature
+        int spectrumChanged = 0, mixed = 0;
+        for (size_t i = 0; i < entries; ++i) {
+            const Neuron& n = coarse.getNeurons()[i];
+            if (n.superparticle < 0) continue;
+            spectrumChanged += n.spectrum.r != blended[i].r || n.spectrum.g != blended[i].g ||
+                               n.spectrum.b != blended[i].b;
+            Neuron palette = n;
+            palette.updateSpectrum();
+            mixed += n.spectrum.g != palette.spectrum.g || n.spectrum.b != palette.spectrum.b;
+        }
+
+        // What remains is mass loss: a superparticle loses mass at its mean
+        // member's rate, not at the rate of its heaviest members
+
+        bool result = entries < 500 && massError < 1e-3 && luminosityError < 2e-3 &&
+                      spectrumChanged == 0 && mixed > 0;
+        std::cout << "  Entries: " << entries << ", mass error: " << massError
+                  << ", luminosity error: " << luminosityError << ", blended spectra: " << mixed
+                  << ", overwritten: " << spectrumChanged << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+
+    static bool testSparseUpdates() {
+        std::cout << "Testing sparse connection updates against dense ones..." << std::endl;
+
+        // With nothing ever quiet, sparse mode visits every neuron and must
+        // find the same neighbors as dense mode
+        NEBULAEmergentGalaxy dense(3000, 100, 17, quiet());
+        NEBULAEmergentGalaxy sparse(3000, 100, 17, quiet());
+        ActivityParams busy;
+        busy.enabled = true;
+        busy.activationThreshold = -1.0f;
+        sparse.setActivityParams(busy);
+        dense.evolveFrame(0.016f);
+        sparse.evolveFrame(0.016f);
+        bool matches = sparse.activeNeuronCount() == 3000;
+        int connected = 0;
+        for (size_t i = 0; i < dense.getNeurons().size(); ++i) {
+            const Neuron& a = dense.getNeurons()[i];
+            const Neuron& b = sparse.getNeurons()[i];
+            matches = matches && a.connections == b.connections && a.activation == b.activation;
+            connected += a.connections > 0;
+        }
+
+        // Everything dormant and no photons of its own (a pool of zero is
+        // never refilled): a tiny frame changes nothing, a photon burst at
+        // a neuron wakes it
+        NEBULAEmergentGalaxy idle(3000, 0, 17, quiet());
+        ActivityParams still;
+        still.enabled = true;
+        still.activationThreshold = 1e9f;
+        still.speedThreshold = 1e9f;
+        still.connectionThreshold = 1 << 30;
+        still.graceFrames = 2;
+        still.dormantPeriod = 1 << 20;
+        idle.setActivityParams(still);
+        for (int frame = 0; frame < 4; ++frame) idle.evolveFrame(0.016f);
+        idle.evolveFrame(1e-8f);
+        const size_t asleep = idle.activeNeuronCount();
+        PhotonBurst burst;
+        burst.origin = idle.getNeurons()[0].position;
+        idle.injectPhotonBurst(burst);
+        idle.evolveFrame(1e-8f);
+        const size_t woken = idle.activeNeuronCount();
+
+        // A pass that renumbers the array keeps each neuron's dormancy: only
+        // the burst's neurons and the new superparticles are active after it
+        idle.setObservers({burst.origin});
+        LodParams lod;
+        lod.enabled = true;
+        lod.refineRadius = 600.0f;
+        lod.updateEvery = 1 << 30;
+        idle.setLodParams(lod);
+        idle.updateLevelOfDetail();
+        idle.evolveFrame(1e-8f);
+        const size_t renumbered = idle.activeNeuronCount();
+        const bool followed = idle.superparticleCount() > 0 && renumbered <= woken + idle.superparticleCount();
+
+        bool result = matches && connected > 1000 && asleep == 0 && woken > 0 && followed;
+        std::cout << "  Neurons with connections: " << connected << ", sparse matches dense: "
+                  << (matches ? "yes" : "no") << std::endl;
+        std::cout << "  Active while idle: " << asleep << ", after a photon burst: " << woken
+                  << ", after coarsening: " << renumbered << " (" << idle.superparticleCount()
+                  << " superparticles)" << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+
+    static bool testSteadyStateFramesOffHeap() {
+        std::cout << "Testing heap allocations of steady-state galaxy frames..." << std::endl;
+
+        bool result = true;
+        for (ExecutionMode mode : {ExecutionMode::Deterministic, ExecutionMode::TaskGraph}) {
+            NEBULAEmergentGalaxy galaxy(2000, 100, 19, quiet());
+            galaxy.setExecutionMode(mode);
+
+            // Warm-up frames grow the arenas, scratch and spatial index
+            for (int f = 0; f < 10; ++f) galaxy.evolveFrame(0.016f);
+
+            const long before = HeapCounter::count();
+            for (int f = 0; f < 20; ++f) galaxy.evolveFrame(0.016f);
+            const long allocations = HeapCounter::count() - before;
+
+            result = result && allocations == 0;
+            std::cout << "  " << (mode == ExecutionMode::Deterministic ? "Deterministic" : "TaskGraph")
+                      << ": heap allocations in 20 frames: " << allocations << std::endl;
+        }
+
+        // Frames on which LOD and streaming passes run but find nothing to
+        // move reuse the galaxy's pass buffer; passes that do fold, thaw or
+        // evict neurons allocate and are outside the guarantee
+        char scratch[] = "/tmp/nebula_galaxy_XXXXXX";
+        if (!mkdtemp(scratch)) return false;
+        {
+            NEBULAEmergentGalaxy galaxy(2000, 100, 19, quiet());
+            galaxy.setObservers({Vector3(1500, 0, 0)});
+            StreamingParams streaming;
+            streaming.enabled = true;
+            streaming.activeRadius = 800.0f;
+            streaming.frozenRadius = 1500.0f;
+            streaming.directory = scratch;
+            streaming.updateEvery = 5;
+            galaxy.setStreamingParams(streaming);
+            LodParams lod;
+            lod.enabled = true;
+            lod.refineRadius = 300.0f;
+            lod.updateEvery = 5;
+            galaxy.setLodParams(lod);
+            for (int f = 0; f < 10; ++f) galaxy.evolveFrame(0.016f);
+            // The counter is process-wide: let the warm-up's cell writes finish
+            galaxy.waitForStreamingIo();
+
+            const long before = HeapCounter::count();
+            for (int f = 0; f < 20; ++f) galaxy.evolveFrame(0.016f);
+            const long allocations = HeapCounter::count() - before;
+
+            result = result && allocations == 0 && galaxy.superparticleCount() > 0 &&
+                     galaxy.frozenNeuronCount() > 0;
+            std::cout << "  With LOD and streaming passes every 5 frames: heap allocations in 20 frames: "
+                      << allocations << std::endl;
+            galaxy.setStreamingParams(StreamingParams());
+            galaxy.updateStreaming();
+        }
+        rmdir(scratch);
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+
+    static bool testHandlesAcrossPasses() {
+        std::cout << "Testing neuron handles across LOD, streaming and fusion passes..." << std::endl;
+
+        NEBULAEmergentGalaxy galaxy(3000, 100, 23, quiet());
+        std::vector<NeuronHandle> handles;
+        std::vector<Neuron> original;
+        for (size_t i = 0; i < galaxy.getNeurons().size(); ++i) {
+            handles.push_back(galaxy.neuronHandle(i));
+            original.push_back(galaxy.getNeurons()[i]);
+        }
+        // Every handle alive and at a neuron identical to the original one,
+        // or (when held) alive without an index
+        auto check = [&](bool held) {
+            size_t found = 0;
+            bool same = true;
+            for (size_t k = 0; k < handles.size(); ++k) {
+                const size_t i = galaxy.findNeuron(handles[k]);
+                same = same && galaxy.neuronExists(handles[k]);
+                if (i == SIZE_MAX) continue;
+                const Neuron& n = galaxy.getNeurons()[i];
+                same = same && galaxy.neuronHandle(i) == handles[k] &&
+                       std::abs(n.mass - original[k].mass) < 1e-4f * original[k].mass &&
+                       (n.position - original[k].position).magnitude() < 1e-3f;
+                ++found;
+            }
+            return same && (held ? found < handles.size() : found == handles.size());
+        };
+
+        // Level of detail: coarsen everything, then refine it all again
+        galaxy.setObservers({Vector3(100000, 0, 0)});
+        LodParams lod;
+        lod.enabled = true;
+        lod.refineRadius = 300.0f;
+        galaxy.setLodParams(lod);
+        galaxy.updateLevelOfDetail();
+        const bool coarsened = galaxy.superparticleCount() > 0 && check(true);
+        galaxy.setLodParams(LodParams());
+        galaxy.updateLevelOfDetail();
+        const bool refined = galaxy.superparticleCount() == 0 && check(false);
+
+        // Streaming: freeze and evict far cells, then bring them all back
+        char scratch[] = "/tmp/nebula_galaxy_XXXXXX";
+        if (!mkdtemp(scratch)) return false;
+        galaxy.setObservers({Vector3(1500, 0, 0)});
+        StreamingParams streaming;
+        streaming.enabled = true;
+        streaming.activeRadius = 800.0f;
+        streaming.frozenRadius = 1500.0f;
+        streaming.directory = scratch;
+        galaxy.setStreamingParams(streaming);
+        galaxy.updateStreaming();
+        const bool frozen = galaxy.frozenNeuronCount() > 0 && galaxy.evictedNeuronCount() > 0 && check(true);
+        galaxy.setStreamingParams(StreamingParams());
+        galaxy.updateStreaming();
+        const bool thawed = galaxy.frozenNeuronCount() == 0 && check(false);
+        rmdir(scratch);
+
+        // Fusion alone: absorbed neurons are gone, the rest keep their handles
+        FusionParams fuse;
+        fuse.enabled = true;
+        fuse.fusionThreshold = 0.0f;
+        fuse.fusionRadius = 20.0f;
+        fuse.fissionMinMass = 1e9f;
+        galaxy.setFusionParams(fuse);
+        const FusionChanges fused = galaxy.updateFusionFission();
+        size_t gone = 0;
+        bool kept = true;
+        for (const NeuronHandle& h : handles) {
+            const bool exists = galaxy.neuronExists(h);
+            gone += !exists;
+            kept = kept && (exists ? galaxy.findNeuron(h) != SIZE_MAX : galaxy.findNeuron(h) == SIZE_MAX);
+        }
+        const bool fusion = fused.fused > 0 && gone == fused.fused && kept &&
+                            galaxy.getNeurons().size() == handles.size() - gone;
+
+        // Fission alone: the parent's handle names the first product, the
+        // second gets a handle of its own
+        std::vector<NeuronHandle> parents;
+        std::vector<float> parentMass;
+        for (size_t i = 0; i < galaxy.getNeurons().size(); ++i) {
+            if (galaxy.getNeurons()[i].mass < 2.0f) continue;
+            parents.push_back(galaxy.neuronHandle(i));
+            parentMass.push_back(galaxy.getNeurons()[i].mass);
+        }
+        const size_t before = galaxy.getNeurons().size();
+        FusionParams split;
+        split.enabled = true;
+        split.fusionThreshold = 1e9f;
+        split.fissionThreshold = 1e9f;
+        split.fissionMinMass = 2.0f;
+        galaxy.setFusionParams(split);
+        const FusionChanges splits = galaxy.updateFusionFission();
+        bool halves = splits.split == parents.size() && galaxy.getNeurons().size() == before + parents.size();
+        for (size_t k = 0; k < parents.size(); ++k) {
+            const Neuron* n = galaxy.neuron(parents[k]);
+            halves = halves && n && std::abs(n->mass - 0.5f * parentMass[k]) < 1e-5f * parentMass[k];
+        }
+        std::vector<NeuronHandle> all;
+        for (size_t i = 0; i < galaxy.getNeurons().size(); ++i) all.push_back(galaxy.neuronHandle(i));
+        std::sort(all.begin(), all.end(), [](const NeuronHandle& a, const NeuronHandle& b) { return a.slot < b.slot; });
+        const bool distinct = std::adjacent_find(all.begin(), all.end(), [](const NeuronHandle& a, const NeuronHandle& b) {
+            return a.slot == b.slot;
+        }) == all.end();
+        const bool fission = !parents.empty() && halves && distinct;
+
+        bool result = coarsened && refined && frozen && thawed && fusion && fission;
+        std::cout << "  LOD: " << (coarsened && refined ? "ok" : "broken") << ", streaming: "
+                  << (frozen && thawed ? "ok" : "broken") << std::endl;
+        std::cout << "  Fused away: " << gone << ", split: " << splits.split << " (parents keep handles: "
+                  << (halves ? "yes" : "no") << ")" << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+
+    static bool testTrajectoryCompression() {
+        std::cout << "Testing trajectory compression on a simulated galaxy..." << std::endl;
+
+        char path[] = "/tmp/nebula_galaxy_trajectory_XXXXXX";
+        int fd = mkstemp(path);
+        if (fd < 0) return false;
+        close(fd);
+
+        // Orbits at the usual frame step, recorded every frame to 1e-3 within
+        // +-4096: a neuron moves several quanta per frame at nearly constant
+        // velocity
+        NEBULAEmergentGalaxy galaxy(3000, 100, 29, quiet());
+        TrajectoryParams params;
+        params.errorBound = 1e-3f;
+        params.extent = 4096.0f;
+        const int frames = 60;
+        std::vector<std::vector<Vector3>> recorded;
+        size_t bytes = 0, beyond = 0;
+        {
+            TrajectoryWriter writer;
+            if (!writer.open(path, params)) return false;
+            for (int f = 0; f < frames; ++f) {
+                galaxy.evolveFrame(0.016f);
+                const auto& neurons = galaxy.getNeurons();
+                writer.record(f, galaxy.getSimulationTime(), neurons.size(),
+                              [&](size_t i) { return neurons[i].position; });
+                std::vector<Vector3> positions;
+                for (const Neuron& n : neurons) positions.push_back(n.position);
+                recorded.push_back(positions);
+            }
+            writer.close();
+            bytes = writer.bytes();
+            beyond = writer.coordinatesBeyondExtent();
+        }
+
+        TrajectoryReader reader;
+        TrajectoryFrame frame;
+        int decoded = 0;
+        float maxError = 0.0f;
+        bool consistent = reader.open(path);
+        while (consistent && reader.next(frame)) {
+            const std::vector<Vector3>& expected = recorded[decoded];
+            consistent = frame.x.size() == expected.size();
+            for (size_t i = 0; consistent && i < expected.size(); ++i) {
+                maxError = std::max({maxError, std::abs(frame.x[i] - expected[i].x),
+                                     std::abs(frame.y[i] - expected[i].y), std::abs(frame.z[i] - expected[i].z)});
+            }
+            ++decoded;
+        }
+        unlink(path);
+        const double ratio = static_cast<double>(frames) * 3000 * 3 * sizeof(float) / bytes;
+
+        // Fine bounds at a large extent are below float resolution
+        TrajectoryWriter unreachable;
+        TrajectoryParams fine = params;
+        fine.errorBound = 1e-4f;
+        fine.extent = 1e5f;
+        const bool rejected = !unreachable.open(path, fine);
+
+        bool result = consistent && decoded == frames && beyond == 0 && maxError <= params.errorBound &&
+                      reader.errorBound() == params.errorBound && ratio > 8.0 && rejected;
+        std::cout << "  Frames: " << decoded << ", max error: " << maxError << " (bound " << reader.errorBound()
+                  << ", " << beyond << " coordinates beyond extent), compression vs raw floats: " << ratio << "x"
+                  << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+
+    static bool testInjectionNextFrame() {
+        std::cout << "Testing stimulus injection into a running galaxy..." << std::endl;
+
+        // Twins, one of which gets a burst larger than its photon pool and
+        // a kick around one neuron. A frame short enough that the photons
+        // are still near their origin afterwards.
+        NEBULAEmergentGalaxy plain(2000, 10, 31, quiet());
+        NEBULAEmergentGalaxy stirred(2000, 10, 31, quiet());
+        PhotonBurst burst;
+        burst.origin = Vector3(0, 0, 0);
+        burst.photons = 50;
+        burst.wavelength = 123e-9f;
+        NeuronPerturbation perturbation;
+        perturbation.center = stirred.getNeurons()[0].position;
+        perturbation.radius = 150.0f;
+        perturbation.velocityKick = Vector3(0, 1000, 0);
+        const bool queued = stirred.injectPhotonBurst(burst) && stirred.injectPerturbation(perturbation);
+        const bool deferred = stirred.getPhotons().size() == 10 &&
+                              stirred.getNeurons()[0].velocity.y == plain.getNeurons()[0].velocity.y;
+
+        std::vector<bool> inside;
+        for (const Neuron& n : stirred.getNeurons()) {
+            inside.push_back((n.position - perturbation.center).magnitude() <= perturbation.radius);
+        }
+        plain.evolveFrame(1e-8f);
+        stirred.evolveFrame(1e-8f);
+
+        size_t emitted = 0;
+        for (const Photon& p : stirred.getPhotons()) {
+            emitted += p.active && p.wavelength == burst.wavelength && !p.source.valid() &&
+                       p.position.magnitude() < 10.0f;
+        }
+        size_t kicked = 0;
+        bool kicks = true;
+        for (size_t i = 0; i < inside.size(); ++i) {
+            const Vector3 change = stirred.getNeurons()[i].velocity - plain.getNeurons()[i].velocity;
+            const Vector3 expected = inside[i] ? perturbation.velocityKick : Vector3(0, 0, 0);
+            kicks = kicks && (change - expected).magnitude() < 1e-3f;
+            kicked += inside[i];
+        }
+
+        bool result = queued && deferred && emitted == 50 && stirred.getPhotons().size() >= 50 && kicked > 1 && kicks;
+        std::cout << "  Photons emitted: " << emitted << " (pool " << stirred.getPhotons().size()
+                  << "), neurons kicked: " << kicked << (kicks ? "" : " (wrong kicks)") << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+
+private:
+    static GalaxyOptions quiet() {
+        GalaxyOptions options;
+        options.verbose = false;
+        return options;
+    }
+
+    template <typename Neurons>
+    static double totalMass(const Neurons& neurons) {
+        double total = 0.0;
+        for (const Neuron& n : neurons) total += n.mass;
+        return total;
+    }
+};
+
+int main() {
+    std::cout << "🧪 NEBULA EMERGENT Galaxy Integration Test Suite" << std::endl;
+    std::cout << "================================================" << std::endl;
+
+    int totalTests = 0;
+    int passedTests = 0;
+
+    std::vector<std::pair<std::string, bool(*)()>> tests = {
+        {"Snapshot Completeness", GalaxyValidator::testSnapshotCompleteness},
+        {"Diversity Dimming Persists", GalaxyValidator::testDiversityDimmingPersists},
+        {"Superparticle Stellar Evolution", GalaxyValidator::testSuperparticleStellarEvolution},
+        {"Sparse Updates", GalaxyValidator::testSparseUpdates},
+        {"Steady-State Frames Off Heap", GalaxyValidator::testSteadyStateFramesOffHeap},
+        {"Handles Across Passes", GalaxyValidator::testHandlesAcrossPasses},
+        {"Trajectory Compression", GalaxyValidator::testTrajectoryCompression},
+        {"Injection Next Frame", GalaxyValidator::testInjectionNextFrame}
+    };
+
+    for (auto& test : tests) {
+        std::cout << "\n--- " << test.first << " ---" << std::endl;
+        bool result = test.second();
+        totalTests++;
+        if (result) passedTests++;
+        std::cout << std::endl;
+    }
+
+    std::cout << "================================================" << std::endl;
+    std::cout << "Test Summary:" << std::endl;
+    std::cout << "  Total Tests: " << totalTests << std::endl;
+    std::cout << "  Passed: " << passedTests << std::endl;
+    std::cout << "  Failed: " << (totalTests - passedTests) << std::endl;
+    std::cout << "  Success Rate: " << (100.0f * passedTests / totalTests) << "%" << std::endl;
+
+    if (passedTests == totalTests) {
+        std::cout << "\n✅ All galaxy integration tests PASSED!" << std::endl;
+        return 0;
+    } else {
+        std::cout << "\n❌ Some tests FAILED!" << std::endl;
+        return 1;
+    }
+}
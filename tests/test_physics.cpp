@@ -6,6 +6,33 @@
 #include <cmath>
 #include <vector>
 #include <chrono>
+#include <random>
+#include <array>
+#include <fstream>
+#include <sstream>
+
+// This unit supplies the counting operator new (see FrameArena.h)
+#define NEBULA_COUNT_HEAP_ALLOCATIONS
+
+#include "../src/ActiveSet.h"
+#include "../src/AllPairsGravity.h"
+#include "../src/CellStreaming.h"
+#include "../src/Clustering.h"
+#include "../src/ClusterTracking.h"
+#include "../src/DiversityMaintenance.h"
+#include "../src/CowArray.h"
+#include "../src/DomainDecomposition.h"
+#include "../src/FrameArena.h"
+#include "../src/FusionFission.h"
+#include "../src/InjectionQueue.h"
+#include "../src/LevelOfDetail.h"
+#include "../src/LiveState.h"
+#include "../src/OutOfCore.h"
+#include "../src/SlotMap.h"
+#include "../src/SnapshotLoader.h"
+#include "../src/SpatialGrid.h"
+#include "../src/TaskGraph.h"
+#include "../src/TrajectoryStream.h"
 
 // Include main NEBULA components (simplified for testing)
 struct Vector3 {
@@ -131,6 +158,1363 @@ public:
         return result;
     }
     
+    static bool testExactAllPairsGravity() {
+        std::cout << "Testing tiled all-pairs gravity against direct summation..." << std::endl;
+        
+        // Not a multiple of the tile size or SIMD width, to exercise remainders
+        const size_t count = 1000;
+        std::vector<float> x(count), y(count), z(count), m(count);
+        std::vector<float> ax(count), ay(count), az(count);
+        
+        std::mt19937 gen(7);
+        std::uniform_real_distribution<float> pos_dist(-100.0f, 100.0f);
+        std::uniform_real_distribution<float> mass_dist(0.5f, 2.5f);
+        for (size_t i = 0; i < count; ++i) {
+            x[i] = pos_dist(gen);
+            y[i] = pos_dist(gen);
+            z[i] = pos_dist(gen);
+            m[i] = mass_dist(gen);
+        }
+        
+        ThreadPool pool(4);
+        AllPairsGravity gravity;
+        GravityParams params;
+        gravity.computeAccelerations(x.data(), y.data(), z.data(), m.data(), count,
+                                     ax.data(), ay.data(), az.data(), params, pool);
+        
+        double maxError = 0.0;
+        Vector3 netForce(0, 0, 0);
+        for (size_t i = 0; i < count; ++i) {
+            double sx = 0.0, sy = 0.0, sz = 0.0;
+            for (size_t j = 0; j < count; ++j) {
+                if (i == j) continue;
+                double dx = x[j] - x[i], dy = y[j] - y[i], dz = z[j] - z[i];
+                double r2 = dx * dx + dy * dy + dz * dz;
+                if (r2 <= params.minDistanceSquared) continue;
+                double s = GRAVITATIONAL_CONSTANT * m[j] / (r2 * std::sqrt(r2));
+                sx += s * dx;
+                sy += s * dy;
+                sz += s * dz;
+            }
+            double ref = std::sqrt(sx * sx + sy * sy + sz * sz);
+            double err = std::sqrt((ax[i] - sx) * (ax[i] - sx) + (ay[i] - sy) * (ay[i] - sy) +
+                                   (az[i] - sz) * (az[i] - sz));
+            maxError = std::max(maxError, err / ref);
+            netForce = netForce + Vector3(ax[i], ay[i], az[i]) * m[i];
+        }
+        
+        // Symmetric accumulation must conserve momentum: Σ m·a ≈ 0
+        float scale = GRAVITATIONAL_CONSTANT * count;
+        bool result = maxError < 1e-4 && netForce.magnitude() < 1e-4f * scale;
+        std::cout << "  Bodies: " << count << std::endl;
+        std::cout << "  Max relative error: " << maxError << std::endl;
+        std::cout << "  Net force: " << netForce.magnitude() << "N" << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        
+        return result;
+    }
+    
+    static bool testTaskGraphOrdering() {
+        std::cout << "Testing phase task graph dependencies..." << std::endl;
+        
+        // dynamics writes positions, photons read them, stellar touches only
+        // mass/temperature, patterns read everything
+        using namespace SimField;
+        std::atomic<int> clock{0};
+        int dynamicsAt = -1, photonsAt = -1, stellarAt = -1, patternsAt = -1;
+        
+        TaskGraph graph;
+        graph.addTask("dynamics", Position | Velocity, Position | Velocity, [&]() { dynamicsAt = clock++; });
+        graph.addTask("photons", Position, Photons, [&]() { photonsAt = clock++; });
+        graph.addTask("stellar", Mass | Temperature, Mass | Temperature, [&]() { stellarAt = clock++; });
+        graph.addTask("patterns", Position | Mass | Photons, GalaxyTemperature, [&]() { patternsAt = clock++; });
+        
+        bool edges = graph.predecessors(1) == std::vector<size_t>{0} &&
+                     graph.predecessors(2).empty() &&
+                     graph.predecessors(3).size() == 3;
+        
+        ThreadPool pool(4);
+        graph.run(pool, false);
+        bool ordered = dynamicsAt < photonsAt && photonsAt < patternsAt && stellarAt < patternsAt;
+        
+        bool result = edges && ordered && clock == 4;
+        std::cout << graph.describe();
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        
+        return result;
+    }
+    
+    static bool testCopyOnWriteFork() {
+        std::cout << "Testing copy-on-write chunk sharing..." << std::endl;
+        
+        CowArray<int, 64> parent;
+        for (int i = 0; i < 1000; ++i) parent.emplace_back(i);
+        
+        CowArray<int, 64> branch = parent.share();
+        bool sharedAfterFork = branch.sharedChunkCount() == branch.chunkCount();
+        
+        // Writing one element unshares exactly its chunk, on one side only
+        branch[130] = -1;
+        branch.reclaim();
+        bool oneCopied = branch.sharedChunkCount() == branch.chunkCount() - 1 &&
+                         parent.sharedChunkCount() == parent.chunkCount() - 1;
+        bool isolated = parent[130] == 130 && branch[130] == -1 && branch[129] == 129;
+        
+        // Const reads never unshare
+        const auto& view = parent;
+        long sum = 0;
+        for (int value : view) sum += value;
+        bool readsShared = parent.sharedChunkCount() == parent.chunkCount() - 1 && sum == 999L * 1000 / 2;
+        
+        bool result = sharedAfterFork && oneCopied && isolated && readsShared;
+        std::cout << "  Chunks: " << branch.chunkCount() << ", shared after one write: "
+                  << branch.sharedChunkCount() << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        
+        return result;
+    }
+    
+    static bool testFrameArenaSteadyState() {
+        std::cout << "Testing per-frame arena allocations..." << std::endl;
+        
+        // Shape of a galaxy frame: a graph of phases whose bodies capture an
+        // arena record, build transient containers and run parallel loops
+        struct Work {
+            int phase;
+            double* sums;
+            ThreadPool* pool;
+        };
+        ThreadPool pool(4);
+        FrameArena arena;
+        TaskGraph graph;
+        double sums[4] = {};
+        
+        auto frame = [&](bool deterministic) {
+            graph.clear();
+            for (int p = 0; p < 4; ++p) {
+                const Work* work = arena.local().make<Work>(p, sums, &pool);
+                graph.addTask("phase", SimField::Position, p == 3 ? SimField::Mass : 0, [&arena, work]() {
+                    std::pmr::vector<float> bins(2000 + 500 * work->phase, 1.0f, &arena.local());
+                    std::atomic<long> counted{0};
+                    work->pool->parallelFor(0, bins.size(), 256, [&](size_t begin, size_t end, unsigned) {
+                        counted += static_cast<long>(end - begin);
+                    });
+                    work->sums[work->phase] += counted.load();
+                });
+            }
+            graph.run(pool, deterministic);
+            arena.reset();
+        };
+        
+        // Warm-up frames create per-thread arenas and grow reusable storage
+        for (int f = 0; f < 8; ++f) frame(f % 2 == 0);
+        
+        const long before = HeapCounter::count();
+        for (int f = 0; f < 20; ++f) frame(f % 2 == 0);
+        const long allocations = HeapCounter::count() - before;
+        
+        bool correct = sums[0] == 28 * 2000.0 && sums[3] == 28 * 3500.0;
+        bool result = allocations == 0 && correct;
+        std::cout << "  Heap allocations in 20 steady-state frames: " << allocations << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        
+        return result;
+    }
+    
+    static bool testOutOfCoreChunks() {
+        std::cout << "Testing out-of-core chunked galaxy..." << std::endl;
+        
+        char directory[] = "/tmp/nebula_ooc_test_XXXXXX";
+        if (!mkdtemp(directory)) {
+            std::cout << "  Could not create a temporary directory" << std::endl;
+            return false;
+        }
+        
+        OutOfCoreParams params;
+        params.neuronCount = 3000;
+        params.chunksPerSide = 4;
+        params.directory = directory;
+        params.rechunkEvery = 1;
+        params.threads = 2;
+        params.seed = 5;
+        
+        bool result = false;
+        {
+            OutOfCoreGalaxy galaxy(params);
+            if (galaxy.create()) {
+                galaxy.evolveFrame();
+                galaxy.evolveFrame();
+                
+                // Re-chunking keeps every neuron exactly once, in its grid cell
+                const size_t n = galaxy.size();
+                const uint32_t* ids = galaxy.ids();
+                std::vector<char> seen(n, 0);
+                bool permutation = true;
+                for (size_t i = 0; i < n; ++i) {
+                    permutation = permutation && ids[i] < n && !seen[ids[i]];
+                    if (ids[i] < n) seen[ids[i]] = 1;
+                }
+                const float* x = galaxy.column(OocColumn::X);
+                const float* y = galaxy.column(OocColumn::Y);
+                const float* z = galaxy.column(OocColumn::Z);
+                bool placed = true;
+                for (size_t c = 0; c < galaxy.chunkCount(); ++c) {
+                    const OocChunk& chunk = galaxy.chunk(c);
+                    for (size_t i = chunk.begin; i < chunk.begin + chunk.count; ++i) {
+                        placed = placed && galaxy.chunkOf(x[i], z[i]) == c;
+                    }
+                }
+                
+                // Connections across chunk borders match a brute-force count
+                // on the positions they were computed from
+                long mismatches = 0;
+                long crossChunk = 0;
+                const int32_t* connections = galaxy.connections();
+                for (size_t i = 0; i < n; ++i) {
+                    int count = 0;
+                    for (size_t j = 0; j < n; ++j) {
+                        if (i == j) continue;
+                        const float dx = x[i] - x[j], dy = y[i] - y[j], dz = z[i] - z[j];
+                        if (std::sqrt(dx * dx + dy * dy + dz * dz) < params.connectionRadius) {
+                            ++count;
+                            crossChunk += galaxy.chunkOf(x[i], z[i]) != galaxy.chunkOf(x[j], z[j]);
+                        }
+                    }
+                    mismatches += count != connections[i];
+                }
+                
+                result = permutation && placed && mismatches == 0 && crossChunk > 0;
+                std::cout << "  Chunks: " << galaxy.chunkCount() << ", cross-chunk pairs: " << crossChunk
+                          << ", connection mismatches: " << mismatches << std::endl;
+            }
+        }
+        rmdir(directory);
+        
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testTrajectoryStream() {
+        std::cout << "Testing compressed trajectory stream..." << std::endl;
+        
+        char path[] = "/tmp/nebula_trajectory_test_XXXXXX";
+        int fd = mkstemp(path);
+        if (fd < 0) {
+            std::cout << "  Could not create a temporary file" << std::endl;
+            return false;
+        }
+        close(fd);
+        
+        // Neurons drifting a little each frame, with the count changing
+        // midway (which forces a keyframe)
+        TrajectoryParams params;
+        params.errorBound = 0.01f;
+        params.keyframeInterval = 8;
+        const int frames = 30;
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> place(-2000.0f, 2000.0f);
+        std::normal_distribution<float> step(0.0f, 0.05f);
+        std::vector<Vector3> positions(5000);
+        for (auto& p : positions) p = Vector3(place(rng), place(rng) * 0.05f, place(rng));
+        
+        std::vector<std::vector<Vector3>> recorded;
+        size_t bytes = 0;
+        {
+            TrajectoryWriter writer;
+            if (!writer.open(path, params)) return false;
+            for (int f = 0; f < frames; ++f) {
+                if (f == 20) positions.resize(4000);
+                for (auto& p : positions) p = p + Vector3(step(rng), step(rng), step(rng));
+                writer.record(f, f * 0.016, positions.size(), [&](size_t i) { return positions[i]; });
+                recorded.push_back(positions);
+            }
+            writer.close();
+            bytes = writer.bytes();
+        }
+        
+        TrajectoryReader reader;
+        TrajectoryFrame frame;
+        int decoded = 0;
+        float maxError = 0.0f;
+        bool consistent = reader.open(path);
+        while (consistent && reader.next(frame)) {
+            const std::vector<Vector3>& expected = recorded[decoded];
+            consistent = frame.frame == decoded && frame.x.size() == expected.size();
+            for (size_t i = 0; consistent && i < expected.size(); ++i) {
+                maxError = std::max({maxError, std::abs(frame.x[i] - expected[i].x),
+                                     std::abs(frame.y[i] - expected[i].y), std::abs(frame.z[i] - expected[i].z)});
+            }
+            ++decoded;
+        }
+        unlink(path);
+        
+        size_t rawBytes = 0;
+        for (const auto& positionsAt : recorded) rawBytes += positionsAt.size() * 3 * sizeof(float);
+        const double ratio = static_cast<double>(rawBytes) / bytes;
+        
+        // Float rounding of the decoded value adds at most an ulp at |x| ~ 2000
+        bool result = consistent && decoded == frames && maxError <= params.errorBound + 2.5e-4f && ratio > 3.0;
+        std::cout << "  Frames: " << decoded << ", max error: " << maxError
+                  << ", compression vs raw floats: " << ratio << "x" << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testSnapshotLoader() {
+        std::cout << "Testing parallel snapshot loader..." << std::endl;
+        
+        char path[] = "/tmp/nebula_snapshot_test_XXXXXX";
+        int fd = mkstemp(path);
+        if (fd < 0) {
+            std::cout << "  Could not create a temporary file" << std::endl;
+            return false;
+        }
+        close(fd);
+        
+        // Large enough to be cut into several pieces; columns reordered, an
+        // unknown column, blank lines and CRLF endings mixed in
+        const size_t neurons = 40000;
+        std::vector<std::array<float, 4>> expected(neurons);
+        std::mt19937 rng(3);
+        std::normal_distribution<float> normal(0.0f, 300.0f);
+        {
+            std::ofstream file(path);
+            file << "# NEBULA EMERGENT Galaxy State\n# Time: 1.25\n# Format: z id x y mass\n";
+            for (size_t i = 0; i < neurons; ++i) {
+                expected[i] = {normal(rng), normal(rng), normal(rng), 0.5f + i % 7};
+                file << expected[i][2] << " " << i << " " << expected[i][0] << "\t" << expected[i][1] << " "
+                     << expected[i][3] << (i % 5 == 0 ? "\r\n" : "\n");
+                if (i % 1000 == 0) file << "\n";
+            }
+        }
+        
+        ThreadPool pool(4);
+        SnapshotData snapshot;
+        bool loaded = SnapshotLoader::load(path, pool, snapshot);
+        bool match = loaded && snapshot.size() == neurons && snapshot.time == 1.25f;
+        for (size_t i = 0; match && i < neurons; ++i) {
+            // Reading back what the stream printed must give the same floats
+            std::ostringstream printed;
+            printed << expected[i][0] << " " << expected[i][1] << " " << expected[i][2];
+            std::istringstream reread(printed.str());
+            float x, y, z;
+            reread >> x >> y >> z;
+            match = snapshot[SnapshotField::X][i] == x && snapshot[SnapshotField::Y][i] == y &&
+                    snapshot[SnapshotField::Z][i] == z && snapshot[SnapshotField::Mass][i] == expected[i][3] &&
+                    snapshot[SnapshotField::Temperature][i] == 2700.0f;
+        }
+        
+        // A malformed line is rejected, not half-loaded
+        {
+            std::ofstream file(path, std::ios::app);
+            file << "1.0 2 3.0 oops 1.0\n";
+        }
+        std::cout << "  (expected error follows)" << std::endl;
+        bool rejected = !SnapshotLoader::load(path, pool, snapshot) && snapshot.size() == 0;
+        unlink(path);
+        
+        bool result = match && rejected;
+        std::cout << "  Neurons: " << (loaded ? neurons : 0) << ", values match: " << (match ? "yes" : "no")
+                  << ", malformed rejected: " << (rejected ? "yes" : "no") << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testLiveStateSeqlock() {
+        std::cout << "Testing live state seqlock..." << std::endl;
+        
+        // Every field of publication k carries k, so a torn read shows up
+        // as a snapshot whose fields disagree
+        struct Sample {
+            Vector3 position;
+            float luminosity, temperature;
+            int connections;
+        };
+        const std::string name = "/nebula_live_test_" + std::to_string(getpid());
+        LivePublisher publisher;
+        if (!publisher.open(name, 2000)) return false;
+        
+        LiveReader reader;
+        if (!reader.attach(name)) return false;
+        
+        std::atomic<bool> done{false};
+        const long publications = 20000;
+        std::thread writer([&]() {
+            for (long k = 1; k <= publications; ++k) {
+                LiveStats stats{};
+                stats.frame = k;
+                stats.simulationTime = k;
+                const float v = static_cast<float>(k);
+                const Sample sample{Vector3(v, v, v), v, v, static_cast<int>(k)};
+                publisher.publish(stats, 6000, [&](size_t) { return sample; });
+                if (k % 16 == 0) std::this_thread::yield();
+            }
+            done = true;
+        });
+        
+        long consistent = 0, torn = 0;
+        LiveSnapshot snapshot;
+        while (!done.load()) {
+            if (!reader.read(snapshot) || snapshot.sequence == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            bool same = snapshot.neurons.size() == 2000 && snapshot.stride == 3 &&
+                        snapshot.stats.simulationTime == static_cast<double>(snapshot.stats.frame);
+            for (const LiveNeuron& n : snapshot.neurons) {
+                same = same && n.x == snapshot.stats.frame && n.temperature == snapshot.stats.frame &&
+                       n.connections == snapshot.stats.frame;
+            }
+            ++(same ? consistent : torn);
+        }
+        writer.join();
+        
+        const bool final = reader.read(snapshot) && snapshot.stats.frame == publications &&
+                           snapshot.neurons.back().index == 3 * 1999;
+        publisher.close();
+        const bool closed = !reader.publisherLive();
+        
+        bool result = torn == 0 && consistent > 10 && final && closed;
+        std::cout << "  Consistent reads: " << consistent << ", torn: " << torn << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testInjectionQueue() {
+        std::cout << "Testing MPSC injection queue..." << std::endl;
+        
+        // Producers tag items with (producer, sequence); the consumer drains
+        // in small batches while they push and checks nothing is lost,
+        // duplicated or reordered within a producer
+        struct Item { int producer = -1; int sequence = -1; };
+        const int producers = 4, perProducer = 20000;
+        MpscQueue<Item> queue(256);
+        
+        std::atomic<int> running{producers};
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; ++p) {
+            threads.emplace_back([&, p]() {
+                for (int s = 0; s < perProducer; ++s) {
+                    while (!queue.tryPush(Item{p, s})) std::this_thread::yield();
+                }
+                --running;
+            });
+        }
+        
+        std::vector<int> next(producers, 0);
+        long received = 0, outOfOrder = 0;
+        auto take = [&](const Item& item) {
+            if (item.producer < 0 || item.producer >= producers || item.sequence != next[item.producer]) {
+                ++outOfOrder;
+            } else {
+                ++next[item.producer];
+            }
+            ++received;
+        };
+        while (running.load() > 0) {
+            if (queue.drain(take, 64) == 0) std::this_thread::yield();
+        }
+        for (std::thread& t : threads) t.join();
+        queue.drain(take);
+        
+        // A full queue refuses pushes until the consumer frees a cell
+        MpscQueue<Item> small(4);
+        int accepted = 0;
+        while (small.tryPush(Item{0, accepted})) ++accepted;
+        Item first;
+        const bool bounded = accepted == 4 && small.tryPop(first) && first.sequence == 0 &&
+                             small.tryPush(Item{0, 4}) && !small.tryPush(Item{0, 5});
+        
+        bool result = received == long(producers) * perProducer && outOfOrder == 0 && queue.empty() && bounded;
+        std::cout << "  Received: " << received << "/" << long(producers) * perProducer
+                  << ", out of order: " << outOfOrder << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testActiveSet() {
+        std::cout << "Testing active set bookkeeping..." << std::endl;
+        
+        const size_t count = 1000;
+        ActiveSet set;
+        set.reset(count);
+        
+        // Odd neurons stay quiet for the grace period and go dormant
+        for (int update = 0; update < 3; ++update) {
+            for (size_t i = 0; i < count; ++i) set.settle(i, i % 2 == 1, 3);
+        }
+        bool lists = set.activeCount() == 500 && set.dormantCount() == 500;
+        for (size_t i = 0; i < count; ++i) lists = lists && set.isActive(i) == (i % 2 == 0);
+        
+        // Every dormant neuron is revisited exactly once per period
+        std::vector<int> visits(count, 0);
+        size_t cursor = 0;
+        std::vector<uint32_t> due;
+        for (int update = 0; update < 10; ++update) {
+            set.collectDue(cursor, 10, due);
+            for (uint32_t i : due) ++visits[i];
+        }
+        bool rotation = due.size() == 500 + 50;
+        for (size_t i = 0; i < count; ++i) rotation = rotation && visits[i] == (i % 2 == 0 ? 10 : 1);
+        
+        // Waking and a non-quiet verdict both restore a neuron
+        set.wake(1);
+        set.settle(3, false, 3);
+        set.wake(1);
+        const bool woken = set.isActive(1) && set.isActive(3) && set.activeCount() == 502 &&
+                           set.dormantCount() == 498;
+        
+        bool result = lists && rotation && woken;
+        std::cout << "  Active: " << set.activeCount() << ", dormant: " << set.dormantCount() << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testLevelOfDetail() {
+        std::cout << "Testing level-of-detail superparticles..." << std::endl;
+        
+        struct Spectrum { float r = 1, g = 1, b = 1; };
+        struct Particle {
+            Vector3 position, velocity;
+            float mass = 1, luminosity = 1, temperature = 5000, age = 0, activation = 0;
+            int connections = 0;
+            Spectrum spectrum;
+            int superparticle = -1;
+        };
+        
+        // A cluster at the observer and a halo 20000 units out
+        std::mt19937 rng(11);
+        std::uniform_real_distribution<float> u(0.0f, 1.0f);
+        std::vector<Particle> particles(4000);
+        for (size_t i = 0; i < particles.size(); ++i) {
+            Particle& p = particles[i];
+            const float offset = i < 1000 ? 0.0f : 20000.0f;
+            p.position = Vector3(offset + u(rng) * 3000.0f, u(rng) * 3000.0f, u(rng) * 3000.0f);
+            p.velocity = Vector3(u(rng), u(rng), u(rng));
+            p.mass = 0.5f + u(rng) * 2.0f;
+            p.luminosity = p.mass * (2000.0f + u(rng) * 5000.0f) / 5778.0f;
+            p.spectrum.r = u(rng);
+        }
+        auto sums = [](const std::vector<Particle>& ps, double& mass, double& luminosity) {
+            mass = luminosity = 0.0;
+            for (const Particle& p : ps) {
+                mass += p.mass;
+                luminosity += p.luminosity;
+            }
+        };
+        double mass0, luminosity0;
+        sums(particles, mass0, luminosity0);
+        
+        LodParams params;
+        params.enabled = true;
+        LodHierarchy<Particle> lod;
+        lod.setParams(params);
+        std::vector<Vector3> observer{Vector3(1500, 1500, 1500)};
+        const LodChanges coarsened = lod.update(particles, observer);
+        
+        double mass1, luminosity1;
+        sums(particles, mass1, luminosity1);
+        size_t nearIndividuals = 0;
+        for (const Particle& p : particles) nearIndividuals += p.superparticle < 0 && p.position.x < 5000.0f;
+        const bool coarse = coarsened.coarsened > 0 && particles.size() < 1500 && nearIndividuals == 1000 &&
+                            lod.representedCount(particles) == 4000 &&
+                            std::abs(mass1 - mass0) < 1e-5 * mass0 && std::abs(luminosity1 - luminosity0) < 1e-5 * luminosity0;
+        
+        // Nothing changes while the observer stays inside the hysteresis band
+        const bool stable = lod.update(particles, observer).coarsened == 0;
+        
+        // Superparticles drift and evolve, then the observer flies out to them
+        const Vector3 drift(40.0f, -10.0f, 5.0f);
+        for (Particle& p : particles) {
+            if (p.superparticle < 0) continue;
+            p.position = p.position + drift;
+            p.mass *= 0.9f;
+            p.luminosity *= 1.1f;
+        }
+        double mass2, luminosity2;
+        sums(particles, mass2, luminosity2);
+        observer[0] = Vector3(21500, 1500, 1500);
+        const LodChanges refined = lod.update(particles, observer);
+        double mass3, luminosity3;
+        sums(particles, mass3, luminosity3);
+        
+        // Farther than the refine radius from the far cluster only the near one coarsens
+        size_t farIndividuals = 0;
+        for (const Particle& p : particles) farIndividuals += p.superparticle < 0 && p.position.x > 15000.0f;
+        const bool fine = refined.refined > 0 && farIndividuals == 3000 && lod.representedCount(particles) == 4000 &&
+                          std::abs(mass3 - mass2) < 1e-5 * mass2 && std::abs(luminosity3 - luminosity2) < 1e-5 * luminosity2;
+        
+        bool result = coarse && stable && fine;
+        std::cout << "  Coarsened: " << coarsened.coarsened << " (" << particles.size() << " entries after refining "
+                  << refined.refined << "), mass drift: " << std::abs(mass3 - mass2) / mass2 << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testCellStreaming() {
+        std::cout << "Testing observer-driven cell streaming..." << std::endl;
+        
+        struct Particle {
+            Vector3 position, velocity;
+            float mass = 1, luminosity = 1, temperature = 5000, age = 0, activation = 0;
+            int connections = 0;
+            int superparticle = -1;
+            uint32_t slot = 0;
+            int spectrumUpdates = 0;
+            void updateSpectrum() { ++spectrumUpdates; }
+        };
+        
+        // One cluster at the observer, one a few cells out, one far away
+        std::mt19937 rng(5);
+        std::uniform_real_distribution<float> u(0.0f, 1.0f);
+        std::vector<Particle> particles(3000);
+        for (size_t i = 0; i < particles.size(); ++i) {
+            Particle& p = particles[i];
+            const float offset = i < 1000 ? 0.0f : i < 2000 ? 3000.0f : 9000.0f;
+            p.position = Vector3(offset + u(rng) * 900.0f, u(rng) * 900.0f, u(rng) * 900.0f);
+            p.velocity = Vector3(u(rng), u(rng), u(rng));
+            p.mass = 0.5f + u(rng) * 2.0f;
+        }
+        const std::vector<Particle> original = particles;
+        
+        StreamingParams params;
+        params.enabled = true;
+        params.cellSize = 1000.0f;
+        params.activeRadius = 2000.0f;
+        params.frozenRadius = 6000.0f;
+        params.directory = "/tmp";
+        CellStreamer<Particle> streamer;
+        streamer.setParams(params);
+        std::vector<Vector3> observer{Vector3(500, 500, 500)};
+        
+        // No I/O thread until there is something to write
+        const bool lazy = !streamer.ioStarted();
+        const StreamingChanges first = streamer.update(particles, 0.0, observer);
+        streamer.waitForIo();
+        const bool split = streamer.ioStarted() && first.frozen == 2000 && first.evicted == 1000 && particles.size() == 1000 &&
+                           streamer.frozenCount() == 1000 && streamer.evictedCount() == 1000;
+        
+        // Nothing moves while the observer stays put
+        const bool stable = streamer.update(particles, 1.0, observer).frozen == 0;
+        
+        // The observer flies to the far cluster: the first pass starts its
+        // load, the next one thaws it after coasting 10 time units
+        observer[0] = Vector3(9500, 500, 500);
+        streamer.update(particles, 5.0, observer);
+        streamer.waitForIo();
+        const StreamingChanges arrived = streamer.update(particles, 10.0, observer);
+        bool coasted = arrived.loaded == 1000 && arrived.thawed == 1000;
+        for (const Particle& p : particles) {
+            if (p.position.x < 8000.0f) continue;
+            coasted = coasted && p.spectrumUpdates == 1 && std::abs(p.age - 10.0f) < 1e-4f;
+        }
+        
+        // Switching off brings every neuron back, in memory or on disk
+        std::vector<Particle> all = particles;
+        StreamingChanges restored;
+        streamer.restoreAll(all, 10.0, restored);
+        double mass0 = 0.0, mass1 = 0.0;
+        for (const Particle& p : original) mass0 += p.mass;
+        for (const Particle& p : all) mass1 += p.mass;
+        const bool complete = all.size() == original.size() && !streamer.holdsCells() &&
+                              std::abs(mass1 - mass0) < 1e-6 * mass0;
+        
+        bool result = lazy && split && stable && coasted && complete;
+        std::cout << "  Frozen: " << first.frozen << ", evicted: " << first.evicted << ", reloaded: "
+                  << arrived.loaded << ", restored: " << all.size() << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testCellStreamingWriteFailure() {
+        std::cout << "Testing cell streaming when writes fail..." << std::endl;
+        
+        struct Particle {
+            Vector3 position, velocity;
+            float mass = 1, luminosity = 1, temperature = 5000, age = 0, activation = 0;
+            int connections = 0;
+            int superparticle = -1;
+            uint32_t slot = 0;
+            void updateSpectrum() {}
+        };
+        
+        // A directory that cannot be written is refused up front
+        StreamingParams params;
+        params.enabled = true;
+        params.cellSize = 1000.0f;
+        params.activeRadius = 2000.0f;
+        params.frozenRadius = 6000.0f;
+        params.directory = "/nonexistent";
+        CellStreamer<Particle> refused;
+        const bool rejected = !refused.setParams(params) && !refused.params().enabled;
+        
+        // One that vanishes after the check fails every write: the neurons
+        // must come back frozen, not disappear
+        char scratch[] = "/tmp/nebula_stream_XXXXXX";
+        const bool made = mkdtemp(scratch) != nullptr;
+        params.directory = scratch;
+        CellStreamer<Particle> streamer;
+        const bool accepted = made && streamer.setParams(params);
+        rmdir(scratch);
+        
+        std::vector<Particle> particles(2000);
+        for (size_t i = 0; i < particles.size(); ++i) {
+            particles[i].position = Vector3(i < 1000 ? 500.0f : 9500.0f, 500.0f, 500.0f);
+            particles[i].mass = 1.0f + static_cast<float>(i % 5);
+            particles[i].slot = static_cast<uint32_t>(i);
+        }
+        std::vector<Vector3> observer{Vector3(500, 500, 500)};
+        const StreamingChanges first = streamer.update(particles, 0.0, observer);
+        streamer.waitForIo();
+        streamer.update(particles, 1.0, observer);
+        streamer.waitForIo();
+        const size_t held = streamer.frozenCount();
+        const bool kept = first.evicted == 1000 && streamer.evictedCount() == 0 && held == 1000;
+        size_t slots = 0;
+        streamer.forEachSlot([&](uint32_t) { ++slots; });
+        
+        StreamingChanges restored;
+        streamer.restoreAll(particles, 2.0, restored);
+        double mass = 0.0;
+        for (const Particle& p : particles) mass += p.mass;
+        const bool complete = particles.size() == 2000 && std::abs(mass - 6000.0) < 1e-6 && slots == 1000;
+        
+        bool result = rejected && accepted && kept && complete;
+        std::cout << "  Refused unwritable directory: " << (rejected ? "yes" : "no") << ", held after failed writes: "
+                  << held << ", restored: " << particles.size() << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testFusionFission() {
+        std::cout << "Testing fusion/fission with union-find and prefix-sum compaction..." << std::endl;
+        
+        struct Particle {
+            Vector3 position, velocity;
+            float mass = 1, luminosity = 0.5f, temperature = 5000, age = 0, activation = 0;
+            int connections = 0;
+            std::vector<int> synapses;
+            int superparticle = -1;
+            void updateSpectrum() {}
+        };
+        
+        // A grid of unremarkable neurons 50 units apart, with a luminous
+        // chain of three (transitive), a luminous pair, a luminous neuron
+        // too far from the others, and two dim heavy ones that split
+        std::vector<Particle> particles;
+        for (int i = 0; i < 20000; ++i) {
+            Particle p;
+            p.position = Vector3((i % 40) * 50.0f, ((i / 40) % 25) * 50.0f, (i / 1000) * 50.0f);
+            p.velocity = Vector3(1, 0, 0);
+            particles.push_back(p);
+        }
+        auto luminous = [&](size_t i, Vector3 position, Vector3 velocity, float mass) {
+            particles[i].position = position;
+            particles[i].velocity = velocity;
+            particles[i].mass = mass;
+            particles[i].luminosity = 2.0f;
+        };
+        luminous(100, Vector3(10, 10, 10), Vector3(1, 0, 0), 1.0f);
+        luminous(5000, Vector3(11.5f, 10, 10), Vector3(0, 1, 0), 3.0f);
+        luminous(9000, Vector3(13, 10, 10), Vector3(0, 0, 1), 2.0f);
+        luminous(300, Vector3(500, 510, 520), Vector3(2, 0, 0), 1.0f);
+        luminous(12000, Vector3(501, 510, 520), Vector3(-2, 0, 0), 1.0f);
+        luminous(700, Vector3(900, 910, 920), Vector3(0, 0, 0), 1.0f);
+        particles[42].luminosity = particles[19999].luminosity = 0.05f;
+        particles[42].mass = particles[19999].mass = 4.0f;
+        
+        auto totals = [](const std::vector<Particle>& ps, double& mass, Vector3& momentum) {
+            mass = 0.0;
+            momentum = Vector3();
+            for (const Particle& p : ps) {
+                mass += p.mass;
+                momentum = momentum + p.velocity * p.mass;
+            }
+        };
+        double mass0, mass1;
+        Vector3 momentum0, momentum1;
+        totals(particles, mass0, momentum0);
+        
+        FusionParams params;
+        params.enabled = true;
+        FusionFissionEngine<Particle> engine;
+        engine.setParams(params);
+        engine.setSeed(3);
+        ThreadPool pool(4);
+        std::vector<Particle> out(engine.plan(particles, pool));
+        engine.apply(particles, out, pool);
+        const FusionChanges changes = engine.changes();
+        totals(out, mass1, momentum1);
+        
+        // The chain's root (index 100) keeps its place in the order, one
+        // further along for the split before it
+        const Particle& fused = out[101];
+        const bool merged = changes.groups == 2 && changes.fused == 3 && changes.split == 2 &&
+                            out.size() == particles.size() - 3 + 2 &&
+                            std::abs(fused.mass - 6.0f) < 1e-5f && std::abs(fused.luminosity - 6.0f) < 1e-5f &&
+                            std::abs(fused.position.x - 11.75f) < 1e-4f &&
+                            std::abs(fused.velocity.x - 1.0f / 6.0f) < 1e-5f &&
+                            std::abs(fused.velocity.y - 0.5f) < 1e-5f;
+        const bool conserved = std::abs(mass1 - mass0) < 1e-6 * mass0 &&
+                               (momentum1 - momentum0).magnitude() < 1e-3f * momentum0.magnitude();
+        
+        // Products of the split at index 42 sit on either side of it
+        const Vector3 apart = out[42].position - out[43].position;
+        const Vector3 middle = (out[42].position + out[43].position) * 0.5f;
+        const bool split = std::abs(out[42].mass - 2.0f) < 1e-6f && std::abs(apart.magnitude() - 10.0f) < 1e-3f &&
+                           (middle - particles[42].position).magnitude() < 1e-3f;
+        
+        // The same seed gives the same result on one thread
+        ThreadPool single(1);
+        FusionFissionEngine<Particle> serial;
+        serial.setParams(params);
+        serial.setSeed(3);
+        std::vector<Particle> again(serial.plan(particles, single));
+        serial.apply(particles, again, single);
+        bool deterministic = again.size() == out.size();
+        for (size_t i = 0; deterministic && i < out.size(); ++i) {
+            deterministic = (again[i].position - out[i].position).magnitude() == 0.0f && again[i].mass == out[i].mass;
+        }
+        
+        bool result = merged && conserved && split && deterministic;
+        std::cout << "  Fused: " << changes.fused << " into " << changes.groups << " groups, split: " << changes.split
+                  << ", neurons: " << particles.size() << " -> " << out.size() << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testSlotMapHandles() {
+        std::cout << "Testing generational slot map handles..." << std::endl;
+        
+        SlotMap<int> map;
+        std::vector<SlotHandle> handles;
+        for (int i = 0; i < 1000; ++i) handles.push_back(map.insert(i));
+        
+        // Erase every third; the survivors stay reachable wherever they moved
+        for (size_t i = 0; i < handles.size(); i += 3) map.erase(handles[i]);
+        bool lookups = map.size() == 666;
+        for (size_t i = 0; i < handles.size(); ++i) {
+            const int* value = map.get(handles[i]);
+            lookups = lookups && (i % 3 == 0 ? value == nullptr : value && *value == static_cast<int>(i));
+        }
+        
+        // Reused slots get a new generation: old handles never alias
+        std::vector<SlotHandle> reused;
+        for (int i = 0; i < 334; ++i) reused.push_back(map.insert(-i));
+        bool generations = map.size() == 1000 && !map.erase(handles[0]);
+        for (size_t i = 0; i < handles.size(); i += 3) generations = generations && !map.contains(handles[i]);
+        for (const SlotHandle& h : reused) generations = generations && map.contains(h) && h.generation > 0;
+        
+        // Dense iteration sees exactly the live values, each handle names its own
+        long sum = 0;
+        for (int v : map) sum += v;
+        long expected = 0;
+        for (int i = 0; i < 1000; ++i) expected += i % 3 == 0 ? 0 : i;
+        for (int i = 0; i < 334; ++i) expected -= i;
+        bool dense = sum == expected;
+        for (size_t i = 0; i < map.size(); ++i) dense = dense && map.get(map.handleAt(i)) == &map[i];
+        
+        // A parked slot stays alive without an index
+        SlotTable table;
+        const SlotHandle h = table.create(5);
+        table.park(h.slot);
+        const bool parked = table.alive(h) && table.find(h) == SlotTable::NONE;
+        table.place(h.slot, 7);
+        const bool placed = table.find(h) == 7;
+        
+        bool result = lookups && generations && dense && parked && placed;
+        std::cout << "  Live: " << map.size() << ", stale lookups rejected: " << (generations ? "yes" : "no") << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testParallelClustering() {
+        std::cout << "Testing parallel grid DBSCAN clustering..." << std::endl;
+        
+        struct Particle {
+            Vector3 position, velocity;
+            float mass = 1, luminosity = 1, activation = 1;
+        };
+        
+        // Three blobs (one spinning about z), a thin bridge-free gap
+        // between two of them, and uniform background noise
+        std::mt19937 rng(21);
+        std::normal_distribution<float> normal(0.0f, 1.0f);
+        std::uniform_real_distribution<float> u(-3000.0f, 3000.0f);
+        std::vector<Particle> particles;
+        const Vector3 centers[3] = {Vector3(0, 0, 0), Vector3(900, 0, 0), Vector3(0, 1500, 400)};
+        for (int b = 0; b < 3; ++b) {
+            for (int i = 0; i < 1500; ++i) {
+                Particle p;
+                p.position = centers[b] + Vector3(normal(rng), normal(rng), normal(rng)) * 60.0f;
+                const Vector3 r = p.position - centers[b];
+                p.velocity = b == 0 ? Vector3(-r.y, r.x, 0) * 0.01f : Vector3(5, 0, 0);
+                p.mass = 1.0f + (i % 3);
+                particles.push_back(p);
+            }
+        }
+        for (int i = 0; i < 500; ++i) {
+            Particle p;
+            p.position = Vector3(u(rng), u(rng), u(rng));
+            particles.push_back(p);
+        }
+        
+        ClusterParams params;
+        params.epsilon = 40.0f;
+        params.minPoints = 10;
+        ClusterEngine engine;
+        engine.setParams(params);
+        ThreadPool pool(4);
+        const ClusterResult result = engine.identify(particles, pool);
+        
+        // Brute-force DBSCAN reference: core flags and core connectivity
+        const size_t n = particles.size();
+        const float eps2 = params.epsilon * params.epsilon;
+        auto near = [&](size_t a, size_t b) { return std::pow((particles[a].position - particles[b].position).magnitude(), 2.0f) <= eps2; };
+        std::vector<int> isCore(n, 0);
+        for (size_t a = 0; a < n; ++a) {
+            int count = 0;
+            for (size_t b = 0; b < n; ++b) count += near(a, b);
+            isCore[a] = count >= params.minPoints;
+        }
+        std::vector<int> label(n, -1);
+        int labels = 0;
+        for (size_t a = 0; a < n; ++a) {
+            if (!isCore[a] || label[a] >= 0) continue;
+            std::vector<size_t> stack{a};
+            label[a] = labels;
+            while (!stack.empty()) {
+                const size_t c = stack.back();
+                stack.pop_back();
+                for (size_t b = 0; b < n; ++b) {
+                    if (isCore[b] && label[b] < 0 && near(c, b)) {
+                        label[b] = labels;
+                        stack.push_back(b);
+                    }
+                }
+            }
+            ++labels;
+        }
+        // Same partition of core neurons; border and noise as DBSCAN defines them
+        bool agrees = static_cast<int>(result.clusterCount()) == labels;
+        std::vector<int> mapping(labels, -2);
+        for (size_t a = 0; a < n && agrees; ++a) {
+            const int32_t id = result.clusterOf[a];
+            if (isCore[a]) {
+                if (mapping[label[a]] == -2) mapping[label[a]] = id;
+                agrees = id >= 0 && mapping[label[a]] == id;
+            } else {
+                bool border = false;
+                for (size_t b = 0; b < n && !border; ++b) border = isCore[b] && near(a, b);
+                agrees = border == (id >= 0);
+            }
+        }
+        
+        // Aggregates of the spinning blob (the cluster holding neuron 0)
+        const ClusterSummary& spin = result.clusters[result.clusterOf[0]];
+        double mass = 0.0, lz = 0.0;
+        for (const uint32_t* i = result.begin(result.clusterOf[0]); i != result.end(result.clusterOf[0]); ++i) {
+            const Particle& p = particles[*i];
+            const Vector3 r = p.position - Vector3(spin.centroid.x, spin.centroid.y, spin.centroid.z);
+            mass += p.mass;
+            lz += p.mass * (r.x * p.velocity.y - r.y * p.velocity.x);
+        }
+        const bool aggregates = std::abs(spin.mass - mass) < 1e-6 * mass && spin.angularMomentum.z > 0.0f &&
+                                std::abs(spin.angularMomentum.z - lz) < 1e-3 * std::abs(lz) &&
+                                std::abs(spin.centroid.x) < 10.0f && spin.size == result.size(result.clusterOf[0]);
+        
+        // Same IDs with one thread
+        ThreadPool single(1);
+        ClusterEngine serial;
+        serial.setParams(params);
+        const bool deterministic = serial.identify(particles, single).clusterOf == result.clusterOf;
+        
+        bool result_ = agrees && aggregates && deterministic;
+        std::cout << "  Clusters: " << result.clusterCount() << " (reference " << labels << "), noise: "
+                  << result.noise << ", spin Lz: " << spin.angularMomentum.z << std::endl;
+        std::cout << "  Result: " << (result_ ? "PASS" : "FAIL") << std::endl;
+        return result_;
+    }
+    
+    static bool testClusterTracking() {
+        std::cout << "Testing persistent cluster tracking..." << std::endl;
+        
+        struct Particle {
+            Vector3 position, velocity;
+            float mass = 1, luminosity = 1, activation = 1;
+            SlotHandle handle;
+        };
+        
+        // Blobs of 400 neurons; a particle's handle is fixed for its life
+        SlotTable slots;
+        std::mt19937 rng(8);
+        std::normal_distribution<float> normal(0.0f, 1.0f);
+        auto blob = [&](std::vector<Particle>& out, const Vector3& center) {
+            for (int i = 0; i < 400; ++i) {
+                Particle p;
+                p.position = center + Vector3(normal(rng), normal(rng), normal(rng)) * 30.0f;
+                p.handle = slots.create(0);
+                out.push_back(p);
+            }
+        };
+        
+        ClusterParams params;
+        params.epsilon = 30.0f;
+        params.minPoints = 6;
+        ClusterEngine engine;
+        engine.setParams(params);
+        ClusterTracker tracker;
+        ThreadPool pool(4);
+        auto track = [&](std::vector<Particle>& particles) {
+            const ClusterResult& result = engine.identify(particles, pool);
+            tracker.update(result, slots.slotCount(), [&](size_t i) { return particles[i].handle; }, pool);
+            return result.clusterCount();
+        };
+        auto has = [&](ClusterEventType type) {
+            for (const ClusterEvent& e : tracker.events()) if (e.type == type) return true;
+            return false;
+        };
+        
+        // Pass 1: three births
+        std::vector<Particle> particles;
+        blob(particles, Vector3(0, 0, 0));
+        blob(particles, Vector3(1000, 0, 0));
+        blob(particles, Vector3(0, 1000, 0));
+        bool births = track(particles) == 3 && tracker.changes().born == 3 && tracker.events().size() == 3;
+        
+        // Pass 2: order shuffled and everything drifts: same three IDs, no events
+        std::vector<SlotHandle> before;
+        for (size_t c = 0; c < 3; ++c) before.push_back(tracker.idOf(c));
+        std::reverse(particles.begin(), particles.end());
+        for (Particle& p : particles) p.position = p.position + Vector3(5, 0, 0);
+        bool persistent = track(particles) == 3 && tracker.events().empty() && tracker.changes().memberships == 0;
+        for (const SlotHandle& id : before) {
+            const TrackedCluster* t = tracker.get(id);
+            persistent = persistent && t && t->passes == 2 && t->stability > 0.19f && t->born == 1;
+        }
+        
+        // Pass 3: the blob at y = 1000 dies, one appears at z = 1000, and the
+        // blob at x = 1000 moves onto the one at the origin: a merge
+        const SlotHandle mover = tracker.idOf(static_cast<size_t>(engine.last().clusterOf[400]));
+        std::vector<Particle> next;
+        for (Particle& p : particles) {
+            if (p.position.y > 500.0f) continue;
+            if (p.position.x > 500.0f) p.position.x -= 1000.0f - 40.0f;
+            next.push_back(p);
+        }
+        blob(next, Vector3(0, 0, 1000));
+        particles = next;
+        bool events = track(particles) == 2 && tracker.changes().born == 1 && tracker.changes().died == 1 &&
+                      tracker.changes().merged == 1 && has(ClusterEventType::Merge) && !tracker.alive(mover) &&
+                      tracker.clusters().size() == 2;
+        
+        // Pass 4: the merged cluster splits back in two along x
+        for (Particle& p : particles) {
+            if (p.position.z < 500.0f && p.handle.slot % 2 == 0) p.position.x += 2000.0f;
+        }
+        const size_t merged = tracker.clusters().size();
+        bool splits = track(particles) == 3 && tracker.changes().split == 1 && has(ClusterEventType::Split) &&
+                      tracker.clusters().size() == merged + 1;
+        for (const ClusterEvent& e : tracker.events()) {
+            if (e.type == ClusterEventType::Split) splits = splits && tracker.alive(e.cluster) && tracker.alive(e.other);
+        }
+        
+        // Only neurons that changed cluster were rewritten
+        const size_t moved = tracker.changes().memberships;
+        track(particles);
+        bool incremental = moved > 0 && tracker.changes().memberships == 0;
+        
+        // Pass 5: the blob at z = 1000 is replaced by new neurons in the same
+        // place, one old neuron staying. The pair is mutual but the link is
+        // too weak to hold: a death and a birth, not a continuation.
+        const SlotHandle replaced = tracker.idOf(static_cast<size_t>(engine.last().clusterOf[particles.size() - 1]));
+        next.clear();
+        bool stayed = false;
+        for (Particle& p : particles) {
+            if (p.position.z > 500.0f && stayed) continue;
+            stayed = stayed || p.position.z > 500.0f;
+            next.push_back(p);
+        }
+        blob(next, Vector3(0, 0, 1000));
+        particles = next;
+        const size_t count = tracker.clusters().size();
+        bool weak = track(particles) == count && tracker.changes().born == 1 && tracker.changes().died == 1 &&
+                    tracker.changes().split == 0 && tracker.changes().merged == 0 && !tracker.alive(replaced);
+        
+        bool result = births && persistent && events && splits && incremental && weak;
+        std::cout << "  Persistent: " << (persistent ? "yes" : "no") << ", merge/birth/death: " << (events ? "yes" : "no")
+                  << ", split: " << (splits ? "yes" : "no") << ", rewritten on split: " << moved
+                  << ", weak continuation replaced: " << (weak ? "yes" : "no") << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testDiversityMaintenance() {
+        std::cout << "Testing grid-accelerated diversity maintenance..." << std::endl;
+        
+        struct Particle {
+            Vector3 position, velocity;
+            float mass = 1, luminosity = 1, temperature = 5000, activation = 1;
+            int superparticle = -1;
+            void updateSpectrum() {}
+        };
+        
+        // Uniform neurons, a tenth of them bright, plus one dense blob
+        std::mt19937 rng(17);
+        std::uniform_real_distribution<float> u(-2000.0f, 2000.0f);
+        std::normal_distribution<float> normal(0.0f, 1.0f);
+        std::vector<Particle> initial(6000);
+        for (size_t i = 0; i < initial.size(); ++i) {
+            Particle& p = initial[i];
+            if (i < 1000) {
+                p.position = Vector3(normal(rng), normal(rng), normal(rng)) * 40.0f;
+            } else {
+                p.position = Vector3(u(rng), u(rng), u(rng));
+            }
+            p.luminosity = i % 10 == 0 ? 8.0f + (i % 7) : 1.0f + (i % 3);
+        }
+        ThreadPool pool(4);
+        const ClusterResult none;
+        
+        // Inhibition alone (no temperature, no perturbation) against the
+        // all-pairs UE5 loop with exp()
+        DiversityParams params;
+        params.enabled = true;
+        params.initialTemperature = params.minTemperature = 0.0f;
+        params.perturbEvery = 1 << 30;
+        DiversityController inhibition;
+        inhibition.setParams(params);
+        std::vector<Particle> particles = initial;
+        inhibition.update(particles, none, 0.016f, pool);
+        double worst = 0.0;
+        size_t repelled = 0;
+        bool repulsion = true;
+        for (size_t j = 0; j < initial.size(); ++j) {
+            double field = 0.0;
+            for (size_t i = 0; i < initial.size(); ++i) {
+                if (i == j || initial[i].luminosity <= params.brightThreshold) continue;
+                const float d = (initial[i].position - initial[j].position).magnitude();
+                if (d < params.inhibitionRadius) {
+                    field += params.inhibitionStrength * initial[i].luminosity * std::exp(-d / params.inhibitionRadius);
+                }
+            }
+            const double expected = initial[j].luminosity / (1.0 + field);
+            worst = std::max(worst, std::abs(particles[j].luminosity - expected) / expected);
+            const float speed = particles[j].velocity.magnitude();
+            if (field > params.repulsionThreshold + 0.01) {
+                ++repelled;
+                repulsion = repulsion && std::abs(speed - field * params.repulsionSpeed) < 0.01 * field * params.repulsionSpeed;
+            }
+        }
+        const bool accurate = worst < 0.005 && repulsion && repelled > 0 &&
+                              inhibition.changes().repelled >= repelled;
+        
+        // Pressure: the blob holds more than a tenth of the neurons
+        params.brightThreshold = 1e9f;
+        DiversityController pressure;
+        pressure.setParams(params);
+        ClusterEngine engine;
+        ClusterParams clusterParams;
+        clusterParams.epsilon = 30.0f;
+        engine.setParams(clusterParams);
+        particles = initial;
+        const ClusterResult& clusters = engine.identify(particles, pool);
+        pressure.update(particles, clusters, 0.016f, pool);
+        bool dimmed = pressure.changes().pressured > 900;
+        for (size_t i = 0; i < initial.size(); ++i) {
+            const int32_t c = clusters.clusterOf[i];
+            const bool big = c >= 0 && clusters.size(c) > initial.size() / 10;
+            const float factor = big ? 0.95f * 0.9f : 1.0f;
+            dimmed = dimmed && std::abs(particles[i].luminosity - initial[i].luminosity * factor) < 1e-5f &&
+                     std::abs(particles[i].temperature - initial[i].temperature * factor) < 1e-2f;
+        }
+        
+        // Everything at once, perturbing every pass: same result on 1 and 4
+        // threads, about 1% perturbed, temperature cooling
+        DiversityParams full;
+        full.enabled = true;
+        full.perturbEvery = 1;
+        auto run = [&](ThreadPool& threads, std::vector<Particle>& out, size_t& perturbed, float& temperature) {
+            DiversityController controller;
+            controller.setParams(full);
+            controller.setSeed(5);
+            out = initial;
+            perturbed = 0;
+            for (int pass = 0; pass < 3; ++pass) {
+                const ClusterResult& found = engine.identify(out, threads);
+                perturbed += controller.update(out, found, 0.016f, threads).perturbed;
+            }
+            temperature = controller.temperature();
+        };
+        ThreadPool single(1);
+        std::vector<Particle> a, b;
+        size_t perturbedA = 0, perturbedB = 0;
+        float temperatureA = 0, temperatureB = 0;
+        run(single, a, perturbedA, temperatureA);
+        run(pool, b, perturbedB, temperatureB);
+        bool deterministic = perturbedA == perturbedB && temperatureA == temperatureB;
+        for (size_t i = 0; i < a.size(); ++i) {
+            deterministic = deterministic && a[i].luminosity == b[i].luminosity &&
+                            a[i].velocity.x == b[i].velocity.x && a[i].velocity.z == b[i].velocity.z;
+        }
+        const bool perturbation = perturbedA > 3 * 6000 / 200 && perturbedA < 3 * 6000 / 50 &&
+                                  std::abs(temperatureA - 1000.0f * std::pow(0.995f, 3.0f)) < 0.01f;
+        
+        bool result = accurate && dimmed && deterministic && perturbation;
+        std::cout << "  Worst luminosity error vs all pairs: " << worst * 100.0 << "%, repelled: " << repelled
+                  << ", perturbed in 3 passes: " << perturbedA << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testSpatialGridQueries() {
+        std::cout << "Testing spatial grid queries..." << std::endl;
+        
+        // A dense disk plus far outliers, so cells are both crowded and empty
+        std::mt19937 rng(7);
+        std::normal_distribution<float> normal(0.0f, 1.0f);
+        std::vector<Vector3> points(20000);
+        for (size_t i = 0; i < points.size(); ++i) {
+            const float spread = i % 100 == 0 ? 5000.0f : 400.0f;
+            points[i] = Vector3(normal(rng) * spread, normal(rng) * 40.0f, normal(rng) * spread);
+        }
+        ThreadPool pool(4);
+        SpatialGrid grid;
+        grid.build(points.size(), [&](size_t i) -> const Vector3& { return points[i]; }, 100.0f, pool);
+        
+        std::vector<Vector3> queries;
+        for (int q = 0; q < 200; ++q) queries.push_back(Vector3(normal(rng) * 600.0f, normal(rng) * 60.0f,
+                                                                normal(rng) * 600.0f));
+        
+        auto sorted = [](std::vector<SpatialHit> hits) {
+            std::vector<uint32_t> ids;
+            for (const SpatialHit& h : hits) ids.push_back(h.index);
+            std::sort(ids.begin(), ids.end());
+            return ids;
+        };
+        
+        int mismatches = 0;
+        std::vector<SpatialHit> hits;
+        for (const Vector3& c : queries) {
+            // Radius
+            std::vector<uint32_t> expected;
+            for (size_t i = 0; i < points.size(); ++i) {
+                if ((points[i] - c).magnitude() <= 150.0f) expected.push_back(i);
+            }
+            grid.radius(c, 150.0f, hits);
+            mismatches += sorted(hits) != expected;
+            
+            // Nearest: same distances as a full sort
+            std::vector<float> distances;
+            for (const Vector3& p : points) distances.push_back((p - c).magnitude());
+            std::sort(distances.begin(), distances.end());
+            grid.nearest(c, 16, hits);
+            bool same = hits.size() == 16;
+            for (size_t k = 0; same && k < hits.size(); ++k) {
+                same = std::abs(hits[k].distance - distances[k]) <= 1e-3f * (1.0f + distances[k]);
+            }
+            mismatches += !same;
+            
+            // Box
+            const Vector3 lo = c - Vector3(120, 30, 80), hi = c + Vector3(120, 30, 80);
+            expected.clear();
+            for (size_t i = 0; i < points.size(); ++i) {
+                const Vector3& p = points[i];
+                if (p.x >= lo.x && p.x <= hi.x && p.y >= lo.y && p.y <= hi.y && p.z >= lo.z && p.z <= hi.z) {
+                    expected.push_back(i);
+                }
+            }
+            grid.box(lo, hi, hits);
+            mismatches += sorted(hits) != expected;
+            
+            // Ray from outside the disk through the query point
+            const Vector3 origin(-3000.0f, 20.0f, c.z * 0.5f), dir = c - origin;
+            const float length = dir.magnitude() * 2.0f;
+            const Vector3 d = dir * (1.0f / dir.magnitude());
+            expected.clear();
+            for (size_t i = 0; i < points.size(); ++i) {
+                const Vector3 r = points[i] - origin;
+                const float t = std::min(length, std::max(0.0f, r.x * d.x + r.y * d.y + r.z * d.z));
+                if ((r - d * t).magnitude() <= 25.0f) expected.push_back(i);
+            }
+            grid.ray(origin, dir, length, 25.0f, hits);
+            mismatches += sorted(hits) != expected;
+        }
+        
+        // Batches agree with single queries
+        SpatialQueryResults batch;
+        grid.nearestBatch(queries, 8, pool, batch);
+        int batchMismatches = batch.queries() != queries.size();
+        for (size_t q = 0; q < queries.size() && !batchMismatches; ++q) {
+            grid.nearest(queries[q], 8, hits);
+            batchMismatches += !std::equal(hits.begin(), hits.end(), batch.begin(q), batch.end(q),
+                [](const SpatialHit& a, const SpatialHit& b) { return a.index == b.index; });
+        }
+        grid.radiusBatch(queries, 150.0f, pool, batch);
+        for (size_t q = 0; q < queries.size(); ++q) {
+            grid.radius(queries[q], 150.0f, hits);
+            batchMismatches += batch.count(q) != hits.size();
+        }
+        
+        // The grid answers for the positions it was built from
+        points[0] = Vector3(1e6f, 1e6f, 1e6f);
+        grid.radius(Vector3(1e6f, 1e6f, 1e6f), 1.0f, hits);
+        const bool snapshot = hits.empty();
+        
+        // A tiny cell over a huge extent must not overflow the cell counts
+        std::vector<Vector3> extremes = {Vector3(-1e30f, 0, 0), Vector3(1e30f, 1e30f, -1e30f), Vector3(0, 0, 0)};
+        SpatialGrid wide;
+        wide.build(extremes.size(), [&](size_t i) -> const Vector3& { return extremes[i]; }, 1e-6f, pool);
+        wide.radius(Vector3(0, 0, 0), 1.0f, hits);
+        const bool clamped = wide.cellCount() <= 64 && hits.size() == 1 && hits[0].index == 2;
+        
+        bool result = mismatches == 0 && batchMismatches == 0 && snapshot && clamped;
+        std::cout << "  Cells: " << grid.cellCount() << " of " << grid.cellSize() << " units, mismatches: "
+                  << mismatches << ", batch mismatches: " << batchMismatches << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        return result;
+    }
+    
+    static bool testDomainDecomposition() {
+        std::cout << "Testing slab cuts and shared-memory rings..." << std::endl;
+        
+        // Cuts at neuron-count quantiles, from exact positions and from a histogram
+        std::vector<float> xs;
+        for (int i = 0; i < 1000; ++i) xs.push_back(i * i * 0.001f);
+        SlabDecomposition exact = SlabDecomposition::balanced(xs, 4);
+        std::vector<int> counts(4, 0);
+        for (float x : xs) counts[exact.owner(x)]++;
+        bool balanced = counts[0] == 250 && counts[1] == 250 && counts[2] == 250 && counts[3] == 250;
+        
+        std::vector<uint64_t> histogram(100, 0);
+        for (float x : xs) histogram[std::min<size_t>(99, static_cast<size_t>(x / 1000.0f * 100))]++;
+        SlabDecomposition binned = SlabDecomposition::fromHistogram(histogram, 0.0f, 1000.0f, 4);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (float x : xs) counts[binned.owner(x)]++;
+        bool histogramBalanced = *std::max_element(counts.begin(), counts.end()) < 300;
+        
+        // Ring wraps around and preserves order
+        SharedSegment segment("/nebula_test_ring_" + std::to_string(getpid()), ShmRing<NeuronRecord>::bytesFor(8));
+        bool ordered = segment.isOpen();
+        if (ordered) {
+            ShmRing<NeuronRecord> ring(segment.data(), 8, true);
+            uint32_t nextIn = 0, nextOut = 0;
+            for (int round = 0; round < 10; ++round) {
+                NeuronRecord r{};
+                for (r.id = nextIn; ring.tryPush(r); r.id = ++nextIn) {}
+                while (ring.tryPop(r)) ordered = ordered && r.id == nextOut++;
+            }
+            ordered = ordered && nextIn == 80 && nextOut == 80;
+        }
+        
+        bool result = balanced && histogramBalanced && ordered;
+        std::cout << "  Histogram cut counts: " << counts[0] << " " << counts[1] << " "
+                  << counts[2] << " " << counts[3] << std::endl;
+        std::cout << "  Result: " << (result ? "PASS" : "FAIL") << std::endl;
+        
+        return result;
+    }
+    
     static bool testPerformanceBenchmark() {
         std::cout << "Testing performance benchmark..." << std::endl;
         
@@ -183,6 +1567,26 @@ int main() {
         {"Gravitational Force", PhysicsValidator::testGravitationalForce},
         {"Wien's Displacement Law", PhysicsValidator::testWiensLaw},
         {"Energy Conservation", PhysicsValidator::testEnergyConservation},
+        {"Exact All-Pairs Gravity", PhysicsValidator::testExactAllPairsGravity},
+        {"Task Graph Ordering", PhysicsValidator::testTaskGraphOrdering},
+        {"Copy-on-Write Fork", PhysicsValidator::testCopyOnWriteFork},
+        {"Frame Arena Steady State", PhysicsValidator::testFrameArenaSteadyState},
+        {"Domain Decomposition", PhysicsValidator::testDomainDecomposition},
+        {"Out-of-Core Chunks", PhysicsValidator::testOutOfCoreChunks},
+        {"Trajectory Stream", PhysicsValidator::testTrajectoryStream},
+        {"Snapshot Loader", PhysicsValidator::testSnapshotLoader},
+        {"Live State Seqlock", PhysicsValidator::testLiveStateSeqlock},
+        {"Injection Queue", PhysicsValidator::testInjectionQueue},
+        {"Spatial Grid Queries", PhysicsValidator::testSpatialGridQueries},
+        {"Active Set", PhysicsValidator::testActiveSet},
+        {"Level of Detail", PhysicsValidator::testLevelOfDetail},
+        {"Cell Streaming", PhysicsValidator::testCellStreaming},
+        {"Cell Streaming Write Failure", PhysicsValidator::testCellStreamingWriteFailure},
+        {"Fusion/Fission", PhysicsValidator::testFusionFission},
+        {"Slot Map Handles", PhysicsValidator::testSlotMapHandles},
+        {"Parallel Clustering", PhysicsValidator::testParallelClustering},
+        {"Cluster Tracking", PhysicsValidator::testClusterTracking},
+        {"Diversity Maintenance", PhysicsValidator::testDiversityMaintenance},
         {"Performance Benchmark", PhysicsValidator::testPerformanceBenchmark}
     };
     